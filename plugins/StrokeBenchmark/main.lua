@@ -0,0 +1,81 @@
+-- Register all Toolbar actions and intialize all UI stuff
+function initUi()
+  app.registerUi({["menu"] = "Run stroke API benchmark", ["callback"] = "benchmark"});
+end
+
+local STROKES = 500
+local POINTS_PER_STROKE = 400
+
+-- Creates spirals spread over the current page
+local function createStrokes()
+  local strokes = {}
+  for s = 1, STROKES do
+    local points = app.newPoints()
+    local cx = 50 + (s % 25) * 20
+    local cy = 50 + math.floor(s / 25) * 35
+    for i = 1, POINTS_PER_STROKE do
+      local angle = i * 0.1
+      local radius = i * 0.02
+      points:append(cx + radius * math.cos(angle), cy + radius * math.sin(angle), 0.5)
+    end
+    strokes[s] = {["points"] = points, ["width"] = 0.8, ["color"] = 0x3333cc}
+  end
+  return strokes
+end
+
+function benchmark()
+  local total = STROKES * POINTS_PER_STROKE
+  local report = {}
+
+  local start = os.clock()
+  local strokes = createStrokes()
+  table.insert(report, string.format("Create %d points: %.1f ms", total, (os.clock() - start) * 1000))
+
+  start = os.clock()
+  app.addStrokes(strokes)
+  table.insert(report, string.format("Add %d strokes (one undo action): %.1f ms", STROKES, (os.clock() - start) * 1000))
+
+  start = os.clock()
+  local read = app.getStrokes()
+  table.insert(report, string.format("Read %d strokes: %.1f ms", #read, (os.clock() - start) * 1000))
+
+  -- Reuse one table for all strokes
+  start = os.clock()
+  local values = {}
+  local sum = 0
+  for _, stroke in ipairs(read) do
+    local _, n = stroke.points:getRange(1, #stroke.points, values)
+    for i = 1, 3 * n, 3 do
+      sum = sum + values[i]
+    end
+  end
+  table.insert(report, string.format("Copy out all points in batches: %.1f ms", (os.clock() - start) * 1000))
+
+  start = os.clock()
+  for _, stroke in ipairs(read) do
+    stroke.points:transform(1, 0, 0, 1, 10, 10)
+  end
+  table.insert(report, string.format("Transform all points: %.1f ms", (os.clock() - start) * 1000))
+
+  -- The strokes added above are the last ones on the layer
+  start = os.clock()
+  local first = #read - STROKES
+  for s = 1, STROKES do
+    app.setStrokePoints(first + s, read[first + s].points)
+  end
+  table.insert(report, string.format("Write back %d strokes (one undo action each): %.1f ms", STROKES,
+                                     (os.clock() - start) * 1000))
+
+  start = os.clock()
+  for _, stroke in ipairs(read) do
+    local points = stroke.points
+    for i = 1, #points do
+      local x, y, p = points:get(i)
+      points:set(i, x, y, p)
+    end
+  end
+  table.insert(report, string.format("Get and set each point: %.1f ms", (os.clock() - start) * 1000))
+
+  table.insert(report, "Use Undo to move the strokes back and to remove them.")
+  app.msgbox(table.concat(report, "\n"), {[1] = "OK"})
+end
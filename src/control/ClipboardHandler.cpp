@@ -5,6 +5,7 @@
 #include <cairo-svg.h>
 #include <config.h>
 
+#include "model/Stroke.h"
 #include "serializing/BinObjectEncoding.h"
 #include "serializing/ObjectInputStream.h"
 #include "serializing/ObjectOutputStream.h"
@@ -69,21 +70,39 @@ auto ElementCompareFunc(Element* a, Element* b) -> gint {
 static GdkAtom atomSvg1 = gdk_atom_intern_static_string("image/svg");
 static GdkAtom atomSvg2 = gdk_atom_intern_static_string("image/svg+xml");
 
-// The contents of the clipboard
-class ClipboardContents {
+/**
+ * The contents of the clipboard. The images are only rendered if another application requests them,
+ * from copies of the elements, as the selection may change or be deleted after copying.
+ * Xournal++ itself only pastes the serialized elements.
+ */
+class ClipboardContents: public ElementContainer {
 public:
-    ClipboardContents(string text, GdkPixbuf* image, string svg, GString* str) {
+    ClipboardContents(string text, GString* str, EditSelection* selection) {
         this->text = std::move(text);
-        this->image = image;
-        this->svg = std::move(svg);
         this->str = str;
+
+        for (Element* e: *selection->getElements()) {
+            this->elements.push_back(e->clone());
+        }
+
+        this->x = selection->getXOnView();
+        this->y = selection->getYOnView();
+        this->width = selection->getWidth();
+        this->height = selection->getHeight();
     }
 
-    ~ClipboardContents() {
-        g_object_unref(this->image);
+    ~ClipboardContents() override {
+        for (Element* e: this->elements) {
+            delete e;
+        }
+
+        if (this->image) {
+            g_object_unref(this->image);
+        }
         g_string_free(this->str, true);
     }
 
+    vector<Element*>* getElements() override { return &this->elements; }
 
     static void getFunction(GtkClipboard* clipboard, GtkSelectionData* selection, guint info,
                             ClipboardContents* contents) {
@@ -94,10 +113,10 @@ public:
         } else if (target == gdk_atom_intern_static_string("image/png") ||
                    target == gdk_atom_intern_static_string("image/jpeg") ||
                    target == gdk_atom_intern_static_string("image/gif")) {
-            gtk_selection_data_set_pixbuf(selection, contents->image);
+            gtk_selection_data_set_pixbuf(selection, contents->getImage());
         } else if (atomSvg1 == target || atomSvg2 == target) {
-            gtk_selection_data_set(selection, target, 8, reinterpret_cast<guchar const*>(contents->svg.c_str()),
-                                   contents->svg.length());
+            const string& svg = contents->getSvg();
+            gtk_selection_data_set(selection, target, 8, reinterpret_cast<guchar const*>(svg.c_str()), svg.length());
         } else if (atomXournal == target) {
             gtk_selection_data_set(selection, target, 8, reinterpret_cast<guchar*>(contents->str->str),
                                    contents->str->len);
@@ -106,17 +125,73 @@ public:
 
     static void clearFunction(GtkClipboard* clipboard, ClipboardContents* contents) { delete contents; }
 
+private:
+    /**
+     * Renders the elements with 300 DPI, once for all image targets
+     */
+    GdkPixbuf* getImage() {
+        if (this->image) {
+            return this->image;
+        }
+
+        double dpiFactor = 1.0 / Util::DPI_NORMALIZATION_FACTOR * 300.0;
+
+        int width = this->width * dpiFactor;
+        int height = this->height * dpiFactor;
+        cairo_surface_t* surfacePng = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+        cairo_t* crPng = cairo_create(surfacePng);
+        cairo_scale(crPng, dpiFactor, dpiFactor);
+
+        cairo_translate(crPng, -this->x, -this->y);
+        DocumentView view;
+        view.drawSelection(crPng, this);
+
+        cairo_destroy(crPng);
+
+        this->image = xoj_pixbuf_get_from_surface(surfacePng, 0, 0, width, height);
+
+        cairo_surface_destroy(surfacePng);
+
+        return this->image;
+    }
+
+    const string& getSvg() {
+        if (!this->svg.empty()) {
+            return this->svg;
+        }
+
+        cairo_surface_t* surfaceSVG = cairo_svg_surface_create_for_stream(
+                reinterpret_cast<cairo_write_func_t>(svgWriteFunction), &this->svg, this->width, this->height);
+        cairo_t* crSVG = cairo_create(surfaceSVG);
+
+        cairo_translate(crSVG, -this->x, -this->y);
+        DocumentView view;
+        view.drawSelection(crSVG, this);
+
+        cairo_destroy(crSVG);
+        cairo_surface_destroy(surfaceSVG);
+
+        return this->svg;
+    }
+
+    static auto svgWriteFunction(string* svg, const unsigned char* data, unsigned int length) -> cairo_status_t {
+        svg->append(reinterpret_cast<const char*>(data), length);
+        return CAIRO_STATUS_SUCCESS;
+    }
+
 private:
     string text;
-    GdkPixbuf* image;
-    string svg;
     GString* str;
-};
 
-static auto svgWriteFunction(GString* string, const unsigned char* data, unsigned int length) -> cairo_status_t {
-    g_string_append_len(string, reinterpret_cast<const gchar*>(data), length);
-    return CAIRO_STATUS_SUCCESS;
-}
+    vector<Element*> elements;
+    double x;
+    double y;
+    double width;
+    double height;
+
+    GdkPixbuf* image = nullptr;
+    string svg;
+};
 
 auto ClipboardHandler::copy() -> bool {
     if (!this->selection) {
@@ -127,7 +202,15 @@ auto ClipboardHandler::copy() -> bool {
     // prepare xournal contents
     /////////////////////////////////////////////////////////////////
 
-    ObjectOutputStream out(new BinObjectEncoding());
+    // Reserve the buffer up front, the points of the strokes make up most of the stream
+    gsize reserve = 4096;
+    for (Element* e: *this->selection->getElements()) {
+        if (e->getType() == ELEMENT_STROKE) {
+            reserve += dynamic_cast<Stroke*>(e)->getPointCount() * sizeof(Point) + 64;
+        }
+    }
+
+    ObjectOutputStream out(new BinObjectEncoding(reserve));
 
     out.writeString(PROJECT_STRING);
 
@@ -156,46 +239,7 @@ auto ClipboardHandler::copy() -> bool {
     g_list_free(textElements);
 
     /////////////////////////////////////////////////////////////////
-    // prepare image contents: PNG
-    /////////////////////////////////////////////////////////////////
-
-    DocumentView view;
-
-    double dpiFactor = 1.0 / Util::DPI_NORMALIZATION_FACTOR * 300.0;
-
-    int width = selection->getWidth() * dpiFactor;
-    int height = selection->getHeight() * dpiFactor;
-    cairo_surface_t* surfacePng = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
-    cairo_t* crPng = cairo_create(surfacePng);
-    cairo_scale(crPng, dpiFactor, dpiFactor);
-
-    cairo_translate(crPng, -selection->getXOnView(), -selection->getYOnView());
-    view.drawSelection(crPng, this->selection);
-
-    cairo_destroy(crPng);
-
-    GdkPixbuf* image = xoj_pixbuf_get_from_surface(surfacePng, 0, 0, width, height);
-
-    cairo_surface_destroy(surfacePng);
-
-    /////////////////////////////////////////////////////////////////
-    // prepare image contents: SVG
-    /////////////////////////////////////////////////////////////////
-
-    GString* svgString = g_string_sized_new(1048576);  // 1MB
-
-    cairo_surface_t* surfaceSVG =
-            cairo_svg_surface_create_for_stream(reinterpret_cast<cairo_write_func_t>(svgWriteFunction), svgString,
-                                                selection->getWidth(), selection->getHeight());
-    cairo_t* crSVG = cairo_create(surfaceSVG);
-
-    view.drawSelection(crSVG, this->selection);
-
-    cairo_surface_destroy(surfaceSVG);
-    cairo_destroy(crSVG);
-
-    /////////////////////////////////////////////////////////////////
-    // copy to clipboard
+    // copy to clipboard, the images are rendered when requested
     /////////////////////////////////////////////////////////////////
 
     GtkTargetList* list = gtk_target_list_new(nullptr, 0);
@@ -214,7 +258,7 @@ auto ClipboardHandler::copy() -> bool {
 
     targets = gtk_target_table_new_from_list(list, &n_targets);
 
-    auto* contents = new ClipboardContents(text, image, svgString->str, out.getStr());
+    auto* contents = new ClipboardContents(text, out.getStr(), this->selection);
 
     gtk_clipboard_set_with_data(this->clipboard, targets, n_targets,
                                 reinterpret_cast<GtkClipboardGetFunc>(ClipboardContents::getFunction),
@@ -224,8 +268,6 @@ auto ClipboardHandler::copy() -> bool {
     gtk_target_table_free(targets, n_targets);
     gtk_target_list_unref(list);
 
-    g_string_free(svgString, true);
-
     return true;
 }
 
@@ -25,10 +25,12 @@
 #include "jobs/CustomExportJob.h"
 #include "jobs/PdfExportJob.h"
 #include "jobs/SaveJob.h"
+#include "jobs/SearchIndexJob.h"
 #include "layer/LayerController.h"
 #include "model/StrokeStyle.h"
 #include "pagetype/PageTypeHandler.h"
 #include "plugin/PluginController.h"
+#include "search/SearchIndex.h"
 #include "serializing/ObjectInputStream.h"
 #include "settings/ButtonConfig.h"
 #include "settings/SettingsEnums.h"
@@ -38,6 +40,8 @@
 #include "undo/InsertDeletePageUndoAction.h"
 #include "undo/InsertUndoAction.h"
 #include "view/TextView.h"
+#include "xojfile/AutosaveJournal.h"
+#include "xojfile/ZipPageIndex.h"
 #include "xojfile/LoadHandler.h"
 
 #include "CrashHandler.h"
@@ -89,6 +93,9 @@ Control::Control(GApplication* gtkApp, GladeSearchpath* gladeSearchPath): gtkApp
 
     this->scheduler = new XournalScheduler();
 
+    this->autosaveJournal = new AutosaveJournal();
+    this->zipPageIndex = new ZipPageIndex();
+
     this->doc = new Document(this);
 
     // for crashhandling
@@ -125,6 +132,9 @@ Control::~Control() {
 
     deleteLastAutosaveFile("");
     this->scheduler->stop();
+    if (this->searchIndex) {
+        this->searchIndex->cancel();
+    }
     this->changedPages.clear();  // can be removed, will be done by implicit destructor
 
     delete this->pluginController;
@@ -159,6 +169,10 @@ Control::~Control() {
     this->zoom = nullptr;
     delete this->scheduler;
     this->scheduler = nullptr;
+    delete this->autosaveJournal;
+    this->autosaveJournal = nullptr;
+    delete this->zipPageIndex;
+    this->zipPageIndex = nullptr;
     delete this->dragDropHandler;
     this->dragDropHandler = nullptr;
     delete this->audioController;
@@ -204,6 +218,18 @@ void Control::renameLastAutosaveFile() {
         errors.emplace_back(FS(fmtstr % filename.u8string() % renamed.u8string() % e.what()));
     }
 
+    // The journal belongs to the renamed file
+    auto journal = AutosaveJournal::getJournalPath(filename);
+    if (fs::exists(journal)) {
+        try {
+            Util::safeRenameFile(journal, AutosaveJournal::getJournalPath(renamed));
+        } catch (fs::filesystem_error const& e) {
+            auto fmtstr = _F("Could not rename autosave file from \"{1}\" to \"{2}\": {3}");
+            errors.emplace_back(FS(fmtstr % journal.u8string() %
+                                   AutosaveJournal::getJournalPath(renamed).u8string() % e.what()));
+        }
+    }
+
 
     if (!errors.empty()) {
         string error = std::accumulate(errors.begin() + 1, errors.end(), *errors.begin(),
@@ -219,9 +245,16 @@ void Control::setLastAutosaveFile(fs::path newAutosaveFile) { this->lastAutosave
 
 void Control::deleteLastAutosaveFile(fs::path newAutosaveFile) {
     fs::remove(this->lastAutosaveFilename);
+    if (!this->lastAutosaveFilename.empty()) {
+        fs::remove(AutosaveJournal::getJournalPath(this->lastAutosaveFilename));
+    }
     this->lastAutosaveFilename = std::move(newAutosaveFile);
 }
 
+auto Control::getAutosaveJournal() -> AutosaveJournal* { return this->autosaveJournal; }
+
+auto Control::getZipPageIndex() -> ZipPageIndex* { return this->zipPageIndex; }
+
 auto Control::checkChangedDocument(Control* control) -> bool {
     if (!control->doc->tryLock()) {
         // call again later
@@ -1601,6 +1634,26 @@ auto Control::searchTextOnPage(string text, int p, int* occures, double* top) ->
     return getWindow()->getXournal()->searchTextOnPage(std::move(text), p, occures, top);
 }
 
+auto Control::getSearchIndex() -> std::shared_ptr<SearchIndex> {
+    this->doc->lock();
+    fs::path pdfFile = this->doc->getPdfFilepath();
+    size_t pdfPageCount = this->doc->getPdfPageCount();
+    this->doc->unlock();
+
+    if (!this->searchIndex || !this->searchIndex->isFor(pdfFile, pdfPageCount)) {
+        if (this->searchIndex) {
+            this->searchIndex->cancel();
+        }
+        this->searchIndex = std::make_shared<SearchIndex>(pdfFile, pdfPageCount);
+
+        auto* job = new SearchIndexJob(this, this->searchIndex);
+        this->scheduler->addJob(job, JOB_PRIORITY_NONE);
+        job->unref();
+    }
+
+    return this->searchIndex;
+}
+
 auto Control::getCurrentPage() -> PageRef {
     this->doc->lock();
     PageRef p = this->doc->getPage(getCurrentPageNo());
@@ -2021,6 +2074,17 @@ auto Control::openFile(fs::path filepath, int scrollToPage, bool forceOpen) -> b
         }
     }
 
+    // An autosave file which is opened to recover it may have changes in its journal.
+    // Only done here, other loads must not modify their input.
+    string journalError;
+    int journalEntries = AutosaveJournal::replay(loadedDocument, filepath, journalError);
+    if (!journalError.empty()) {
+        XojMsgBox::showErrorToUser(getGtkWindow(), journalError);
+    }
+    if (journalEntries > 0) {
+        g_message("%s", FC(_F("Recovered {1} autosave journal entries") % journalEntries));
+    }
+
     this->closeDocument();
 
     this->doc->lock();
@@ -2086,7 +2150,7 @@ void Control::fileLoaded(int scrollToPage) {
     this->doc->unlock();
 
     if (!filepath.empty()) {
-        MetadataEntry md = MetadataManager::getForFile(filepath);
+        MetadataEntry md = this->metadata->getForFile(filepath);
         if (!md.valid) {
             md.zoom = -1;
             md.page = 0;
@@ -2175,7 +2239,7 @@ auto Control::annotatePdf(fs::path filepath, bool /*attachPdf*/, bool attachToDo
         this->doc->lock();
         auto filepath = this->doc->getEvMetadataFilename();
         this->doc->unlock();
-        MetadataEntry md = MetadataManager::getForFile(filepath);
+        MetadataEntry md = this->metadata->getForFile(filepath);
         loadMetadata(md);
     } else {
         this->doc->lock();
@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -36,10 +37,12 @@
 #include "XournalType.h"
 
 class AudioController;
+class AutosaveJournal;
 class FullscreenHandler;
 class Sidebar;
 class XojPageView;
 class SaveHandler;
+class ZipPageIndex;
 class GladeSearchpath;
 class MetadataManager;
 class XournalppCursor;
@@ -52,6 +55,7 @@ class PageTypeMenu;
 class BaseExportJob;
 class LayerController;
 class PluginController;
+class SearchIndex;
 
 class Control:
         public ActionHandler,
@@ -177,6 +181,11 @@ public:
 
     bool searchTextOnPage(string text, int p, int* occures, double* top);
 
+    /**
+     * The full text index of the current document, it is built in the background on first use
+     */
+    std::shared_ptr<SearchIndex> getSearchIndex();
+
     /**
      * Fire page selected, but first check if the page Number is valid
      *
@@ -225,6 +234,8 @@ public:
     void renameLastAutosaveFile();
     void setLastAutosaveFile(fs::path newAutosaveFile);
     void deleteLastAutosaveFile(fs::path newAutosaveFile);
+    AutosaveJournal* getAutosaveJournal();
+    ZipPageIndex* getZipPageIndex();
     void setClipboardHandlerSelection(EditSelection* selection);
 
     MetadataManager* getMetadataManager();
@@ -385,6 +396,21 @@ private:
     int autosaveTimeout = 0;
     fs::path lastAutosaveFilename;
 
+    /**
+     * Journal of the pages changed since the last full autosave, only used by the AutosaveJob
+     */
+    AutosaveJournal* autosaveJournal = nullptr;
+
+    /**
+     * Page entries of the last saved zip container, only used by the SaveJob
+     */
+    ZipPageIndex* zipPageIndex = nullptr;
+
+    /**
+     * Full text index of the current document, filled by the SearchIndexJob
+     */
+    std::shared_ptr<SearchIndex> searchIndex;
+
     XournalScheduler* scheduler;
 
     /**
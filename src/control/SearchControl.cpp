@@ -3,12 +3,14 @@
 #include <utility>
 
 #include "model/Layer.h"
+#include "search/SearchIndex.h"
 #include "model/Text.h"
 #include "view/TextView.h"
 
-SearchControl::SearchControl(const PageRef& page, XojPdfPageSPtr pdf) {
+SearchControl::SearchControl(const PageRef& page, XojPdfPageSPtr pdf, std::shared_ptr<SearchIndex> index) {
     this->page = page;
     this->pdf = std::move(pdf);
+    this->index = std::move(index);
 }
 
 SearchControl::~SearchControl() { freeSearchResults(); }
@@ -37,7 +39,9 @@ auto SearchControl::search(string text, int* occures, double* top) -> bool {
     }
 
     if (this->pdf) {
-        this->results = this->pdf->findText(text);
+        if (!this->index || !this->index->findOnPdfPage(this->page->getPdfPageNr(), text, this->results)) {
+            this->results = this->pdf->findText(text);
+        }
     }
 
     for (Layer* l: *this->page->getLayers()) {
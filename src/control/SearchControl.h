@@ -11,12 +11,16 @@
 
 #pragma once
 
+#include <memory>
+
 #include "model/PageRef.h"
 #include "pdf/base/XojPdfPage.h"
 
+class SearchIndex;
+
 class SearchControl {
 public:
-    SearchControl(const PageRef& page, XojPdfPageSPtr pdf);
+    SearchControl(const PageRef& page, XojPdfPageSPtr pdf, std::shared_ptr<SearchIndex> index);
     virtual ~SearchControl();
 
     bool search(string text, int* occures, double* top);
@@ -29,5 +33,10 @@ private:
     PageRef page;
     XojPdfPageSPtr pdf;
 
+    /**
+     * Has the text of the PDF page once it is indexed
+     */
+    std::shared_ptr<SearchIndex> index;
+
     vector<XojPdfRectangle> results;
 };
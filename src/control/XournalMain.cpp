@@ -8,9 +8,11 @@
 #include <gui/toolbarMenubar/model/ToolbarColorNames.h>
 #include <libintl.h>
 
+#include "control/jobs/BatchExport.h"
 #include "control/jobs/ImageExport.h"
 #include "control/jobs/ProgressListener.h"
 #include "gui/GladeSearchpath.h"
+#include "gui/LatencyTrace.h"
 #include "gui/MainWindow.h"
 #include "gui/XournalView.h"
 #include "pdf/base/XojPdfExport.h"
@@ -21,6 +23,7 @@
 #include "Control.h"
 #include "Stacktrace.h"
 #include "StringUtils.h"
+#include "ThreadPool.h"
 #include "XojMsgBox.h"
 #include "config-dev.h"
 #include "config-paths.h"
@@ -52,10 +55,13 @@ auto migrateSettings() -> MigrateResult;
 void checkForErrorlog();
 void checkForEmergencySave(Control* control);
 
-auto exportPdf(const char* input, const char* output, const char* range, bool noBackground, bool presentationMode)
-        -> int;
+auto exportPdf(const char* input, const char* output, const char* range, bool noBackground, bool presentationMode,
+               int workers) -> int;
 auto exportImg(const char* input, const char* output, const char* range, int pngDpi, int pngWidth, int pngHeight,
-               bool noBackground) -> int;
+               bool noBackground, int workers) -> int;
+auto exportBatch(gchar** inputs, const char* manifest, const char* outputDir, const char* format, const char* range,
+                 int pngDpi, int pngWidth, int pngHeight, bool noBackground, bool presentationMode, int workers)
+        -> int;
 
 void initResourcePath(GladeSearchpath* gladePath, const gchar* relativePathAndFile, bool failIfNotFound = true);
 
@@ -236,13 +242,14 @@ void checkForEmergencySave(Control* control) {
  * @param pngWidth Set the width for Png files. Non positive values are ignored
  * @param pngHeight Set the height for Png files. Non positive values are ignored
  * @param noBackground If true, the exported image file has transparent background
+ * @param workers Count of pages exported concurrently. Non positive values use one per CPU core
  *
  *  The priority is: pngDpi overwrites pngWidth overwrites pngHeight
  *
  * @return 0 on success, -2 on failure opening the input file, -3 on export failure
  */
 auto exportImg(const char* input, const char* output, const char* range, int pngDpi, int pngWidth, int pngHeight,
-               bool noBackground) -> int {
+               bool noBackground, int workers) -> int {
     LoadHandler loader;
 
     Document* doc = loader.loadDocument(input);
@@ -267,7 +274,8 @@ auto exportImg(const char* input, const char* output, const char* range, int png
 
     DummyProgressListener progress;
 
-    ImageExport imgExport(doc, path, format, noBackground, exportRange);
+    ImageExport imgExport(doc->createSnapshot(), path, format, noBackground, exportRange);
+    imgExport.setWorkerCount(workers > 0 ? workers : ThreadPool::getDefaultThreadCount());
 
     if (format == EXPORT_GRAPHICS_PNG) {
         if (pngDpi > 0) {
@@ -304,11 +312,12 @@ auto exportImg(const char* input, const char* output, const char* range, int png
  * @param noBackground If true, the exported pdf file has white background
  * @param presentationMode If true, then for each xournalpp page, instead of rendering one PDF page, the page layers are
  * rendered one by one to produce as many pages as there are layers.
+ * @param workers Count of pages exported concurrently. Non positive values use one per CPU core
  *
  * @return 0 on success, -2 on failure opening the input file, -3 on export failure
  */
-auto exportPdf(const char* input, const char* output, const char* range, bool noBackground, bool presentationMode)
-        -> int {
+auto exportPdf(const char* input, const char* output, const char* range, bool noBackground, bool presentationMode,
+               int workers) -> int {
     LoadHandler loader;
 
     Document* doc = loader.loadDocument(input);
@@ -318,8 +327,9 @@ auto exportPdf(const char* input, const char* output, const char* range, bool no
 
     GFile* file = g_file_new_for_commandline_arg(output);
 
-    XojPdfExport* pdfe = XojPdfExportFactory::createExport(doc, nullptr);
+    XojPdfExport* pdfe = XojPdfExportFactory::createExport(doc->createSnapshot(), nullptr);
     pdfe->setNoBackgroundExport(noBackground);
+    pdfe->setWorkerCount(workers > 0 ? workers : ThreadPool::getDefaultThreadCount());
     char* cpath = g_file_get_path(file);
     string path = cpath;
     g_free(cpath);
@@ -352,6 +362,52 @@ auto exportPdf(const char* input, const char* output, const char* range, bool no
     return 0;  // no error
 }
 
+/**
+ * @brief Convert many files within one process, see BatchExport
+ * @param inputs The files to convert, may be nullptr
+ * @param manifest A file listing further files to convert, one per line. May be nullptr
+ * @param outputDir The folder of the converted files
+ * @param format The output format: pdf, png or svg. If format=nullptr, exports as pdf
+ *
+ * The other parameters are the same as for exportImg and exportPdf
+ *
+ * @return 0 on success, -2 on invalid arguments, -3 if any file could not be converted
+ */
+auto exportBatch(gchar** inputs, const char* manifest, const char* outputDir, const char* format, const char* range,
+                 int pngDpi, int pngWidth, int pngHeight, bool noBackground, bool presentationMode, int workers)
+        -> int {
+    ExportGraphicsFormat exportFormat = format ? BatchExport::parseFormat(format) : EXPORT_GRAPHICS_PDF;
+    if (exportFormat == EXPORT_GRAPHICS_UNDEFINED) {
+        g_warning("%s", FC(_F("Unsupported batch export format \"{1}\"") % format));
+        return -2;
+    }
+
+    BatchExport batch(fs::u8path(outputDir), exportFormat);
+
+    for (gchar** input = inputs; input && *input; input++) {
+        batch.addInput(fs::u8path(*input));
+    }
+    if (manifest && !batch.addManifest(fs::u8path(manifest))) {
+        g_warning("%s", FC(_F("Could not read the batch manifest \"{1}\"") % manifest));
+        return -2;
+    }
+
+    batch.setRange(range);
+    batch.setNoBackground(noBackground);
+    batch.setPresentationMode(presentationMode);
+    batch.setWorkerCount(workers > 0 ? workers : 0);
+
+    if (pngDpi > 0) {
+        batch.setQualityParameter(RasterImageQualityParameter(EXPORT_QUALITY_DPI, pngDpi));
+    } else if (pngWidth > 0) {
+        batch.setQualityParameter(RasterImageQualityParameter(EXPORT_QUALITY_WIDTH, pngWidth));
+    } else if (pngHeight > 0) {
+        batch.setQualityParameter(RasterImageQualityParameter(EXPORT_QUALITY_HEIGHT, pngHeight));
+    }
+
+    return batch.run() == 0 ? 0 : -3;
+}
+
 struct XournalMainPrivate {
     XournalMainPrivate() = default;
     XournalMainPrivate(XournalMainPrivate&&) = delete;
@@ -363,11 +419,17 @@ struct XournalMainPrivate {
         g_strfreev(optFilename);
         g_free(pdfFilename);
         g_free(imgFilename);
+        g_free(batchDir);
+        g_free(batchManifest);
+        g_free(batchFormat);
     }
 
     gchar** optFilename{};
     gchar* pdfFilename{};
     gchar* imgFilename{};
+    gchar* batchDir{};
+    gchar* batchManifest{};
+    gchar* batchFormat{};
     gboolean showVersion = false;
     int openAtPageNumber = 0;  // when no --page is used, the document opens at the page specified in the metadata file
     gchar* exportRange{};
@@ -378,6 +440,8 @@ struct XournalMainPrivate {
             false;  // don't use bool, see
                     // https://stackoverflow.com/questions/21152042/is-glib-command-line-parsing-order-sensitive
     gboolean presentationMode = false;
+    int exportWorkers = -1;
+    gboolean traceLatency = false;
     std::unique_ptr<GladeSearchpath> gladePath;
     std::unique_ptr<Control> control;
     std::unique_ptr<MainWindow> win;
@@ -496,6 +560,7 @@ void on_open_files(GApplication*, gpointer, gint, gchar*, XMPtr) {
 void on_startup(GApplication* application, XMPtr app_data) {
     initLocalisation();
     ensure_input_model_compatibility();
+    LatencyTrace::setEnabled(app_data->traceLatency);
     MigrateResult migrateResult = migrateSettings();
 
     app_data->gladePath = std::make_unique<GladeSearchpath>();
@@ -582,13 +647,20 @@ auto on_handle_local_options(GApplication*, GVariantDict*, XMPtr app_data) -> gi
         return 0;
     }
 
+    if (app_data->batchDir) {
+        return exportBatch(app_data->optFilename, app_data->batchManifest, app_data->batchDir, app_data->batchFormat,
+                           app_data->exportRange, app_data->exportPngDpi, app_data->exportPngWidth,
+                           app_data->exportPngHeight, app_data->exportNoBackground, app_data->presentationMode,
+                           app_data->exportWorkers);
+    }
     if (app_data->pdfFilename && app_data->optFilename && *app_data->optFilename) {
         return exportPdf(*app_data->optFilename, app_data->pdfFilename, app_data->exportRange,
-                         app_data->exportNoBackground, app_data->presentationMode);
+                         app_data->exportNoBackground, app_data->presentationMode, app_data->exportWorkers);
     }
     if (app_data->imgFilename && app_data->optFilename && *app_data->optFilename) {
         return exportImg(*app_data->optFilename, app_data->imgFilename, app_data->exportRange, app_data->exportPngDpi,
-                         app_data->exportPngWidth, app_data->exportPngHeight, app_data->exportNoBackground);
+                         app_data->exportPngWidth, app_data->exportPngHeight, app_data->exportNoBackground,
+                         app_data->exportWorkers);
     }
     return -1;
 }
@@ -598,6 +670,7 @@ void on_shutdown(GApplication*, XMPtr app_data) {
     app_data->win->getXournal()->clearSelection();
     app_data->control->getScheduler()->stop();
     ToolbarColorNames::getInstance().save();
+    LatencyTrace::getInstance().report();
 }
 
 }  // namespace
@@ -619,6 +692,8 @@ auto XournalMain::run(int argc, char** argv) -> int {
                                        "<input>", nullptr},
                           GOptionEntry{"version", 0, 0, G_OPTION_ARG_NONE, &app_data.showVersion,
                                        _("Get version of xournalpp"), nullptr},
+                          GOptionEntry{"trace-latency", 0, 0, G_OPTION_ARG_NONE, &app_data.traceLatency,
+                                       _("Log the latency from pen input to the screen"), nullptr},
                           GOptionEntry{nullptr}};  // Must be terminated by a nullptr. See gtk doc
     g_application_add_main_option_entries(G_APPLICATION(app), options.data());
 
@@ -633,6 +708,18 @@ auto XournalMain::run(int argc, char** argv) -> int {
                            "                                 Guess the output format from the extension of IMGFILE\n"
                            "                                 Supported formats: .png, .svg"),
                          "IMGFILE"},
+            GOptionEntry{"batch-export", 0, G_OPTION_FLAG_IN_MAIN, G_OPTION_ARG_FILENAME, &app_data.batchDir,
+                         _("Export all FILEs into DIR without opening a window\n"
+                           "                                 Prints the timings and the throughput at the end"),
+                         "DIR"},
+            GOptionEntry{"batch-manifest", 0, 0, G_OPTION_ARG_FILENAME, &app_data.batchManifest,
+                         _("Also export the files listed in MANIFEST, one per line\n"
+                           "                                 No effect without --batch-export"),
+                         "MANIFEST"},
+            GOptionEntry{"batch-format", 0, 0, G_OPTION_ARG_STRING, &app_data.batchFormat,
+                         _("Set the format of the batch export: pdf, png or svg. Default is pdf\n"
+                           "                                 No effect without --batch-export"),
+                         "FORMAT"},
             GOptionEntry{"export-no-background", 0, 0, G_OPTION_ARG_NONE, &app_data.exportNoBackground,
                          _("Export without background\n"
                            "                                 The exported file has transparent or white background,\n"
@@ -662,6 +749,11 @@ auto XournalMain::run(int argc, char** argv) -> int {
                       "                                 No effect without -i/--create-img=foo.png\n"
                       "                                 Ignored if --export-png-dpi or --export-png-width is used"),
                     "N"},
+            GOptionEntry{"export-workers", 0, 0, G_OPTION_ARG_INT, &app_data.exportWorkers,
+                         _("Set the count of pages exported concurrently. Default is one per CPU core\n"
+                           "                                 No effect without -p/--create-pdf, -i/--create-img\n"
+                           "                                 or --batch-export"),
+                         "N"},
             GOptionEntry{nullptr}};  // Must be terminated by a nullptr. See gtk doc
     GOptionGroup* exportGroup = g_option_group_new("export", _("Advanced export options"),
                                                    _("Display advanced export options"), nullptr, nullptr);
@@ -1,6 +1,7 @@
 #include "AutosaveJob.h"
 
 #include "control/Control.h"
+#include "control/xojfile/AutosaveJournal.h"
 #include "control/xojfile/SaveHandler.h"
 
 #include "XojMsgBox.h"
@@ -24,11 +25,13 @@ void AutosaveJob::run() {
 
     Document* doc = control->getDocument();
 
+    // Only copy the modified pages while locked, serializing runs on the snapshot
     doc->lock();
-    handler.prepareSave(doc);
-    auto filepath = doc->getFilepath();
+    auto snapshot = doc->createSnapshot();
     doc->unlock();
 
+    auto filepath = snapshot->getFilepath();
+
     if (filepath.empty()) {
         filepath = Util::getAutosaveFilepath();
     } else {
@@ -37,10 +40,20 @@ void AutosaveJob::run() {
     Util::clearExtensions(filepath);
     filepath += ".autosave.xopp";
 
+    AutosaveJournal* journal = control->getAutosaveJournal();
+    if (journal->append(filepath, snapshot)) {
+        g_message("%s", FS(_F("Autosave journal appended to {1}") % filepath.string()).c_str());
+        return;
+    }
+    if (!journal->getLastError().empty()) {
+        g_warning("%s", journal->getLastError().c_str());
+    }
+
     control->renameLastAutosaveFile();
 
     g_message("%s", FS(_F("Autosaving to {1}") % filepath.string()).c_str());
 
+    handler.prepareSave(*snapshot);
     handler.saveTo(filepath);
 
     this->error = handler.getErrorMessage();
@@ -49,6 +62,7 @@ void AutosaveJob::run() {
     } else {
         // control->deleteLastAutosaveFile(filepath);
         control->setLastAutosaveFile(filepath);
+        journal->compacted(filepath, snapshot);
     }
 }
 
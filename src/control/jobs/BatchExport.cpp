@@ -0,0 +1,281 @@
+#include "BatchExport.h"
+
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <utility>
+
+#include "control/xojfile/LoadHandler.h"
+#include "model/Document.h"
+#include "pdf/base/XojPdfExport.h"
+#include "pdf/base/XojPdfExportFactory.h"
+
+#include "PageRange.h"
+#include "ProgressListener.h"
+#include "StringUtils.h"
+#include "ThreadPool.h"
+#include "i18n.h"
+
+/**
+ * Count of documents loaded ahead of the export, each of them is kept in memory
+ */
+constexpr size_t LOAD_AHEAD = 2;
+
+struct BatchExport::LoadedDocument {
+    fs::path input;
+
+    /**
+     * The document belongs to its LoadHandler
+     */
+    std::unique_ptr<LoadHandler> loader;
+    Document* doc = nullptr;
+
+    string error;
+};
+
+namespace {
+/**
+ * Remembers the count of pages an exporter announces
+ */
+class PageCountListener: public ProgressListener {
+public:
+    void setMaximumState(int max) override { this->pageCount = max; }
+    void setCurrentState(int state) override {}
+
+    int pageCount = 0;
+};
+
+auto secondsSince(gint64 start) -> double { return (g_get_monotonic_time() - start) / 1e6; }
+
+auto formatNumber(double value) -> string {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2) << value;
+    return out.str();
+}
+}  // namespace
+
+BatchExport::BatchExport(fs::path outputDir, ExportGraphicsFormat format):
+        outputDir(std::move(outputDir)), format(format) {}
+
+BatchExport::~BatchExport() = default;
+
+void BatchExport::addInput(fs::path const& input) { this->inputs.push_back(input); }
+
+auto BatchExport::addManifest(fs::path const& manifest) -> bool {
+    std::ifstream in(manifest);
+    if (!in.is_open()) {
+        return false;
+    }
+
+    string line;
+    while (std::getline(in, line)) {
+        line = StringUtils::trim(line);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        fs::path input = fs::u8path(line);
+        if (input.is_relative()) {
+            input = manifest.parent_path() / input;
+        }
+        addInput(input);
+    }
+
+    return !in.bad();
+}
+
+void BatchExport::setNoBackground(bool noBackground) { this->noBackground = noBackground; }
+
+void BatchExport::setPresentationMode(bool presentationMode) { this->presentationMode = presentationMode; }
+
+void BatchExport::setRange(const char* range) { this->range = range ? range : ""; }
+
+void BatchExport::setQualityParameter(RasterImageQualityParameter qParam) { this->qualityParameter = qParam; }
+
+void BatchExport::setWorkerCount(unsigned int workerCount) { this->workerCount = workerCount; }
+
+auto BatchExport::parseFormat(const string& format) -> ExportGraphicsFormat {
+    string f = StringUtils::toLowerCase(format);
+    if (f == "pdf") {
+        return EXPORT_GRAPHICS_PDF;
+    }
+    if (f == "png") {
+        return EXPORT_GRAPHICS_PNG;
+    }
+    if (f == "svg") {
+        return EXPORT_GRAPHICS_SVG;
+    }
+    return EXPORT_GRAPHICS_UNDEFINED;
+}
+
+auto BatchExport::getOutputPath(fs::path const& input) const -> fs::path {
+    fs::path output = this->outputDir / input.filename();
+    switch (this->format) {
+        case EXPORT_GRAPHICS_PNG:
+            return output.replace_extension(".png");
+        case EXPORT_GRAPHICS_SVG:
+            return output.replace_extension(".svg");
+        default:
+            return output.replace_extension(".pdf");
+    }
+}
+
+auto BatchExport::exportDocument(LoadedDocument& loaded, int& pages) -> string {
+    Document* doc = loaded.doc;
+    fs::path output = getOutputPath(loaded.input);
+    unsigned int workers = this->workerCount > 0 ? this->workerCount : ThreadPool::getDefaultThreadCount();
+
+    PageRangeVector exportRange;
+    if (!this->range.empty()) {
+        exportRange = PageRange::parse(this->range.c_str(), int(doc->getPageCount()));
+    } else {
+        exportRange.push_back(new PageRangeEntry(0, int(doc->getPageCount() - 1)));
+    }
+
+    PageCountListener progress;
+    string error;
+
+    if (this->format == EXPORT_GRAPHICS_PDF) {
+        std::unique_ptr<XojPdfExport> pdfe(XojPdfExportFactory::createExport(doc->createSnapshot(), &progress));
+        pdfe->setNoBackgroundExport(this->noBackground);
+        pdfe->setWorkerCount(workers);
+
+        if (!pdfe->createPdf(output, exportRange, this->presentationMode)) {
+            error = pdfe->getLastError();
+        }
+        this->renderTime += pdfe->getRenderTime();
+        this->encodeTime += pdfe->getEncodeTime();
+    } else {
+        ImageExport imgExport(doc->createSnapshot(), output, this->format, this->noBackground, exportRange);
+        if (this->format == EXPORT_GRAPHICS_PNG) {
+            imgExport.setQualityParameter(this->qualityParameter);
+        }
+        imgExport.setWorkerCount(workers);
+        imgExport.exportGraphics(&progress);
+        error = imgExport.getLastErrorMsg();
+        this->renderTime += imgExport.getRenderTime();
+        this->encodeTime += imgExport.getEncodeTime();
+    }
+
+    for (PageRangeEntry* e: exportRange) {
+        delete e;
+    }
+    exportRange.clear();
+
+    pages = progress.pageCount;
+    return error;
+}
+
+auto BatchExport::run() -> int {
+    gint64 start = g_get_monotonic_time();
+
+    if (!this->outputDir.empty()) {
+        std::error_code ec;
+        fs::create_directories(this->outputDir, ec);
+    }
+
+    // Inputs with the same file name would overwrite each other's output, only the first one is exported
+    vector<fs::path> inputs;
+    std::set<fs::path> outputs;
+    for (fs::path const& input: this->inputs) {
+        fs::path output = getOutputPath(input);
+        if (!outputs.insert(output.lexically_normal()).second) {
+            g_warning("%s", FC(_F("Skipping \"{1}\": \"{2}\" is already exported from another file") %
+                               input.u8string() % output.u8string()));
+            this->failedFiles++;
+            continue;
+        }
+        inputs.push_back(input);
+    }
+
+    // Stage 1: the documents are loaded on a separate thread, while the previous document is exported
+    ThreadPool loadPool(1);
+    std::deque<std::future<LoadedDocument>> loading;
+    size_t nextInput = 0;
+
+    auto loadNext = [&]() {
+        auto promise = std::make_shared<std::promise<LoadedDocument>>();
+        loading.push_back(promise->get_future());
+
+        fs::path input = inputs[nextInput++];
+        loadPool.addTask([this, promise, input]() {
+            gint64 loadStart = g_get_monotonic_time();
+
+            LoadedDocument loaded;
+            loaded.input = input;
+            loaded.loader = std::make_unique<LoadHandler>();
+            loaded.doc = loaded.loader->loadDocument(input);
+            if (loaded.doc == nullptr) {
+                loaded.error = loaded.loader->getLastError();
+            }
+
+            // Only the load thread writes loadTime, it is read after the pool is finished
+            this->loadTime += secondsSince(loadStart);
+            promise->set_value(std::move(loaded));
+        });
+    };
+
+    while (loading.size() < LOAD_AHEAD && nextInput < inputs.size()) {
+        loadNext();
+    }
+
+    // Stage 2 and 3: the pages are rendered and encoded concurrently by the exporters
+    while (!loading.empty()) {
+        gint64 waitStart = g_get_monotonic_time();
+        LoadedDocument loaded = loading.front().get();
+        loading.pop_front();
+        this->loadWaitTime += secondsSince(waitStart);
+
+        if (nextInput < inputs.size()) {
+            loadNext();
+        }
+
+        if (loaded.doc == nullptr) {
+            g_warning("%s", FC(_F("Could not load \"{1}\": {2}") % loaded.input.u8string() % loaded.error));
+            this->failedFiles++;
+            continue;
+        }
+
+        gint64 exportStart = g_get_monotonic_time();
+        int pages = 0;
+        string error = exportDocument(loaded, pages);
+        this->exportTime += secondsSince(exportStart);
+
+        if (!error.empty()) {
+            g_warning("%s", FC(_F("Could not export \"{1}\": {2}") % loaded.input.u8string() % error));
+            this->failedFiles++;
+            continue;
+        }
+
+        this->exportedFiles++;
+        this->exportedPages += pages;
+    }
+
+    loadPool.waitAll();
+
+    printStatistics(secondsSince(start));
+
+    return this->failedFiles;
+}
+
+void BatchExport::printStatistics(double wallTime) const {
+    double seconds = std::max(wallTime, 1e-6);
+
+    std::cout << FS(_F("Converted {1} of {2} files ({3} pages) in {4} s") % this->exportedFiles %
+                    this->inputs.size() % this->exportedPages % formatNumber(wallTime))
+              << std::endl;
+    std::cout << FS(_F("  load:   {1} s") % formatNumber(this->loadTime)) << std::endl;
+    std::cout << FS(_F("  export: {1} s") % formatNumber(this->exportTime)) << std::endl;
+    std::cout << FS(_F("    render: {1} s (all workers)") % formatNumber(this->renderTime)) << std::endl;
+    std::cout << FS(_F("    encode: {1} s (all workers)") % formatNumber(this->encodeTime)) << std::endl;
+    std::cout << FS(_F("  waiting for load: {1} s") % formatNumber(this->loadWaitTime)) << std::endl;
+    std::cout << FS(_F("Throughput: {1} files/s, {2} pages/s") % formatNumber(this->exportedFiles / seconds) %
+                    formatNumber(this->exportedPages / seconds))
+              << std::endl;
+}
@@ -0,0 +1,115 @@
+/*
+ * Xournal++
+ *
+ * Headless conversion of many documents within one process
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "ImageExport.h"
+#include "XournalType.h"
+#include "filesystem.h"
+
+/**
+ * @brief Converts a list of documents to PDF or image files
+ *
+ * The documents are loaded on a separate thread ahead of the export, so loading the next
+ * documents overlaps with rendering and encoding the current one. The pages of each document
+ * are rendered and encoded concurrently by the PDF and image exporters.
+ */
+class BatchExport {
+public:
+    BatchExport(fs::path outputDir, ExportGraphicsFormat format);
+    virtual ~BatchExport();
+
+public:
+    void addInput(fs::path const& input);
+
+    /**
+     * @brief Add the files listed in a manifest, one path per line.
+     * Empty lines and lines starting with # are ignored, relative paths are resolved against the manifest folder.
+     * @return false if the manifest could not be read
+     */
+    bool addManifest(fs::path const& manifest);
+
+    void setNoBackground(bool noBackground);
+    void setPresentationMode(bool presentationMode);
+
+    /**
+     * @param range Page range applied to every document, nullptr to export all pages
+     */
+    void setRange(const char* range);
+
+    void setQualityParameter(RasterImageQualityParameter qParam);
+
+    /**
+     * @param workerCount Count of pages exported concurrently, 0 to use one per CPU core
+     */
+    void setWorkerCount(unsigned int workerCount);
+
+    /**
+     * @brief Convert all documents and print the stage timings and the throughput
+     * Documents whose output file is already written by a previous document are skipped.
+     * @return The count of documents which could not be converted
+     */
+    int run();
+
+    /**
+     * @brief Parse the format given on the command line
+     * @return EXPORT_GRAPHICS_UNDEFINED if the format is unknown
+     */
+    static ExportGraphicsFormat parseFormat(const string& format);
+
+private:
+    struct LoadedDocument;
+
+    /**
+     * @return The path of the file exported from input
+     */
+    fs::path getOutputPath(fs::path const& input) const;
+
+    /**
+     * @brief Export a loaded document
+     * @param pages returns the count of exported pages
+     * @return The error message, empty on success
+     */
+    string exportDocument(LoadedDocument& loaded, int& pages);
+
+    void printStatistics(double wallTime) const;
+
+private:
+    fs::path outputDir;
+    ExportGraphicsFormat format = EXPORT_GRAPHICS_PDF;
+
+    vector<fs::path> inputs;
+
+    bool noBackground = false;
+    bool presentationMode = false;
+    string range;
+    RasterImageQualityParameter qualityParameter;
+    unsigned int workerCount = 0;
+
+    /**
+     * Statistics, in seconds
+     */
+    double loadTime = 0;
+    double exportTime = 0;
+
+    /**
+     * Reported by the exporters, summed over their workers
+     */
+    double renderTime = 0;
+    double encodeTime = 0;
+    double loadWaitTime = 0;
+    int exportedFiles = 0;
+    int failedFiles = 0;
+    int exportedPages = 0;
+};
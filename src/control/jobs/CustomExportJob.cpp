@@ -12,6 +12,7 @@
 #include "ImageExport.h"
 #include "PathUtil.h"
 #include "SaveJob.h"
+#include "ThreadPool.h"
 #include "XojMsgBox.h"
 #include "i18n.h"
 
@@ -110,38 +111,50 @@ auto CustomExportJob::showFilechooser() -> bool {
  */
 void CustomExportJob::exportGraphics() {
     bool hideBackground = filters.at(this->chosenFilterName)->withoutBackground;
-    ImageExport imgExport(control->getDocument(), filepath, format, hideBackground, exportRange);
+    Document* doc = control->getDocument();
+    doc->lock();
+    auto snapshot = doc->createSnapshot();
+    doc->unlock();
+
+    ImageExport imgExport(snapshot, filepath, format, hideBackground, exportRange);
     if (format == EXPORT_GRAPHICS_PNG) {
         imgExport.setQualityParameter(pngQualityParameter);
     }
+    imgExport.setWorkerCount(ThreadPool::getDefaultThreadCount());
     imgExport.exportGraphics(control);
     errorMsg = imgExport.getLastErrorMsg();
 }
 
 void CustomExportJob::run() {
     if (exportTypeXoj) {
-        SaveJob::updatePreview(control);
         Document* doc = this->control->getDocument();
 
-        XojExportHandler h;
         doc->lock();
-        h.prepareSave(doc);
-        h.saveTo(filepath, this->control);
+        auto snapshot = doc->createSnapshot();
         doc->unlock();
 
+        SaveJob::updatePreview(doc, *snapshot);
+
+        XojExportHandler h;
+        h.prepareSave(*snapshot);
+        h.saveTo(filepath, this->control);
+
         if (!h.getErrorMessage().empty()) {
             this->lastError = FS(_F("Save file error: {1}") % h.getErrorMessage());
 
             callAfterRun();
         }
     } else if (format == EXPORT_GRAPHICS_PDF) {
-        // don't lock the page here for the whole flow, else we get a dead lock...
-        // the ui is blocked, so there should be no changes...
         Document* doc = control->getDocument();
 
-        XojPdfExport* pdfe = XojPdfExportFactory::createExport(doc, control);
+        doc->lock();
+        auto snapshot = doc->createSnapshot();
+        doc->unlock();
+
+        XojPdfExport* pdfe = XojPdfExportFactory::createExport(snapshot, control);
 
         pdfe->setNoBackgroundExport(filters[this->chosenFilterName]->withoutBackground);
+        pdfe->setWorkerCount(ThreadPool::getDefaultThreadCount());
 
         if (!pdfe->createPdf(this->filepath, exportRange, presentationMode)) {
             this->errorMsg = pdfe->getLastError();
@@ -1,21 +1,28 @@
 #include "ImageExport.h"
 
+#include <algorithm>
 #include <cmath>
+#include <condition_variable>
 #include <utility>
 
 #include <cairo-svg.h>
 
 #include "control/jobs/ProgressListener.h"
-#include "model/Document.h"
+#include "model/DocumentSnapshot.h"
 #include "view/PdfView.h"
 
+#include "ThreadPool.h"
 #include "Util.h"
 #include "i18n.h"
 
 
-ImageExport::ImageExport(Document* doc, fs::path file, ExportGraphicsFormat format, bool hideBackground,
-                         PageRangeVector& exportRange):
-        doc(doc), file(std::move(file)), format(format), hideBackground(hideBackground), exportRange(exportRange) {}
+ImageExport::ImageExport(std::shared_ptr<DocumentSnapshot> snapshot, fs::path file, ExportGraphicsFormat format,
+                         bool hideBackground, PageRangeVector& exportRange):
+        snapshot(std::move(snapshot)),
+        file(std::move(file)),
+        format(format),
+        hideBackground(hideBackground),
+        exportRange(exportRange) {}
 
 ImageExport::~ImageExport() = default;
 
@@ -34,12 +41,70 @@ void ImageExport::setQualityParameter(ExportQualityCriterion criterion, int valu
     this->qualityParameter = RasterImageQualityParameter(criterion, value);
 }
 
+/**
+ * @brief Set the count of pages rendered and encoded concurrently
+ * @param workerCount The count of worker threads, 1 exports the pages one after another
+ */
+void ImageExport::setWorkerCount(unsigned int workerCount) { this->workerCount = std::max(workerCount, 1U); }
+
+auto ImageExport::getRenderTime() const -> double { return this->renderTime / 1e6; }
+
+auto ImageExport::getEncodeTime() const -> double { return this->encodeTime / 1e6; }
+
+/**
+ * @brief Limit the memory used by the raster surfaces of the pages exported concurrently
+ * @param bytes The memory budget in bytes
+ */
+void ImageExport::setMemoryBudget(size_t bytes) { this->memoryBudget = bytes; }
+
 /**
  * @brief Get the last error message
  * @return The last error message to show to the user
  */
 auto ImageExport::getLastErrorMsg() const -> string { return lastError; }
 
+void ImageExport::setLastError(const string& error) {
+    std::lock_guard<std::mutex> lock(this->errorMutex);
+    this->lastError = error;
+}
+
+/**
+ * @brief Get the zoom ratio of a PNG page
+ * @param width the width of the page being exported
+ * @param height the height of the page being exported
+ * @param zoomRatio the zoom ratio for PNG exports with fixed DPI
+ */
+auto ImageExport::getPngZoomRatio(double width, double height, double zoomRatio) -> double {
+    switch (this->qualityParameter.getQualityCriterion()) {
+        case EXPORT_QUALITY_WIDTH:
+            return ((double)this->qualityParameter.getValue()) / width;
+        case EXPORT_QUALITY_HEIGHT:
+            return ((double)this->qualityParameter.getValue()) / height;
+        case EXPORT_QUALITY_DPI:  // Use the zoomRatio given as argument
+        default:
+            return zoomRatio;
+    }
+}
+
+/**
+ * @brief Estimate the memory used by the surface of a page
+ * @param page The page being exported
+ * @param zoomRatio the zoom ratio for PNG exports with fixed DPI
+ */
+auto ImageExport::getSurfaceSize(const PageRef& page, double zoomRatio) -> size_t {
+    if (this->format != EXPORT_GRAPHICS_PNG) {
+        // SVG surfaces are streamed to the file
+        return 0;
+    }
+
+    zoomRatio = getPngZoomRatio(page->getWidth(), page->getHeight(), zoomRatio);
+    auto width = static_cast<size_t>(std::round(page->getWidth() * zoomRatio));
+    auto height = static_cast<size_t>(std::round(page->getHeight() * zoomRatio));
+
+    // ARGB32
+    return width * height * 4;
+}
+
 /**
  * @brief Create Cairo surface for a given page
  * @param width the width of the page being exported
@@ -52,32 +117,20 @@ auto ImageExport::getLastErrorMsg() const -> string { return lastError; }
  * height (in pixels). In this case, the zoomRatio (and the DPI) is page-dependent as soon as the document has pages of
  * different sizes.
  */
-auto ImageExport::createSurface(double width, double height, int id, double zoomRatio) -> double {
+auto ImageExport::createSurface(double width, double height, int id, double zoomRatio, cairo_surface_t*& surface,
+                                cairo_t*& cr) -> double {
     switch (this->format) {
         case EXPORT_GRAPHICS_PNG:
-            switch (this->qualityParameter.getQualityCriterion()) {
-                case EXPORT_QUALITY_WIDTH:
-                    zoomRatio = ((double)this->qualityParameter.getValue()) / width;
-                    this->surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, this->qualityParameter.getValue(),
-                                                               (int)std::round(height * zoomRatio));
-                    break;
-                case EXPORT_QUALITY_HEIGHT:
-                    zoomRatio = ((double)this->qualityParameter.getValue()) / height;
-                    this->surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, (int)std::round(width * zoomRatio),
-                                                               this->qualityParameter.getValue());
-                    break;
-                case EXPORT_QUALITY_DPI:  // Use the zoomRatio given as argument
-                    this->surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, (int)std::round(width * zoomRatio),
-                                                               (int)std::round(height * zoomRatio));
-                    break;
-            }
-            this->cr = cairo_create(this->surface);
-            cairo_scale(this->cr, zoomRatio, zoomRatio);
+            zoomRatio = getPngZoomRatio(width, height, zoomRatio);
+            surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, (int)std::round(width * zoomRatio),
+                                                 (int)std::round(height * zoomRatio));
+            cr = cairo_create(surface);
+            cairo_scale(cr, zoomRatio, zoomRatio);
             return zoomRatio;
         case EXPORT_GRAPHICS_SVG:
-            this->surface = cairo_svg_surface_create(getFilenameWithNumber(id).u8string().c_str(), width, height);
-            cairo_svg_surface_restrict_to_version(this->surface, CAIRO_SVG_VERSION_1_2);
-            this->cr = cairo_create(this->surface);
+            surface = cairo_svg_surface_create(getFilenameWithNumber(id).u8string().c_str(), width, height);
+            cairo_svg_surface_restrict_to_version(surface, CAIRO_SVG_VERSION_1_2);
+            cr = cairo_create(surface);
             break;
         default:
             g_error("Unsupported graphics format: %i", this->format);
@@ -88,8 +141,8 @@ auto ImageExport::createSurface(double width, double height, int id, double zoom
 /**
  * Free / store the surface
  */
-auto ImageExport::freeSurface(int id) -> bool {
-    cairo_destroy(this->cr);
+auto ImageExport::freeSurface(int id, cairo_surface_t* surface, cairo_t* cr) -> bool {
+    cairo_destroy(cr);
 
     cairo_status_t status = CAIRO_STATUS_SUCCESS;
     if (format == EXPORT_GRAPHICS_PNG) {
@@ -132,30 +185,41 @@ auto ImageExport::getFilenameWithNumber(int no) const -> fs::path {
  */
 void ImageExport::exportImagePage(int pageId, int id, double zoomRatio, ExportGraphicsFormat format,
                                   DocumentView& view) {
-    doc->lock();
-    PageRef page = doc->getPage(pageId);
-    doc->unlock();
+    gint64 renderStart = g_get_monotonic_time();
+    PageRef page = snapshot->getPage(pageId);
 
-    zoomRatio = createSurface(page->getWidth(), page->getHeight(), id, zoomRatio);
+    cairo_surface_t* surface = nullptr;
+    cairo_t* cr = nullptr;
+    zoomRatio = createSurface(page->getWidth(), page->getHeight(), id, zoomRatio, surface, cr);
 
-    cairo_status_t state = cairo_surface_status(this->surface);
+    cairo_status_t state = cairo_surface_status(surface);
     if (state != CAIRO_STATUS_SUCCESS) {
-        this->lastError = _("Error save image #1");
+        cairo_destroy(cr);
+        cairo_surface_destroy(surface);
+        setLastError(_("Error save image #1"));
         return;
     }
 
     if (page->getBackgroundType().isPdfPage()) {
+        std::lock_guard<std::mutex> lock(this->pdfMutex);
+
         int pgNo = page->getPdfPageNr();
-        XojPdfPageSPtr popplerPage = doc->getPdfPage(pgNo);
+        XojPdfPageSPtr popplerPage = snapshot->getPdfDocument().getPage(pgNo);
 
         PdfView::drawPage(nullptr, popplerPage, cr, zoomRatio, page->getWidth(), page->getHeight());
     }
 
-    view.drawPage(page, this->cr, true, hideBackground);
+    view.drawPage(page, cr, true, hideBackground);
+
+    // The PNG is compressed and the SVG written when the surface is stored
+    gint64 encodeStart = g_get_monotonic_time();
+    this->renderTime += encodeStart - renderStart;
+    bool stored = freeSurface(id, surface, cr);
+    this->encodeTime += g_get_monotonic_time() - encodeStart;
 
-    if (!freeSurface(id)) {
+    if (!stored) {
         // could not create this file...
-        this->lastError = _("Error save image #2");
+        setLastError(_("Error save image #2"));
         return;
     }
 }
@@ -165,9 +229,7 @@ void ImageExport::exportImagePage(int pageId, int id, double zoomRatio, ExportGr
  * @param stateListener A listener to track the export progress
  */
 void ImageExport::exportGraphics(ProgressListener* stateListener) {
-    // don't lock the page here for the whole flow, else we get a dead lock...
-    // the ui is blocked, so there should be no changes...
-    int count = doc->getPageCount();
+    int count = snapshot->getPageCount();
 
     bool onePage =
             ((this->exportRange.size() == 1) && (this->exportRange[0]->getFirst() == this->exportRange[0]->getLast()));
@@ -194,6 +256,20 @@ void ImageExport::exportGraphics(ProgressListener* stateListener) {
         zoomRatio = ((double)this->qualityParameter.getValue()) / Util::DPI_NORMALIZATION_FACTOR;
     }
 
+    if (this->workerCount > 1 && selectedCount > 1) {
+        std::vector<int> pages;
+        std::vector<int> ids;
+        for (int i = 0; i < count; i++) {
+            if (selectedPages[i]) {
+                pages.push_back(i);
+                ids.push_back(onePage ? -1 : i + 1);
+            }
+        }
+
+        exportGraphicsParallel(pages, ids, zoomRatio, stateListener);
+        return;
+    }
+
     DocumentView view;
     int current = 0;
 
@@ -211,6 +287,58 @@ void ImageExport::exportGraphics(ProgressListener* stateListener) {
     }
 }
 
+/**
+ * @brief Export the selected pages on a thread pool, each worker renders and encodes its own page
+ * @param pages The indices of the pages to export
+ * @param ids The numbers of the pages to export
+ * @param zoomRatio The zoom ratio for PNG exports with fixed DPI
+ * @param stateListener A listener to track the export progress
+ */
+void ImageExport::exportGraphicsParallel(const std::vector<int>& pages, const std::vector<int>& ids,
+                                         double zoomRatio, ProgressListener* stateListener) {
+    ThreadPool pool(this->workerCount);
+
+    std::mutex budgetMutex;
+    std::condition_variable pageFinished;
+    size_t usedMemory = 0;
+    int finishedCount = 0;
+
+    for (size_t n = 0; n < pages.size(); n++) {
+        PageRef page = snapshot->getPage(pages[n]);
+
+        size_t surfaceSize = getSurfaceSize(page, zoomRatio);
+
+        {
+            // Wait until the surface fits into the budget, a single page is always exported
+            std::unique_lock<std::mutex> lock(budgetMutex);
+            pageFinished.wait(lock,
+                              [&]() { return usedMemory == 0 || usedMemory + surfaceSize <= this->memoryBudget; });
+            usedMemory += surfaceSize;
+        }
+
+        int pageId = pages[n];
+        int id = ids[n];
+        pool.addTask([&, pageId, id, surfaceSize]() {
+            // The background painters are not shared between threads
+            DocumentView view;
+            view.setPopplerMutex(&this->pdfMutex);
+            exportImagePage(pageId, id, zoomRatio, format, view);
+
+            int state = 0;
+            {
+                std::lock_guard<std::mutex> lock(budgetMutex);
+                usedMemory -= surfaceSize;
+                state = finishedCount++;
+            }
+            pageFinished.notify_all();
+
+            stateListener->setCurrentState(state);
+        });
+    }
+
+    pool.waitAll();
+}
+
 RasterImageQualityParameter::RasterImageQualityParameter() = default;
 RasterImageQualityParameter::RasterImageQualityParameter(ExportQualityCriterion criterion, int value):
         qualityCriterion(criterion), value(value) {}
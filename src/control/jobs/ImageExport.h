@@ -11,6 +11,9 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -22,7 +25,7 @@
 #include "XournalType.h"
 #include "filesystem.h"
 
-class Document;
+class DocumentSnapshot;
 class ProgressListener;
 
 enum ExportGraphicsFormat { EXPORT_GRAPHICS_UNDEFINED, EXPORT_GRAPHICS_PDF, EXPORT_GRAPHICS_PNG, EXPORT_GRAPHICS_SVG };
@@ -68,8 +71,11 @@ private:
  */
 class ImageExport {
 public:
-    ImageExport(Document* doc, fs::path file, ExportGraphicsFormat format, bool hideBackground,
-                PageRangeVector& exportRange);
+    /**
+     * The pages are rendered from the snapshot, the document does not need to be locked while exporting
+     */
+    ImageExport(std::shared_ptr<DocumentSnapshot> snapshot, fs::path file, ExportGraphicsFormat format,
+                bool hideBackground, PageRangeVector& exportRange);
     virtual ~ImageExport();
 
 public:
@@ -98,24 +104,62 @@ public:
      */
     void setQualityParameter(ExportQualityCriterion criterion, int value);
 
+    /**
+     * @brief Set the count of pages rendered and encoded concurrently
+     * @param workerCount The count of worker threads, 1 exports the pages one after another
+     */
+    void setWorkerCount(unsigned int workerCount);
+
+    /**
+     * @brief Limit the memory used by the raster surfaces of the pages exported concurrently.
+     * A single page is always exported, even if it exceeds the budget.
+     * @param bytes The memory budget in bytes
+     */
+    void setMemoryBudget(size_t bytes);
+
+    /**
+     * @brief The time spent drawing the pages and storing them as PNG / SVG files, summed over all workers
+     * @return The time in seconds
+     */
+    double getRenderTime() const;
+    double getEncodeTime() const;
+
 private:
+    /**
+     * @brief Get the zoom ratio of a PNG page
+     * @param width the width of the page being exported
+     * @param height the height of the page being exported
+     * @param zoomRatio the zoom ratio for PNG exports with fixed DPI
+     */
+    double getPngZoomRatio(double width, double height, double zoomRatio);
+
+    /**
+     * @brief Estimate the memory used by the surface of a page
+     * @param page The page being exported
+     * @param zoomRatio the zoom ratio for PNG exports with fixed DPI
+     */
+    size_t getSurfaceSize(const PageRef& page, double zoomRatio);
+
     /**
      * @brief Create Cairo surface for a given page
      * @param width the width of the page being exported
      * @param height the height of the page being exported
      * @param id the id of the page being exported
      * @param zoomRatio the zoom ratio for PNG exports with fixed DPI
+     * @param surface returns the created surface
+     * @param cr returns the Cairo context of the surface
      *
      * @return the zoom ratio of the current page if the export type is PNG, 0.0 otherwise
      *          The return value may differ from that of the parameter zoomRatio
      *          if the export has fixed page width or height (in pixels)
      */
-    double createSurface(double width, double height, int id, double zoomRatio);
+    double createSurface(double width, double height, int id, double zoomRatio, cairo_surface_t*& surface,
+                         cairo_t*& cr);
 
     /**
      * Free / store the surface
      */
-    bool freeSurface(int id);
+    bool freeSurface(int id, cairo_surface_t* surface, cairo_t* cr);
 
     /**
      * @brief Get a filename with a (page) number appended
@@ -136,11 +180,23 @@ private:
      */
     void exportImagePage(int pageId, int id, double zoomRatio, ExportGraphicsFormat format, DocumentView& view);
 
+    /**
+     * @brief Export the selected pages on a thread pool, each worker renders and encodes its own page
+     * @param pages The indices of the pages to export
+     * @param ids The numbers of the pages to export
+     * @param zoomRatio The zoom ratio for PNG exports with fixed DPI
+     * @param stateListener A listener to track the export progress
+     */
+    void exportGraphicsParallel(const std::vector<int>& pages, const std::vector<int>& ids, double zoomRatio,
+                                ProgressListener* stateListener);
+
+    void setLastError(const string& error);
+
 public:
     /**
-     * Document to export
+     * Snapshot of the document to export
      */
-    Document* doc = nullptr;
+    std::shared_ptr<DocumentSnapshot> snapshot;
 
     /**
      * Filename for export
@@ -168,17 +224,33 @@ public:
     RasterImageQualityParameter qualityParameter = RasterImageQualityParameter();
 
     /**
-     * Export surface
+     * Count of pages exported concurrently
      */
-    cairo_surface_t* surface = nullptr;
+    unsigned int workerCount = 1;
 
     /**
-     * Cairo context
+     * Memory budget for the surfaces of the pages exported concurrently, 512 MiB by default
      */
-    cairo_t* cr = nullptr;
+    size_t memoryBudget = 512 * 1024 * 1024;
+
+    /**
+     * Time spent in exportImagePage(), in microseconds
+     */
+    std::atomic<gint64> renderTime{0};
+    std::atomic<gint64> encodeTime{0};
 
     /**
      * The last error message to show to the user
      */
     string lastError;
+
+    /**
+     * Protects lastError
+     */
+    std::mutex errorMutex;
+
+    /**
+     * Poppler is not thread safe, PDF backgrounds and TeX images are rendered one after another
+     */
+    std::mutex pdfMutex;
 };
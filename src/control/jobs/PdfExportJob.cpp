@@ -4,6 +4,7 @@
 #include "pdf/base/XojPdfExport.h"
 #include "pdf/base/XojPdfExportFactory.h"
 
+#include "ThreadPool.h"
 #include "i18n.h"
 
 PdfExportJob::PdfExportJob(Control* control): BaseExportJob(control, _("PDF Export")) {}
@@ -29,9 +30,13 @@ void PdfExportJob::run() {
     Document* doc = control->getDocument();
 
     doc->lock();
-    XojPdfExport* pdfe = XojPdfExportFactory::createExport(doc, control);
+    auto snapshot = doc->createSnapshot();
     doc->unlock();
 
+    XojPdfExport* pdfe = XojPdfExportFactory::createExport(snapshot, control);
+
+    pdfe->setWorkerCount(ThreadPool::getDefaultThreadCount());
+
     if (!pdfe->createPdf(this->filepath, false)) {
         if (control->getWindow()) {
             callAfterRun();
@@ -1,9 +1,12 @@
 #include "SaveJob.h"
 
+#include <memory>
+
 #include <config.h>
 
 #include "control/Control.h"
 #include "control/xojfile/SaveHandler.h"
+#include "control/xojfile/ZipSaveHandler.h"
 #include "view/DocumentView.h"
 
 #include "PathUtil.h"
@@ -32,15 +35,12 @@ void SaveJob::afterRun() {
     }
 }
 
-void SaveJob::updatePreview(Control* control) {
+void SaveJob::updatePreview(Document* doc, DocumentSnapshot& snapshot) {
     const int previewSize = 128;
 
-    Document* doc = control->getDocument();
-
-    doc->lock();
-
-    if (doc->getPageCount() > 0) {
-        PageRef page = doc->getPage(0);
+    // Render from the snapshot, so the document does not need to be locked while rendering
+    if (snapshot.getPageCount() > 0) {
+        PageRef page = snapshot.getPage(0);
 
         double width = page->getWidth();
         double height = page->getHeight();
@@ -62,7 +62,7 @@ void SaveJob::updatePreview(Control* control) {
 
         if (page->getBackgroundType().isPdfPage()) {
             int pgNo = page->getPdfPageNr();
-            XojPdfPageSPtr popplerPage = doc->getPdfPage(pgNo);
+            XojPdfPageSPtr popplerPage = snapshot.getPdfDocument().getPage(pgNo);
             if (popplerPage) {
                 popplerPage->render(cr, false);
             }
@@ -71,25 +71,40 @@ void SaveJob::updatePreview(Control* control) {
         DocumentView view;
         view.drawPage(page, cr, true);
         cairo_destroy(cr);
-        doc->setPreview(crBuffer);
+        snapshot.setPreview(crBuffer);
         cairo_surface_destroy(crBuffer);
     } else {
-        doc->setPreview(nullptr);
+        snapshot.setPreview(nullptr);
     }
 
+    doc->lock();
+    doc->setPreview(snapshot.getPreview());
     doc->unlock();
 }
 
 auto SaveJob::save() -> bool {
-    updatePreview(control);
     Document* doc = this->control->getDocument();
-    SaveHandler h;
+    Settings* settings = this->control->getSettings();
+
+    std::unique_ptr<SaveHandler> h;
+    if (settings->isSaveZipContainer()) {
+        auto zipHandler = std::make_unique<ZipSaveHandler>();
+        zipHandler->setAudioFolder(fs::u8path(settings->getAudioFolder()));
+        zipHandler->setPageIndex(this->control->getZipPageIndex());
+        h = std::move(zipHandler);
+    } else {
+        h = std::make_unique<SaveHandler>();
+    }
 
     doc->lock();
-    h.prepareSave(doc);
-    fs::path const filepath = doc->getFilepath();
+    auto snapshot = doc->createSnapshot();
     doc->unlock();
 
+    // The snapshot is independent of the document, so the user may continue editing while saving
+    updatePreview(doc, *snapshot);
+    h->prepareSave(*snapshot);
+    fs::path const filepath = snapshot->getFilepath();
+
     if (doc->shouldCreateBackupOnSave()) {
         try {
             Util::safeRenameFile(filepath, fs::path{filepath} += "~");
@@ -102,13 +117,14 @@ auto SaveJob::save() -> bool {
 
     auto const target = fs::path{filepath}.replace_extension(".xopp");
 
+    h->saveTo(target, this->control);
+
     doc->lock();
-    h.saveTo(target, this->control);
     doc->setFilepath(target);
     doc->unlock();
 
-    if (!h.getErrorMessage().empty()) {
-        this->lastError = FS(_F("Save file error: {1}") % h.getErrorMessage());
+    if (!h->getErrorMessage().empty()) {
+        this->lastError = FS(_F("Save file error: {1}") % h->getErrorMessage());
         if (!control->getWindow()) {
             g_error("%s", this->lastError.c_str());
         }
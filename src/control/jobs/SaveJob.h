@@ -14,6 +14,8 @@
 #include <string>
 #include <vector>
 
+#include "model/DocumentSnapshot.h"
+
 #include "BlockingJob.h"
 #include "XournalType.h"
 
@@ -29,7 +31,10 @@ public:
 
     bool save();
 
-    static void updatePreview(Control* control);
+    /**
+     * Renders the preview of the first page of the snapshot and sets it on the snapshot and the document
+     */
+    static void updatePreview(Document* doc, DocumentSnapshot& snapshot);
 
 protected:
     virtual void afterRun();
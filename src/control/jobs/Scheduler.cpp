@@ -240,10 +240,12 @@ auto Scheduler::jobThreadCallback(Scheduler* scheduler) -> gpointer {
 
         SDEBUG("do job: %" PRId64, (uint64_t)job);
 
-        g_mutex_unlock(&scheduler->jobQueueMutex);
-
+        // Mark the job as running before it leaves the queue lock, else removeSource() could find it neither
+        // in the queue nor running, and return while it still accesses its source
         g_mutex_lock(&scheduler->jobRunningMutex);
 
+        g_mutex_unlock(&scheduler->jobQueueMutex);
+
         job->execute();
 
         job->unref();
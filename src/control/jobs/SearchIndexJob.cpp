@@ -0,0 +1,75 @@
+#include "SearchIndexJob.h"
+
+#include <utility>
+
+#include "control/Control.h"
+#include "control/search/SearchIndex.h"
+
+/**
+ * PDF pages indexed by one run
+ */
+constexpr size_t PAGES_PER_RUN = 8;
+
+SearchIndexJob::SearchIndexJob(Control* control, std::shared_ptr<SearchIndex> index, bool loadCache):
+        control(control), index(std::move(index)), loadCache(loadCache) {}
+
+SearchIndexJob::~SearchIndexJob() = default;
+
+void SearchIndexJob::run() {
+    if (this->index->isCancelled() || this->index->getPdfPageCount() == 0) {
+        return;
+    }
+
+    if (this->loadCache && this->index->load(this->index->getCacheFile()) && this->index->isComplete()) {
+        callAfterRun();
+        return;
+    }
+
+    Document* doc = control->getDocument();
+    size_t pdfPage = this->index->getNextPdfPage();
+    for (size_t i = 0; i < PAGES_PER_RUN && pdfPage < this->index->getPdfPageCount(); i++, pdfPage++) {
+        doc->lock();
+        XojPdfPageSPtr page;
+        if (this->index->isFor(doc->getPdfFilepath(), doc->getPdfPageCount())) {
+            page = doc->getPdfPage(pdfPage);
+        } else {
+            // Another PDF was loaded in the meantime
+            this->index->cancel();
+        }
+        doc->unlock();
+
+        if (this->index->isCancelled()) {
+            return;
+        }
+
+        std::u32string text;
+        vector<XojPdfRectangle> glyphs;
+        if (page) {
+            page->getTextLayout(text, glyphs);
+        }
+        this->index->addPdfPage(pdfPage, text, glyphs);
+    }
+
+    if (this->index->isComplete()) {
+        this->index->save(this->index->getCacheFile());
+        SearchIndex::cleanupCache();
+    }
+
+    callAfterRun();
+}
+
+void SearchIndexJob::afterRun() {
+    if (this->index->isCancelled()) {
+        return;
+    }
+
+    if (!this->index->isComplete()) {
+        auto* job = new SearchIndexJob(this->control, this->index, false);
+        control->getScheduler()->addJob(job, JOB_PRIORITY_NONE);
+        job->unref();
+    }
+}
+
+auto SearchIndexJob::getType() -> JobType { return JOB_TYPE_SEARCH_INDEX; }
+
+auto SearchIndexJob::getSource() -> void* { return this->index.get(); }
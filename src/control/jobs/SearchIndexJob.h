@@ -0,0 +1,47 @@
+/*
+ * Xournal++
+ *
+ * Extracts the text of the PDF background for the search index
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Job.h"
+#include "XournalType.h"
+
+class Control;
+class SearchIndex;
+
+/**
+ * Indexes a few PDF pages per run and then schedules the next run, so rendering is not
+ * blocked for long. The first run tries to load the index from the cache directory.
+ */
+class SearchIndexJob: public Job {
+public:
+    SearchIndexJob(Control* control, std::shared_ptr<SearchIndex> index, bool loadCache = true);
+
+protected:
+    virtual ~SearchIndexJob();
+
+public:
+    virtual void run();
+    void afterRun();
+
+    virtual JobType getType();
+
+    virtual void* getSource();
+
+private:
+    Control* control = nullptr;
+    std::shared_ptr<SearchIndex> index;
+    bool loadCache = true;
+};
@@ -0,0 +1,67 @@
+#include "SearchJob.h"
+
+#include <utility>
+
+#include "control/Control.h"
+#include "Util.h"
+
+/**
+ * Pages searched by one run
+ */
+constexpr size_t PAGES_PER_RUN = 16;
+
+SearchJob::SearchJob(Control* control, std::shared_ptr<SearchIndex> index, string text, size_t firstPage,
+                     size_t pageCount):
+        control(control),
+        index(std::move(index)),
+        text(std::move(text)),
+        firstPage(firstPage),
+        pageCount(pageCount) {}
+
+SearchJob::~SearchJob() = default;
+
+void SearchJob::cancel() { this->cancelled = true; }
+
+auto SearchJob::isCancelled() const -> bool { return this->cancelled; }
+
+auto SearchJob::getText() const -> const string& { return this->text; }
+
+void SearchJob::run() {
+    vector<size_t> pages;
+    vector<SearchResult> results;
+
+    // The trigram index excludes the PDF pages which cannot contain the text, once per search
+    if (this->searchedPages == 0) {
+        this->pdfCandidates = this->index->findPdfCandidates(this->text);
+    }
+
+    Document* doc = control->getDocument();
+    for (size_t i = 0; i < PAGES_PER_RUN && this->searchedPages < this->pageCount; i++, this->searchedPages++) {
+        if (isCancelled()) {
+            return;
+        }
+
+        size_t page = (this->firstPage + this->searchedPages) % this->pageCount;
+        this->index->searchPage(doc, page, this->text, this->pdfCandidates, results);
+        pages.push_back(page);
+    }
+
+    bool finished = this->searchedPages >= this->pageCount;
+
+    // Released by the callback
+    this->ref();
+    Util::execInUiThread([this, pages = std::move(pages), results = std::move(results), finished]() {
+        if (!isCancelled()) {
+            control->getSearchBar()->searchResultsFound(this, pages, results, finished);
+        }
+        this->unref();
+    });
+
+    if (!finished && !isCancelled()) {
+        control->getScheduler()->addJob(this, JOB_PRIORITY_LOW);
+    }
+}
+
+auto SearchJob::getType() -> JobType { return JOB_TYPE_SEARCH; }
+
+auto SearchJob::getSource() -> void* { return this->index.get(); }
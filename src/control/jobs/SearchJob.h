@@ -0,0 +1,72 @@
+/*
+ * Xournal++
+ *
+ * Searches the pages of the document in the background
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "control/search/SearchIndex.h"
+
+#include "Job.h"
+#include "XournalType.h"
+
+class Control;
+
+/**
+ * Searches a few pages per run, starting at a page and wrapping around at the end of the
+ * document, and then schedules the next run, so rendering is not blocked for long.
+ * The results of each run are passed to SearchBar::searchResultsFound() on the UI thread.
+ */
+class SearchJob: public Job {
+public:
+    SearchJob(Control* control, std::shared_ptr<SearchIndex> index, string text, size_t firstPage, size_t pageCount);
+
+protected:
+    virtual ~SearchJob();
+
+public:
+    /**
+     * Stops searching, e.g. because the text was changed. Can be called from any thread.
+     */
+    void cancel();
+    bool isCancelled() const;
+
+    const string& getText() const;
+
+    virtual void run();
+
+    virtual JobType getType();
+
+    virtual void* getSource();
+
+private:
+    Control* control = nullptr;
+    std::shared_ptr<SearchIndex> index;
+    string text;
+
+    size_t firstPage = 0;
+    size_t pageCount = 0;
+
+    /**
+     * Count of pages searched, in search order beginning at firstPage
+     */
+    size_t searchedPages = 0;
+
+    /**
+     * The PDF pages which can contain the text, see SearchIndex::findPdfCandidates()
+     */
+    vector<bool> pdfCandidates;
+
+    std::atomic<bool> cancelled{false};
+};
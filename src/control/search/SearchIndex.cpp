@@ -0,0 +1,564 @@
+#include "SearchIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include "model/Document.h"
+#include "model/Layer.h"
+#include "model/Text.h"
+#include "serializing/BinObjectEncoding.h"
+#include "serializing/InputStreamException.h"
+#include "serializing/ObjectInputStream.h"
+#include "serializing/ObjectOutputStream.h"
+
+#include "PathUtil.h"
+
+/**
+ * Increase if the format of the cache file changes
+ */
+constexpr int CACHE_VERSION = 1;
+
+constexpr auto CACHE_EXTENSION = ".index";
+
+/**
+ * Count of index files kept in the cache directory
+ */
+constexpr size_t MAX_CACHE_FILES = 32;
+
+/**
+ * Characters of context shown before and after an occurrence
+ */
+constexpr size_t CONTEXT_BEFORE = 30;
+constexpr size_t CONTEXT_AFTER = 50;
+
+namespace {
+/**
+ * Case insensitive comparison, line breaks match spaces
+ */
+inline auto fold(char32_t c) -> char32_t {
+    if (g_unichar_isspace(c)) {
+        return U' ';
+    }
+    return g_unichar_tolower(c);
+}
+
+inline auto trigram(char32_t a, char32_t b, char32_t c) -> uint64_t {
+    return (static_cast<uint64_t>(a) << 42) | (static_cast<uint64_t>(b) << 21) | static_cast<uint64_t>(c);
+}
+
+inline auto toGlyphUnit(double v) -> uint16_t {
+    return static_cast<uint16_t>(std::clamp(std::round(v * 8), 0.0, 65535.0));
+}
+}  // namespace
+
+SearchIndex::SearchIndex(fs::path pdfFile, size_t pdfPageCount): pdfFile(std::move(pdfFile)) {
+    this->pdfPages.resize(pdfPageCount);
+}
+
+SearchIndex::~SearchIndex() = default;
+
+auto SearchIndex::isFor(const fs::path& pdfFile, size_t pdfPageCount) const -> bool {
+    return this->pdfFile == pdfFile && this->pdfPages.size() == pdfPageCount;
+}
+
+auto SearchIndex::getPdfPageCount() const -> size_t { return this->pdfPages.size(); }
+
+auto SearchIndex::getIndexedPdfPageCount() -> size_t {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->indexedPdfPages;
+}
+
+auto SearchIndex::getNextPdfPage() -> size_t {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    for (size_t i = 0; i < this->pdfPages.size(); i++) {
+        if (!this->pdfPages[i]) {
+            return i;
+        }
+    }
+    return this->pdfPages.size();
+}
+
+auto SearchIndex::isComplete() -> bool { return getIndexedPdfPageCount() == getPdfPageCount(); }
+
+void SearchIndex::cancel() { this->cancelled = true; }
+
+auto SearchIndex::isCancelled() const -> bool { return this->cancelled; }
+
+void SearchIndex::addPdfPage(size_t pdfPage, const std::u32string& text, const vector<XojPdfRectangle>& glyphs) {
+    vector<GlyphBox> boxes;
+    boxes.reserve(glyphs.size());
+    for (const XojPdfRectangle& r: glyphs) {
+        boxes.push_back({toGlyphUnit(r.x1), toGlyphUnit(r.y1), toGlyphUnit(r.x2), toGlyphUnit(r.y2)});
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    addPdfPageUnlocked(pdfPage, text, std::move(boxes));
+}
+
+void SearchIndex::addPdfPageUnlocked(size_t pdfPage, std::u32string text, vector<GlyphBox> glyphs) {
+    if (pdfPage >= this->pdfPages.size() || this->pdfPages[pdfPage] || text.size() != glyphs.size()) {
+        return;
+    }
+
+    std::u32string folded = toLower(text);
+    vector<uint64_t> keys;
+    for (size_t i = 0; i + 2 < folded.size(); i++) {
+        keys.push_back(trigram(folded[i], folded[i + 1], folded[i + 2]));
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    auto page = static_cast<uint32_t>(pdfPage);
+    for (uint64_t key: keys) {
+        vector<uint32_t>& pages = this->trigrams[key];
+        // The pages are usually indexed in order
+        if (pages.empty() || pages.back() < page) {
+            pages.push_back(page);
+        } else {
+            pages.insert(std::lower_bound(pages.begin(), pages.end(), page), page);
+        }
+    }
+
+    auto entry = std::make_unique<PdfPageText>();
+    entry->text = std::move(text);
+    entry->glyphs = std::move(glyphs);
+    this->pdfPages[pdfPage] = std::move(entry);
+    this->indexedPdfPages++;
+}
+
+auto SearchIndex::findCandidates(const std::u32string& query) -> vector<uint32_t> {
+    vector<uint32_t> candidates;
+
+    if (query.size() < 3) {
+        for (size_t i = 0; i < this->pdfPages.size(); i++) {
+            if (this->pdfPages[i]) {
+                candidates.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        return candidates;
+    }
+
+    vector<const vector<uint32_t>*> lists;
+    for (size_t i = 0; i + 2 < query.size(); i++) {
+        auto it = this->trigrams.find(trigram(query[i], query[i + 1], query[i + 2]));
+        if (it == this->trigrams.end()) {
+            return candidates;
+        }
+        lists.push_back(&it->second);
+    }
+
+    // Start with the rarest trigram, so the intersection stays small
+    std::sort(lists.begin(), lists.end(), [](auto* a, auto* b) { return a->size() < b->size(); });
+
+    candidates = *lists[0];
+    for (size_t i = 1; i < lists.size() && !candidates.empty(); i++) {
+        vector<uint32_t> intersection;
+        std::set_intersection(candidates.begin(), candidates.end(), lists[i]->begin(), lists[i]->end(),
+                              std::back_inserter(intersection));
+        candidates = std::move(intersection);
+    }
+
+    return candidates;
+}
+
+auto SearchIndex::findOnPdfPage(size_t pdfPage, const string& text, vector<XojPdfRectangle>& rects) -> bool {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (pdfPage >= this->pdfPages.size() || !this->pdfPages[pdfPage]) {
+        return false;
+    }
+
+    const PdfPageText& page = *this->pdfPages[pdfPage];
+    std::u32string query = toLower(toUcs4(text));
+    for (size_t pos: find(page.text, query)) {
+        vector<XojPdfRectangle> lines = glyphRects(page, pos, query.size());
+        rects.insert(rects.end(), lines.begin(), lines.end());
+    }
+    return true;
+}
+
+auto SearchIndex::getTextElements(const PageRef& page) -> TextElementsEntry& {
+    TextElementsEntry& entry = this->textElements[page.get()];
+    if (entry.page.lock() == page && entry.revision == page->getRevision()) {
+        return entry;
+    }
+
+    entry.page = page;
+    entry.revision = page->getRevision();
+    entry.texts.clear();
+    for (Layer* l: *page->getLayers()) {
+        for (Element* e: *l->getElements()) {
+            if (e->getType() == ELEMENT_TEXT) {
+                auto* t = dynamic_cast<Text*>(e);
+                XojPdfRectangle bounds(t->getX(), t->getY(), t->getX() + t->getElementWidth(),
+                                       t->getY() + t->getElementHeight());
+                entry.texts.push_back({l, toUcs4(t->getText()), bounds});
+            }
+        }
+    }
+    return entry;
+}
+
+void SearchIndex::findOnPage(size_t p, const PageRef& page, const std::u32string& query, bool searchPdf,
+                             vector<SearchResult>& results, size_t maxResults) {
+    size_t pdfPage = page->getPdfPageNr();
+    if (searchPdf && pdfPage < this->pdfPages.size() && this->pdfPages[pdfPage]) {
+        const PdfPageText& pdfText = *this->pdfPages[pdfPage];
+        for (size_t pos: find(pdfText.text, query)) {
+            if (results.size() >= maxResults) {
+                return;
+            }
+
+            vector<XojPdfRectangle> lines = glyphRects(pdfText, pos, query.size());
+
+            SearchResult result;
+            result.page = p;
+            if (!lines.empty()) {
+                result.rect = lines[0];
+                for (const XojPdfRectangle& r: lines) {
+                    result.rect.x1 = std::min(result.rect.x1, r.x1);
+                    result.rect.y1 = std::min(result.rect.y1, r.y1);
+                    result.rect.x2 = std::max(result.rect.x2, r.x2);
+                    result.rect.y2 = std::max(result.rect.y2, r.y2);
+                }
+            }
+            result.context = context(pdfText.text, pos, query.size());
+            results.push_back(std::move(result));
+        }
+    }
+
+    for (const TextElementsEntry::TextEntry& t: getTextElements(page).texts) {
+        if (!page->isLayerVisible(t.layer)) {
+            continue;
+        }
+
+        for (size_t pos: find(t.text, query)) {
+            if (results.size() >= maxResults) {
+                return;
+            }
+
+            SearchResult result;
+            result.page = p;
+            result.rect = t.bounds;
+            result.context = context(t.text, pos, query.size());
+            result.inTextElement = true;
+            results.push_back(std::move(result));
+        }
+    }
+}
+
+void SearchIndex::forgetDeletedPages() {
+    for (auto it = this->textElements.begin(); it != this->textElements.end();) {
+        if (it->second.page.expired()) {
+            it = this->textElements.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+auto SearchIndex::search(Document* doc, const string& text, size_t maxResults) -> vector<SearchResult> {
+    vector<SearchResult> results;
+
+    std::u32string query = toLower(toUcs4(text));
+    if (query.empty()) {
+        return results;
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    vector<bool> candidates(this->pdfPages.size(), false);
+    for (uint32_t p: findCandidates(query)) {
+        candidates[p] = true;
+    }
+
+    doc->lock();
+    for (size_t p = 0; p < doc->getPageCount() && results.size() < maxResults; p++) {
+        PageRef page = doc->getPage(p);
+        size_t pdfPage = page->getPdfPageNr();
+        findOnPage(p, page, query, pdfPage < candidates.size() && candidates[pdfPage], results, maxResults);
+    }
+    doc->unlock();
+
+    forgetDeletedPages();
+
+    return results;
+}
+
+auto SearchIndex::findPdfCandidates(const string& text) -> vector<bool> {
+    std::u32string query = toLower(toUcs4(text));
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    vector<bool> candidates(this->pdfPages.size(), false);
+    for (size_t i = 0; i < this->pdfPages.size(); i++) {
+        candidates[i] = !this->pdfPages[i];
+    }
+    for (uint32_t p: findCandidates(query)) {
+        candidates[p] = true;
+    }
+    return candidates;
+}
+
+void SearchIndex::searchPage(Document* doc, size_t p, const string& text, const vector<bool>& pdfCandidates,
+                             vector<SearchResult>& results) {
+    std::u32string query = toLower(toUcs4(text));
+    if (query.empty()) {
+        return;
+    }
+
+    doc->lock();
+    PageRef page = p < doc->getPageCount() ? doc->getPage(p) : nullptr;
+    bool samePdf = isFor(doc->getPdfFilepath(), doc->getPdfPageCount());
+    doc->unlock();
+
+    if (!page) {
+        return;
+    }
+
+    size_t pdfPage = page->getPdfPageNr();
+    bool searchPdf = pdfCandidates.empty() || (pdfPage < pdfCandidates.size() && pdfCandidates[pdfPage]);
+
+    // Extract the text of the PDF page first, if the SearchIndexJob did not get to it yet.
+    // The document is not locked while the index is, in the same order as in search().
+    if (searchPdf && samePdf && pdfPage < getPdfPageCount() && !isIndexed(pdfPage)) {
+        doc->lock();
+        XojPdfPageSPtr pdf = doc->getPdfPage(pdfPage);
+        doc->unlock();
+
+        std::u32string pdfText;
+        vector<XojPdfRectangle> glyphs;
+        if (pdf) {
+            pdf->getTextLayout(pdfText, glyphs);
+        }
+        addPdfPage(pdfPage, pdfText, glyphs);
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    doc->lock();
+    findOnPage(p, page, query, searchPdf, results, std::numeric_limits<size_t>::max());
+    doc->unlock();
+}
+
+auto SearchIndex::isIndexed(size_t pdfPage) -> bool {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return pdfPage < this->pdfPages.size() && this->pdfPages[pdfPage];
+}
+
+auto SearchIndex::getCacheFile() const -> fs::path {
+    string key = this->pdfFile.u8string();
+
+    std::error_code ec;
+    auto size = fs::file_size(this->pdfFile, ec);
+    if (!ec) {
+        key += "|" + std::to_string(size);
+    }
+    auto modified = fs::last_write_time(this->pdfFile, ec);
+    if (!ec) {
+        key += "|" + std::to_string(modified.time_since_epoch().count());
+    }
+    key += "|" + std::to_string(this->pdfPages.size());
+
+    gchar* hash = g_compute_checksum_for_string(G_CHECKSUM_SHA1, key.c_str(), -1);
+    fs::path file = Util::getCacheSubfolder("search") / (string(hash) + CACHE_EXTENSION);
+    g_free(hash);
+    return file;
+}
+
+auto SearchIndex::load(const fs::path& file) -> bool {
+    gchar* contents = nullptr;
+    gsize length = 0;
+    if (!g_file_get_contents(file.u8string().c_str(), &contents, &length, nullptr)) {
+        return false;
+    }
+    std::unique_ptr<gchar, decltype(&g_free)> data(contents, &g_free);
+
+    // Read completely before anything is added, so an invalid file does not leave some of its pages
+    struct LoadedPage {
+        size_t pdfPage;
+        vector<char32_t> text;
+        vector<GlyphBox> glyphs;
+    };
+    vector<LoadedPage> pages;
+
+    ObjectInputStream in;
+    try {
+        if (!in.read(data.get(), static_cast<int>(length))) {
+            return false;
+        }
+        data.reset();
+
+        in.readObject("SearchIndex");
+        if (in.readInt() != CACHE_VERSION || in.readSizeT() != this->pdfPages.size()) {
+            return false;
+        }
+
+        size_t count = in.readSizeT();
+        for (size_t i = 0; i < count; i++) {
+            LoadedPage page;
+            page.pdfPage = in.readSizeT();
+            page.text = in.readArray<char32_t>();
+            page.glyphs = in.readArray<GlyphBox>();
+            pages.push_back(std::move(page));
+        }
+        in.endObject();
+    } catch (InputStreamException& e) {
+        g_warning("Search index %s is invalid: %s", file.u8string().c_str(), e.what());
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        for (LoadedPage& page: pages) {
+            addPdfPageUnlocked(page.pdfPage, std::u32string(page.text.begin(), page.text.end()),
+                               std::move(page.glyphs));
+        }
+    }
+
+    // Keep recently used indices when the cache is cleaned up
+    std::error_code ec;
+    fs::last_write_time(file, fs::file_time_type::clock::now(), ec);
+    return true;
+}
+
+auto SearchIndex::save(const fs::path& file) -> bool {
+    ObjectOutputStream out(new BinObjectEncoding());
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        out.writeObject("SearchIndex");
+        out.writeInt(CACHE_VERSION);
+        out.writeSizeT(this->pdfPages.size());
+        out.writeSizeT(this->indexedPdfPages);
+        for (size_t i = 0; i < this->pdfPages.size(); i++) {
+            if (!this->pdfPages[i]) {
+                continue;
+            }
+            out.writeSizeT(i);
+            out.writeArray(vector<char32_t>(this->pdfPages[i]->text.begin(), this->pdfPages[i]->text.end()));
+            out.writeArray(this->pdfPages[i]->glyphs);
+        }
+        out.endObject();
+    }
+
+    GString* str = out.getStr();
+    GError* error = nullptr;
+    if (!g_file_set_contents(file.u8string().c_str(), str->str, str->len, &error)) {
+        g_warning("Could not save the search index to %s: %s", file.u8string().c_str(), error->message);
+        g_error_free(error);
+        return false;
+    }
+
+    return true;
+}
+
+void SearchIndex::cleanupCache() {
+    fs::path folder = Util::getCacheSubfolder("search");
+
+    // Remove the least recently used indices
+    std::error_code ec;
+    vector<std::pair<fs::file_time_type, fs::path>> files;
+    for (const auto& f: fs::directory_iterator(folder, ec)) {
+        if (f.path().extension() == CACHE_EXTENSION) {
+            files.emplace_back(fs::last_write_time(f.path(), ec), f.path());
+        }
+    }
+    if (files.size() > MAX_CACHE_FILES) {
+        std::sort(files.begin(), files.end());
+        for (size_t i = 0; i < files.size() - MAX_CACHE_FILES; i++) {
+            fs::remove(files[i].second, ec);
+        }
+    }
+}
+
+auto SearchIndex::toLower(const std::u32string& text) -> std::u32string {
+    std::u32string folded(text.size(), U' ');
+    std::transform(text.begin(), text.end(), folded.begin(), fold);
+    return folded;
+}
+
+auto SearchIndex::toUcs4(const string& text) -> std::u32string {
+    glong length = 0;
+    gunichar* chars = g_utf8_to_ucs4_fast(text.c_str(), -1, &length);
+    std::u32string result(chars, chars + length);
+    g_free(chars);
+    return result;
+}
+
+auto SearchIndex::toUtf8(const std::u32string& text, size_t start, size_t length) -> string {
+    gchar* utf8 = g_ucs4_to_utf8(reinterpret_cast<const gunichar*>(text.data() + start), static_cast<glong>(length),
+                                 nullptr, nullptr, nullptr);
+    string result = utf8 ? utf8 : "";
+    g_free(utf8);
+    return result;
+}
+
+auto SearchIndex::find(const std::u32string& text, const std::u32string& query) -> vector<size_t> {
+    vector<size_t> positions;
+    if (query.empty()) {
+        return positions;
+    }
+
+    for (size_t i = 0; i + query.size() <= text.size(); i++) {
+        size_t k = 0;
+        while (k < query.size() && fold(text[i + k]) == query[k]) {
+            k++;
+        }
+        if (k == query.size()) {
+            positions.push_back(i);
+            i += query.size() - 1;
+        }
+    }
+    return positions;
+}
+
+auto SearchIndex::glyphRects(const PdfPageText& page, size_t start, size_t length) -> vector<XojPdfRectangle> {
+    vector<XojPdfRectangle> rects;
+
+    for (size_t i = start; i < start + length && i < page.glyphs.size(); i++) {
+        // Line breaks have no useful bounding box
+        if (g_unichar_isspace(page.text[i])) {
+            continue;
+        }
+
+        const GlyphBox& g = page.glyphs[i];
+        XojPdfRectangle r(g.x1 / 8.0, g.y1 / 8.0, g.x2 / 8.0, g.y2 / 8.0);
+
+        // Merge the characters of each line
+        if (!rects.empty() && r.y1 < rects.back().y2 && r.y2 > rects.back().y1 && r.x1 >= rects.back().x1) {
+            XojPdfRectangle& line = rects.back();
+            line.x2 = std::max(line.x2, r.x2);
+            line.y1 = std::min(line.y1, r.y1);
+            line.y2 = std::max(line.y2, r.y2);
+        } else {
+            rects.push_back(r);
+        }
+    }
+
+    return rects;
+}
+
+auto SearchIndex::context(const std::u32string& text, size_t start, size_t length) -> string {
+    size_t from = start > CONTEXT_BEFORE ? start - CONTEXT_BEFORE : 0;
+    size_t to = std::min(text.size(), start + length + CONTEXT_AFTER);
+
+    std::u32string excerpt;
+    for (size_t i = from; i < to; i++) {
+        char32_t c = g_unichar_isspace(text[i]) ? U' ' : text[i];
+        if (c == U' ' && (excerpt.empty() || excerpt.back() == U' ')) {
+            continue;
+        }
+        excerpt += c;
+    }
+
+    string result = toUtf8(excerpt, 0, excerpt.size());
+    if (from > 0) {
+        result = "…" + result;
+    }
+    if (to < text.size()) {
+        result += "…";
+    }
+    return result;
+}
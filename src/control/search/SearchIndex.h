@@ -0,0 +1,230 @@
+/*
+ * Xournal++
+ *
+ * Full text index of the PDF background and the Text elements of a document
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "model/PageRef.h"
+#include "pdf/base/XojPdfPage.h"
+
+#include "XournalType.h"
+#include "filesystem.h"
+
+class Document;
+class Layer;
+
+/**
+ * An occurrence of the searched text
+ */
+struct SearchResult {
+    /**
+     * The document page
+     */
+    size_t page = 0;
+
+    /**
+     * Bounding box of the occurrence in page coordinates
+     */
+    XojPdfRectangle rect;
+
+    /**
+     * The text around the occurrence, for the result list
+     */
+    string context;
+
+    /**
+     * True if the text was found in a Text element, false for the PDF background
+     */
+    bool inTextElement = false;
+};
+
+/**
+ * The text of the PDF pages is extracted once by SearchIndexJob in the background and stored in
+ * the cache directory, so the PDF does not need to be searched page by page for every query.
+ * The Text elements are indexed on demand and updated when the revision of their page changes.
+ *
+ * A trigram index narrows a query down to the pages which can contain it, only these pages are
+ * compared with the query.
+ */
+class SearchIndex {
+public:
+    SearchIndex(fs::path pdfFile, size_t pdfPageCount);
+    virtual ~SearchIndex();
+
+public:
+    /**
+     * @return True if the index was created for this background PDF
+     */
+    bool isFor(const fs::path& pdfFile, size_t pdfPageCount) const;
+
+    size_t getPdfPageCount() const;
+    size_t getIndexedPdfPageCount();
+
+    /**
+     * @return The first PDF page which is not indexed yet, getPdfPageCount() if all are
+     */
+    size_t getNextPdfPage();
+
+    bool isIndexed(size_t pdfPage);
+
+    bool isComplete();
+
+    /**
+     * Stores the text of a PDF page, glyphs holds the bounding box of each character
+     */
+    void addPdfPage(size_t pdfPage, const std::u32string& text, const vector<XojPdfRectangle>& glyphs);
+
+    /**
+     * Stops indexing, e.g. because another document was loaded
+     */
+    void cancel();
+    bool isCancelled() const;
+
+    /**
+     * Finds text on a PDF page
+     *
+     * @return False if the page is not indexed yet
+     */
+    bool findOnPdfPage(size_t pdfPage, const string& text, vector<XojPdfRectangle>& rects);
+
+    /**
+     * Finds all occurrences of text in the document, ordered by page. PDF pages which are not
+     * indexed yet are skipped. Needs to be called from the UI thread.
+     *
+     * @param maxResults Stops after this many results
+     */
+    vector<SearchResult> search(Document* doc, const string& text, size_t maxResults);
+
+    /**
+     * Uses the trigram index to find the PDF pages which can contain text
+     *
+     * @return For each PDF page, false if it cannot contain text. Pages which are not indexed yet may.
+     */
+    vector<bool> findPdfCandidates(const string& text);
+
+    /**
+     * Finds all occurrences of text on a document page. If its PDF page is not indexed yet, the
+     * text of the PDF page is extracted and added to the index first.
+     *
+     * @param pdfCandidates From findPdfCandidates(), the PDF text of other pages is not compared with text.
+     *                      Empty to search every PDF page.
+     */
+    void searchPage(Document* doc, size_t page, const string& text, const vector<bool>& pdfCandidates,
+                    vector<SearchResult>& results);
+
+    /**
+     * The file in the cache directory, named by the path, size and modification time of the PDF
+     */
+    fs::path getCacheFile() const;
+
+    /**
+     * Loads the index of the PDF pages saved by save()
+     *
+     * @return False if the file does not exist or does not match the PDF
+     */
+    bool load(const fs::path& file);
+    bool save(const fs::path& file);
+
+    /**
+     * Removes the least recently used files from the cache directory
+     */
+    static void cleanupCache();
+
+private:
+    /**
+     * Bounding box of a character, in 1/8 point
+     */
+    struct GlyphBox {
+        uint16_t x1;
+        uint16_t y1;
+        uint16_t x2;
+        uint16_t y2;
+    };
+
+    struct PdfPageText {
+        std::u32string text;
+        vector<GlyphBox> glyphs;
+    };
+
+    struct TextElementsEntry {
+        struct TextEntry {
+            Layer* layer;
+            std::u32string text;
+            XojPdfRectangle bounds;
+        };
+
+        std::weak_ptr<XojPage> page;
+        uint64_t revision = 0;
+        vector<TextEntry> texts;
+    };
+
+    void addPdfPageUnlocked(size_t pdfPage, std::u32string text, vector<GlyphBox> glyphs);
+
+    /**
+     * Collects the PDF pages which contain all trigrams of the query
+     */
+    vector<uint32_t> findCandidates(const std::u32string& query);
+
+    TextElementsEntry& getTextElements(const PageRef& page);
+
+    /**
+     * Appends the occurrences of query on the page with the index p
+     *
+     * @param searchPdf False if the PDF page cannot contain the query
+     */
+    void findOnPage(size_t p, const PageRef& page, const std::u32string& query, bool searchPdf,
+                    vector<SearchResult>& results, size_t maxResults);
+
+    /**
+     * Removes the Text elements of pages which do not exist anymore
+     */
+    void forgetDeletedPages();
+
+    static std::u32string toLower(const std::u32string& text);
+    static std::u32string toUcs4(const string& text);
+    static string toUtf8(const std::u32string& text, size_t start, size_t length);
+
+    /**
+     * @return The positions of query (lowercase) in text
+     */
+    static vector<size_t> find(const std::u32string& text, const std::u32string& query);
+
+    /**
+     * The rectangles covering the characters of an occurrence, one for each line
+     */
+    static vector<XojPdfRectangle> glyphRects(const PdfPageText& page, size_t start, size_t length);
+
+    static string context(const std::u32string& text, size_t start, size_t length);
+
+private:
+    fs::path pdfFile;
+
+    std::mutex mutex;
+
+    vector<std::unique_ptr<PdfPageText>> pdfPages;
+    size_t indexedPdfPages = 0;
+
+    /**
+     * For each trigram the PDF pages containing it, in ascending order
+     */
+    std::unordered_map<uint64_t, vector<uint32_t>> trigrams;
+
+    std::unordered_map<const XojPage*, TextElementsEntry> textElements;
+
+    std::atomic<bool> cancelled{false};
+};
@@ -1,43 +1,43 @@
 #include "MetadataManager.h"
 
-#include <algorithm>  // std::sort
+#include <algorithm>
 #include <fstream>
 #include <sstream>
-
-#include <fcntl.h>
-#include <glib/gstdio.h>
-#include <sys/stat.h>
-#include <sys/types.h>
+#include <utility>
 
 #include "PathUtil.h"
-#include "XojMsgBox.h"
 
 using namespace std;
 
-MetadataEntry::MetadataEntry(): valid(false), zoom(1), page(0), time(0) {}
-
-
-MetadataManager::MetadataManager(): metadata(nullptr) { g_mutex_init(&this->mutex); }
+/**
+ * The first line of the index file
+ */
+constexpr auto INDEX_HEADER = "XOJ-METADATA-INDEX/1.0";
 
-MetadataManager::~MetadataManager() { documentChanged(); }
+/**
+ * The number of files whose metadata is kept
+ */
+constexpr size_t MAX_ENTRIES = 500;
 
 /**
- * Delete an old metadata file
+ * The index file is only rewritten if it has this many outdated records
  */
-void MetadataManager::deleteMetadataFile(fs::path const& path) {
-    // be careful, delete the Metadata file, NOT the Document!
-    if (path.extension() != ".metadata") {
-        g_warning("Try to delete non-metadata file: %s", path.string().c_str());
-        return;
-    }
+constexpr size_t MIN_OUTDATED_RECORDS = 64;
 
-    try {
-        fs::remove(path);
-    } catch (fs::filesystem_error const&) {
-        g_warning("Could not delete metadata file %s", path.string().c_str());
-    }
+MetadataEntry::MetadataEntry(): valid(false), zoom(1), page(0), time(0) {}
+
+
+MetadataManager::MetadataManager(): MetadataManager(Util::getConfigFile("metadata.index")) {
+    this->importOldFiles = true;
+}
+
+MetadataManager::MetadataManager(fs::path indexFile): metadata(nullptr), indexFile(std::move(indexFile)) {
+    g_mutex_init(&this->mutex);
+    g_mutex_init(&this->indexMutex);
 }
 
+MetadataManager::~MetadataManager() { documentChanged(); }
+
 /**
  * Document was closed, a new document was opened etc.
  */
@@ -55,56 +55,107 @@ void MetadataManager::documentChanged() {
     delete m;
 }
 
-auto sortMetadata(MetadataEntry& a, MetadataEntry& b) -> bool { return a.time > b.time; }
+void MetadataManager::loadIndex() {
+    if (this->indexLoaded) {
+        return;
+    }
+    this->indexLoaded = true;
 
-/**
- * Load the metadata list (sorted)
- */
-auto MetadataManager::loadList() -> vector<MetadataEntry> {
-    auto folder = Util::getConfigSubfolder("metadata");
+    std::error_code ec;
+    if (!fs::exists(this->indexFile, ec)) {
+        fs::path folder = Util::getConfigFolder() / "metadata";
+        if (this->importOldFiles && fs::is_directory(folder)) {
+            importMetadataFolder(folder);
+        }
+        writeIndex();
+        return;
+    }
+
+    bool complete = true;
+    if (!readIndex(complete)) {
+        g_warning("Metadata index \"%s\" is not valid, it is created again", this->indexFile.u8string().c_str());
+        writeIndex();
+        return;
+    }
+
+    if (!complete || this->entries.size() > MAX_ENTRIES) {
+        writeIndex();
+    }
+}
+
+auto MetadataManager::readIndex(bool& complete) -> bool {
+    ifstream in(this->indexFile);
+    string header;
+    if (!in.is_open() || !getline(in, header) || header != INDEX_HEADER) {
+        return false;
+    }
+
+    // Later records replace earlier ones of the same file. Another instance may append an older record of a file
+    // than the one stored by this instance, so the time decides.
+    complete = true;
+    while (!(in >> ws).eof()) {
+        MetadataEntry entry;
+        if (!(in >> entry.time >> entry.page >> entry.zoom >> entry.path)) {
+            // e.g. if the application was terminated while appending
+            complete = false;
+            break;
+        }
+        entry.valid = true;
 
-    vector<MetadataEntry> data;
+        auto& current = this->entries[entry.path.u8string()];
+        if (!current.valid || entry.time >= current.time) {
+            current = std::move(entry);
+        }
+        this->indexRecords++;
+    }
+    return true;
+}
+
+void MetadataManager::importMetadataFolder(fs::path const& folder) {
     try {
         for (auto const& f: fs::directory_iterator(folder)) {
-            auto path = folder / f;
-
-            MetadataEntry entry = loadMetadataFile(path, f.path());
+            // be careful, only read and delete the Metadata files
+            if (f.path().extension() != ".metadata") {
+                continue;
+            }
 
-            if (entry.valid) {
-                data.push_back(entry);
+            MetadataEntry entry = loadMetadataFile(f.path());
+            auto& current = this->entries[entry.path.u8string()];
+            if (entry.valid && entry.time > current.time) {
+                current = std::move(entry);
             }
+
+            fs::remove(f.path());
         }
-    } catch (fs::filesystem_error& e) {
-        XojMsgBox::showErrorToUser(nullptr, e.what());
-        return data;
+        fs::remove(folder);
+    } catch (fs::filesystem_error const& e) {
+        g_warning("Could not import the metadata files: %s", e.what());
     }
 
-    std::sort(data.begin(), data.end(), sortMetadata);
-
-    return data;
+    // Entries of invalid files
+    for (auto it = this->entries.begin(); it != this->entries.end();) {
+        it = it->second.valid ? std::next(it) : this->entries.erase(it);
+    }
 }
 
 /**
  * Parse a single metadata file
  */
-auto MetadataManager::loadMetadataFile(fs::path const& path, fs::path const& file) -> MetadataEntry {
+auto MetadataManager::loadMetadataFile(fs::path const& path) -> MetadataEntry {
     MetadataEntry entry;
-    entry.metadataFile = path;
 
     string line;
     ifstream infile(path);
 
-    auto time = file.stem().string();
+    auto time = path.stem().string();
     entry.time = strtoll(time.c_str(), nullptr, 10);
 
     if (!getline(infile, line) || line != "XOJ-METADATA/1.0") {
-        deleteMetadataFile(path);
         // Not valid
         return entry;
     }
 
     if (!getline(infile, line)) {
-        deleteMetadataFile(path);
         // Not valid
         return entry;
     }
@@ -112,14 +163,12 @@ auto MetadataManager::loadMetadataFile(fs::path const& path, fs::path const& fil
     iss >> entry.path;
 
     if (!getline(infile, line) || line.length() < 6 || line.substr(0, 5) != "page=") {
-        deleteMetadataFile(path);
         // Not valid
         return entry;
     }
     entry.page = strtoll(line.substr(5).c_str(), nullptr, 10);
 
     if (!getline(infile, line) || line.length() < 6 || line.substr(0, 5) != "zoom=") {
-        deleteMetadataFile(path);
         // Not valid
         return entry;
     }
@@ -133,47 +182,99 @@ auto MetadataManager::loadMetadataFile(fs::path const& path, fs::path const& fil
  * Get the metadata for a file
  */
 auto MetadataManager::getForFile(fs::path const& file) -> MetadataEntry {
-    vector<MetadataEntry> files = loadList();
-
-    MetadataEntry entry;
-    for (const MetadataEntry& e: files) {
-        if (e.path == file) {
-            entry = e;
-            break;
-        }
+    g_mutex_lock(&this->mutex);
+    if (metadata != nullptr && metadata->path == file) {
+        MetadataEntry entry = *metadata;
+        g_mutex_unlock(&this->mutex);
+        return entry;
     }
+    g_mutex_unlock(&this->mutex);
+
+    g_mutex_lock(&this->indexMutex);
+    loadIndex();
 
-    for (int i = 20; i < static_cast<int>(files.size()); i++) {
-        auto path = files[i].metadataFile;
-        deleteMetadataFile(path);
+    MetadataEntry entry;
+    if (auto it = this->entries.find(file.u8string()); it != this->entries.end()) {
+        entry = it->second;
     }
+    g_mutex_unlock(&this->indexMutex);
 
     return entry;
 }
 
 /**
- * Store metadata to file
+ * Store metadata to the index
  */
 void MetadataManager::storeMetadata(MetadataEntry* m) {
-    vector<MetadataEntry> files = loadList();
-    for (const MetadataEntry& e: files) {
-        if (e.path == m->path) {
-            // This is an old entry with the same path
-            deleteMetadataFile(e.metadataFile);
+    g_mutex_lock(&this->indexMutex);
+    loadIndex();
+
+    this->entries[m->path.u8string()] = *m;
+
+    if (this->entries.size() > MAX_ENTRIES ||
+        this->indexRecords + 1 > 2 * this->entries.size() + MIN_OUTDATED_RECORDS) {
+        writeIndex();
+    } else {
+        appendToIndex(*m);
+    }
+    g_mutex_unlock(&this->indexMutex);
+}
+
+void MetadataManager::writeIndex() {
+    // Other instances may have appended records since the index was read, these would be lost by rewriting it
+    bool complete = true;
+    readIndex(complete);
+
+    if (this->entries.size() > MAX_ENTRIES) {
+        // Only keep the most recently used files
+        vector<std::pair<gint64, string>> files;
+        files.reserve(this->entries.size());
+        for (auto const& [path, entry]: this->entries) {
+            files.emplace_back(entry.time, path);
+        }
+        auto kept = files.end() - MAX_ENTRIES;
+        std::nth_element(files.begin(), kept, files.end());
+
+        for (auto it = files.begin(); it != kept; ++it) {
+            this->entries.erase(it->second);
         }
     }
 
-    auto path = Util::getConfigSubfolder("metadata");
-    gint64 time = g_get_real_time();
-    path /= std::to_string(time);
-    path += ".metadata";
+    fs::path tmpFile = this->indexFile;
+    tmpFile += ".new";
 
-    ofstream out(path);
-    out << "XOJ-METADATA/1.0\n";
-    out << m->path << "\n";
-    out << "page=" << m->page << "\n";
-    out << "zoom=" << m->zoom << "\n";
+    ofstream out(tmpFile);
+    out << INDEX_HEADER << "\n";
+    for (auto const& [path, entry]: this->entries) {
+        out << entry.time << " " << entry.page << " " << entry.zoom << " " << entry.path << "\n";
+    }
     out.close();
+
+    try {
+        if (out.fail()) {
+            g_warning("Could not write metadata index \"%s\"", tmpFile.u8string().c_str());
+            fs::remove(tmpFile);
+            return;
+        }
+        fs::rename(tmpFile, this->indexFile);
+    } catch (fs::filesystem_error const& e) {
+        g_warning("Could not write metadata index: %s", e.what());
+        return;
+    }
+
+    this->indexRecords = this->entries.size();
+}
+
+void MetadataManager::appendToIndex(MetadataEntry const& m) {
+    ofstream out(this->indexFile, ios::app);
+    out << m.time << " " << m.page << " " << m.zoom << " " << m.path << "\n";
+    out.close();
+
+    if (out.fail()) {
+        g_warning("Could not write metadata index \"%s\"", this->indexFile.u8string().c_str());
+        return;
+    }
+    this->indexRecords++;
 }
 
 /**
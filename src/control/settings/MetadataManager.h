@@ -12,6 +12,7 @@
 #pragma once
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "XournalType.h"
@@ -22,7 +23,6 @@ public:
     MetadataEntry();
 
 public:
-    fs::path metadataFile;
     bool valid;
     fs::path path;
     double zoom;
@@ -30,16 +30,26 @@ public:
     gint64 time;
 };
 
+/**
+ * The entries of all files are stored in one index file, which is read once and again before it is
+ * rewritten. A changed entry is appended to it, the file is rewritten when most of its records are
+ * outdated. Only the most recently used files are kept.
+ */
 class MetadataManager {
 public:
     MetadataManager();
+
+    /**
+     * Uses the given index file, instead of the one in the config folder
+     */
+    explicit MetadataManager(fs::path indexFile);
     virtual ~MetadataManager();
 
 public:
     /**
      * Get the metadata for a file
      */
-    static MetadataEntry getForFile(fs::path const& file);
+    MetadataEntry getForFile(fs::path const& file);
 
     /**
      * Store the current data into metadata
@@ -53,28 +63,63 @@ public:
 
 private:
     /**
-     * Delete an old metadata file
+     * Reads the index file, if it was not read yet. The index mutex needs to be locked.
      */
-    static void deleteMetadataFile(fs::path const& path);
+    void loadIndex();
 
     /**
-     * Parse a single metadata file
+     * Reads the records of the index file into the entries, a record only replaces a newer entry of its file
+     *
+     * @param complete Set to false if the last record is cut off
+     * @return False if the file could not be read or is not an index file
      */
-    static MetadataEntry loadMetadataFile(fs::path const& path, fs::path const& file);
+    bool readIndex(bool& complete);
 
     /**
-     * Store metadata to file
+     * Imports the metadata files of older versions, which stored one file per document
      */
-    static void storeMetadata(MetadataEntry* m);
+    void importMetadataFolder(fs::path const& folder);
+
+    /**
+     * Parse a single metadata file of an older version
+     */
+    static MetadataEntry loadMetadataFile(fs::path const& path);
 
-private:
     /**
-     * Load the metadata list (sorted)
+     * Store metadata to the index
      */
-    static vector<MetadataEntry> loadList();
+    void storeMetadata(MetadataEntry* m);
 
+    /**
+     * Writes the index file with only the current entries, after merging the records appended by other instances
+     */
+    void writeIndex();
+
+    /**
+     * Appends an entry to the index file
+     */
+    void appendToIndex(MetadataEntry const& m);
 
 private:
     GMutex mutex{};
     MetadataEntry* metadata;
+
+    GMutex indexMutex{};
+    fs::path indexFile;
+    bool indexLoaded = false;
+
+    /**
+     * The entries by the path of their file
+     */
+    std::unordered_map<string, MetadataEntry> entries;
+
+    /**
+     * The number of records in the index file, including outdated ones
+     */
+    size_t indexRecords = 0;
+
+    /**
+     * Whether the metadata files of older versions are imported
+     */
+    bool importOldFiles = false;
 };
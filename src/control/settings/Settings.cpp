@@ -87,6 +87,11 @@ void Settings::loadDefault() {
     this->autosaveTimeout = 3;
     this->autosaveEnabled = true;
 
+    this->undoMemoryBudget = 256;
+    this->undoMemoryLimit = 2048;
+
+    this->saveZipContainer = false;
+
     this->addHorizontalSpace = false;
     this->addHorizontalSpaceAmount = 150;
     this->addVerticalSpace = false;
@@ -161,6 +166,8 @@ void Settings::loadDefault() {
     this->newInputSystemEnabled = true;
     this->inputSystemTPCButton = false;
     this->inputSystemDrawOutsideWindow = true;
+    this->inputSystemMotionCoalescing = true;
+    this->inputSystemPrediction = false;
 
     this->strokeFilterIgnoreTime = 150;
     this->strokeFilterIgnoreLength = 1;
@@ -380,8 +387,14 @@ void Settings::parseItem(xmlDocPtr doc, xmlNodePtr cur) {
         this->audioFolder = reinterpret_cast<const char*>(value);
     } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("autosaveEnabled")) == 0) {
         this->autosaveEnabled = xmlStrcmp(value, reinterpret_cast<const xmlChar*>("true")) == 0;
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("saveZipContainer")) == 0) {
+        this->saveZipContainer = xmlStrcmp(value, reinterpret_cast<const xmlChar*>("true")) == 0;
     } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("autosaveTimeout")) == 0) {
         this->autosaveTimeout = g_ascii_strtoll(reinterpret_cast<const char*>(value), nullptr, 10);
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("undoMemoryBudget")) == 0) {
+        this->undoMemoryBudget = g_ascii_strtoll(reinterpret_cast<const char*>(value), nullptr, 10);
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("undoMemoryLimit")) == 0) {
+        this->undoMemoryLimit = g_ascii_strtoll(reinterpret_cast<const char*>(value), nullptr, 10);
     } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("fullscreenHideElements")) == 0) {
         this->fullscreenHideElements = reinterpret_cast<const char*>(value);
     } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("presentationHideElements")) == 0) {
@@ -457,6 +470,10 @@ void Settings::parseItem(xmlDocPtr doc, xmlNodePtr cur) {
         this->inputSystemTPCButton = xmlStrcmp(value, reinterpret_cast<const xmlChar*>("true")) == 0;
     } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("inputSystemDrawOutsideWindow")) == 0) {
         this->inputSystemDrawOutsideWindow = xmlStrcmp(value, reinterpret_cast<const xmlChar*>("true")) == 0;
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("inputSystemMotionCoalescing")) == 0) {
+        this->inputSystemMotionCoalescing = xmlStrcmp(value, reinterpret_cast<const xmlChar*>("true")) == 0;
+    } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("inputSystemPrediction")) == 0) {
+        this->inputSystemPrediction = xmlStrcmp(value, reinterpret_cast<const xmlChar*>("true")) == 0;
     } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("strokeFilterIgnoreTime")) == 0) {
         this->strokeFilterIgnoreTime = g_ascii_strtoll(reinterpret_cast<const char*>(value), nullptr, 10);
     } else if (xmlStrcmp(name, reinterpret_cast<const xmlChar*>("strokeFilterIgnoreLength")) == 0) {
@@ -806,6 +823,11 @@ void Settings::save() {
     WRITE_BOOL_PROP(autosaveEnabled);
     WRITE_INT_PROP(autosaveTimeout);
 
+    WRITE_INT_PROP(undoMemoryBudget);
+    WRITE_INT_PROP(undoMemoryLimit);
+
+    WRITE_BOOL_PROP(saveZipContainer);
+
     WRITE_BOOL_PROP(addHorizontalSpace);
     WRITE_INT_PROP(addHorizontalSpaceAmount);
     WRITE_BOOL_PROP(addVerticalSpace);
@@ -865,6 +887,8 @@ void Settings::save() {
     WRITE_BOOL_PROP(newInputSystemEnabled);
     WRITE_BOOL_PROP(inputSystemTPCButton);
     WRITE_BOOL_PROP(inputSystemDrawOutsideWindow);
+    WRITE_BOOL_PROP(inputSystemMotionCoalescing);
+    WRITE_BOOL_PROP(inputSystemPrediction);
 
     WRITE_STRING_PROP(preferredLocale);
 
@@ -1014,6 +1038,30 @@ void Settings::setAutosaveTimeout(int autosave) {
     save();
 }
 
+auto Settings::getUndoMemoryBudget() const -> int { return this->undoMemoryBudget; }
+
+void Settings::setUndoMemoryBudget(int megabytes) {
+    if (this->undoMemoryBudget == megabytes) {
+        return;
+    }
+
+    this->undoMemoryBudget = megabytes;
+
+    save();
+}
+
+auto Settings::getUndoMemoryLimit() const -> int { return this->undoMemoryLimit; }
+
+void Settings::setUndoMemoryLimit(int megabytes) {
+    if (this->undoMemoryLimit == megabytes) {
+        return;
+    }
+
+    this->undoMemoryLimit = megabytes;
+
+    save();
+}
+
 auto Settings::isAutosaveEnabled() const -> bool { return this->autosaveEnabled; }
 
 void Settings::setAutosaveEnabled(bool autosave) {
@@ -1026,6 +1074,18 @@ void Settings::setAutosaveEnabled(bool autosave) {
     save();
 }
 
+auto Settings::isSaveZipContainer() const -> bool { return this->saveZipContainer; }
+
+void Settings::setSaveZipContainer(bool zipContainer) {
+    if (this->saveZipContainer == zipContainer) {
+        return;
+    }
+
+    this->saveZipContainer = zipContainer;
+
+    save();
+}
+
 auto Settings::getAddVerticalSpace() const -> bool { return this->addVerticalSpace; }
 
 void Settings::setAddVerticalSpace(bool space) { this->addVerticalSpace = space; }
@@ -1778,6 +1838,26 @@ void Settings::setInputSystemDrawOutsideWindowEnabled(bool drawOutsideWindowEnab
 
 auto Settings::getInputSystemDrawOutsideWindowEnabled() const -> bool { return this->inputSystemDrawOutsideWindow; }
 
+void Settings::setInputSystemMotionCoalescingEnabled(bool motionCoalescingEnabled) {
+    if (this->inputSystemMotionCoalescing == motionCoalescingEnabled) {
+        return;
+    }
+    this->inputSystemMotionCoalescing = motionCoalescingEnabled;
+    save();
+}
+
+auto Settings::getInputSystemMotionCoalescingEnabled() const -> bool { return this->inputSystemMotionCoalescing; }
+
+void Settings::setInputSystemPredictionEnabled(bool predictionEnabled) {
+    if (this->inputSystemPrediction == predictionEnabled) {
+        return;
+    }
+    this->inputSystemPrediction = predictionEnabled;
+    save();
+}
+
+auto Settings::getInputSystemPredictionEnabled() const -> bool { return this->inputSystemPrediction; }
+
 void Settings::setDeviceClassForDevice(GdkDevice* device, InputDeviceTypeOption deviceClass) {
     this->setDeviceClassForDevice(gdk_device_get_name(device), gdk_device_get_source(device), deviceClass);
 }
@@ -231,6 +231,14 @@ public:
     bool isAutosaveEnabled() const;
     void setAutosaveEnabled(bool autosave);
 
+    bool isSaveZipContainer() const;
+    void setSaveZipContainer(bool zipContainer);
+
+    int getUndoMemoryBudget() const;
+    void setUndoMemoryBudget(int megabytes);
+    int getUndoMemoryLimit() const;
+    void setUndoMemoryLimit(int megabytes);
+
     bool getAddVerticalSpace() const;
     void setAddVerticalSpace(bool space);
     int getAddVerticalSpaceAmount() const;
@@ -366,6 +374,12 @@ public:
     bool getInputSystemDrawOutsideWindowEnabled() const;
     void setInputSystemDrawOutsideWindowEnabled(bool drawOutsideWindowEnabled);
 
+    bool getInputSystemMotionCoalescingEnabled() const;
+    void setInputSystemMotionCoalescingEnabled(bool motionCoalescingEnabled);
+
+    bool getInputSystemPredictionEnabled() const;
+    void setInputSystemPredictionEnabled(bool predictionEnabled);
+
     void loadDeviceClasses();
     void saveDeviceClasses();
     void setDeviceClassForDevice(GdkDevice* device, InputDeviceTypeOption deviceClass);
@@ -702,6 +716,21 @@ private:
      */
     bool autosaveEnabled{};
 
+    /**
+     * Memory in MB the undo history may use, above it the strokes of the oldest actions are moved to a temporary file
+     */
+    int undoMemoryBudget{};
+
+    /**
+     * Memory in MB including the temporary file, above it the oldest undo actions are dropped
+     */
+    int undoMemoryLimit{};
+
+    /**
+     * Save documents as zip container, with images, TeX objects and background PDFs as binary entries
+     */
+    bool saveZipContainer{};
+
     /**
      * Allow scroll outside the page display area (horizontal)
      */
@@ -911,6 +940,16 @@ private:
 
     bool inputSystemDrawOutsideWindow{};
 
+    /**
+     * Process the pen motion events of one frame together
+     */
+    bool inputSystemMotionCoalescing{};
+
+    /**
+     * Draw the predicted continuation of the stroke in progress
+     */
+    bool inputSystemPrediction{};
+
     std::map<string, std::pair<InputDeviceTypeOption, GdkInputSource>> inputDeviceClasses = {};
 
     /**
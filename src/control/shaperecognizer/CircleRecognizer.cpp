@@ -6,6 +6,7 @@
 #include "util/LoopUtil.h"
 
 #include "Inertia.h"
+#include "InertiaPrefix.h"
 #include "ShapeRecognizerConfig.h"
 
 /**
@@ -56,9 +57,8 @@ auto CircleRecognizer::scoreCircle(Stroke* s, Inertia& inertia) -> double {
     return sum / (divisor);
 }
 
-auto CircleRecognizer::recognize(Stroke* stroke) -> Stroke* {
-    Inertia s;
-    s.calc(stroke->getPoints(), 0, stroke->getPointCount());
+auto CircleRecognizer::recognize(Stroke* stroke, const InertiaPrefix& inertia) -> Stroke* {
+    Inertia s = inertia.get(0, stroke->getPointCount() - 1);
     RDEBUG("Mass=%.0f, Center=(%.1f,%.1f), I=(%.0f,%.0f, %.0f), Rad=%.2f, Det=%.4f", s.getMass(), s.centerX(),
            s.centerY(), s.xx(), s.yy(), s.xy(), s.rad(), s.det());
 
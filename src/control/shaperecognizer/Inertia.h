@@ -22,6 +22,11 @@ class Inertia {
 public:
     Inertia();
     Inertia(const Inertia& inertia);
+
+    /**
+     * Create from the sums of the mass and of its moments
+     */
+    Inertia(double mass, double sx, double sy, double sxx, double sxy, double syy);
     virtual ~Inertia();
 
 public:
@@ -0,0 +1,81 @@
+#include "InertiaPrefix.h"
+
+#include <cmath>
+
+#include "model/Stroke.h"
+
+InertiaPrefix::InertiaPrefix() = default;
+
+InertiaPrefix::~InertiaPrefix() = default;
+
+void InertiaPrefix::addPoint(const Point& p) {
+    if (this->prefix.empty()) {
+        this->origin = p;
+        this->last = p;
+        this->prefix.push_back({0, 0, 0, 0, 0, 0});
+        return;
+    }
+
+    // Same weighting as Inertia::increase, the segment is accounted to its first point
+    double x = this->last.x - this->origin.x;
+    double y = this->last.y - this->origin.y;
+    double dm = hypot(p.x - this->last.x, p.y - this->last.y);
+
+    Sums s = this->prefix.back();
+    s.mass += dm;
+    s.sx += dm * x;
+    s.sy += dm * y;
+    s.sxx += dm * x * x;
+    s.sxy += dm * x * y;
+    s.syy += dm * y * y;
+    this->prefix.push_back(s);
+
+    this->last = p;
+}
+
+void InertiaPrefix::update(const Stroke* stroke) {
+    int count = stroke->getPointCount();
+    int added = getPointCount();
+
+    if (added > count) {
+        clear();
+        added = 0;
+    } else if (added > 0) {
+        Point p = stroke->getPoint(added - 1);
+        if (p.x != this->last.x || p.y != this->last.y) {
+            clear();
+            added = 0;
+        }
+    }
+
+    const Point* pt = stroke->getPoints();
+    for (int i = added; i < count; i++) {
+        addPoint(pt[i]);
+    }
+}
+
+void InertiaPrefix::clear() { this->prefix.clear(); }
+
+auto InertiaPrefix::getPointCount() const -> int { return static_cast<int>(this->prefix.size()); }
+
+auto InertiaPrefix::get(int start, int end) const -> Inertia {
+    if (start < 0 || end <= start || end >= getPointCount()) {
+        return Inertia();
+    }
+
+    const Sums& a = this->prefix[start];
+    const Sums& b = this->prefix[end];
+
+    double mass = b.mass - a.mass;
+    double sx = b.sx - a.sx;
+    double sy = b.sy - a.sy;
+    double sxx = b.sxx - a.sxx;
+    double sxy = b.sxy - a.sxy;
+    double syy = b.syy - a.syy;
+
+    // Move the sums back from the first point to the page origin
+    double ox = this->origin.x;
+    double oy = this->origin.y;
+    return Inertia(mass, sx + mass * ox, sy + mass * oy, sxx + 2 * ox * sx + mass * ox * ox,
+                   sxy + ox * sy + oy * sx + mass * ox * oy, syy + 2 * oy * sy + mass * oy * oy);
+}
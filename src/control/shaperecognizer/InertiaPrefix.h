@@ -0,0 +1,67 @@
+/*
+ * Xournal++
+ *
+ * Part of the Xournal shape recognizer
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "model/Point.h"
+
+#include "Inertia.h"
+
+class Stroke;
+
+/**
+ * Prefix sums of the inertia of the segments of a stroke, accumulated while the stroke is drawn.
+ * The inertia of any range of points is then available in constant time.
+ */
+class InertiaPrefix {
+public:
+    InertiaPrefix();
+    virtual ~InertiaPrefix();
+
+public:
+    void addPoint(const Point& p);
+
+    /**
+     * Adds the points of stroke which were not added yet. Starts over if the points do not
+     * belong to stroke.
+     */
+    void update(const Stroke* stroke);
+
+    void clear();
+
+    int getPointCount() const;
+
+    /**
+     * @return The inertia of the segments between the points start and end
+     */
+    Inertia get(int start, int end) const;
+
+private:
+    struct Sums {
+        double mass;
+        double sx;
+        double sy;
+        double sxx;
+        double sxy;
+        double syy;
+    };
+
+    /**
+     * prefix[i] sums the segments before point i. The sums are relative to the first point,
+     * so they keep their precision far away from the page origin.
+     */
+    std::vector<Sums> prefix;
+
+    Point origin;
+    Point last;
+};
@@ -8,6 +8,7 @@
 
 #include "CircleRecognizer.h"
 #include "Inertia.h"
+#include "InertiaPrefix.h"
 #include "ShapeRecognizerResult.h"
 
 ShapeRecognizer::ShapeRecognizer() {
@@ -97,7 +98,8 @@ auto ShapeRecognizer::tryRectangle() -> Stroke* {
 /*
  * check if something is a polygonal line with at most nsides sides
  */
-auto ShapeRecognizer::findPolygonal(const Point* pt, int start, int end, int nsides, int* breaks, Inertia* ss) -> int {
+auto ShapeRecognizer::findPolygonal(const InertiaPrefix& inertia, int start, int end, int nsides, int* breaks,
+                                    Inertia* ss) -> int {
     Inertia s;
     int i1 = 0, i2 = 0, n1 = 0, n2 = 0;
 
@@ -118,7 +120,7 @@ auto ShapeRecognizer::findPolygonal(const Point* pt, int start, int end, int nsi
     for (; k < nsides; k++) {
         i1 = start + (k * (end - start)) / nsides;
         i2 = start + ((k + 1) * (end - start)) / nsides;
-        s.calc(pt, i1, i2);
+        s = inertia.get(i1, i2);
         if (s.det() < LINE_MAX_DET) {
             break;
         }
@@ -135,16 +137,14 @@ auto ShapeRecognizer::findPolygonal(const Point* pt, int start, int end, int nsi
     // grow the linear piece we found
     while (true) {
         if (i1 > start) {
-            s1 = s;
-            s1.increase(pt[i1 - 1], pt[i1], 1);
+            s1 = inertia.get(i1 - 1, i2);
             det1 = s1.det();
         } else {
             det1 = 1.0;
         }
 
         if (i2 < end) {
-            s2 = s;
-            s2.increase(pt[i2], pt[i2 + 1], 1);
+            s2 = inertia.get(i1, i2 + 1);
             det2 = s2.det();
         } else {
             det2 = 1.0;
@@ -162,7 +162,7 @@ auto ShapeRecognizer::findPolygonal(const Point* pt, int start, int end, int nsi
     }
 
     if (i1 > start) {
-        n1 = findPolygonal(pt, start, i1, (i2 == end) ? (nsides - 1) : (nsides - 2), breaks, ss);
+        n1 = findPolygonal(inertia, start, i1, (i2 == end) ? (nsides - 1) : (nsides - 2), breaks, ss);
         if (n1 == 0) {
             return 0;  // it doesn't work
         }
@@ -175,7 +175,7 @@ auto ShapeRecognizer::findPolygonal(const Point* pt, int start, int end, int nsi
     ss[n1] = s;
 
     if (i2 < end) {
-        n2 = findPolygonal(pt, i2, end, nsides - n1 - 1, breaks + n1 + 1, ss + n1 + 1);
+        n2 = findPolygonal(inertia, i2, end, nsides - n1 - 1, breaks + n1 + 1, ss + n1 + 1);
         if (n2 == 0) {
             return 0;
         }
@@ -189,17 +189,15 @@ auto ShapeRecognizer::findPolygonal(const Point* pt, int start, int end, int nsi
 /**
  * Improve on the polygon found by find_polygonal()
  */
-void ShapeRecognizer::optimizePolygonal(const Point* pt, int nsides, int* breaks, Inertia* ss) {
+void ShapeRecognizer::optimizePolygonal(const InertiaPrefix& inertia, int nsides, int* breaks, Inertia* ss) {
     for (int i = 1; i < nsides; i++) {
         // optimize break between sides i and i+1
         double cost = ss[i - 1].det() * ss[i - 1].det() + ss[i].det() * ss[i].det();
-        Inertia s1 = ss[i - 1];
-        Inertia s2 = ss[i];
         bool improved = false;
         while (breaks[i] > breaks[i - 1] + 1) {
             // try moving the break to the left
-            s1.increase(pt[breaks[i] - 1], pt[breaks[i] - 2], -1);
-            s2.increase(pt[breaks[i] - 1], pt[breaks[i] - 2], 1);
+            Inertia s1 = inertia.get(breaks[i - 1], breaks[i] - 1);
+            Inertia s2 = inertia.get(breaks[i] - 1, breaks[i + 1]);
             double newcost = s1.det() * s1.det() + s2.det() * s2.det();
 
             if (newcost >= cost) {
@@ -217,12 +215,10 @@ void ShapeRecognizer::optimizePolygonal(const Point* pt, int nsides, int* breaks
             continue;
         }
 
-        s1 = ss[i - 1];
-        s2 = ss[i];
         while (breaks[i] < breaks[i + 1] - 1) {
             // try moving the break to the right
-            s1.increase(pt[breaks[i]], pt[breaks[i] + 1], 1);
-            s2.increase(pt[breaks[i]], pt[breaks[i] + 1], -1);
+            Inertia s1 = inertia.get(breaks[i - 1], breaks[i] + 1);
+            Inertia s2 = inertia.get(breaks[i] + 1, breaks[i + 1]);
 
             double newcost = s1.det() * s1.det() + s2.det() * s2.det();
             if (newcost >= cost) {
@@ -241,19 +237,26 @@ void ShapeRecognizer::optimizePolygonal(const Point* pt, int nsides, int* breaks
  * The main pattern recognition function
  */
 auto ShapeRecognizer::recognizePatterns(Stroke* stroke) -> ShapeRecognizerResult* {
+    InertiaPrefix inertia;
+    return recognizePatterns(stroke, inertia);
+}
+
+auto ShapeRecognizer::recognizePatterns(Stroke* stroke, InertiaPrefix& inertia) -> ShapeRecognizerResult* {
     this->stroke = stroke;
 
     if (stroke->getPointCount() < 3) {
         return nullptr;
     }
 
+    inertia.update(stroke);
+
     Inertia ss[4];
     int brk[5] = {0};
 
     // first see if it's a polygon
-    int n = findPolygonal(stroke->getPoints(), 0, stroke->getPointCount() - 1, MAX_POLYGON_SIDES, brk, ss);
+    int n = findPolygonal(inertia, 0, stroke->getPointCount() - 1, MAX_POLYGON_SIDES, brk, ss);
     if (n > 0) {
-        optimizePolygonal(stroke->getPoints(), n, brk, ss);
+        optimizePolygonal(inertia, n, brk, ss);
 #ifdef DEBUG_RECOGNIZER
         g_message("--");
         g_message("ShapeReco:: Polygon, %d edges:", n);
@@ -321,7 +324,7 @@ auto ShapeRecognizer::recognizePatterns(Stroke* stroke) -> ShapeRecognizerResult
     }
 
     // not a polygon: maybe a circle ?
-    Stroke* s = CircleRecognizer::recognize(stroke);
+    Stroke* s = CircleRecognizer::recognize(stroke, inertia);
     if (s) {
         RDEBUG("return circle");
         return new ShapeRecognizerResult(s);
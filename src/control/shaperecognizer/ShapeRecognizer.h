@@ -19,6 +19,7 @@
 
 class Stroke;
 class Point;
+class InertiaPrefix;
 class ShapeRecognizerResult;
 
 class ShapeRecognizer {
@@ -26,6 +27,11 @@ public:
     ShapeRecognizer();
     virtual ~ShapeRecognizer();
 
+    /**
+     * @param inertia Inertia of the stroke, accumulated while it was drawn. Points which were not
+     *                added yet are added here.
+     */
+    ShapeRecognizerResult* recognizePatterns(Stroke* stroke, InertiaPrefix& inertia);
     ShapeRecognizerResult* recognizePatterns(Stroke* stroke);
     void resetRecognizer();
 
@@ -33,9 +39,9 @@ private:
     Stroke* tryRectangle();
     // function Stroke* tryArrow(); removed after commit a3f7a251282dcfea8b4de695f28ce52bf2035da2
 
-    static void optimizePolygonal(const Point* pt, int nsides, int* breaks, Inertia* ss);
+    static void optimizePolygonal(const InertiaPrefix& inertia, int nsides, int* breaks, Inertia* ss);
 
-    int findPolygonal(const Point* pt, int start, int end, int nsides, int* breaks, Inertia* ss);
+    int findPolygonal(const InertiaPrefix& inertia, int start, int end, int nsides, int* breaks, Inertia* ss);
 
 private:
     std::array<RecoSegment, MAX_POLYGON_SIDES + 1> queue{};
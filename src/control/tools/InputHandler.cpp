@@ -34,6 +34,17 @@ void InputHandler::resetShapeRecognizer() {
     // Does nothing here. Implemented in the extending classes
 }
 
+void InputHandler::beginMotionBatch() { this->motionBatch = true; }
+
+void InputHandler::endMotionBatch() {
+    this->motionBatch = false;
+    onMotionBatchEnd();
+}
+
+void InputHandler::onMotionBatchEnd() {
+    // Does nothing here. Implemented in the extending classes
+}
+
 void InputHandler::createStroke(Point p) {
     ToolHandler* h = xournal->getControl()->getToolHandler();
 
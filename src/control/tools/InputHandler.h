@@ -92,6 +92,14 @@ public:
      */
     virtual void onMotionCancelEvent() = 0;
 
+    /**
+     * The motion events which arrived during one frame are delivered between
+     * beginMotionBatch() and endMotionBatch(). Handlers may draw and repaint
+     * them together at the end of the batch.
+     */
+    void beginMotionBatch();
+    void endMotionBatch();
+
     /**
      * @return Current editing stroke
      */
@@ -109,6 +117,11 @@ public:
     bool userTapped = false;
 
 protected:
+    /**
+     * Called at the end of a batch of motion events
+     */
+    virtual void onMotionBatchEnd();
+
     static bool validMotion(Point p, Point q);
 
     void createStroke(Point p);
@@ -119,5 +132,10 @@ protected:
     PageRef page;
     Stroke* stroke;
 
+    /**
+     * If motion events are delivered in a batch
+     */
+    bool motionBatch = false;
+
 private:
 };
@@ -9,6 +9,7 @@
 #include "control/layer/LayerController.h"
 #include "control/settings/Settings.h"
 #include "control/shaperecognizer/ShapeRecognizerResult.h"
+#include "gui/LatencyTrace.h"
 #include "gui/PageView.h"
 #include "gui/XournalView.h"
 #include "undo/InsertUndoAction.h"
@@ -19,6 +20,16 @@
 
 guint32 StrokeHandler::lastStrokeTime;  // persist for next stroke
 
+/**
+ * How far ahead the prediction extrapolates the pen movement, in milliseconds
+ */
+constexpr double PREDICTION_TIME = 16;
+
+/**
+ * Events further apart are not used for the prediction, in milliseconds
+ */
+constexpr guint32 PREDICTION_MAX_INTERVAL = 50;
+
 
 StrokeHandler::StrokeHandler(XournalView* xournal, XojPageView* redrawable, const PageRef& page):
         InputHandler(xournal, redrawable, page),
@@ -47,6 +58,20 @@ void StrokeHandler::draw(cairo_t* cr) {
     }
 
     cairo_mask_surface(cr, surfMask, 0, 0);
+
+    if (this->predictionShown) {
+        double zoom = xournal->getZoom();
+        int dpiScaleFactor = xournal->getDpiScaleFactor();
+
+        cairo_save(cr);
+        cairo_scale(cr, zoom * dpiScaleFactor, zoom * dpiScaleFactor);
+        cairo_set_line_width(cr, stroke->getWidth());
+        cairo_set_line_cap(cr, CAIRO_LINE_CAP_ROUND);
+        cairo_move_to(cr, this->predictionStart.x, this->predictionStart.y);
+        cairo_line_to(cr, this->predictionEnd.x, this->predictionEnd.y);
+        cairo_stroke(cr);
+        cairo_restore(cr);
+    }
 }
 
 
@@ -76,9 +101,55 @@ auto StrokeHandler::onMotionNotifyEvent(const PositionInputData& pos) -> bool {
     }
 
     stroke->addPoint(currentPoint);
+    LatencyTrace::getInstance().handled();
+
+    if (this->recognizeShape) {
+        this->strokeInertia.addPoint(currentPoint);
+    }
+
+    updatePrediction(currentPoint, pos.timestamp);
+
+    const double w = stroke->getWidth();
 
     if ((stroke->getFill() != -1 || stroke->getLineStyle().hasDashes()) &&
         !(stroke->getFill() != -1 && stroke->getToolType() == STROKE_TOOL_HIGHLIGHTER)) {
+        // The whole stroke is drawn again, once per batch
+        this->maskOutdated = true;
+    } else if (pointCount > 0) {
+        Point prevPoint(stroke->getPoint(pointCount - 1));
+
+        Stroke lastSegment;
+
+        lastSegment.addPoint(prevPoint);
+        lastSegment.addPoint(currentPoint);
+        lastSegment.setWidth(w);
+
+        cairo_set_operator(crMask, CAIRO_OPERATOR_OVER);
+        cairo_set_source_rgba(crMask, 1, 1, 1, 1);
+
+        view.drawStroke(crMask, &lastSegment, 0, 1, false);
+
+        addRepaintArea(prevPoint, w);
+        addRepaintArea(currentPoint, w);
+    }
+
+    if (!this->motionBatch) {
+        onMotionBatchEnd();
+    }
+
+    return true;
+}
+
+void StrokeHandler::onMotionBatchEnd() {
+    if (!stroke) {
+        return;
+    }
+
+    const double w = stroke->getWidth();
+
+    if (this->maskOutdated) {
+        this->maskOutdated = false;
+
         // Clear surface
 
         // for debugging purposes
@@ -89,34 +160,72 @@ auto StrokeHandler::onMotionNotifyEvent(const PositionInputData& pos) -> bool {
         cairo_fill(crMask);
 
         view.drawStroke(crMask, stroke, 0, 1, true, true);
-    } else {
-        if (pointCount > 0) {
-            Point prevPoint(stroke->getPoint(pointCount - 1));
 
-            Stroke lastSegment;
+        addRepaintArea(Point(stroke->getX(), stroke->getY()), w);
+        addRepaintArea(Point(stroke->getX() + stroke->getElementWidth(), stroke->getY() + stroke->getElementHeight()),
+                       w);
+    }
 
-            lastSegment.addPoint(prevPoint);
-            lastSegment.addPoint(currentPoint);
-            lastSegment.setWidth(stroke->getWidth());
+    if (this->predictionShown) {
+        // The old prediction is replaced
+        addRepaintArea(this->predictionStart, w);
+        addRepaintArea(this->predictionEnd, w);
+        this->predictionShown = false;
+    }
 
-            cairo_set_operator(crMask, CAIRO_OPERATOR_OVER);
-            cairo_set_source_rgba(crMask, 1, 1, 1, 1);
+    if (this->predictionValid && !stroke->getLineStyle().hasDashes() && stroke->getFill() == -1) {
+        this->predictionStart = stroke->getPoint(stroke->getPointCount() - 1);
+        this->predictionEnd = Point(this->predictionStart.x + this->velocityX * PREDICTION_TIME,
+                                    this->predictionStart.y + this->velocityY * PREDICTION_TIME);
+        this->predictionShown = true;
+        addRepaintArea(this->predictionEnd, w);
+    }
 
-            view.drawStroke(crMask, &lastSegment, 0, 1, false);
-        }
+    if (this->repaintRange) {
+        this->redrawable->repaintRect(this->repaintRange->getX(), this->repaintRange->getY(),
+                                      this->repaintRange->getWidth(), this->repaintRange->getHeight());
+        this->repaintRange.reset();
     }
+}
 
-    const double w = stroke->getWidth();
+void StrokeHandler::addRepaintArea(const Point& p, double width) {
+    if (this->repaintRange) {
+        this->repaintRange->addPoint(p.x - width, p.y - width);
+    } else {
+        this->repaintRange.emplace(p.x - width, p.y - width);
+    }
+    this->repaintRange->addPoint(p.x + width, p.y + width);
+}
 
-    this->redrawable->repaintRect(stroke->getX() - w, stroke->getY() - w, stroke->getElementWidth() + 2 * w,
-                                  stroke->getElementHeight() + 2 * w);
+void StrokeHandler::updatePrediction(const Point& p, guint32 timestamp) {
+    this->predictionValid = false;
 
-    return true;
+    if (!xournal->getControl()->getSettings()->getInputSystemPredictionEnabled()) {
+        return;
+    }
+
+    guint32 dt = timestamp - this->lastMotionTime;
+    if (this->lastMotionTime != 0 && dt > 0 && dt < PREDICTION_MAX_INTERVAL) {
+        double vx = (p.x - this->lastMotionPoint.x) / dt;
+        double vy = (p.y - this->lastMotionPoint.y) / dt;
+
+        // Smooth the velocity, single events are too noisy
+        this->velocityX = (this->velocityX + vx) / 2;
+        this->velocityY = (this->velocityY + vy) / 2;
+        this->predictionValid = true;
+    } else {
+        this->velocityX = 0;
+        this->velocityY = 0;
+    }
+
+    this->lastMotionPoint = p;
+    this->lastMotionTime = timestamp;
 }
 
 void StrokeHandler::onMotionCancelEvent() {
     delete stroke;
     stroke = nullptr;
+    this->predictionShown = false;
 }
 
 void StrokeHandler::onButtonReleaseEvent(const PositionInputData& pos) {
@@ -124,6 +233,10 @@ void StrokeHandler::onButtonReleaseEvent(const PositionInputData& pos) {
         return;
     }
 
+    // Draw outstanding motion and remove the prediction, it must not end up in the page buffer
+    this->predictionValid = false;
+    onMotionBatchEnd();
+
     Control* control = xournal->getControl();
     Settings* settings = control->getSettings();
 
@@ -188,7 +301,8 @@ void StrokeHandler::onButtonReleaseEvent(const PositionInputData& pos) {
             reco = new ShapeRecognizer();
         }
 
-        ShapeRecognizerResult* result = reco->recognizePatterns(stroke);
+        ShapeRecognizerResult* result = reco->recognizePatterns(stroke, this->strokeInertia);
+        this->strokeInertia.clear();
 
         if (result) {
             strokeRecognizerDetected(result, layer);
@@ -303,9 +417,22 @@ void StrokeHandler::onButtonPressEvent(const PositionInputData& pos) {
         this->buttonDownPoint.y = pos.y / zoom;
 
         createStroke(Point(this->buttonDownPoint.x, this->buttonDownPoint.y));
+
+        ToolHandler* h = xournal->getControl()->getToolHandler();
+        this->recognizeShape = h->getDrawingType() == DRAWING_TYPE_STROKE_RECOGNIZER;
+        this->strokeInertia.clear();
+        if (this->recognizeShape) {
+            this->strokeInertia.update(stroke);
+        }
     }
 
     this->startStrokeTime = pos.timestamp;
+
+    this->lastMotionTime = 0;
+    this->predictionValid = false;
+    this->predictionShown = false;
+    this->maskOutdated = false;
+    this->repaintRange.reset();
 }
 
 void StrokeHandler::onButtonDoublePressEvent(const PositionInputData& pos) {
@@ -11,9 +11,13 @@
 
 #pragma once
 
+#include <optional>
+
+#include "control/shaperecognizer/InertiaPrefix.h"
 #include "view/DocumentView.h"
 
 #include "InputHandler.h"
+#include "Range.h"
 #include "SnapToGridInputHandler.h"
 
 class ShapeRecognizer;
@@ -50,6 +54,19 @@ protected:
     void strokeRecognizerDetected(ShapeRecognizerResult* result, Layer* layer);
     void destroySurface();
 
+    /**
+     * Redraws the mask if needed and repaints everything changed since the last call
+     */
+    void onMotionBatchEnd() override;
+
+private:
+    void addRepaintArea(const Point& p, double width);
+
+    /**
+     * Estimates the pen velocity for the prediction
+     */
+    void updatePrediction(const Point& p, guint32 timestamp);
+
 protected:
     Point buttonDownPoint;  // used for tapSelect and filtering - never snapped to grid.
     SnapToGridInputHandler snappingHandler;
@@ -69,6 +86,35 @@ private:
 
     ShapeRecognizer* reco;
 
+    /**
+     * Inertia of the stroke, accumulated while it is drawn if the shape recognizer is active
+     */
+    InertiaPrefix strokeInertia;
+    bool recognizeShape = false;
+
+    /**
+     * The area to repaint at the end of the current batch
+     */
+    std::optional<Range> repaintRange;
+
+    /**
+     * The whole stroke has to be drawn again into the mask
+     */
+    bool maskOutdated = false;
+
+    /**
+     * Predicted continuation of the stroke, only drawn on screen
+     */
+    Point predictionStart;
+    Point predictionEnd;
+    bool predictionValid = false;
+    bool predictionShown = false;
+
+    Point lastMotionPoint;
+    guint32 lastMotionTime = 0;
+    double velocityX = 0;
+    double velocityY = 0;
+
 
     // to filter out short strokes (usually the user tapping on the page to select it)
     guint32 startStrokeTime{};
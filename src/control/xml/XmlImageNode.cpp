@@ -1,5 +1,7 @@
 #include "XmlImageNode.h"
 
+#include <utility>
+
 XmlImageNode::XmlImageNode(const char* tag): XmlNode(tag) {
     this->img = nullptr;
     this->out = nullptr;
@@ -19,6 +21,8 @@ void XmlImageNode::setImage(cairo_surface_t* img) {
     this->img = cairo_surface_reference(img);
 }
 
+void XmlImageNode::setPngData(std::string data) { this->pngData = std::move(data); }
+
 auto XmlImageNode::pngWriteFunction(XmlImageNode* image, const unsigned char* data, unsigned int length)
         -> cairo_status_t {
     for (unsigned int i = 0; i < length; i++, image->pos++) {
@@ -41,7 +45,12 @@ void XmlImageNode::writeOut(OutputStream* out) {
 
     out->write(">");
 
-    if (this->img == nullptr) {
+    if (!this->pngData.empty()) {
+        auto* data = reinterpret_cast<const guchar*>(this->pngData.data());
+        gchar* base64_str = g_base64_encode(data, this->pngData.size());
+        out->write(base64_str);
+        g_free(base64_str);
+    } else if (this->img == nullptr) {
         g_error("XmlImageNode::writeOut(); this->img == nullptr");
     } else {
         this->out = out;
@@ -11,6 +11,8 @@
 
 #pragma once
 
+#include <string>
+
 #include "XmlNode.h"
 
 class XmlImageNode: public XmlNode {
@@ -21,12 +23,18 @@ public:
 public:
     void setImage(cairo_surface_t* img);
 
+    /**
+     * Writes already encoded PNG data instead of an image
+     */
+    void setPngData(std::string data);
+
     static cairo_status_t pngWriteFunction(XmlImageNode* image, const unsigned char* data, unsigned int length);
 
     virtual void writeOut(OutputStream* out);
 
 private:
     cairo_surface_t* img;
+    std::string pngData;
 
     OutputStream* out;
     int pos;
@@ -89,6 +89,12 @@ void XmlNode::writeOut(OutputStream* out, ProgressListener* listener) {
     }
 }
 
+void XmlNode::writeChildren(OutputStream* out) {
+    for (GList* l = this->children; l != nullptr; l = l->next) {
+        static_cast<XmlNode*>(l->data)->writeOut(out);
+    }
+}
+
 void XmlNode::addChild(XmlNode* node) { this->children = g_list_append(this->children, node); }
 
 void XmlNode::putAttrib(XMLAttribute* a) {
@@ -42,6 +42,11 @@ public:
 
     virtual void writeOut(OutputStream* out) { writeOut(out, nullptr); }
 
+    /**
+     * Writes only the children, without the tag of this node
+     */
+    void writeChildren(OutputStream* out);
+
     void addChild(XmlNode* node);
 
 protected:
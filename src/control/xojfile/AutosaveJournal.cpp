@@ -0,0 +1,296 @@
+#include "AutosaveJournal.h"
+
+#include <cstdlib>
+#include <sstream>
+#include <unordered_map>
+#include <utility>
+
+#include "control/xml/XmlNode.h"
+
+#include "GzUtil.h"
+#include "LoadHandler.h"
+#include "OutputStream.h"
+#include "PathUtil.h"
+#include "SaveHandler.h"
+#include "i18n.h"
+
+/**
+ * Identifies the header line of a journal entry
+ */
+constexpr auto JOURNAL_MAGIC = "xopp-journal";
+
+/**
+ * After this many entries a full autosave is written and the journal is started over
+ */
+constexpr int MAX_JOURNAL_ENTRIES = 20;
+
+namespace {
+/**
+ * Writes only the given pages of a snapshot
+ */
+class JournalEntryHandler: public SaveHandler {
+public:
+    void prepareEntry(DocumentSnapshot& doc, const std::vector<size_t>& pages) {
+        delete this->root;
+        this->root = new XmlNode("xournal");
+
+        writeHeader();
+
+        // The PDF background is written by the full autosave, pages only need the PDF page number
+        this->firstPdfPageVisited = true;
+
+        int id = 0;
+        for (size_t i: pages) {
+            visitPage(this->root, doc.getPage(i), doc, id++);
+        }
+    }
+};
+}  // namespace
+
+AutosaveJournal::AutosaveJournal() = default;
+
+AutosaveJournal::~AutosaveJournal() = default;
+
+auto AutosaveJournal::getJournalPath(fs::path const& autosaveFile) -> fs::path {
+    return fs::path{autosaveFile} += ".journal";
+}
+
+auto AutosaveJournal::getLastError() -> string { return this->lastError; }
+
+auto AutosaveJournal::append(fs::path const& autosaveFile, std::shared_ptr<DocumentSnapshot> snapshot) -> bool {
+    this->lastError.clear();
+
+    if (!this->lastSnapshot || this->autosaveFile != autosaveFile || this->entryCount >= MAX_JOURNAL_ENTRIES ||
+        !fs::exists(autosaveFile)) {
+        return false;
+    }
+
+    // Unchanged pages share their copy with the previous snapshot
+    std::unordered_map<XojPage*, size_t> previousPages;
+    for (size_t i = 0; i < this->lastSnapshot->getPageCount(); i++) {
+        previousPages[this->lastSnapshot->getPage(i).get()] = i;
+    }
+
+    string pageMap;
+    std::vector<size_t> changedPages;
+    bool unchanged = snapshot->getPageCount() == this->lastSnapshot->getPageCount();
+    for (size_t i = 0; i < snapshot->getPageCount(); i++) {
+        PageRef page = snapshot->getPage(i);
+
+        if (!pageMap.empty()) {
+            pageMap += ',';
+        }
+
+        auto it = previousPages.find(page.get());
+        if (it != previousPages.end()) {
+            pageMap += std::to_string(it->second);
+            unchanged = unchanged && it->second == i;
+            continue;
+        }
+
+        // Background images are shared by the page index, which cannot be resolved within a partial document
+        if (page->getBackgroundType().isImagePage()) {
+            return false;
+        }
+
+        pageMap += 'n';
+        changedPages.push_back(i);
+        unchanged = false;
+    }
+
+    if (unchanged) {
+        return true;
+    }
+
+    if (changedPages.size() > snapshot->getPageCount() / 2) {
+        // Writing the full document is about as expensive
+        return false;
+    }
+
+    string payload;
+    if (!changedPages.empty()) {
+        JournalEntryHandler handler;
+        handler.prepareEntry(*snapshot, changedPages);
+
+        StringOutputStream out;
+        handler.saveTo(&out, autosaveFile);
+
+        if (!handler.getErrorMessage().empty()) {
+            this->lastError = handler.getErrorMessage();
+            return false;
+        }
+        payload = std::move(out.getContents());
+    }
+
+    string header = string(JOURNAL_MAGIC) + " " + std::to_string(payload.size()) + " " + pageMap + "\n";
+
+    auto journalPath = getJournalPath(autosaveFile);
+
+    // Every append is a separate gzip member, a cut off member only loses the last entry
+    gzFile fp = GzUtil::openPath(journalPath, "ab");
+    if (!fp) {
+        this->lastError = FS(_F("Could not open autosave journal \"{1}\"") % journalPath.u8string());
+        return false;
+    }
+
+    bool success = gzwrite(fp, header.data(), header.size()) == static_cast<int>(header.size());
+    if (success && !payload.empty()) {
+        success = gzwrite(fp, payload.data(), payload.size()) == static_cast<int>(payload.size());
+    }
+    success = gzclose(fp) == Z_OK && success;
+
+    if (!success) {
+        this->lastError = FS(_F("Could not write autosave journal \"{1}\"") % journalPath.u8string());
+        return false;
+    }
+
+    this->lastSnapshot = std::move(snapshot);
+    this->entryCount++;
+
+    return true;
+}
+
+void AutosaveJournal::compacted(fs::path const& autosaveFile, std::shared_ptr<DocumentSnapshot> snapshot) {
+    std::error_code ec;
+    fs::remove(getJournalPath(autosaveFile), ec);
+
+    this->autosaveFile = autosaveFile;
+    this->lastSnapshot = std::move(snapshot);
+    this->entryCount = 0;
+}
+
+auto AutosaveJournal::replay(Document* doc, fs::path const& filepath, string& error) -> int {
+    auto journalPath = getJournalPath(filepath);
+    if (!fs::exists(journalPath)) {
+        return 0;
+    }
+
+    gzFile fp = GzUtil::openPath(journalPath, "rb");
+    if (!fp) {
+        error = FS(_F("Could not open autosave journal \"{1}\"") % journalPath.u8string());
+        return 0;
+    }
+
+    // A member cut off by a crash reads until the damaged position, the header length detects it
+    string data;
+    char buffer[64 * 1024];
+    int len = 0;
+    while ((len = gzread(fp, buffer, sizeof(buffer))) > 0) {
+        data.append(buffer, len);
+    }
+    gzclose(fp);
+
+    int count = 0;
+    size_t pos = 0;
+    while (pos < data.size()) {
+        size_t eol = data.find('\n', pos);
+        if (eol == string::npos) {
+            break;
+        }
+
+        std::istringstream header(data.substr(pos, eol - pos));
+        string magic;
+        size_t length = 0;
+        string pageMap;
+        header >> magic >> length >> pageMap;
+
+        if (header.fail() || magic != JOURNAL_MAGIC) {
+            error = FS(_F("The autosave journal \"{1}\" is corrupted") % journalPath.u8string());
+            break;
+        }
+
+        if (eol + 1 + length > data.size()) {
+            // The last entry was not completely written
+            break;
+        }
+
+        std::vector<PageRef> newPages;
+        if (length > 0) {
+            LoadHandler handler;
+            Document* entry = handler.loadDocumentFromString(data.substr(eol + 1, length), filepath);
+            if (!entry) {
+                error = FS(_F("Could not read autosave journal entry: {1}") % handler.getLastError());
+                break;
+            }
+
+            for (size_t i = 0; i < entry->getPageCount(); i++) {
+                newPages.push_back(entry->getPage(i));
+            }
+        }
+        pos = eol + 1 + length;
+
+        std::vector<PageRef> pages;
+        size_t nextNewPage = 0;
+        bool valid = true;
+
+        std::istringstream items(pageMap);
+        string item;
+        while (valid && std::getline(items, item, ',')) {
+            if (item == "n") {
+                valid = nextNewPage < newPages.size();
+                if (valid) {
+                    pages.push_back(newPages[nextNewPage++]);
+                }
+                continue;
+            }
+
+            char* end = nullptr;
+            size_t index = std::strtoull(item.c_str(), &end, 10);
+            valid = end != item.c_str() && *end == '\0' && index < doc->getPageCount();
+            if (valid) {
+                pages.push_back(doc->getPage(index));
+            }
+        }
+
+        if (!valid || pages.empty()) {
+            error = FS(_F("The autosave journal \"{1}\" is corrupted") % journalPath.u8string());
+            break;
+        }
+
+        while (doc->getPageCount() > 0) {
+            doc->deletePage(doc->getPageCount() - 1);
+        }
+        doc->addPages(pages.begin(), pages.end());
+
+        count++;
+    }
+
+    std::error_code ec;
+    if (count > 0 && writeRecovered(doc, filepath, error)) {
+        fs::remove(journalPath, ec);
+    } else {
+        // Kept for a manual recovery, but not replayed again
+        auto replayedPath = fs::path{journalPath} += ".replayed";
+        fs::remove(replayedPath, ec);
+        fs::rename(journalPath, replayedPath, ec);
+    }
+
+    return count;
+}
+
+auto AutosaveJournal::writeRecovered(Document* doc, fs::path const& filepath, string& error) -> bool {
+    auto tmpPath = fs::path{filepath} += ".recovered";
+
+    SaveHandler handler;
+    handler.prepareSave(doc);
+    handler.saveTo(tmpPath);
+
+    string saveError = handler.getErrorMessage();
+    if (saveError.empty()) {
+        try {
+            if (Util::safeRenameFile(tmpPath, filepath)) {
+                return true;
+            }
+        } catch (fs::filesystem_error const& e) {
+            saveError = e.what();
+        }
+    }
+
+    std::error_code ec;
+    fs::remove(tmpPath, ec);
+    if (!error.empty()) {
+        error += "\n";
+    }
+    error += FS(_F("Could not write the recovered document \"{1}\": {2}") % filepath.u8string() % saveError);
+    return false;
+}
@@ -0,0 +1,89 @@
+/*
+ * Xournal++
+ *
+ * Append only journal next to an autosave file, containing
+ * the pages which changed since the last full autosave
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "model/Document.h"
+#include "model/DocumentSnapshot.h"
+
+#include "XournalType.h"
+#include "filesystem.h"
+
+/**
+ * Each entry of the journal describes the complete page order of the document:
+ * unchanged pages reference the page index of the state before the entry,
+ * modified and new pages are stored as xournal XML in the entry.
+ *
+ * The page changes are detected by comparing the pages of DocumentSnapshot%s, which are only
+ * copied if their revision changed, i.e. after an undo action or a page notification touched them.
+ */
+class AutosaveJournal {
+public:
+    AutosaveJournal();
+    virtual ~AutosaveJournal();
+
+public:
+    /**
+     * Appends the pages changed since the last autosave to the journal of autosaveFile
+     *
+     * @return false if a full autosave is needed instead, e.g. because there is no base file yet,
+     *         the journal is too long or most of the pages changed
+     */
+    bool append(fs::path const& autosaveFile, std::shared_ptr<DocumentSnapshot> snapshot);
+
+    /**
+     * A full autosave of snapshot was written to autosaveFile, the journal is not needed anymore
+     */
+    void compacted(fs::path const& autosaveFile, std::shared_ptr<DocumentSnapshot> snapshot);
+
+    /**
+     * @return The error of the last append, if any
+     */
+    string getLastError();
+
+    static fs::path getJournalPath(fs::path const& autosaveFile);
+
+    /**
+     * Replays the journal next to filepath, if there is one, onto the loaded document.
+     * An entry cut off by a crash while writing is ignored.
+     * Only called if the user opens an autosave file to recover it, as filepath is modified.
+     *
+     * The journal is only replayed once: the recovered document is written to filepath and the
+     * journal is removed. If that fails, the journal is renamed, so it is not replayed onto a file
+     * which may already contain it.
+     *
+     * @return The count of replayed entries
+     */
+    static int replay(Document* doc, fs::path const& filepath, string& error);
+
+private:
+    /**
+     * Writes the document to filepath, through a temporary file
+     */
+    static bool writeRecovered(Document* doc, fs::path const& filepath, string& error);
+
+private:
+    fs::path autosaveFile;
+
+    /**
+     * The snapshot of the state written by the last full autosave or journal entry
+     */
+    std::shared_ptr<DocumentSnapshot> lastSnapshot;
+
+    int entryCount = 0;
+
+    string lastError;
+};
@@ -1,5 +1,6 @@
 #include "LoadHandler.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <utility>
 
@@ -117,10 +118,10 @@ auto LoadHandler::openFile(fs::path const& filepath) -> bool {
                     FS(_F("The file is no valid .xopp file (Mimetype missing): \"{1}\"") % filepath.u8string());
             return false;
         }
-        char mimetype[25];
+        char mimetype[26] = {0};
         // read the mimetype and a few more bytes to make sure we do not only read a subset
         zip_fread(mimetypeFp, mimetype, 25);
-        if (!strcmp(mimetype, "application/xournal++")) {
+        if (strcmp(mimetype, "application/xournal++") != 0) {
             this->lastError = FS(_F("The file is no valid .xopp file (Mimetype wrong): \"{1}\"") % filepath.u8string());
             return false;
         }
@@ -133,7 +134,7 @@ auto LoadHandler::openFile(fs::path const& filepath) -> bool {
                     FS(_F("The file is no valid .xopp file (Version missing): \"{1}\"") % filepath.u8string());
             return false;
         }
-        char versionString[50];
+        char versionString[51] = {0};
         zip_fread(versionFp, versionString, 50);
         std::string versions(versionString);
         std::regex versionRegex("current=(\\d+?)(?:\n|\r\n)min=(\\d+?)");
@@ -171,6 +172,16 @@ auto LoadHandler::closeFile() -> bool {
 }
 
 auto LoadHandler::readContentFile(char* buffer, zip_uint64_t len) -> zip_int64_t {
+    if (this->contentBuffer) {
+        if (this->contentBufferPos >= this->contentBuffer->size()) {
+            return -1;
+        }
+        zip_uint64_t lengthRead = std::min<zip_uint64_t>(len, this->contentBuffer->size() - this->contentBufferPos);
+        memcpy(buffer, this->contentBuffer->data() + this->contentBufferPos, lengthRead);
+        this->contentBufferPos += lengthRead;
+        return static_cast<zip_int64_t>(lengthRead);
+    }
+
     if (this->isGzFile) {
         if (gzeof(this->gzFp)) {
             return -1;
@@ -295,6 +306,8 @@ void LoadHandler::parseContents() {
         this->page = std::make_unique<XojPage>(width, height);
 
         pages.push_back(this->page);
+    } else if (strcmp(elementName, "pageref") == 0) {
+        this->parsePageRef();
     } else if (strcmp(elementName, "audio") == 0) {
         this->parseAudio();
     } else if (strcmp(elementName, "title") == 0) {
@@ -306,6 +319,50 @@ void LoadHandler::parseContents() {
     }
 }
 
+void LoadHandler::parsePageRef() {
+    const char* src = LoadHandlerHelper::getAttrib("src", false, this);
+    if (src == nullptr) {
+        error("%s", _("Page reference without source"));
+        return;
+    }
+
+    if (this->isGzFile || this->zipFp == nullptr) {
+        error("%s", FC(_F("Page reference \"{1}\" outside of a zip container") % src));
+        return;
+    }
+
+    gpointer data = nullptr;
+    gsize dataLength = 0;
+    if (!readZipAttachment(fs::u8path(src), data, dataLength)) {
+        return;
+    }
+
+    // The entry contains a single <page>, parsed with the same state as an inline page.
+    // Errors are reported to the outer parser, which stops with them.
+    const GMarkupParser parser = {LoadHandler::parserStartElement, LoadHandler::parserEndElement,
+                                  LoadHandler::parserText, nullptr, nullptr};
+    GMarkupParseContext* context =
+            g_markup_parse_context_new(&parser, static_cast<GMarkupParseFlags>(0), this, nullptr);
+
+    GError* parseError = nullptr;
+    if (g_markup_parse_context_parse(context, static_cast<const gchar*>(data), dataLength, &parseError)) {
+        g_markup_parse_context_end_parse(context, &parseError);
+    }
+
+    g_markup_parse_context_free(context);
+    g_free(data);
+
+    if (parseError) {
+        error("%s", FC(_F("Error reading page \"{1}\": {2}") % src % parseError->message));
+        g_error_free(parseError);
+        return;
+    }
+
+    if (this->error == nullptr && this->pos != PARSER_POS_STARTED) {
+        error("%s", FC(_F("Page \"{1}\" is not complete") % src));
+    }
+}
+
 void LoadHandler::parseBgSolid() {
     PageType bg;
     const char* style = LoadHandlerHelper::getAttrib("style", false, this);
@@ -422,6 +479,8 @@ void LoadHandler::parseBgPdf() {
                         return;
                     }
 
+                    // The PDF is part of the container, keep it attached when saving again
+                    attachToDocument = true;
                     doc.readPdf(pdfFilename, false, attachToDocument, data, dataLength);
 
                     if (!doc.getLastErrorMsg().empty()) {
@@ -656,7 +715,7 @@ void LoadHandler::parseTexImage() {
 }
 
 void LoadHandler::parseAttachment() {
-    if (this->pos != PARSER_POS_IN_IMAGE || this->pos != PARSER_POS_IN_TEXIMAGE) {
+    if (this->pos != PARSER_POS_IN_IMAGE && this->pos != PARSER_POS_IN_TEXIMAGE) {
         g_warning("Found attachment tag as child of a tag that should not have such a child (ignoring this tag)");
         return;
     }
@@ -975,6 +1034,29 @@ auto LoadHandler::loadDocument(fs::path const& filepath) -> Document* {
     return &this->doc;
 }
 
+auto LoadHandler::loadDocumentFromString(const string& contents, fs::path const& filepath) -> Document* {
+    initAttributes();
+    doc.clearDocument();
+
+    this->filepath = filepath;
+    this->xournalFilepath = filepath;
+    this->contentBuffer = &contents;
+    this->contentBufferPos = 0;
+
+    // The PDF belongs to the document the pages are added to
+    this->pdfFilenameParsed = true;
+
+    bool valid = parseXml();
+    this->contentBuffer = nullptr;
+
+    if (!valid) {
+        return nullptr;
+    }
+
+    doc.setFilepath(filepath);
+    return &this->doc;
+}
+
 // Todo(fabian): return data and length by value not by reference, to ensure data and length is assigned always
 //      return string not a pointer. Ownage is not clear!
 auto LoadHandler::readZipAttachment(fs::path const& filename, gpointer& data, gsize& length) -> bool {
@@ -1005,8 +1087,8 @@ auto LoadHandler::readZipAttachment(fs::path const& filename, gpointer& data, gs
     data = g_malloc(attachmentFileStat.size);
     zip_uint64_t readBytes = 0;
     while (readBytes < length) {
-        zip_int64_t read = zip_fread(attachmentFile, data, attachmentFileStat.size);
-        if (read == -1) {
+        zip_int64_t read = zip_fread(attachmentFile, static_cast<char*>(data) + readBytes, length - readBytes);
+        if (read <= 0) {
             g_free(data);
             error("%s", FC(_F("Could not open attachment: {1}. Error message: No valid file size provided") %
                            filename.string()));
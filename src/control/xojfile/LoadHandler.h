@@ -48,6 +48,12 @@ public:
 public:
     Document* loadDocument(fs::path const& filepath);
 
+    /**
+     * Parses a document from memory, used for the entries of an AutosaveJournal.
+     * The PDF background is not loaded, PDF pages only reference the page number.
+     */
+    Document* loadDocumentFromString(const string& contents, fs::path const& filepath);
+
     string getLastError();
     bool isAttachedPdfMissing() const;
     string getMissingPdfFilename();
@@ -61,6 +67,7 @@ public:
 private:
     void parseStart();
     void parseContents();
+    void parsePageRef();
     void parsePage();
     void parseLayer();
     void parseAudio();
@@ -127,6 +134,12 @@ private:
     gzFile gzFp;
     bool isGzFile = false;
 
+    /**
+     * If set, the content is read from this buffer instead of a file
+     */
+    const string* contentBuffer = nullptr;
+    string::size_type contentBufferPos = 0;
+
     vector<double> pressureBuffer;
 
     std::vector<PageRef> pages;
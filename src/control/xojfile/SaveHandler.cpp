@@ -27,31 +27,33 @@ SaveHandler::SaveHandler() {
     this->root = nullptr;
     this->firstPdfPageVisited = false;
     this->attachBgId = 1;
-    this->backgroundImages = nullptr;
 }
 
-SaveHandler::~SaveHandler() {
-    delete this->root;
+SaveHandler::~SaveHandler() { delete this->root; }
 
-    for (GList* l = this->backgroundImages; l != nullptr; l = l->next) {
-        delete static_cast<BackgroundImage*>(l->data);
+void SaveHandler::prepareSave(Document* doc) {
+    DocumentSnapshot snapshot(doc);
+    prepareSave(snapshot);
+}
+
+void SaveHandler::prepareSave(DocumentSnapshot& doc) {
+    prepareRoot(doc);
+
+    for (size_t i = 0; i < doc.getPageCount(); i++) {
+        PageRef p = doc.getPage(i);
+        visitPage(this->root, p, doc, i);
     }
-    g_list_free(this->backgroundImages);
-    this->backgroundImages = nullptr;
 }
 
-void SaveHandler::prepareSave(Document* doc) {
+void SaveHandler::prepareRoot(DocumentSnapshot& doc) {
     if (this->root) {
         // cleanup old data
         delete this->root;
         this->root = nullptr;
 
-        for (GList* l = this->backgroundImages; l != nullptr; l = l->next) {
-            delete static_cast<BackgroundImage*>(l->data);
-        }
-        g_list_free(this->backgroundImages);
-        this->backgroundImages = nullptr;
+        this->backgroundImages.clear();
     }
+    this->backgroundImageIds.clear();
 
     this->firstPdfPageVisited = false;
     this->attachBgId = 1;
@@ -60,21 +62,9 @@ void SaveHandler::prepareSave(Document* doc) {
 
     writeHeader();
 
-    cairo_surface_t* preview = doc->getPreview();
+    cairo_surface_t* preview = doc.getPreview();
     if (preview) {
-        auto* image = new XmlImageNode("preview");
-        image->setImage(preview);
-        this->root->addChild(image);
-    }
-
-    for (size_t i = 0; i < doc->getPageCount(); i++) {
-        PageRef p = doc->getPage(i);
-        p->getBackgroundImage().clearSaveState();
-    }
-
-    for (size_t i = 0; i < doc->getPageCount(); i++) {
-        PageRef p = doc->getPage(i);
-        visitPage(this->root, p, doc, i);
+        writePreview(preview);
     }
 }
 
@@ -84,6 +74,12 @@ void SaveHandler::writeHeader() {
     this->root->addChild(new XmlTextNode("title", std::string{"Xournal++ document - see "} + PROJECT_URL));
 }
 
+void SaveHandler::writePreview(cairo_surface_t* preview) {
+    auto* image = new XmlImageNode("preview");
+    image->setImage(preview);
+    this->root->addChild(image);
+}
+
 auto SaveHandler::getColorStr(Color c, unsigned char alpha) -> string {
     char str[10];
     sprintf(str, "#%08" PRIx32, uint32_t(c) << 8U | alpha);
@@ -176,31 +172,38 @@ void SaveHandler::visitLayer(XmlNode* page, Layer* l) {
 
             writeTimestamp(t, text);
         } else if (e->getType() == ELEMENT_IMAGE) {
-            auto* i = dynamic_cast<Image*>(e);
-            auto* image = new XmlImageNode("image");
-            layer->addChild(image);
-
-            image->setImage(i->getImage());
-
-            image->setAttrib("left", i->getX());
-            image->setAttrib("top", i->getY());
-            image->setAttrib("right", i->getX() + i->getElementWidth());
-            image->setAttrib("bottom", i->getY() + i->getElementHeight());
+            visitImage(layer, dynamic_cast<Image*>(e));
         } else if (e->getType() == ELEMENT_TEXIMAGE) {
-            auto* i = dynamic_cast<TexImage*>(e);
-            auto* image = new XmlTexNode("teximage", std::string(i->getBinaryData()));
-            layer->addChild(image);
-
-            image->setAttrib("text", i->getText().c_str());
-            image->setAttrib("left", i->getX());
-            image->setAttrib("top", i->getY());
-            image->setAttrib("right", i->getX() + i->getElementWidth());
-            image->setAttrib("bottom", i->getY() + i->getElementHeight());
+            visitTexImage(layer, dynamic_cast<TexImage*>(e));
         }
     }
 }
 
-void SaveHandler::visitPage(XmlNode* root, PageRef p, Document* doc, int id) {
+void SaveHandler::visitImage(XmlNode* layer, Image* i) {
+    auto* image = new XmlImageNode("image");
+    layer->addChild(image);
+
+    // The encoded data is written as is, the image does not need to be decoded
+    image->setPngData(i->getPngData());
+
+    image->setAttrib("left", i->getX());
+    image->setAttrib("top", i->getY());
+    image->setAttrib("right", i->getX() + i->getElementWidth());
+    image->setAttrib("bottom", i->getY() + i->getElementHeight());
+}
+
+void SaveHandler::visitTexImage(XmlNode* layer, TexImage* i) {
+    auto* image = new XmlTexNode("teximage", std::string(i->getBinaryData()));
+    layer->addChild(image);
+
+    image->setAttrib("text", i->getText().c_str());
+    image->setAttrib("left", i->getX());
+    image->setAttrib("top", i->getY());
+    image->setAttrib("right", i->getX() + i->getElementWidth());
+    image->setAttrib("bottom", i->getY() + i->getElementHeight());
+}
+
+void SaveHandler::visitPage(XmlNode* root, PageRef p, DocumentSnapshot& doc, int id) {
     auto* page = new XmlNode("page");
     root->addChild(page);
     page->setAttrib("width", p->getWidth());
@@ -219,56 +222,40 @@ void SaveHandler::visitPage(XmlNode* root, PageRef p, Document* doc, int id) {
         if (!firstPdfPageVisited) {
             firstPdfPageVisited = true;
 
-            if (doc->isAttachPdf()) {
-                background->setAttrib("domain", "attach");
-                auto filepath = doc->getFilepath();
-                Util::clearExtensions(filepath);
-                filepath += ".xopp.bg.pdf";
-                background->setAttrib("filename", "bg.pdf");
-
-                GError* error = nullptr;
-                doc->getPdfDocument().save(filepath, &error);
-
-                if (error) {
-                    if (!this->errorMessage.empty()) {
-                        this->errorMessage += "\n";
-                    }
-                    this->errorMessage +=
-                            FS(_F("Could not write background \"{1}\", {2}") % filepath.u8string() % error->message);
-
-                    g_error_free(error);
-                }
+            if (doc.isAttachPdf()) {
+                writeAttachedPdf(background, doc);
             } else {
                 background->setAttrib("domain", "absolute");
-                background->setAttrib("filename", doc->getPdfFilepath().string());
+                background->setAttrib("filename", doc.getPdfFilepath().string());
             }
         }
         background->setAttrib("pageno", p->getPdfPageNr() + 1);
     } else if (p->getBackgroundType().isImagePage()) {
         background->setAttrib("type", "pixmap");
 
-        int cloneId = p->getBackgroundImage().getCloneId();
-        if (cloneId != -1) {
+        BackgroundImage& img = p->getBackgroundImage();
+        GdkPixbuf* pixbuf = img.getPixbuf();
+        auto cloneId = pixbuf ? this->backgroundImageIds.find(pixbuf) : this->backgroundImageIds.end();
+        if (cloneId != this->backgroundImageIds.end()) {
             background->setAttrib("domain", "clone");
-            char* filename = g_strdup_printf("%i", cloneId);
+            char* filename = g_strdup_printf("%i", cloneId->second);
             background->setAttrib("filename", filename);
             g_free(filename);
-        } else if (p->getBackgroundImage().isAttached() && p->getBackgroundImage().getPixbuf()) {
+        } else if (img.isAttached() && pixbuf) {
             char* filename = g_strdup_printf("bg_%d.png", this->attachBgId++);
             background->setAttrib("domain", "attach");
             background->setAttrib("filename", filename);
-            p->getBackgroundImage().setFilepath(filename);
 
-            auto* img = new BackgroundImage();
-            *img = p->getBackgroundImage();
-            this->backgroundImages = g_list_append(this->backgroundImages, img);
+            this->backgroundImages.push_back({img, filename});
 
             g_free(filename);
-            p->getBackgroundImage().setCloneId(id);
+            this->backgroundImageIds[pixbuf] = id;
         } else {
             background->setAttrib("domain", "absolute");
-            background->setAttrib("filename", p->getBackgroundImage().getFilepath().string());
-            p->getBackgroundImage().setCloneId(id);
+            background->setAttrib("filename", img.getFilepath().string());
+            if (pixbuf) {
+                this->backgroundImageIds[pixbuf] = id;
+            }
         }
     } else {
         writeSolidBackground(background, p);
@@ -285,6 +272,26 @@ void SaveHandler::visitPage(XmlNode* root, PageRef p, Document* doc, int id) {
     }
 }
 
+void SaveHandler::writeAttachedPdf(XmlNode* background, DocumentSnapshot& doc) {
+    background->setAttrib("domain", "attach");
+    auto filepath = doc.getFilepath();
+    Util::clearExtensions(filepath);
+    filepath += ".xopp.bg.pdf";
+    background->setAttrib("filename", "bg.pdf");
+
+    GError* error = nullptr;
+    doc.getPdfDocument().save(filepath, &error);
+
+    if (error) {
+        if (!this->errorMessage.empty()) {
+            this->errorMessage += "\n";
+        }
+        this->errorMessage += FS(_F("Could not write background \"{1}\", {2}") % filepath.u8string() % error->message);
+
+        g_error_free(error);
+    }
+}
+
 void SaveHandler::writeSolidBackground(XmlNode* background, PageRef p) {
     background->setAttrib("type", "solid");
     background->setAttrib("color", getColorStr(p->getBackgroundColor()));
@@ -321,11 +328,9 @@ void SaveHandler::saveTo(OutputStream* out, const fs::path& filepath, ProgressLi
     out->write("<?xml version=\"1.0\" standalone=\"no\"?>\n");
     root->writeOut(out, listener);
 
-    for (GList* l = this->backgroundImages; l != nullptr; l = l->next) {
-        auto* img = static_cast<BackgroundImage*>(l->data);
-
-        auto tmpfn = (fs::path(filepath) += ".") += img->getFilepath();
-        if (!gdk_pixbuf_save(img->getPixbuf(), tmpfn.u8string().c_str(), "png", nullptr, nullptr)) {
+    for (AttachedBackground& bg: this->backgroundImages) {
+        auto tmpfn = (fs::path(filepath) += ".") += bg.filename;
+        if (!gdk_pixbuf_save(bg.image.getPixbuf(), tmpfn.u8string().c_str(), "png", nullptr, nullptr)) {
             if (!this->errorMessage.empty()) {
                 this->errorMessage += "\n";
             }
@@ -12,10 +12,13 @@
 #pragma once
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "control/xml/XmlAudioNode.h"
+#include "model/BackgroundImage.h"
 #include "model/Document.h"
+#include "model/DocumentSnapshot.h"
 #include "model/PageRef.h"
 #include "model/Stroke.h"
 
@@ -25,6 +28,8 @@
 class XmlNode;
 class XmlPointNode;
 class ProgressListener;
+class Image;
+class TexImage;
 
 class SaveHandler {
 public:
@@ -33,16 +38,28 @@ public:
 
 public:
     void prepareSave(Document* doc);
-    void saveTo(const fs::path& filepath, ProgressListener* listener = nullptr);
+
+    /**
+     * Prepares the save from a snapshot, the document does not need to be locked
+     */
+    virtual void prepareSave(DocumentSnapshot& doc);
+    virtual void saveTo(const fs::path& filepath, ProgressListener* listener = nullptr);
     void saveTo(OutputStream* out, const fs::path& filepath, ProgressListener* listener = nullptr);
     string getErrorMessage();
 
 protected:
     static string getColorStr(Color c, unsigned char alpha = 0xff);
 
-    virtual void visitPage(XmlNode* root, PageRef p, Document* doc, int id);
+    /**
+     * Creates the root node with the header and the preview, without pages
+     */
+    void prepareRoot(DocumentSnapshot& doc);
+
+    virtual void visitPage(XmlNode* root, PageRef p, DocumentSnapshot& doc, int id);
     virtual void visitLayer(XmlNode* page, Layer* l);
     virtual void visitStroke(XmlPointNode* stroke, Stroke* s);
+    virtual void visitImage(XmlNode* layer, Image* i);
+    virtual void visitTexImage(XmlNode* layer, TexImage* i);
 
     /**
      * Export the fill attributes
@@ -50,6 +67,8 @@ protected:
     virtual void visitStrokeExtended(XmlPointNode* stroke, Stroke* s);
 
     virtual void writeHeader();
+    virtual void writePreview(cairo_surface_t* preview);
+    virtual void writeAttachedPdf(XmlNode* background, DocumentSnapshot& doc);
     virtual void writeSolidBackground(XmlNode* background, PageRef p);
     virtual void writeTimestamp(AudioElement* audioElement, XmlAudioNode* xmlAudioNode);
 
@@ -60,5 +79,19 @@ protected:
 
     string errorMessage;
 
-    GList* backgroundImages;
+    /**
+     * An attached background image and the name of the file it is written to
+     */
+    struct AttachedBackground {
+        BackgroundImage image;
+        string filename;
+    };
+
+    vector<AttachedBackground> backgroundImages;
+
+    /**
+     * The id of the page each background image was written with first, the following pages refer to it
+     * as clone. The images are shared with the document, so this is not stored in them.
+     */
+    std::unordered_map<GdkPixbuf*, int> backgroundImageIds;
 };
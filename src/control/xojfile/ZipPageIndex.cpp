@@ -0,0 +1,60 @@
+#include "ZipPageIndex.h"
+
+ZipPageIndex::ZipPageIndex() = default;
+
+ZipPageIndex::~ZipPageIndex() = default;
+
+auto ZipPageIndex::statFile(fs::path const& file, GStatBuf& st) -> bool {
+    return g_stat(file.u8string().c_str(), &st) == 0;
+}
+
+auto ZipPageIndex::isValidFor(fs::path const& file) const -> bool {
+    if (this->file.empty() || this->file != file) {
+        return false;
+    }
+
+    // The file may have been replaced by another program
+    GStatBuf st;
+    return statFile(file, st) && st.st_size == this->fileSize && st.st_mtime == this->fileTime;
+}
+
+auto ZipPageIndex::getEntry(const PageRef& page) const -> string {
+    auto it = this->entries.find(page.get());
+    if (it == this->entries.end() || it->second.first.lock() != page) {
+        return "";
+    }
+    return it->second.second;
+}
+
+auto ZipPageIndex::getAttachedPdf() const -> fs::path { return this->attachedPdf; }
+
+auto ZipPageIndex::getNextPageId() const -> int { return this->nextPageId; }
+
+void ZipPageIndex::saved(fs::path const& file, const std::vector<std::pair<PageRef, string>>& pageEntries,
+                         int nextPageId, fs::path attachedPdf) {
+    clear();
+
+    GStatBuf st;
+    if (!statFile(file, st)) {
+        return;
+    }
+
+    this->file = file;
+    this->fileSize = st.st_size;
+    this->fileTime = st.st_mtime;
+    this->nextPageId = nextPageId;
+    this->attachedPdf = std::move(attachedPdf);
+
+    for (auto& e: pageEntries) {
+        this->entries[e.first.get()] = std::make_pair(std::weak_ptr<XojPage>(e.first), e.second);
+    }
+}
+
+void ZipPageIndex::clear() {
+    this->file.clear();
+    this->fileSize = -1;
+    this->fileTime = -1;
+    this->entries.clear();
+    this->nextPageId = 1;
+    this->attachedPdf.clear();
+}
@@ -0,0 +1,79 @@
+/*
+ * Xournal++
+ *
+ * Remembers which zip container entries hold the pages of the last save
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <glib/gstdio.h>
+
+#include "model/PageRef.h"
+
+#include "XournalType.h"
+#include "filesystem.h"
+
+/**
+ * The pages are identified by the copies of the DocumentSnapshot%s, which are shared
+ * between snapshots as long as a page is unchanged. A page whose copy was written
+ * by the last save can keep its entry, the container only needs to rewrite the other pages.
+ */
+class ZipPageIndex {
+public:
+    ZipPageIndex();
+    virtual ~ZipPageIndex();
+
+public:
+    /**
+     * @return true if file was written by the last save and was not modified since
+     */
+    bool isValidFor(fs::path const& file) const;
+
+    /**
+     * @return The entry of page in the last saved container, empty if the page changed since
+     */
+    string getEntry(const PageRef& page) const;
+
+    /**
+     * @return The background PDF stored in the last saved container, empty if none was attached
+     */
+    fs::path getAttachedPdf() const;
+
+    /**
+     * @return A number not used by any page entry of the last saved container
+     */
+    int getNextPageId() const;
+
+    /**
+     * Stores the state of a successfully written container
+     */
+    void saved(fs::path const& file, const std::vector<std::pair<PageRef, string>>& pageEntries, int nextPageId,
+               fs::path attachedPdf);
+
+    void clear();
+
+private:
+    static bool statFile(fs::path const& file, GStatBuf& st);
+
+private:
+    fs::path file;
+    gint64 fileSize = -1;
+    gint64 fileTime = -1;
+
+    std::unordered_map<XojPage*, std::pair<std::weak_ptr<XojPage>, string>> entries;
+
+    int nextPageId = 1;
+
+    fs::path attachedPdf;
+};
@@ -0,0 +1,429 @@
+#include "ZipSaveHandler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <utility>
+
+#include <config.h>
+#include <glib/gstdio.h>
+
+#include "control/xml/XmlAudioNode.h"
+#include "control/xml/XmlNode.h"
+#include "model/AudioElement.h"
+#include "model/BackgroundImage.h"
+#include "model/Image.h"
+#include "model/Layer.h"
+#include "model/TexImage.h"
+
+#include "OutputStream.h"
+#include "StringUtils.h"
+#include "ZipPageIndex.h"
+#include "i18n.h"
+
+ZipSaveHandler::ZipSaveHandler() = default;
+
+ZipSaveHandler::~ZipSaveHandler() {
+    if (!this->pdfTempFile.empty()) {
+        std::error_code ec;
+        fs::remove(this->pdfTempFile, ec);
+    }
+}
+
+void ZipSaveHandler::setAudioFolder(fs::path audioFolder) { this->audioFolder = std::move(audioFolder); }
+
+void ZipSaveHandler::addError(const string& error) {
+    if (!this->errorMessage.empty()) {
+        this->errorMessage += "\n";
+    }
+    this->errorMessage += error;
+}
+
+void ZipSaveHandler::addAttachment(string name, string data, bool compress) {
+    Attachment a;
+    a.name = std::move(name);
+    a.data = std::move(data);
+    a.compress = compress;
+    this->attachments.push_back(std::move(a));
+}
+
+void ZipSaveHandler::addAttachmentFile(string name, fs::path const& file) {
+    Attachment a;
+    a.name = std::move(name);
+    a.file = file;
+    this->attachments.push_back(std::move(a));
+}
+
+void ZipSaveHandler::setPageIndex(ZipPageIndex* pageIndex) { this->pageIndex = pageIndex; }
+
+void ZipSaveHandler::prepareSave(DocumentSnapshot& doc) {
+    this->snapshot = &doc;
+    this->attachments.clear();
+    this->audioEntries.clear();
+
+    collectAudioFiles(doc);
+
+    // Only the manifest, the pages are written when the target container is known
+    prepareRoot(doc);
+}
+
+void ZipSaveHandler::collectAudioFiles(DocumentSnapshot& doc) {
+    std::set<string> usedEntries;
+    for (size_t i = 0; i < doc.getPageCount(); i++) {
+        for (Layer* l: *doc.getPage(i)->getLayers()) {
+            for (Element* e: *l->getElements()) {
+                if (e->getType() != ELEMENT_STROKE && e->getType() != ELEMENT_TEXT) {
+                    continue;
+                }
+
+                string filename = dynamic_cast<AudioElement*>(e)->getAudioFilename();
+                if (filename.empty() || this->audioEntries.count(filename)) {
+                    continue;
+                }
+
+                fs::path file = fs::u8path(filename);
+                if (file.is_relative()) {
+                    file = this->audioFolder / file;
+                }
+
+                if (!fs::is_regular_file(file)) {
+                    g_warning("%s", FC(_F("Audio recording \"{1}\" not found, it is not saved with the document") %
+                                       file.u8string()));
+                    this->audioEntries[filename] = "";
+                    continue;
+                }
+
+                // Recordings are never modified, the name only depends on the path, so a partial save can keep
+                // the entry. Recordings of different folders may have the same file name.
+                string folder = "audio/" + std::to_string(std::hash<string>{}(file.u8string()));
+                string entry = folder + "/" + file.filename().u8string();
+                for (int i = 1; usedEntries.count(entry); i++) {
+                    entry = folder + "-" + std::to_string(i) + "/" + file.filename().u8string();
+                }
+                usedEntries.insert(entry);
+                this->audioEntries[filename] = entry;
+            }
+        }
+    }
+}
+
+void ZipSaveHandler::writeHeader() {
+    SaveHandler::writeHeader();
+
+    // LoadHandler extracts the recordings while parsing these nodes, before the elements reference them
+    for (auto& audio: this->audioEntries) {
+        if (audio.second.empty()) {
+            continue;
+        }
+
+        auto* node = new XmlNode("audio");
+        node->setAttrib("fn", audio.second);
+        this->root->addChild(node);
+    }
+}
+
+void ZipSaveHandler::writeTimestamp(AudioElement* audioElement, XmlAudioNode* xmlAudioNode) {
+    xmlAudioNode->setAttrib("ts", audioElement->getTimestamp());
+
+    auto it = this->audioEntries.find(audioElement->getAudioFilename());
+    if (it != this->audioEntries.end() && !it->second.empty()) {
+        xmlAudioNode->setAttrib("fn", it->second);
+    }
+}
+
+void ZipSaveHandler::writePreview(cairo_surface_t* preview) {
+    Image image;
+    image.setImage(cairo_surface_reference(preview));
+    addAttachment("thumbnails/thumbnail.png", image.getPngData(), false);
+}
+
+void ZipSaveHandler::writeAttachedPdf(XmlNode* background, DocumentSnapshot& doc) {
+    // The PDF itself is written once by saveTo
+    background->setAttrib("domain", "attach");
+    background->setAttrib("filename", "bg.pdf");
+}
+
+void ZipSaveHandler::writePdf() {
+    // The PDF can only be saved to a file, it is copied into the container when closing it
+    gchar* tempName = nullptr;
+    GError* error = nullptr;
+    int fd = g_file_open_tmp("xournalpp_bg_XXXXXX.pdf", &tempName, &error);
+    if (fd != -1) {
+        g_close(fd, nullptr);
+        this->pdfTempFile = fs::u8path(tempName);
+        g_free(tempName);
+
+        this->snapshot->getPdfDocument().save(this->pdfTempFile, &error);
+    }
+
+    if (error) {
+        addError(FS(_F("Could not write background \"{1}\", {2}") % "bg.pdf" % error->message));
+        g_error_free(error);
+        return;
+    }
+
+    addAttachmentFile("bg.pdf", this->pdfTempFile);
+}
+
+void ZipSaveHandler::writePage(size_t pageIndex, int id, const string& entry) {
+    PageRef p = this->snapshot->getPage(pageIndex);
+
+    this->attachmentPrefix = "pages/" + std::to_string(id) + "/";
+    this->imageCount = 0;
+
+    // Every page entry names the PDF, as any of them may be the first one loaded
+    this->firstPdfPageVisited = false;
+
+    XmlNode container("pages");
+    visitPage(&container, p, *this->snapshot, static_cast<int>(pageIndex));
+
+    StringOutputStream out;
+    out.write("<?xml version=\"1.0\" standalone=\"no\"?>\n");
+    container.writeChildren(&out);
+    addAttachment(entry, out.getContents(), true);
+}
+
+void ZipSaveHandler::visitImage(XmlNode* layer, Image* i) {
+    auto* image = new XmlNode("image");
+    layer->addChild(image);
+
+    image->setAttrib("left", i->getX());
+    image->setAttrib("top", i->getY());
+    image->setAttrib("right", i->getX() + i->getElementWidth());
+    image->setAttrib("bottom", i->getY() + i->getElementHeight());
+
+    string name = this->attachmentPrefix + std::to_string(++this->imageCount) + ".png";
+
+    auto* attachment = new XmlNode("attachment");
+    attachment->setAttrib("path", name);
+    image->addChild(attachment);
+
+    addAttachment(name, i->getPngData(), false);
+}
+
+void ZipSaveHandler::visitTexImage(XmlNode* layer, TexImage* i) {
+    auto* image = new XmlNode("teximage");
+    layer->addChild(image);
+
+    image->setAttrib("text", i->getText().c_str());
+    image->setAttrib("left", i->getX());
+    image->setAttrib("top", i->getY());
+    image->setAttrib("right", i->getX() + i->getElementWidth());
+    image->setAttrib("bottom", i->getY() + i->getElementHeight());
+
+    const string& data = i->getBinaryData();
+    bool isPdf = data.compare(0, 4, "%PDF") == 0;
+    string name = this->attachmentPrefix + "tex" + std::to_string(++this->imageCount) + (isPdf ? ".pdf" : ".png");
+
+    auto* attachment = new XmlNode("attachment");
+    attachment->setAttrib("path", name);
+    image->addChild(attachment);
+
+    addAttachment(name, data, false);
+}
+
+auto ZipSaveHandler::writeEntry(zip_t* zip, const string& name, zip_source_t* source, bool compress) -> bool {
+    if (!source) {
+        addError(FS(_F("Could not write \"{1}\": {2}") % name % zip_strerror(zip)));
+        return false;
+    }
+
+    zip_int64_t index = zip_file_add(zip, name.c_str(), source, ZIP_FL_OVERWRITE | ZIP_FL_ENC_UTF_8);
+    if (index < 0) {
+        zip_source_free(source);
+        addError(FS(_F("Could not write \"{1}\": {2}") % name % zip_strerror(zip)));
+        return false;
+    }
+
+    zip_set_file_compression(zip, index, compress ? ZIP_CM_DEFLATE : ZIP_CM_STORE, 0);
+    return true;
+}
+
+void ZipSaveHandler::deleteUnusedEntries(zip_t* zip, const std::set<string>& keep,
+                                         const std::vector<string>& keepPrefixes) {
+    zip_int64_t count = zip_get_num_entries(zip, 0);
+    for (zip_int64_t i = 0; i < count; i++) {
+        const char* name = zip_get_name(zip, i, 0);
+        if (name == nullptr || keep.count(name)) {
+            continue;
+        }
+
+        bool used = std::any_of(keepPrefixes.begin(), keepPrefixes.end(),
+                                [name](const string& prefix) { return StringUtils::startsWith(name, prefix); });
+        if (!used) {
+            zip_delete(zip, i);
+        }
+    }
+}
+
+void ZipSaveHandler::saveTo(const fs::path& filepath, ProgressListener* listener) {
+    g_return_if_fail(this->snapshot != nullptr);
+
+    // Update the container of the last save in place, if it was not touched since
+    bool partial = this->pageIndex && this->pageIndex->isValidFor(filepath);
+
+    int zipError = 0;
+    zip_t* zip = nullptr;
+    if (partial) {
+        zip = zip_open(filepath.u8string().c_str(), 0, &zipError);
+        partial = zip != nullptr;
+    }
+    if (!zip) {
+        zip = zip_open(filepath.u8string().c_str(), ZIP_CREATE | ZIP_TRUNCATE, &zipError);
+    }
+    if (!zip) {
+        zip_error_t error;
+        zip_error_init_with_code(&error, zipError);
+        addError(FS(_F("Could not open \"{1}\" for writing: {2}") % filepath.u8string() % zip_error_strerror(&error)));
+        zip_error_fini(&error);
+        if (this->pageIndex) {
+            this->pageIndex->clear();
+        }
+        return;
+    }
+
+    static const string mimetype = "application/xournal++";
+    static const string version = "current=" + std::to_string(FILE_FORMAT_VERSION) +
+                                  "\nmin=" + std::to_string(FILE_FORMAT_VERSION) + "\n";
+
+    std::set<string> keep = {"mimetype", "META-INF/version", "content.xml", "thumbnails/thumbnail.png"};
+    std::vector<string> keepPrefixes;
+    std::vector<std::pair<PageRef, string>> pageEntries;
+    int nextPageId = partial ? this->pageIndex->getNextPageId() : 1;
+    bool hasPdfPages = false;
+
+    size_t pageCount = this->snapshot->getPageCount();
+    if (listener) {
+        listener->setMaximumState(static_cast<int>(pageCount));
+    }
+
+    for (size_t i = 0; i < pageCount; i++) {
+        PageRef p = this->snapshot->getPage(i);
+        hasPdfPages = hasPdfPages || p->getBackgroundType().isPdfPage();
+
+        // Image backgrounds are referenced by the page number, their pages are always written again
+        string entry;
+        if (partial && !p->getBackgroundType().isImagePage()) {
+            entry = this->pageIndex->getEntry(p);
+        }
+
+        if (entry.empty()) {
+            int id = nextPageId++;
+            entry = "pages/" + std::to_string(id) + ".xml";
+            writePage(i, id, entry);
+        } else {
+            keepPrefixes.push_back(entry.substr(0, entry.size() - 4) + "/");
+        }
+        keep.insert(entry);
+
+        auto* pageref = new XmlNode("pageref");
+        pageref->setAttrib("src", entry);
+        this->root->addChild(pageref);
+
+        pageEntries.emplace_back(p, entry);
+
+        if (listener) {
+            listener->setCurrentState(static_cast<int>(i + 1));
+        }
+    }
+
+    fs::path attachedPdf;
+    if (hasPdfPages && this->snapshot->isAttachPdf()) {
+        attachedPdf = this->snapshot->getPdfFilepath();
+        keep.insert("bg.pdf");
+        if (!partial || this->pageIndex->getAttachedPdf() != attachedPdf) {
+            writePdf();
+        }
+    }
+
+    for (auto& audio: this->audioEntries) {
+        if (audio.second.empty()) {
+            continue;
+        }
+
+        keep.insert(audio.second);
+        if (partial && zip_name_locate(zip, audio.second.c_str(), 0) >= 0) {
+            continue;
+        }
+
+        fs::path file = fs::u8path(audio.first);
+        if (file.is_relative()) {
+            file = this->audioFolder / file;
+        }
+        addAttachmentFile(audio.second, file);
+    }
+
+    for (AttachedBackground& bg: this->backgroundImages) {
+        gchar* buffer = nullptr;
+        gsize bufferSize = 0;
+        GError* error = nullptr;
+        if (!gdk_pixbuf_save_to_buffer(bg.image.getPixbuf(), &buffer, &bufferSize, "png", &error, nullptr)) {
+            addError(FS(_F("Could not write background \"{1}\". Continuing anyway.") % bg.filename));
+            g_clear_error(&error);
+            continue;
+        }
+
+        addAttachment(bg.filename, string(buffer, bufferSize), false);
+        g_free(buffer);
+    }
+
+    for (Attachment& a: this->attachments) {
+        keep.insert(a.name);
+    }
+
+    if (partial) {
+        deleteUnusedEntries(zip, keep, keepPrefixes);
+    }
+
+    StringOutputStream content;
+    content.write("<?xml version=\"1.0\" standalone=\"no\"?>\n");
+    this->root->writeOut(&content);
+
+    // The mimetype is the first entry and not compressed, so the file type can be detected from the first bytes.
+    // An updated container already starts with it.
+    bool success = true;
+    if (!partial) {
+        success = writeEntry(zip, "mimetype", zip_source_buffer(zip, mimetype.data(), mimetype.size(), 0), false) &&
+                  writeEntry(zip, "META-INF/version", zip_source_buffer(zip, version.data(), version.size(), 0), true);
+    }
+
+    const string& contents = content.getContents();
+    success = success &&
+              writeEntry(zip, "content.xml", zip_source_buffer(zip, contents.data(), contents.size(), 0), true);
+
+    for (Attachment& a: this->attachments) {
+        if (!success) {
+            break;
+        }
+
+        zip_source_t* source = nullptr;
+        if (a.file.empty()) {
+            source = zip_source_buffer(zip, a.data.data(), a.data.size(), 0);
+        } else {
+            source = zip_source_file(zip, a.file.u8string().c_str(), 0, -1);
+        }
+        success = writeEntry(zip, a.name, source, a.compress);
+    }
+
+    if (!success) {
+        zip_discard(zip);
+        if (this->pageIndex) {
+            this->pageIndex->clear();
+        }
+        return;
+    }
+
+    // The new entries are read and compressed here, unchanged entries are copied without decompressing them
+    if (zip_close(zip) != 0) {
+        addError(FS(_F("Could not write \"{1}\": {2}") % filepath.u8string() % zip_strerror(zip)));
+        zip_discard(zip);
+        if (this->pageIndex) {
+            this->pageIndex->clear();
+        }
+        return;
+    }
+
+    if (this->pageIndex) {
+        this->pageIndex->saved(filepath, pageEntries, nextPageId, attachedPdf);
+    }
+}
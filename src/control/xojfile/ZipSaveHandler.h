@@ -0,0 +1,142 @@
+/*
+ * Xournal++
+ *
+ * Saves a document as zip container
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <zip.h>
+
+#include "SaveHandler.h"
+#include "XournalType.h"
+#include "filesystem.h"
+
+class ZipPageIndex;
+
+/**
+ * Writes the zip container read by LoadHandler: a stored "mimetype" entry, "META-INF/version",
+ * the XML in "content.xml" and all binary data as separate entries, which are referenced
+ * by <attachment> nodes or "attach" domains instead of being base64 encoded into the XML.
+ *
+ * Each page is an entry "pages/<id>.xml" with its attachments in "pages/<id>/", "content.xml"
+ * only references them with <pageref> nodes. With a ZipPageIndex the container written by the
+ * last save is updated in place, the entries of unchanged pages are kept as they are.
+ */
+class ZipSaveHandler: public SaveHandler {
+public:
+    ZipSaveHandler();
+    virtual ~ZipSaveHandler();
+
+public:
+    using SaveHandler::prepareSave;
+    using SaveHandler::saveTo;
+
+    /**
+     * The pages are only serialized by saveTo, doc has to be kept until then
+     */
+    void prepareSave(DocumentSnapshot& doc) override;
+    void saveTo(const fs::path& filepath, ProgressListener* listener = nullptr) override;
+
+    /**
+     * The folder audio recordings with a relative filename are stored in
+     */
+    void setAudioFolder(fs::path audioFolder);
+
+    /**
+     * Enables partial saves, the index is updated after each successful save
+     */
+    void setPageIndex(ZipPageIndex* pageIndex);
+
+protected:
+    void writeHeader() override;
+    void writePreview(cairo_surface_t* preview) override;
+    void writeAttachedPdf(XmlNode* background, DocumentSnapshot& doc) override;
+    void writeTimestamp(AudioElement* audioElement, XmlAudioNode* xmlAudioNode) override;
+    void visitImage(XmlNode* layer, Image* i) override;
+    void visitTexImage(XmlNode* layer, TexImage* i) override;
+
+    /**
+     * Adds an entry with binary data, which is written by saveTo
+     * @param compress false for data which is already compressed, like PNG or PDF
+     */
+    void addAttachment(string name, string data, bool compress);
+
+    /**
+     * Adds an entry with the contents of a file, which is read by saveTo
+     */
+    void addAttachmentFile(string name, fs::path const& file);
+
+    void addError(const string& error);
+
+private:
+    /**
+     * Finds the audio recordings of the document, so they are declared before the first page
+     */
+    void collectAudioFiles(DocumentSnapshot& doc);
+
+    /**
+     * Serializes page into the entry "pages/<id>.xml"
+     */
+    void writePage(size_t pageIndex, int id, const string& entry);
+
+    /**
+     * Saves the background PDF to a temporary file and adds it as "bg.pdf"
+     */
+    void writePdf();
+
+    /**
+     * Removes all entries of the existing container which are not part of this save
+     */
+    void deleteUnusedEntries(zip_t* zip, const std::set<string>& keep, const std::vector<string>& keepPrefixes);
+
+    bool writeEntry(zip_t* zip, const string& name, zip_source_t* source, bool compress);
+
+private:
+    struct Attachment {
+        string name;
+        string data;
+        fs::path file;
+        bool compress = false;
+    };
+
+    /**
+     * A deque, as libzip reads the data while closing the archive, the buffers must not move
+     */
+    std::deque<Attachment> attachments;
+
+    fs::path audioFolder;
+
+    ZipPageIndex* pageIndex = nullptr;
+
+    DocumentSnapshot* snapshot = nullptr;
+
+    /**
+     * Prefix of the attachments of the page currently serialized
+     */
+    string attachmentPrefix;
+
+    /**
+     * Audio filename of the elements -> name of the zip entry, empty if the recording does not exist
+     */
+    std::map<string, string> audioEntries;
+
+    /**
+     * Temporary copy of the background PDF, removed with the handler
+     */
+    fs::path pdfTempFile;
+
+    int imageCount = 0;
+};
@@ -0,0 +1,172 @@
+#include "LatencyTrace.h"
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * Interval between two reports in the log, in microseconds
+ */
+constexpr gint64 REPORT_INTERVAL = 10 * G_USEC_PER_SEC;
+
+/**
+ * Frames whose timings are not complete after this many frames are not waited for anymore
+ */
+constexpr gint64 MAX_PENDING_FRAMES = 16;
+
+static const char* STAGE_NAMES[LatencyTrace::STAGE_COUNT] = {"handled", "repaint queued", "drawn", "presented"};
+
+std::atomic<bool> LatencyTrace::enabled{false};
+
+LatencyTrace::LatencyTrace() = default;
+
+LatencyTrace::~LatencyTrace() = default;
+
+auto LatencyTrace::getInstance() -> LatencyTrace& {
+    static LatencyTrace instance;
+    return instance;
+}
+
+void LatencyTrace::setEnabled(bool enabled) {
+    LatencyTrace::enabled = enabled;
+    if (enabled) {
+        g_message("Latency tracing enabled, reporting every %d seconds",
+                  static_cast<int>(REPORT_INTERVAL / G_USEC_PER_SEC));
+    }
+}
+
+void LatencyTrace::setCurrentEvent(gint64 receiveTime) {
+    if (!isEnabled()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->currentEvent = receiveTime;
+}
+
+auto LatencyTrace::getCurrentEvent() -> gint64 {
+    if (!isEnabled()) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->currentEvent;
+}
+
+void LatencyTrace::handled() {
+    if (!isEnabled()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (this->currentEvent == 0) {
+        return;
+    }
+
+    record(STAGE_HANDLED, {this->currentEvent}, g_get_monotonic_time());
+    this->awaitingRepaint.push_back(this->currentEvent);
+
+    // Count each event only once, even if it is handled on two pages
+    this->currentEvent = 0;
+}
+
+void LatencyTrace::repaintQueued() {
+    if (!isEnabled()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (this->awaitingRepaint.empty()) {
+        return;
+    }
+
+    record(STAGE_REPAINT_QUEUED, this->awaitingRepaint, g_get_monotonic_time());
+    this->awaitingDraw.insert(this->awaitingDraw.end(), this->awaitingRepaint.begin(), this->awaitingRepaint.end());
+    this->awaitingRepaint.clear();
+}
+
+void LatencyTrace::drawn(GdkFrameClock* clock) {
+    if (!isEnabled()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    gint64 now = g_get_monotonic_time();
+
+    if (!this->awaitingDraw.empty()) {
+        record(STAGE_DRAWN, this->awaitingDraw, now);
+        if (clock) {
+            this->awaitingPresent.push_back({gdk_frame_clock_get_frame_counter(clock), std::move(this->awaitingDraw)});
+        }
+        this->awaitingDraw.clear();
+    }
+
+    if (clock) {
+        collectPresented(clock);
+    }
+
+    if (this->lastReport == 0) {
+        this->lastReport = now;
+    } else if (now - this->lastReport > REPORT_INTERVAL) {
+        writeReport();
+        this->lastReport = now;
+    }
+}
+
+void LatencyTrace::collectPresented(GdkFrameClock* clock) {
+    gint64 current = gdk_frame_clock_get_frame_counter(clock);
+
+    while (!this->awaitingPresent.empty()) {
+        Frame& frame = this->awaitingPresent.front();
+        if (frame.counter >= current) {
+            // Still being painted
+            break;
+        }
+
+        GdkFrameTimings* timings = gdk_frame_clock_get_timings(clock, frame.counter);
+        bool complete = timings && gdk_frame_timings_get_complete(timings);
+        if (!complete && timings && current - frame.counter < MAX_PENDING_FRAMES) {
+            break;
+        }
+
+        // Not every backend reports the presentation time
+        if (complete && gdk_frame_timings_get_presentation_time(timings) > 0) {
+            record(STAGE_PRESENTED, frame.events, gdk_frame_timings_get_presentation_time(timings));
+        }
+
+        this->awaitingPresent.pop_front();
+    }
+}
+
+void LatencyTrace::record(Stage stage, const std::vector<gint64>& events, gint64 time) {
+    for (gint64 event: events) {
+        this->samples[stage].push_back(time - event);
+    }
+}
+
+void LatencyTrace::report() {
+    if (!isEnabled()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    writeReport();
+}
+
+void LatencyTrace::writeReport() {
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        std::vector<gint64>& s = this->samples[i];
+        if (s.empty()) {
+            continue;
+        }
+
+        std::sort(s.begin(), s.end());
+        auto percentile = [&s](double p) {
+            size_t rank = static_cast<size_t>(std::ceil(p * s.size()));
+            return s[std::max<size_t>(rank, 1) - 1] / 1000.0;
+        };
+
+        g_message("Latency %-14s n=%-6zu p50=%6.2f ms  p95=%6.2f ms  p99=%6.2f ms  max=%6.2f ms", STAGE_NAMES[i],
+                  s.size(), percentile(0.50), percentile(0.95), percentile(0.99), s.back() / 1000.0);
+        s.clear();
+    }
+}
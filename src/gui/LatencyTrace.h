@@ -0,0 +1,110 @@
+/*
+ * Xournal++
+ *
+ * Measures the latency from pen input to the painted result
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include <gtk/gtk.h>
+
+/**
+ * Opt-in tracing, enabled with --trace-latency.
+ *
+ * Every event is timestamped when InputContext receives it. If a handler adds it to a stroke, the
+ * latency is recorded when the handler is done, when the repaint is queued, when the widget has
+ * been drawn and when the compositor reports the frame as presented. The percentiles of each
+ * stage are written to the log every few seconds and on exit.
+ *
+ * All calls are cheap no-ops while tracing is disabled.
+ */
+class LatencyTrace final {
+public:
+    enum Stage { STAGE_HANDLED, STAGE_REPAINT_QUEUED, STAGE_DRAWN, STAGE_PRESENTED, STAGE_COUNT };
+
+private:
+    LatencyTrace();
+
+public:
+    static LatencyTrace& getInstance();
+
+    ~LatencyTrace();
+    LatencyTrace(LatencyTrace const&) = delete;
+    LatencyTrace(LatencyTrace&&) = delete;
+    LatencyTrace& operator=(LatencyTrace const&) = delete;
+    LatencyTrace& operator=(LatencyTrace&&) = delete;
+
+public:
+    static void setEnabled(bool enabled);
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * Sets the receive time of the event which is processed now, 0 if none
+     */
+    void setCurrentEvent(gint64 receiveTime);
+
+    /**
+     * @return The receive time of the event which is processed now, 0 if none
+     */
+    gint64 getCurrentEvent();
+
+    /**
+     * The current event was applied to the page
+     */
+    void handled();
+
+    /**
+     * A repaint was queued for all handled events
+     */
+    void repaintQueued();
+
+    /**
+     * The widget was drawn in the current frame of clock
+     */
+    void drawn(GdkFrameClock* clock);
+
+    /**
+     * Writes the percentiles of all stages to the log and starts over
+     */
+    void report();
+
+private:
+    void record(Stage stage, const std::vector<gint64>& events, gint64 time);
+    void collectPresented(GdkFrameClock* clock);
+    void writeReport();
+
+private:
+    static std::atomic<bool> enabled;
+
+    std::mutex mutex;
+
+    gint64 currentEvent = 0;
+
+    std::vector<gint64> awaitingRepaint;
+    std::vector<gint64> awaitingDraw;
+
+    struct Frame {
+        gint64 counter;
+        std::vector<gint64> events;
+    };
+
+    std::deque<Frame> awaitingPresent;
+
+    /**
+     * Latency samples of each stage in microseconds
+     */
+    std::array<std::vector<gint64>, STAGE_COUNT> samples;
+
+    gint64 lastReport = 0;
+};
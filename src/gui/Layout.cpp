@@ -1,8 +1,8 @@
 #include "Layout.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <cstdlib>
-#include <numeric>
 #include <optional>
 #include <utility>
 
@@ -56,56 +56,69 @@ void Layout::checkScroll(GtkAdjustment* adjustment, double& lastScroll) {
 void Layout::updateVisibility() {
     Rectangle visRect = getVisibleRect();
 
-    // step through every possible page position and update using p->setIsVisible()
-    // Using initial grid aprox speeds things up by a factor of 5.  See previous git check-in for specifics.
-    int x1 = 0;
-    int y1 = 0;
+    // The grid locations overlapping the visible area are used as an aprox for page visibility
+    auto const& rowEnds = this->pc.rowEnds;
+    auto const& colEnds = this->pc.colEnds;
+    double const top = visRect.y - this->borderY;
+    double const left = visRect.x - this->borderX;
+    size_t const firstRow = findIndex(rowEnds, top);
+    size_t const firstCol = findIndex(colEnds, left);
+    // Up to the first row (column) which starts below (right of) the visible area
+    size_t const endRow = std::min<size_t>(
+            std::upper_bound(begin(rowEnds), end(rowEnds), top + visRect.height) - begin(rowEnds) + 1, rowEnds.size());
+    size_t const endCol = std::min<size_t>(
+            std::upper_bound(begin(colEnds), end(colEnds), left + visRect.width) - begin(colEnds) + 1, colEnds.size());
 
     // Data to select page based on visibility
     std::optional<size_t> mostPageNr;
     double mostPagePercent = 0;
 
-    for (size_t row = 0; row < this->rowYStart.size(); ++row) {
-        int y2 = this->rowYStart[row];
-        for (size_t col = 0; col < this->colXStart.size(); ++col) {
-            int x2 = this->colXStart[col];
+    std::vector<size_t> nowVisible;
+    for (size_t row = firstRow; row < endRow; ++row) {
+        for (size_t col = firstCol; col < endCol; ++col) {
             auto optionalPage = this->mapper.at({col, row});
-            if (optionalPage)  // a page exists at this grid location
-            {
-                XojPageView* pageView = this->view->viewPages[*optionalPage];
-
-
-                // check if grid location is visible as an aprox for page visiblity:
-                if (!(visRect.x > x2 || visRect.x + visRect.width < x1)  // visrect not outside current row/col
-                    && !(visRect.y > y2 || visRect.y + visRect.height < y1)) {
-                    // now use exact check of page itself:
-                    // visrect not outside current page dimensions:
-                    auto const& pageRect = pageView->getRect();
-                    if (auto intersection = pageRect.intersects(visRect); intersection) {
-                        pageView->setIsVisible(true);
-                        // Set the selected page
-                        double percent = intersection->area() / pageRect.area();
-
-                        if (percent > mostPagePercent) {
-                            mostPageNr = *optionalPage;
-                            mostPagePercent = percent;
-                        }
-                    }
-                } else {
-                    pageView->setIsVisible(false);
+            if (!optionalPage || *optionalPage >= this->view->viewPages.size()) {
+                continue;
+            }
+            nowVisible.push_back(*optionalPage);
+
+            // now use exact check of page itself:
+            // visrect not outside current page dimensions:
+            // the view of the page is only created if it is visible
+            auto const& pageRect = this->view->viewPages[*optionalPage].getRect();
+            if (auto intersection = pageRect.intersects(visRect); intersection) {
+                this->view->getViewFor(*optionalPage)->setIsVisible(true);
+                // Set the selected page
+                double percent = intersection->area() / pageRect.area();
+
+                if (percent > mostPagePercent) {
+                    mostPageNr = *optionalPage;
+                    mostPagePercent = percent;
                 }
             }
-            x1 = x2;
         }
-        y1 = y2;
-        x1 = 0;
     }
 
+    // Only the pages which left the visible grid locations are hidden
+    std::sort(begin(nowVisible), end(nowVisible));
+    for (size_t page: this->visiblePages) {
+        if (page < this->view->viewPages.size() && !std::binary_search(begin(nowVisible), end(nowVisible), page)) {
+            if (XojPageView* pageView = this->view->viewPages[page].getView()) {
+                pageView->setIsVisible(false);
+            }
+        }
+    }
+    this->visiblePages = std::move(nowVisible);
+
     if (mostPageNr) {
         this->view->getControl()->firePageSelected(*mostPageNr);
     }
 }
 
+auto Layout::findIndex(std::vector<unsigned> const& ends, double pos) -> size_t {
+    return std::lower_bound(begin(ends), end(ends), pos) - begin(ends);
+}
+
 auto Layout::getVisibleRect() -> Rectangle<double> {
     return Rectangle(gtk_adjustment_get_value(scrollHandling->getHorizontal()),
                      gtk_adjustment_get_value(scrollHandling->getVertical()),
@@ -127,37 +140,158 @@ inline auto sumIf(size_t base, size_t addend, bool predicate) -> size_t {
 void Layout::recalculate_int() const {
     auto* settings = view->getControl()->getSettings();
     size_t len = view->viewPages.size();
-    mapper.configureFromSettings(len, settings);
+    size_t firstChanged = mapper.configureFromSettings(len, settings);
     size_t colCount = mapper.getColumns();
     size_t rowCount = mapper.getRows();
 
-    pc.widthCols.assign(colCount, 0);
-    pc.heightRows.assign(rowCount, 0);
+    // Paired pages are only aligned to each other if there is more than one page
+    pc.full = pc.full || firstChanged == 0 || (mapper.isPairedPages() && (len > 1) != (pc.pageCount > 1));
+
+    std::vector<bool> dirtyRows(rowCount, pc.full);
+    std::vector<bool> dirtyCols(colCount, pc.full);
+    if (!pc.full) {
+        // Added rows and columns, removed ones are dropped
+        std::fill(begin(dirtyRows) + std::min(pc.heightRows.size(), rowCount), end(dirtyRows), true);
+        std::fill(begin(dirtyCols) + std::min(pc.widthCols.size(), colCount), end(dirtyCols), true);
 
-    for (size_t pageIdx{}; pageIdx < len; ++pageIdx) {
-        auto const& raster_p = mapper.at(pageIdx);  // auto [c, r] raster = mapper.at();
-        auto const& c = raster_p.first;
-        auto const& r = raster_p.second;
-        XojPageView* v = view->viewPages[pageIdx];
-        pc.widthCols[c] = std::max<unsigned>(pc.widthCols[c], v->getDisplayWidth());
-        pc.heightRows[r] = std::max<unsigned>(pc.heightRows[r], v->getDisplayHeight());
+        size_t const maxPages = std::max(len, pc.pageCount);
+        markPages(std::min(pc.dirtyBegin, maxPages), std::min(pc.dirtyEnd, maxPages), dirtyRows, dirtyCols);
+        markPages(firstChanged, maxPages, dirtyRows, dirtyCols);
     }
 
+    recalculateRowsCols(dirtyRows, dirtyCols);
+
     // add space around the entire page area to accommodate older Wacom tablets with limited sense area.
     size_t const vPadding =
             sumIf(XOURNAL_PADDING, settings->getAddVerticalSpaceAmount(), settings->getAddVerticalSpace());
     size_t const hPadding =
             sumIf(XOURNAL_PADDING, settings->getAddHorizontalSpaceAmount(), settings->getAddHorizontalSpace());
 
-    pc.minWidth = 2 * hPadding + (pc.widthCols.size() - 1) * XOURNAL_PADDING_BETWEEN;
-    pc.minHeight = 2 * vPadding + (pc.heightRows.size() - 1) * XOURNAL_PADDING_BETWEEN;
+    pc.minWidth = 2 * hPadding + pc.colEnds.back() - XOURNAL_PADDING_BETWEEN;
+    pc.minHeight = 2 * vPadding + pc.rowEnds.back() - XOURNAL_PADDING_BETWEEN;
 
-    pc.minWidth = std::accumulate(begin(pc.widthCols), end(pc.widthCols), pc.minWidth);
-    pc.minHeight = std::accumulate(begin(pc.heightRows), end(pc.heightRows), pc.minHeight);
+    pc.pageCount = len;
+    pc.dirtyBegin = pc.dirtyEnd = 0;
+    pc.full = false;
     pc.valid = true;
 }
 
+void Layout::markPages(size_t begin, size_t end, std::vector<bool>& dirtyRows, std::vector<bool>& dirtyCols) const {
+    for (size_t pageIdx = begin; pageIdx < end; ++pageIdx) {
+        auto const [c, r] = mapper.at(pageIdx);
+        if (c < dirtyCols.size()) {
+            dirtyCols[c] = true;
+        }
+        if (r < dirtyRows.size()) {
+            dirtyRows[r] = true;
+        }
+    }
+}
+
+void Layout::recalculateRowsCols(std::vector<bool> const& dirtyRows, std::vector<bool> const& dirtyCols) const {
+    size_t const rowCount = dirtyRows.size();
+    size_t const colCount = dirtyCols.size();
+
+    // The prefix sums of added rows and columns are always calculated
+    size_t firstResizedRow = std::min(pc.heightRows.size(), rowCount);
+    size_t firstResizedCol = std::min(pc.widthCols.size(), colCount);
+    pc.heightRows.resize(rowCount);
+    pc.widthCols.resize(colCount);
+    pc.rowEnds.resize(rowCount);
+    pc.colEnds.resize(colCount);
+
+    // The pages of marked rows always need to be positioned again, since they contain changed pages.
+    // The columns only need it if their width changed, since the pages are centered in them.
+    for (size_t r = 0; r < rowCount; ++r) {
+        if (!dirtyRows[r]) {
+            continue;
+        }
+        pc.firstMovedRow = std::min(pc.firstMovedRow, r);
+
+        unsigned height = 0;
+        for (size_t c = 0; c < colCount; ++c) {
+            if (auto page = mapper.at({c, r})) {
+                height = std::max<unsigned>(height, view->viewPages[*page].getDisplayHeight());
+            }
+        }
+        if (height != pc.heightRows[r] || pc.full) {
+            pc.heightRows[r] = height;
+            firstResizedRow = std::min(firstResizedRow, r);
+        }
+    }
+    for (size_t c = 0; c < colCount; ++c) {
+        if (!dirtyCols[c]) {
+            continue;
+        }
+
+        unsigned width = 0;
+        for (size_t r = 0; r < rowCount; ++r) {
+            if (auto page = mapper.at({c, r})) {
+                width = std::max<unsigned>(width, view->viewPages[*page].getDisplayWidth());
+            }
+        }
+        if (width != pc.widthCols[c] || pc.full) {
+            pc.widthCols[c] = width;
+            firstResizedCol = std::min(firstResizedCol, c);
+        }
+    }
+    pc.firstMovedCol = std::min(pc.firstMovedCol, firstResizedCol);
+
+    // accumulated - pixel location relative to the border for use by getViewAt() and updateVisibility()
+    for (size_t r = firstResizedRow; r < rowCount; ++r) {
+        pc.rowEnds[r] = (r > 0 ? pc.rowEnds[r - 1] : 0) + pc.heightRows[r] + XOURNAL_PADDING_BETWEEN;
+    }
+    for (size_t c = firstResizedCol; c < colCount; ++c) {
+        pc.colEnds[c] = (c > 0 ? pc.colEnds[c - 1] : 0) + pc.widthCols[c] + XOURNAL_PADDING_BETWEEN;
+    }
+}
+
 void Layout::recalculate() {
+    pc.valid = false;
+    pc.full = true;
+    gtk_widget_queue_resize(view->getWidget());
+}
+
+void Layout::pageSizeChanged(size_t page) {
+    std::lock_guard g{pc.m};
+    if (pc.dirtyBegin < pc.dirtyEnd) {
+        pc.dirtyBegin = std::min(pc.dirtyBegin, page);
+        pc.dirtyEnd = std::max(pc.dirtyEnd, page + 1);
+    } else {
+        pc.dirtyBegin = page;
+        pc.dirtyEnd = page + 1;
+    }
+    pc.valid = false;
+    gtk_widget_queue_resize(view->getWidget());
+}
+
+void Layout::pageInserted(size_t page) {
+    for (size_t& visible: this->visiblePages) {
+        if (visible >= page) {
+            ++visible;
+        }
+    }
+
+    std::lock_guard g{pc.m};
+    // All following pages moved by one
+    pc.dirtyBegin = pc.dirtyBegin < pc.dirtyEnd ? std::min(pc.dirtyBegin, page) : page;
+    pc.dirtyEnd = SIZE_MAX;
+    pc.valid = false;
+    gtk_widget_queue_resize(view->getWidget());
+}
+
+void Layout::pageDeleted(size_t page) {
+    this->visiblePages.erase(std::remove(begin(this->visiblePages), end(this->visiblePages), page),
+                             end(this->visiblePages));
+    for (size_t& visible: this->visiblePages) {
+        if (visible > page) {
+            --visible;
+        }
+    }
+
+    std::lock_guard g{pc.m};
+    pc.dirtyBegin = pc.dirtyBegin < pc.dirtyEnd ? std::min(pc.dirtyBegin, page) : page;
+    pc.dirtyEnd = SIZE_MAX;
     pc.valid = false;
     gtk_widget_queue_resize(view->getWidget());
 }
@@ -192,68 +326,51 @@ void Layout::layoutPages(int width, int height) {
     int64_t const borderX = std::max<int64_t>(h_padding, centeringXBorder);
     int64_t const borderY = std::max<int64_t>(v_padding, centeringYBorder);
 
-    // initialize here and x again in loop below.
-    int64_t x = borderX;
-    int64_t y = borderY;
-
+    if (borderX != this->borderX || borderY != this->borderY) {
+        this->borderX = borderX;
+        this->borderY = borderY;
+        pc.firstMovedRow = 0;
+        pc.firstMovedCol = 0;
+    }
 
-    // Iterate over ALL possible rows and columns.
+    // Only the pages below the first changed row and right of the first resized column moved, the others keep
+    // their position. All pages are positioned again on zoom or if the size of the window changed.
     // We don't know which page, if any,  is to be displayed in each row, column -  ask the mapper object!
     // Then assign that page coordinates with center, left or right justify within row,column grid cell as required.
-    for (size_t r = 0; r < rows; r++) {
-        for (size_t c = 0; c < columns; c++) {
+    size_t const firstRow = pc.firstMovedCol < columns ? 0 : pc.firstMovedRow;
+    for (size_t r = firstRow; r < rows; r++) {
+        int64_t const y = borderY + (r > 0 ? this->pc.rowEnds[r - 1] : 0);
+        for (size_t c = r < pc.firstMovedRow ? pc.firstMovedCol : 0; c < columns; c++) {
             auto optionalPage = this->mapper.at({c, r});
+            if (!optionalPage) {
+                continue;
+            }
 
-            if (optionalPage) {
-
-                XojPageView* v = this->view->viewPages[*optionalPage];
-                v->setMappedRowCol(r, c);  // store row and column for e.g. proper arrow key navigation
-                int64_t vDisplayWidth = v->getDisplayWidth();
-                {
-                    int64_t paddingLeft = 0;
-                    int64_t paddingRight = 0;
-                    auto columnPadding = static_cast<int64_t>(this->pc.widthCols[c] - vDisplayWidth);
-
-                    if (isPairedPages && len > 1) {
-                        // pair pages mode
-                        if (c % 2 == 0) {
-                            // align right
-                            paddingLeft = XOURNAL_PADDING_BETWEEN - XOURNAL_ROOM_FOR_SHADOW + columnPadding;
-                            paddingRight = XOURNAL_ROOM_FOR_SHADOW;
-                        } else {  // align left
-                            paddingLeft = XOURNAL_ROOM_FOR_SHADOW;
-                            paddingRight = XOURNAL_PADDING_BETWEEN - XOURNAL_ROOM_FOR_SHADOW + columnPadding;
-                        }
-                    } else {                                                            // not paired page mode - center
-                        paddingLeft = XOURNAL_PADDING_BETWEEN / 2 + columnPadding / 2;  // center justify
-                        paddingRight = XOURNAL_PADDING_BETWEEN - paddingLeft + columnPadding / 2;
-                    }
-
-                    x += paddingLeft;
-
-                    v->setX(x);  // set the page position
-                    v->setY(y);
-
-                    x += vDisplayWidth + paddingRight;
+            PageViewPlaceholder& v = this->view->viewPages[*optionalPage];
+            v.setMappedRowCol(r, c);  // store row and column for e.g. proper arrow key navigation
+            int64_t vDisplayWidth = v.getDisplayWidth();
+            int64_t paddingLeft = 0;
+            auto columnPadding = static_cast<int64_t>(this->pc.widthCols[c] - vDisplayWidth);
+
+            if (isPairedPages && len > 1) {
+                // pair pages mode
+                if (c % 2 == 0) {
+                    // align right
+                    paddingLeft = XOURNAL_PADDING_BETWEEN - XOURNAL_ROOM_FOR_SHADOW + columnPadding;
+                } else {  // align left
+                    paddingLeft = XOURNAL_ROOM_FOR_SHADOW;
                 }
-            } else {
-                x += this->pc.widthCols[c] + XOURNAL_PADDING_BETWEEN;
+            } else {                                                            // not paired page mode - center
+                paddingLeft = XOURNAL_PADDING_BETWEEN / 2 + columnPadding / 2;  // center justify
             }
+
+            // set the page position
+            v.setPosition(borderX + (c > 0 ? this->pc.colEnds[c - 1] : 0) + paddingLeft, y);
         }
-        x = borderX;
-        y += this->pc.heightRows[r] + XOURNAL_PADDING_BETWEEN;
     }
 
-    this->colXStart.resize(this->pc.widthCols.size());
-    this->rowYStart.resize(this->pc.heightRows.size());
-
-    // accumulated - absolute pixel location for use by getViewAt() and updateVisibility()
-    int64_t totalWidth = borderX;
-    std::transform(begin(this->pc.widthCols), end(this->pc.widthCols), begin(this->colXStart),
-                   [&totalWidth](auto&& widthCol) { return (totalWidth += widthCol + XOURNAL_PADDING_BETWEEN); });
-    int64_t totalHeight = borderY;
-    std::transform(begin(this->pc.heightRows), end(this->pc.heightRows), begin(this->rowYStart),
-                   [&totalHeight](auto&& heightRow) { return (totalHeight += heightRow + XOURNAL_PADDING_BETWEEN); });
+    pc.firstMovedRow = SIZE_MAX;
+    pc.firstMovedCol = SIZE_MAX;
 }
 
 int Layout::getPaddingAbovePage(size_t pageIndex) const {
@@ -330,15 +447,13 @@ void Layout::ensureRectIsVisible(int x, int y, int width, int height) {
 
 auto Layout::getPageViewAt(int x, int y) -> XojPageView* {
     // Binary Search:
-    auto rit = std::lower_bound(this->rowYStart.begin(), this->rowYStart.end(), y);
-    int const foundRow = std::distance(this->rowYStart.begin(), rit);
-    auto cit = std::lower_bound(this->colXStart.begin(), this->colXStart.end(), x);
-    int const foundCol = std::distance(this->colXStart.begin(), cit);
+    size_t const foundRow = findIndex(this->pc.rowEnds, static_cast<double>(y - this->borderY));
+    size_t const foundCol = findIndex(this->pc.colEnds, static_cast<double>(x - this->borderX));
 
     auto optionalPage = this->mapper.at({foundCol, foundRow});
 
-    if (optionalPage && this->view->viewPages[*optionalPage]->containsPoint(x, y, false)) {
-        return this->view->viewPages[*optionalPage];
+    if (optionalPage && this->view->viewPages[*optionalPage].containsPoint(x, y)) {
+        return this->view->getViewFor(*optionalPage);
     }
 
     return nullptr;
@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -44,7 +45,23 @@ public:
         size_t minHeight = 0;
         std::vector<unsigned> widthCols;
         std::vector<unsigned> heightRows;
+
+        // Prefix sums of the column widths and row heights, including the padding after each of them
+        std::vector<unsigned> colEnds;
+        std::vector<unsigned> rowEnds;
+        size_t pageCount = 0;
         bool valid = false;
+
+        // If not set, only the rows and columns of the pages in the dirty range are calculated again
+        bool full = true;
+
+        // The range of pages which were resized, inserted or moved since the last calculation
+        size_t dirtyBegin = 0;
+        size_t dirtyEnd = 0;
+
+        // The pages in these and all following rows and columns need to be positioned again by layoutPages
+        size_t firstMovedRow = 0;
+        size_t firstMovedCol = 0;
     };
 
 public:
@@ -92,6 +109,17 @@ public:
      */
     void recalculate();
 
+    /**
+     * Only recalculates the rows and columns of a page whose size changed
+     */
+    void pageSizeChanged(size_t page);
+
+    /**
+     * Only recalculates the rows and columns from the inserted or deleted page on
+     */
+    void pageInserted(size_t page);
+    void pageDeleted(size_t page);
+
     /**
      * Performs a layout of the XojPageView's managed in this Layout
      * Sets out pages in a grid.
@@ -105,6 +133,8 @@ public:
      * Updates the current XojPageView. The XojPageView is selected based on
      * the percentage of the visible area of the XojPageView relative
      * to its total area.
+     *
+     * Only the pages in the visible rows and columns are checked, which are found by a binary search.
      */
     void updateVisibility();
 
@@ -149,6 +179,22 @@ protected:
 
 private:
     void recalculate_int() const;
+
+    /**
+     * Recalculates the sizes of the marked rows and columns and the prefix sums from the first of them on
+     */
+    void recalculateRowsCols(std::vector<bool> const& dirtyRows, std::vector<bool> const& dirtyCols) const;
+
+    /**
+     * Marks the rows and columns of a range of pages, which may also be pages which do not exist anymore
+     */
+    void markPages(size_t begin, size_t end, std::vector<bool>& dirtyRows, std::vector<bool>& dirtyCols) const;
+
+    /**
+     * The index of the row (column) containing the coordinate, relative to the first row (column)
+     */
+    static size_t findIndex(std::vector<unsigned> const& ends, double pos);
+
     // Todo(Fabian): move to ScrollHandling also it must not depend on Layout
     static void checkScroll(GtkAdjustment* adjustment, double& lastScroll);
 
@@ -174,6 +220,15 @@ private:
      */
     mutable LayoutMapper mapper;
     mutable PreCalculated pc{};
-    mutable std::vector<unsigned> colXStart;
-    mutable std::vector<unsigned> rowYStart;
+
+    /**
+     * The space left and above of the pages, set by layoutPages
+     */
+    int64_t borderX = 0;
+    int64_t borderY = 0;
+
+    /**
+     * The pages which were in the visible rows and columns at the last updateVisibility
+     */
+    std::vector<size_t> visiblePages;
 };
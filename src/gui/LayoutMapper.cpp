@@ -44,7 +44,7 @@ void calculate(LayoutMapper::internal_data& data, size_t numRows, size_t numCols
     }
 }
 
-void LayoutMapper::configureFromSettings(size_t numPages, Settings* settings) {
+auto LayoutMapper::configureFromSettings(size_t numPages, Settings* settings) -> size_t {
     internal_data data;
     // get from user settings:
     data.actualPages = numPages;
@@ -62,27 +62,28 @@ void LayoutMapper::configureFromSettings(size_t numPages, Settings* settings) {
 
     calculate(data, numRows, numCols, fixRows, pairsOffset);
     if (data == data_) {
-        return;
+        return numPages;
     }
+
+    size_t firstChanged = data.keepsPositions(data_) ? std::min(data.actualPages, data_.actualPages) : 0;
     data_ = data;
-    precalculateMappers();
+    return firstChanged;
 }
 
-void LayoutMapper::precalculateMappers() {
-    this->pageToRaster.clear();
-    this->rasterToPage.clear();
-    this->pageToRaster.resize(data_.actualPages);
-    this->rasterToPage.reserve(data_.rows * data_.cols);
-
-    for (size_t col{}; col < data_.cols; ++col) {
-        for (size_t row{}; row < data_.rows; ++row) {
-            auto maybe_index = map(col, row);
-            if (maybe_index) {
-                this->pageToRaster[*maybe_index] = std::pair<size_t, size_t>{col, row};
-                this->rasterToPage.emplace(std::pair<size_t, size_t>{col, row}, *maybe_index);
-            }
-        }
+auto LayoutMapper::internal_data::keepsPositions(internal_data const& other) const -> bool {
+    if (std::tie(this->offset, this->showPairedPages, this->orientation, this->horizontalDir, this->verticalDir) !=
+        std::tie(other.offset, other.showPairedPages, other.orientation, other.horizontalDir, other.verticalDir)) {
+        return false;
+    }
+    if (this->rows == other.rows && this->cols == other.cols) {
+        return true;
     }
+
+    // Pages are filled in column by column or row by row, only the count of the other dimension may change
+    if (this->orientation == Vertical) {
+        return this->rows == other.rows && this->horizontalDir == LeftToRight;
+    }
+    return this->cols == other.cols && this->verticalDir == TopToBottom;
 }
 
 auto LayoutMapper::getColumns() const -> size_t { return data_.cols; }
@@ -93,9 +94,6 @@ auto LayoutMapper::getFirstPageOffset() const -> int { return data_.offset; }
 
 auto LayoutMapper::isPairedPages() const -> bool { return data_.showPairedPages; }
 
-
-// Todo: replace with map<pair(x,y)> -> index and vector<index> -> pair(x,y)
-//       precalculate it in configure
 auto LayoutMapper::map(size_t col, size_t row) const -> std::optional<size_t> {
     if (isRightToLeft()) {
         // reverse x
@@ -134,11 +132,39 @@ auto LayoutMapper::isBottomToTop() const -> bool { return data_.verticalDir == B
 
 auto LayoutMapper::isRightToLeft() const -> bool { return data_.horizontalDir == RightToLeft; }
 
-auto LayoutMapper::at(size_t page) const -> std::pair<size_t, size_t> { return pageToRaster.at(page); }
+auto LayoutMapper::at(size_t page) const -> std::pair<size_t, size_t> {
+    // The inverse of map()
+    size_t res = page + data_.offset;
+    size_t col = 0;
+    size_t row = 0;
+    if (isVertical()) {
+        if (data_.showPairedPages) {
+            row = (res / 2) % data_.rows;
+            col = (res / 2) / data_.rows * 2 + res % 2;
+        } else {
+            row = res % data_.rows;
+            col = res / data_.rows;
+        }
+    } else  // Horizontal
+    {
+        col = res % data_.cols;
+        row = res / data_.cols;
+    }
+
+    if (isRightToLeft()) {
+        col = data_.cols - 1 - col;
+    }
+
+    if (isBottomToTop()) {
+        row = data_.rows - 1 - row;
+    }
+
+    return {col, row};
+}
 
 auto LayoutMapper::at(std::pair<size_t, size_t> rasterXY) const -> std::optional<size_t> {
-    if (auto iter = rasterToPage.find(rasterXY); iter != end(rasterToPage)) {
-        return iter->second;
+    if (rasterXY.first >= data_.cols || rasterXY.second >= data_.rows) {
+        return std::nullopt;
     }
-    return std::nullopt;
+    return map(rasterXY.first, rasterXY.second);
 }
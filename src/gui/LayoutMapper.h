@@ -13,27 +13,13 @@
 
 #include <optional>
 #include <string>
-#include <unordered_map>
+#include <tuple>
 #include <vector>
 
 #include "control/settings/Settings.h"
-#include "util/hashcombine.h"
 
 #include "XournalType.h"
 
-namespace std {
-template <>
-class hash<std::pair<size_t, size_t>> {
-public:
-    size_t operator()(std::pair<size_t, size_t> const& data) const {
-        size_t seed = 0;
-        boost_c::hash_combine(seed, data.first);
-        boost_c::hash_combine(seed, data.second);
-        return seed;
-    }
-};
-}  // namespace std
-
 /**
  * @brief Layout asks this mapper what page ( if any ) should be at a given column,row.
  */
@@ -72,10 +58,16 @@ public:
      *
      * @param  pages  The number of pages in the document
      * @param  settings  The Settings from which users settings are obtained
+     *
+     * @return The index of the first page whose grid position may have changed, numPages if none did
      */
 
-    void configureFromSettings(size_t numPages, Settings* settings);
+    size_t configureFromSettings(size_t numPages, Settings* settings);
 
+    /**
+     * The grid position (column, row) of a page. This is computed and not checked against the number of pages,
+     * so it can also be used for the positions pages had before some were removed.
+     */
     std::pair<size_t, size_t> at(size_t) const;
     std::optional<size_t> at(std::pair<size_t, size_t>) const;
 
@@ -89,8 +81,6 @@ public:
     bool isVertical() const;
 
 private:
-    void precalculateMappers();
-
     /**
      * Map page location to document index
      *
@@ -120,10 +110,12 @@ private:
                    std::tie(other.cols, other.rows, other.actualPages, other.offset, other.showPairedPages,
                             other.orientation, other.horizontalDir, other.verticalDir);
         }
-    } data_;
 
-    std::vector<std::pair<size_t, size_t>> pageToRaster;
-    std::unordered_map<std::pair<size_t, size_t>, size_t> rasterToPage;
+        /**
+         * If only the number of pages differs, pages may keep their grid position
+         */
+        bool keepsPositions(internal_data const& other) const;
+    } data_;
 
     friend void calculate(LayoutMapper::internal_data& data, size_t numRows, size_t numCols, bool useRows,
                           int firstPageOffset);
@@ -89,6 +89,44 @@ void XojPageView::setIsVisible(bool visible) {
     }
 }
 
+auto XojPageView::isVisible() const -> bool { return this->lastVisibleTime == 0; }
+
+auto XojPageView::isInUse() const -> bool {
+    return this->textEditor || this->inputHandler || this->selection || this->verticalSpace || this->inEraser;
+}
+
+void XojPageView::detachPage() {
+    this->unregisterListener();
+    this->xournal->getControl()->getScheduler()->removePage(this);
+
+    endText();
+    deleteViewBuffer();
+    delete this->inputHandler;
+    this->inputHandler = nullptr;
+    delete this->search;
+    this->search = nullptr;
+    delete this->eraser;
+    this->eraser = nullptr;
+
+    g_mutex_lock(&this->repaintRectMutex);
+    this->rerenderRects.clear();
+    this->rerenderComplete = false;
+    g_mutex_unlock(&this->repaintRectMutex);
+
+    this->selected = false;
+    this->inEraser = false;
+    this->oldtext = nullptr;
+    this->lastVisibleTime = -1;
+    this->page = nullptr;
+}
+
+void XojPageView::attachPage(const PageRef& page) {
+    this->page = page;
+    this->registerListener(this->page);
+    this->eraser = new EraseHandler(xournal->getControl()->getUndoRedoHandler(), xournal->getControl()->getDocument(),
+                                    this->page, xournal->getControl()->getToolHandler(), this);
+}
+
 auto XojPageView::getLastVisibleTime() -> int {
     if (this->crBuffer == nullptr) {
         return -1;
@@ -135,7 +173,7 @@ auto XojPageView::searchTextOnPage(string& text, int* occures, double* top) -> b
             pdf = doc->getPdfPage(pNr);
             doc->unlock();
         }
-        this->search = new SearchControl(page, pdf);
+        this->search = new SearchControl(page, pdf, xournal->getControl()->getSearchIndex());
     }
 
     bool found = this->search->search(text, occures, top);
@@ -486,6 +524,18 @@ void XojPageView::onMotionCancelEvent() {
     }
 }
 
+void XojPageView::beginMotionBatch() {
+    if (this->inputHandler) {
+        this->inputHandler->beginMotionBatch();
+    }
+}
+
+void XojPageView::endMotionBatch() {
+    if (this->inputHandler) {
+        this->inputHandler->endMotionBatch();
+    }
+}
+
 auto XojPageView::onButtonReleaseEvent(const PositionInputData& pos) -> bool {
     Control* control = xournal->getControl();
 
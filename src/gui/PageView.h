@@ -50,6 +50,27 @@ public:
 
     void setIsVisible(bool visible);
 
+    /**
+     * Returns whether the page is in the visible area, see setIsVisible
+     */
+    bool isVisible() const;
+
+    /**
+     * Whether the user is working on the page, e.g. with the text tool or a tool which is
+     * not finished. Such a view must not be recycled.
+     */
+    bool isInUse() const;
+
+    /**
+     * Resets the view and releases its page, so XournalView can reuse it for another page
+     */
+    void detachPage();
+
+    /**
+     * Shows the page with a view which was detached before
+     */
+    void attachPage(const PageRef& page);
+
     bool isSelected() const;
 
     void endText();
@@ -150,6 +171,13 @@ public:  // event handler
     bool onMotionNotifyEvent(const PositionInputData& pos);
     void onMotionCancelEvent();
 
+    /**
+     * Motion events of one frame are delivered between these calls,
+     * so the input handler can repaint them together
+     */
+    void beginMotionBatch();
+    void endMotionBatch();
+
     /**
      * This method actually repaints the XojPageView, triggering
      * a rerender call if necessary
@@ -231,7 +259,7 @@ private:
 
     GMutex drawingMutex{};
 
-    int dispX{};  // position on display - set in Layout::layoutPages
+    int dispX{};  // position on display - set by the PageViewPlaceholder
     int dispY{};
 
 
@@ -244,6 +272,6 @@ private:
     friend class BaseSelectObject;
     friend class SelectObject;
     friend class PlayObject;
-    // only function allowed to setX(), setY(), setMappedRowCol():
-    friend void Layout::layoutPages(int width, int height);
+    // only class allowed to setX(), setY(), setMappedRowCol():
+    friend class PageViewPlaceholder;
 };
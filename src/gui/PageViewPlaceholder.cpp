@@ -0,0 +1,65 @@
+#include "PageViewPlaceholder.h"
+
+#include <cmath>
+#include <utility>
+
+#include "PageView.h"
+#include "XournalView.h"
+
+PageViewPlaceholder::PageViewPlaceholder(XournalView* xournal, PageRef page): page(std::move(page)), xournal(xournal) {}
+
+auto PageViewPlaceholder::getPage() const -> const PageRef& { return this->page; }
+
+auto PageViewPlaceholder::getView() const -> XojPageView* { return this->view; }
+
+void PageViewPlaceholder::setView(XojPageView* view) {
+    this->view = view;
+    if (view) {
+        view->setX(this->dispX);
+        view->setY(this->dispY);
+        view->setMappedRowCol(this->mappedRow, this->mappedCol);
+    }
+}
+
+auto PageViewPlaceholder::releaseView() -> XojPageView* { return std::exchange(this->view, nullptr); }
+
+auto PageViewPlaceholder::getDisplayWidth() const -> int {
+    return std::lround(this->page->getWidth() * this->xournal->getZoom());
+}
+
+auto PageViewPlaceholder::getDisplayHeight() const -> int {
+    return std::lround(this->page->getHeight() * this->xournal->getZoom());
+}
+
+auto PageViewPlaceholder::getX() const -> int { return this->dispX; }
+
+auto PageViewPlaceholder::getY() const -> int { return this->dispY; }
+
+auto PageViewPlaceholder::getMappedRow() const -> int { return this->mappedRow; }
+
+auto PageViewPlaceholder::getMappedCol() const -> int { return this->mappedCol; }
+
+auto PageViewPlaceholder::getRect() const -> Rectangle<double> {
+    return Rectangle<double>(getX(), getY(), getDisplayWidth(), getDisplayHeight());
+}
+
+auto PageViewPlaceholder::containsPoint(int x, int y) const -> bool {
+    return getX() <= x && x <= getX() + getDisplayWidth() && getY() <= y && y <= getY() + getDisplayHeight();
+}
+
+void PageViewPlaceholder::setPosition(int x, int y) {
+    this->dispX = x;
+    this->dispY = y;
+    if (this->view) {
+        this->view->setX(x);
+        this->view->setY(y);
+    }
+}
+
+void PageViewPlaceholder::setMappedRowCol(int row, int col) {
+    this->mappedRow = row;
+    this->mappedCol = col;
+    if (this->view) {
+        this->view->setMappedRowCol(row, col);
+    }
+}
@@ -0,0 +1,86 @@
+/*
+ * Xournal++
+ *
+ * The place of a page in the layout
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include "model/PageRef.h"
+
+#include "Layout.h"
+#include "Rectangle.h"
+
+class XojPageView;
+class XournalView;
+
+/**
+ * @brief Stands in for a page in the layout
+ *
+ * Only carries the size and position of the page, so the layout does not need a XojPageView for every page.
+ * The XojPageView is created by XournalView::getViewFor when the page comes near the visible area and is
+ * released when it has not been visible for some time.
+ */
+class PageViewPlaceholder {
+public:
+    PageViewPlaceholder(XournalView* xournal, PageRef page);
+
+public:
+    const PageRef& getPage() const;
+
+    /**
+     * The view of the page, nullptr if it was not created
+     */
+    XojPageView* getView() const;
+
+    /**
+     * Sets the view of the page and gives it the position of the placeholder
+     */
+    void setView(XojPageView* view);
+
+    /**
+     * Returns the view of the page, the placeholder does not have one afterwards
+     */
+    XojPageView* releaseView();
+
+    /**
+     * The size of the page as displayed, taking into account the current zoom
+     */
+    int getDisplayWidth() const;
+    int getDisplayHeight() const;
+
+    int getX() const;
+    int getY() const;
+    int getMappedRow() const;
+    int getMappedCol() const;
+
+    Rectangle<double> getRect() const;
+
+    /**
+     * Returns whether the page contains the given point on the display
+     */
+    bool containsPoint(int x, int y) const;
+
+private:
+    void setPosition(int x, int y);
+    void setMappedRowCol(int row, int col);
+
+private:
+    PageRef page;
+    XournalView* xournal = nullptr;
+    XojPageView* view = nullptr;
+
+    int dispX{};  // position on display - set in Layout::layoutPages
+    int dispY{};
+
+    int mappedRow{};
+    int mappedCol{};
+
+    // only function allowed to setPosition(), setMappedRowCol():
+    friend void Layout::layoutPages(int width, int height);
+};
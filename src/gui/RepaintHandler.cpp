@@ -3,6 +3,7 @@
 #include "gui/scroll/ScrollHandling.h"
 #include "widgets/XournalWidget.h"
 
+#include "LatencyTrace.h"
 #include "PageView.h"
 #include "XournalView.h"
 
@@ -11,6 +12,8 @@ RepaintHandler::RepaintHandler(XournalView* xournal): xournal(xournal) {}
 RepaintHandler::~RepaintHandler() { this->xournal = nullptr; }
 
 void RepaintHandler::repaintPage(XojPageView* view) {
+    LatencyTrace::getInstance().repaintQueued();
+
     if (xournal->getScrollHandling()->fullRepaint()) {
         gtk_widget_queue_draw(this->xournal->getWidget());
     } else {
@@ -24,6 +27,8 @@ void RepaintHandler::repaintPage(XojPageView* view) {
 }
 
 void RepaintHandler::repaintPageArea(XojPageView* view, int x1, int y1, int x2, int y2) {
+    LatencyTrace::getInstance().repaintQueued();
+
     if (xournal->getScrollHandling()->fullRepaint()) {
         gtk_widget_queue_draw(this->xournal->getWidget());
     } else {
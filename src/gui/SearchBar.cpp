@@ -1,11 +1,19 @@
 #include "SearchBar.h"
 
+#include <algorithm>
+
 #include <config.h>
 
 #include "control/Control.h"
+#include "control/jobs/SearchJob.h"
 
 #include "i18n.h"
 
+/**
+ * Maximum count of results in the result list
+ */
+constexpr size_t MAX_RESULTS = 1000;
+
 SearchBar::SearchBar(Control* control): control(control) {
     MainWindow* win = control->getWindow();
 
@@ -38,12 +46,24 @@ SearchBar::SearchBar(Control* control): control(control) {
                      }),
                      this);
 
+    g_signal_connect(win->get("btSearchResults"), "toggled",
+                     G_CALLBACK(+[](GtkToggleButton* button, SearchBar* self) {
+                         bool active = gtk_toggle_button_get_active(button);
+                         gtk_widget_set_visible(self->control->getWindow()->get("searchResultsScroll"), active);
+                         self->fillResultList();
+                     }),
+                     this);
+    g_signal_connect(win->get("searchResultsList"), "row-activated", G_CALLBACK(resultActivated), this);
+
     cssTextFild = gtk_css_provider_new();
     gtk_style_context_add_provider(gtk_widget_get_style_context(win->get("searchTextField")),
                                    GTK_STYLE_PROVIDER(cssTextFild), GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
 }
 
-SearchBar::~SearchBar() { this->control = nullptr; }
+SearchBar::~SearchBar() {
+    cancelSearch();
+    this->control = nullptr;
+}
 
 auto SearchBar::searchTextonCurrentPage(const char* text, int* occures, double* top) -> bool {
     int p = control->getCurrentPageNo();
@@ -55,12 +75,12 @@ void SearchBar::search(const char* text) {
     MainWindow* win = control->getWindow();
     GtkWidget* lbSearchState = win->get("lbSearchState");
 
-    bool found = true;
     int occures = 0;
 
+    startSearch(text);
+
     if (*text != 0) {
-        found = searchTextonCurrentPage(text, &occures, nullptr);
-        if (found) {
+        if (searchTextonCurrentPage(text, &occures, nullptr)) {
             if (occures == 1) {
                 gtk_label_set_text(GTK_LABEL(lbSearchState), _("Text found on this page"));
             } else {
@@ -69,18 +89,15 @@ void SearchBar::search(const char* text) {
                 g_free(msg);
             }
         } else {
-            gtk_label_set_text(GTK_LABEL(lbSearchState), _("Text not found"));
+            // Updated when the other pages are searched
+            gtk_label_set_text(GTK_LABEL(lbSearchState), _("Searching…"));
         }
     } else {
         searchTextonCurrentPage("", nullptr, nullptr);
         gtk_label_set_text(GTK_LABEL(lbSearchState), "");
     }
 
-    if (found) {
-        gtk_css_provider_load_from_data(cssTextFild, "GtkSearchEntry {}", -1, nullptr);
-    } else {
-        gtk_css_provider_load_from_data(cssTextFild, "GtkSearchEntry { color: #ff0000; }", -1, nullptr);
-    }
+    gtk_css_provider_load_from_data(cssTextFild, "GtkSearchEntry {}", -1, nullptr);
 }
 
 void SearchBar::searchTextChangedCallback(GtkEntry* entry, SearchBar* searchBar) {
@@ -90,92 +107,209 @@ void SearchBar::searchTextChangedCallback(GtkEntry* entry, SearchBar* searchBar)
 
 void SearchBar::buttonCloseSearchClicked(GtkButton* button, SearchBar* searchBar) { searchBar->showSearchBar(false); }
 
-void SearchBar::searchNext() {
-    int page = control->getCurrentPageNo();
-    int count = control->getDocument()->getPageCount();
-    if (count < 2) {
-        // Nothing to do
+void SearchBar::searchNext() { searchPage(true); }
+
+void SearchBar::searchPrevious() { searchPage(false); }
+
+void SearchBar::startSearch(const char* text) {
+    cancelSearch();
+    fillResultList();
+
+    Document* doc = control->getDocument();
+    doc->lock();
+    size_t count = doc->getPageCount();
+    doc->unlock();
+
+    size_t page = control->getCurrentPageNo();
+    this->startPage = page;
+    this->pageResults.assign(count, -1);
+
+    if (*text == 0 || count == 0) {
         return;
     }
 
+    this->searchJob = new SearchJob(control, control->getSearchIndex(), text, page, count);
+    control->getScheduler()->addJob(this->searchJob, JOB_PRIORITY_LOW);
+}
+
+void SearchBar::cancelSearch() {
+    if (this->searchJob) {
+        this->searchJob->cancel();
+        this->searchJob->unref();
+        this->searchJob = nullptr;
+    }
+
+    this->results.clear();
+    this->pageResults.clear();
+    this->resultCount = 0;
+    this->startPage = npos;
+    this->pendingDirection = 0;
+}
+
+void SearchBar::searchResultsFound(SearchJob* job, const vector<size_t>& pages, const vector<SearchResult>& results,
+                                   bool finished) {
+    if (job != this->searchJob) {
+        // Results of a cancelled search
+        return;
+    }
+
+    bool listVisible = gtk_widget_get_visible(control->getWindow()->get("searchResultsScroll"));
+    for (const SearchResult& r: results) {
+        this->resultCount++;
+        if (this->results.size() >= MAX_RESULTS) {
+            continue;
+        }
+
+        auto it = std::upper_bound(this->results.begin(), this->results.end(), r.page,
+                                   [](size_t page, const SearchResult& other) { return page < other.page; });
+        it = this->results.insert(it, r);
+        if (listVisible) {
+            addResultRow(r, static_cast<int>(it - this->results.begin()));
+        }
+    }
+
+    for (size_t page: pages) {
+        if (page < this->pageResults.size()) {
+            this->pageResults[page] = 0;
+        }
+    }
+    for (const SearchResult& r: results) {
+        if (r.page < this->pageResults.size()) {
+            this->pageResults[r.page]++;
+        }
+    }
+
+    if (this->pendingDirection != 0) {
+        searchPage(this->pendingDirection > 0);
+    } else if (finished) {
+        showResultCount();
+    }
+}
+
+void SearchBar::searchPage(bool forward) {
     MainWindow* win = control->getWindow();
-    int x = page + 1;
-    GtkWidget* searchTextField = win->get("searchTextField");
-    const char* text = gtk_entry_get_text(GTK_ENTRY(searchTextField));
+    const char* text = gtk_entry_get_text(GTK_ENTRY(win->get("searchTextField")));
     GtkWidget* lbSearchState = win->get("lbSearchState");
-    if (*text == 0) {
+
+    this->pendingDirection = 0;
+    size_t count = control->getDocument()->getPageCount();
+    if (count < 2 || *text == 0) {
+        // Nothing to do
         return;
     }
 
-    if (x >= count) {
-        x = 0;
+    if (this->pageResults.size() != count) {
+        // Pages were added or removed
+        startSearch(text);
     }
 
-    double top = 0;
-    int occures = 0;
-
-    while (x != page) {
+    size_t page = control->getCurrentPageNo();
+    for (size_t d = 1; d < count; d++) {
+        size_t x = forward ? (page + d) % count : (page + count - d) % count;
 
-        bool found = control->searchTextOnPage(text, x, &occures, &top);
-        if (found) {
-            control->getScrollHandler()->scrollToPage(x, top);
-            gtk_label_set_text(GTK_LABEL(lbSearchState),
-                               (occures == 1 ? FC(_F("Text found once on page {1}") % (x + 1)) :
-                                               FC(_F("Text found {1} times on page {2}") % occures % (x + 1))));
+        if (this->pageResults[x] < 0) {
+            // Continued when the page is searched
+            this->pendingDirection = forward ? 1 : -1;
+            gtk_label_set_text(GTK_LABEL(lbSearchState), _("Searching…"));
             return;
         }
 
-        x++;
-        if (x >= count) {
-            x = 0;
+        if (this->pageResults[x] == 0) {
+            continue;
         }
+
+        double top = 0;
+        int occures = 0;
+        if (control->searchTextOnPage(text, static_cast<int>(x), &occures, &top)) {
+            this->startPage = npos;
+            showResult(x, true, occures, top);
+            return;
+        }
+
+        // The page was changed since it was searched
+        this->pageResults[x] = 0;
     }
 
     gtk_label_set_text(GTK_LABEL(lbSearchState), _("Text not found, searched on all pages"));
 }
 
-void SearchBar::searchPrevious() {
-    int page = control->getCurrentPageNo();
-    int count = control->getDocument()->getPageCount();
-    if (count < 2) {
-        // Nothing to do
+void SearchBar::showResult(size_t page, bool found, int occures, double top) {
+    GtkWidget* lbSearchState = control->getWindow()->get("lbSearchState");
+    control->getScrollHandler()->scrollToPage(page, top);
+
+    if (!found) {
+        gtk_label_set_text(GTK_LABEL(lbSearchState), "");
         return;
     }
+    gtk_label_set_text(GTK_LABEL(lbSearchState),
+                       (occures == 1 ? FC(_F("Text found once on page {1}") % (page + 1)) :
+                                       FC(_F("Text found {1} times on page {2}") % occures % (page + 1))));
+}
 
-    MainWindow* win = control->getWindow();
-    int x = page - 1;
-    GtkWidget* searchTextField = win->get("searchTextField");
-    const char* text = gtk_entry_get_text(GTK_ENTRY(searchTextField));
-    GtkWidget* lbSearchState = win->get("lbSearchState");
-    if (*text == 0) {
+void SearchBar::showResultCount() {
+    // The label still shows the results on the current page, or a page was selected since
+    if (this->startPage >= this->pageResults.size() || this->pageResults[this->startPage] != 0) {
         return;
     }
 
-    if (x < 0) {
-        x = count - 1;
+    GtkWidget* lbSearchState = control->getWindow()->get("lbSearchState");
+    if (this->resultCount > 0) {
+        gtk_label_set_text(GTK_LABEL(lbSearchState),
+                           FC(_F("Text not found on this page, found {1} times in the document") % this->resultCount));
+    } else {
+        gtk_label_set_text(GTK_LABEL(lbSearchState), _("Text not found"));
+        gtk_css_provider_load_from_data(cssTextFild, "GtkSearchEntry { color: #ff0000; }", -1, nullptr);
+    }
+}
+
+void SearchBar::fillResultList() {
+    MainWindow* win = control->getWindow();
+    GtkWidget* list = win->get("searchResultsList");
+
+    GList* children = gtk_container_get_children(GTK_CONTAINER(list));
+    for (GList* l = children; l != nullptr; l = l->next) {
+        gtk_widget_destroy(GTK_WIDGET(l->data));
     }
+    g_list_free(children);
 
-    double top = 0;
-    int occures = 0;
+    // Filled when the list is shown
+    if (!gtk_widget_get_visible(win->get("searchResultsScroll"))) {
+        return;
+    }
 
-    while (x != page) {
+    int position = 0;
+    for (const SearchResult& r: this->results) {
+        addResultRow(r, position++);
+    }
+}
 
-        bool found = control->searchTextOnPage(text, x, &occures, &top);
-        if (found) {
-            control->getScrollHandler()->scrollToPage(x, top);
-            gtk_label_set_text(GTK_LABEL(lbSearchState),
-                               (occures == 1 ? FC(_F("Text found once on page {1}") % (x + 1)) :
-                                               FC(_F("Text found {1} times on page {2}") % occures % (x + 1))));
-            return;
-        }
+void SearchBar::addResultRow(const SearchResult& result, int position) {
+    gchar* context = g_markup_escape_text(result.context.c_str(), -1);
+    string markup = "<b>" + FS(_F("Page {1}") % (result.page + 1)) + "</b>  " + context;
+    g_free(context);
+
+    GtkWidget* label = gtk_label_new(nullptr);
+    gtk_label_set_markup(GTK_LABEL(label), markup.c_str());
+    gtk_label_set_xalign(GTK_LABEL(label), 0);
+    gtk_label_set_ellipsize(GTK_LABEL(label), PANGO_ELLIPSIZE_END);
+    gtk_widget_show(label);
+    gtk_list_box_insert(GTK_LIST_BOX(control->getWindow()->get("searchResultsList")), label, position);
+}
 
-        x--;
-        if (x < 0) {
-            x = count - 1;
-        }
+void SearchBar::resultActivated(GtkListBox* box, GtkListBoxRow* row, SearchBar* searchBar) {
+    size_t index = gtk_list_box_row_get_index(row);
+    if (index >= searchBar->results.size()) {
+        return;
     }
+    const SearchResult& result = searchBar->results[index];
 
-    gtk_label_set_text(GTK_LABEL(lbSearchState), _("Text not found, searched on all pages"));
+    GtkWidget* searchTextField = searchBar->control->getWindow()->get("searchTextField");
+    const char* text = gtk_entry_get_text(GTK_ENTRY(searchTextField));
+
+    int occures = 0;
+    bool found = searchBar->control->searchTextOnPage(text, result.page, &occures, nullptr);
+    searchBar->startPage = npos;
+    searchBar->showResult(result.page, found, occures, result.rect.y1);
 }
 
 void SearchBar::showSearchBar(bool show) {
@@ -187,6 +321,8 @@ void SearchBar::showSearchBar(bool show) {
         gtk_widget_grab_focus(searchTextField);
         gtk_widget_show_all(searchBar);
     } else {
+        cancelSearch();
+        fillResultList();
         gtk_widget_hide(searchBar);
         for (int i = control->getDocument()->getPageCount() - 1; i >= 0; i--) {
             control->searchTextOnPage("", i, nullptr, nullptr);
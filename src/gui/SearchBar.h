@@ -16,9 +16,13 @@
 
 #include <gtk/gtk.h>
 
+#include "control/search/SearchIndex.h"
+
+#include "Util.h"
 #include "XournalType.h"
 
 class Control;
+class SearchJob;
 
 class SearchBar {
 public:
@@ -27,6 +31,15 @@ public:
 
     void showSearchBar(bool show);
 
+    /**
+     * Called on the UI thread for each run of a SearchJob
+     *
+     * @param pages The searched pages
+     * @param finished True if all pages are searched
+     */
+    void searchResultsFound(SearchJob* job, const vector<size_t>& pages, const vector<SearchResult>& results,
+                            bool finished);
+
 private:
     static void buttonCloseSearchClicked(GtkButton* button, SearchBar* searchBar);
     static void searchTextChangedCallback(GtkEntry* entry, SearchBar* searchBar);
@@ -40,7 +53,54 @@ private:
     void search(const char* text);
     bool searchTextonCurrentPage(const char* text, int* occures, double* top);
 
+    /**
+     * Starts a SearchJob at the current page, a running search is cancelled
+     */
+    void startSearch(const char* text);
+    void cancelSearch();
+
+    /**
+     * Jumps to the next page with results, waits for the SearchJob if the pages in between
+     * are not searched yet
+     *
+     * @param forward False to search backwards
+     */
+    void searchPage(bool forward);
+
+    void showResult(size_t page, bool found, int occures, double top);
+    void showResultCount();
+
+    void fillResultList();
+    void addResultRow(const SearchResult& result, int position);
+    static void resultActivated(GtkListBox* box, GtkListBoxRow* row, SearchBar* searchBar);
+
 private:
     Control* control;
     GtkCssProvider* cssTextFild;
+
+    /**
+     * The running or last search, referenced
+     */
+    SearchJob* searchJob = nullptr;
+
+    /**
+     * Ordered by page, at most MAX_RESULTS
+     */
+    vector<SearchResult> results;
+
+    /**
+     * The count of results for each page, -1 if the page was not searched yet
+     */
+    vector<int> pageResults;
+    size_t resultCount = 0;
+
+    /**
+     * The page the search was started on, npos after jumping to another page
+     */
+    size_t startPage = npos;
+
+    /**
+     * 1 or -1 if searchNext() or searchPrevious() waits for the SearchJob, otherwise 0
+     */
+    int pendingDirection = 0;
 };
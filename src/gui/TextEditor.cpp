@@ -940,7 +940,7 @@ void TextEditor::paint(cairo_t* cr, GdkRectangle* repaintRect, double zoom) {
     cairo_translate(cr, x0, y0);
 
     if (this->layout == nullptr) {
-        this->layout = TextView::initPango(cr, this->text);
+        this->layout = TextView::createLayout(this->text);
     }
 
     if (!this->preeditString.empty()) {
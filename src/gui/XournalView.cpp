@@ -24,6 +24,16 @@
 #include "XournalppCursor.h"
 #include "filesystem.h"
 
+/**
+ * The views of this many pages before and after the current page are kept, also if they are not visible
+ */
+constexpr size_t KEPT_PAGE_VIEWS = 4;
+
+/**
+ * The number of released views which are kept for reuse
+ */
+constexpr size_t PAGE_VIEW_POOL_SIZE = 8;
+
 XournalView::XournalView(GtkWidget* parent, Control* control, ScrollHandling* scrollHandling):
         scrollHandling(scrollHandling), control(control) {
     this->cache = new PdfCache(control->getSettings()->getPdfPageCacheSize());
@@ -62,10 +72,15 @@ XournalView::~XournalView() {
     g_source_remove(this->cleanupTimeout);
 
     for (auto&& page: viewPages) {
-        delete page;
+        delete page.releaseView();
     }
     viewPages.clear();
 
+    for (auto&& view: pageViewPool) {
+        delete view;
+    }
+    pageViewPool.clear();
+
     delete this->cache;
     this->cache = nullptr;
     delete this->repaintHandler;
@@ -90,9 +105,12 @@ void XournalView::staticLayoutPages(GtkWidget* widget, GtkAllocation* allocation
 auto XournalView::clearMemoryTimer(XournalView* widget) -> gboolean {
     GList* list = nullptr;
 
+    widget->releaseHiddenViews();
+
     for (auto&& page: widget->viewPages) {
-        if (page->getLastVisibleTime() > 0) {
-            list = g_list_insert_sorted(list, page, reinterpret_cast<GCompareFunc>(pageViewIncreasingClockTime));
+        XojPageView* view = page.getView();
+        if (view && view->getLastVisibleTime() > 0) {
+            list = g_list_insert_sorted(list, view, reinterpret_cast<GCompareFunc>(pageViewIncreasingClockTime));
         }
     }
 
@@ -130,7 +148,7 @@ const int scrollKeySize = 30;
 auto XournalView::onKeyPressEvent(GdkEventKey* event) -> bool {
     size_t p = getCurrentPage();
     if (p != npos && p < this->viewPages.size()) {
-        XojPageView* v = this->viewPages[p];
+        XojPageView* v = getViewFor(p);
         if (v->onKeyPressEvent(event)) {
             return true;
         }
@@ -304,7 +322,7 @@ auto XournalView::getRepaintHandler() -> RepaintHandler* { return this->repaintH
 auto XournalView::onKeyReleaseEvent(GdkEventKey* event) -> bool {
     size_t p = getCurrentPage();
     if (p != npos && p < this->viewPages.size()) {
-        XojPageView* v = this->viewPages[p];
+        XojPageView* v = getViewFor(p);
         if (v->onKeyReleaseEvent(event)) {
             return true;
         }
@@ -329,7 +347,7 @@ auto XournalView::searchTextOnPage(string text, size_t p, int* occures, double*
     if (p == npos || p >= this->viewPages.size()) {
         return false;
     }
-    XojPageView* v = this->viewPages[p];
+    XojPageView* v = getViewFor(p);
 
     return v->searchTextOnPage(text, occures, top);
 }
@@ -345,7 +363,53 @@ auto XournalView::getViewFor(size_t pageNr) -> XojPageView* {
     if (pageNr == npos || pageNr >= this->viewPages.size()) {
         return nullptr;
     }
-    return this->viewPages[pageNr];
+
+    PageViewPlaceholder& placeholder = this->viewPages[pageNr];
+    if (!placeholder.getView()) {
+        XojPageView* view = nullptr;
+        if (this->pageViewPool.empty()) {
+            view = new XojPageView(this, placeholder.getPage());
+        } else {
+            view = this->pageViewPool.back();
+            this->pageViewPool.pop_back();
+            view->attachPage(placeholder.getPage());
+        }
+        placeholder.setView(view);
+    }
+    return placeholder.getView();
+}
+
+void XournalView::releaseHiddenViews() {
+    // The selection may have been moved away from the view it was made on, which still references it
+    if (getSelection()) {
+        return;
+    }
+
+    for (size_t i = 0; i < this->viewPages.size(); i++) {
+        XojPageView* view = this->viewPages[i].getView();
+        if (!view || view->isVisible() || view->isInUse()) {
+            continue;
+        }
+        if (this->currentPage != npos && i + KEPT_PAGE_VIEWS >= this->currentPage &&
+            i <= this->currentPage + KEPT_PAGE_VIEWS) {
+            continue;
+        }
+
+        releaseView(this->viewPages[i].releaseView());
+    }
+}
+
+void XournalView::releaseView(XojPageView* view) {
+    if (view == nullptr) {
+        return;
+    }
+
+    if (this->pageViewPool.size() < PAGE_VIEW_POOL_SIZE && !view->isInUse()) {
+        view->detachPage();
+        this->pageViewPool.push_back(view);
+    } else {
+        delete view;
+    }
 }
 
 void XournalView::pageSelected(size_t page) {
@@ -360,8 +424,9 @@ void XournalView::pageSelected(size_t page) {
 
     control->getMetadataManager()->storeMetadata(file, page, getZoom());
 
-    if (this->lastSelectedPage != npos && this->lastSelectedPage < this->viewPages.size()) {
-        this->viewPages[this->lastSelectedPage]->setSelected(false);
+    if (this->lastSelectedPage != npos && this->lastSelectedPage < this->viewPages.size() &&
+        this->viewPages[this->lastSelectedPage].getView()) {
+        this->viewPages[this->lastSelectedPage].getView()->setSelected(false);
     }
 
     this->currentPage = page;
@@ -369,7 +434,7 @@ void XournalView::pageSelected(size_t page) {
     size_t pdfPage = npos;
 
     if (page != npos && page < viewPages.size()) {
-        XojPageView* vp = viewPages[page];
+        XojPageView* vp = getViewFor(page);
         vp->setSelected(true);
         lastSelectedPage = page;
         pdfPage = vp->getPage()->getPdfPageNr();
@@ -387,15 +452,15 @@ void XournalView::scrollTo(size_t pageNo, double yDocument) {
         return;
     }
 
-    XojPageView* v = this->viewPages[pageNo];
+    PageViewPlaceholder const& v = this->viewPages[pageNo];
 
     // Make sure it is visible
     Layout* layout = gtk_xournal_get_layout(this->widget);
 
-    int x = v->getX();
-    int y = v->getY() + std::lround(yDocument);
-    int width = v->getDisplayWidth();
-    int height = v->getDisplayHeight();
+    int x = v.getX();
+    int y = v.getY() + std::lround(yDocument);
+    int width = v.getDisplayWidth();
+    int height = v.getDisplayHeight();
 
     layout->ensureRectIsVisible(x, y, width, height);
 
@@ -420,16 +485,17 @@ void XournalView::pageRelativeXY(int offCol, int offRow) {
 
 
 void XournalView::endTextAllPages(XojPageView* except) {
-    for (auto v: this->viewPages) {
-        if (except != v) {
+    for (auto&& page: this->viewPages) {
+        XojPageView* v = page.getView();
+        if (v && except != v) {
             v->endText();
         }
     }
 }
 
 void XournalView::layerChanged(size_t page) {
-    if (page != npos && page < this->viewPages.size()) {
-        this->viewPages[page]->rerenderPage();
+    if (page != npos && page < this->viewPages.size() && this->viewPages[page].getView()) {
+        this->viewPages[page].getView()->rerenderPage();
     }
 }
 
@@ -457,7 +523,7 @@ auto XournalView::getVisibleRect(size_t page) -> Rectangle<double>* {
     if (page == npos || page >= this->viewPages.size()) {
         return nullptr;
     }
-    XojPageView* p = this->viewPages[page];
+    XojPageView* p = getViewFor(page);
 
     return getVisibleRect(p);
 }
@@ -523,32 +589,39 @@ void XournalView::zoomChanged() {
 }
 
 void XournalView::pageSizeChanged(size_t page) {
-    layoutPages();
+    Layout* layout = gtk_xournal_get_layout(this->widget);
     if (page != npos && page < this->viewPages.size()) {
-        this->viewPages[page]->rerenderPage();
+        layout->pageSizeChanged(page);
+    } else {
+        layout->recalculate();
+    }
+    updateLayout();
+    if (page != npos && page < this->viewPages.size() && this->viewPages[page].getView()) {
+        this->viewPages[page].getView()->rerenderPage();
     }
 }
 
 void XournalView::pageChanged(size_t page) {
-    if (page != npos && page < this->viewPages.size()) {
-        this->viewPages[page]->rerenderPage();
+    if (page != npos && page < this->viewPages.size() && this->viewPages[page].getView()) {
+        this->viewPages[page].getView()->rerenderPage();
     }
 }
 
 void XournalView::pageDeleted(size_t page) {
     size_t currentPage = control->getCurrentPageNo();
 
-    delete this->viewPages[page];
+    releaseView(this->viewPages[page].releaseView());
     viewPages.erase(begin(viewPages) + page);
 
-    layoutPages();
+    gtk_xournal_get_layout(this->widget)->pageDeleted(page);
+    updateLayout();
     control->getScrollHandler()->scrollToPage(currentPage);
 }
 
 auto XournalView::getTextEditor() -> TextEditor* {
     for (auto&& page: viewPages) {
-        if (page->getTextEditor()) {
-            return page->getTextEditor();
+        if (page.getView() && page.getView()->getTextEditor()) {
+            return page.getView()->getTextEditor();
         }
     }
 
@@ -557,7 +630,9 @@ auto XournalView::getTextEditor() -> TextEditor* {
 
 void XournalView::resetShapeRecognizer() {
     for (auto&& page: viewPages) {
-        page->resetShapeRecognizer();
+        if (page.getView()) {
+            page.getView()->resetShapeRecognizer();
+        }
     }
 }
 
@@ -565,15 +640,15 @@ auto XournalView::getCache() -> PdfCache* { return this->cache; }
 
 void XournalView::pageInserted(size_t page) {
     Document* doc = control->getDocument();
+    // The view is only created once the page comes near the visible area
     doc->lock();
-    auto* pageView = new XojPageView(this, doc->getPage(page));
+    viewPages.emplace(begin(viewPages) + page, this, doc->getPage(page));
     doc->unlock();
 
-    viewPages.insert(begin(viewPages) + page, pageView);
-
-    layoutPages();
-    // check which pages are visible and select the most visible page
     Layout* layout = gtk_xournal_get_layout(this->widget);
+    layout->pageInserted(page);
+    updateLayout();
+    // check which pages are visible and select the most visible page
     layout->updateVisibility();
 }
 
@@ -658,8 +733,12 @@ void XournalView::repaintSelection(bool evenWithoutSelection) {
 }
 
 void XournalView::layoutPages() {
+    gtk_xournal_get_layout(this->widget)->recalculate();
+    updateLayout();
+}
+
+void XournalView::updateLayout() {
     Layout* layout = gtk_xournal_get_layout(this->widget);
-    layout->recalculate();
 
     // Todo (fabian): the following lines are conceptually wrong, the Layout::layoutPages function is meant to be called
     //                by an expose event, but removing it, will break "add page".
@@ -709,7 +788,7 @@ void XournalView::documentChanged(DocumentChangeType type) {
     clearSelection();
 
     for (auto&& page: viewPages) {
-        delete page;
+        releaseView(page.releaseView());
     }
     viewPages.clear();
 
@@ -721,7 +800,7 @@ void XournalView::documentChanged(DocumentChangeType type) {
     size_t pagecount = doc->getPageCount();
     viewPages.reserve(pagecount);
     for (size_t i = 0; i < pagecount; i++) {
-        viewPages.push_back(new XojPageView(this, doc->getPage(i)));
+        viewPages.emplace_back(this, doc->getPage(i));
     }
 
     doc->unlock();
@@ -738,7 +817,7 @@ auto XournalView::cut() -> bool {
         return false;
     }
 
-    XojPageView* page = viewPages[p];
+    XojPageView* page = getViewFor(p);
     return page->cut();
 }
 
@@ -748,7 +827,7 @@ auto XournalView::copy() -> bool {
         return false;
     }
 
-    XojPageView* page = viewPages[p];
+    XojPageView* page = getViewFor(p);
     return page->copy();
 }
 
@@ -758,7 +837,7 @@ auto XournalView::paste() -> bool {
         return false;
     }
 
-    XojPageView* page = viewPages[p];
+    XojPageView* page = getViewFor(p);
     return page->paste();
 }
 
@@ -768,13 +847,13 @@ auto XournalView::actionDelete() -> bool {
         return false;
     }
 
-    XojPageView* page = viewPages[p];
+    XojPageView* page = getViewFor(p);
     return page->actionDelete();
 }
 
 auto XournalView::getDocument() -> Document* { return control->getDocument(); }
 
-auto XournalView::getViewPages() const -> std::vector<XojPageView*> const& { return viewPages; }
+auto XournalView::getViewPages() const -> std::vector<PageViewPlaceholder> const& { return viewPages; }
 
 auto XournalView::getCursor() -> XournalppCursor* { return control->getCursor(); }
 
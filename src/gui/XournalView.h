@@ -18,6 +18,8 @@
 #include "model/PageRef.h"
 #include "widgets/XournalWidget.h"
 
+#include "PageViewPlaceholder.h"
+
 class Control;
 class XournalppCursor;
 class Document;
@@ -59,6 +61,9 @@ public:
 
     void forceUpdatePagenumbers();
 
+    /**
+     * Returns the view of a page, it is created if the page does not have one
+     */
     XojPageView* getViewFor(size_t pageNr);
 
     bool searchTextOnPage(string text, size_t p, int* occures, double* top);
@@ -88,7 +93,7 @@ public:
     void repaintSelection(bool evenWithoutSelection = false);
 
     TextEditor* getTextEditor();
-    std::vector<XojPageView*> const& getViewPages() const;
+    std::vector<PageViewPlaceholder> const& getViewPages() const;
 
     Control* getControl();
     double getZoom();
@@ -144,6 +149,19 @@ private:
 
     Rectangle<double>* getVisibleRect(size_t page);
 
+    // Layout the pages with the updated layout size, without recalculating the pages which did not change
+    void updateLayout();
+
+    /**
+     * Releases the views of pages which were not visible for some time and are not close to the current page
+     */
+    void releaseHiddenViews();
+
+    /**
+     * Keeps the view for reuse or deletes it, if the pool is full
+     */
+    void releaseView(XojPageView* view);
+
     static gboolean clearMemoryTimer(XournalView* widget);
 
     static void staticLayoutPages(GtkWidget* widget, GtkAllocation* allocation, void* data);
@@ -157,7 +175,12 @@ private:
     GtkWidget* widget = nullptr;
     double margin = 75;
 
-    std::vector<XojPageView*> viewPages;
+    std::vector<PageViewPlaceholder> viewPages;
+
+    /**
+     * Released views, which are reused for the next pages which need one
+     */
+    std::vector<XojPageView*> pageViewPool;
 
     Control* control = nullptr;
 
@@ -5,6 +5,7 @@
 #include <config.h>
 
 #include "gui/widgets/ZoomCallib.h"
+#include "undo/UndoRedoHandler.h"
 
 #include "ButtonConfigGui.h"
 #include "DeviceListHelper.h"
@@ -297,6 +298,7 @@ void SettingsDialog::load() {
     loadCheckbox("cbShowScrollbarLeft", settings->isScrollbarOnLeft());
     loadCheckbox("cbAutoloadXoj", settings->isAutloadPdfXoj());
     loadCheckbox("cbAutosave", settings->isAutosaveEnabled());
+    loadCheckbox("cbSaveZipContainer", settings->isSaveZipContainer());
     loadCheckbox("cbAddVerticalSpace", settings->getAddVerticalSpace());
     loadCheckbox("cbAddHorizontalSpace", settings->getAddHorizontalSpace());
     loadCheckbox("cbDrawDirModsEnabled", settings->getDrawDirModsEnabled());
@@ -317,6 +319,8 @@ void SettingsDialog::load() {
     loadCheckbox("cbNewInputSystem", settings->getExperimentalInputSystemEnabled());
     loadCheckbox("cbInputSystemTPCButton", settings->getInputSystemTPCButtonEnabled());
     loadCheckbox("cbInputSystemDrawOutsideWindow", settings->getInputSystemDrawOutsideWindowEnabled());
+    loadCheckbox("cbInputSystemMotionCoalescing", settings->getInputSystemMotionCoalescingEnabled());
+    loadCheckbox("cbInputSystemPrediction", settings->getInputSystemPredictionEnabled());
 
 
     GtkWidget* txtDefaultSaveName = get("txtDefaultSaveName");
@@ -328,6 +332,17 @@ void SettingsDialog::load() {
     GtkWidget* spAutosaveTimeout = get("spAutosaveTimeout");
     gtk_spin_button_set_value(GTK_SPIN_BUTTON(spAutosaveTimeout), settings->getAutosaveTimeout());
 
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(get("spUndoMemoryBudget")), settings->getUndoMemoryBudget());
+    gtk_spin_button_set_value(GTK_SPIN_BUTTON(get("spUndoMemoryLimit")), settings->getUndoMemoryLimit());
+
+    UndoRedoHandler* undoRedo = control->getUndoRedoHandler();
+    auto toMB = [](size_t bytes) { return std::to_string((bytes + 512 * 1024) / (1024 * 1024)); };
+    string undoUsage = FS(_F("The undo history of the current document has {1} actions, using {2} MB of memory and "
+                             "{3} MB in the temporary file. {4} actions were removed because of the limit.") %
+                          undoRedo->getActionCount() % toMB(undoRedo->getMemoryUsage()) %
+                          toMB(undoRedo->getSpilledSize()) % undoRedo->getDroppedCount());
+    gtk_label_set_text(GTK_LABEL(get("lbUndoMemoryUsage")), undoUsage.c_str());
+
     GtkWidget* spNumIgnoredStylusEvents = get("spNumIgnoredStylusEvents");
     if (!ignoreStylusEventsEnabled) {  // The spinButton's value should be >= 1
         gtk_spin_button_set_value(GTK_SPIN_BUTTON(spNumIgnoredStylusEvents), 1);
@@ -589,6 +604,7 @@ void SettingsDialog::save() {
     settings->setScrollbarOnLeft(getCheckbox("cbShowScrollbarLeft"));
     settings->setAutoloadPdfXoj(getCheckbox("cbAutoloadXoj"));
     settings->setAutosaveEnabled(getCheckbox("cbAutosave"));
+    settings->setSaveZipContainer(getCheckbox("cbSaveZipContainer"));
     settings->setAddVerticalSpace(getCheckbox("cbAddVerticalSpace"));
     settings->setAddHorizontalSpace(getCheckbox("cbAddHorizontalSpace"));
     settings->setDrawDirModsEnabled(getCheckbox("cbDrawDirModsEnabled"));
@@ -604,6 +620,8 @@ void SettingsDialog::save() {
     settings->setExperimentalInputSystemEnabled(getCheckbox("cbNewInputSystem"));
     settings->setInputSystemTPCButtonEnabled(getCheckbox("cbInputSystemTPCButton"));
     settings->setInputSystemDrawOutsideWindowEnabled(getCheckbox("cbInputSystemDrawOutsideWindow"));
+    settings->setInputSystemMotionCoalescingEnabled(getCheckbox("cbInputSystemMotionCoalescing"));
+    settings->setInputSystemPredictionEnabled(getCheckbox("cbInputSystemPrediction"));
     settings->setScrollbarFadeoutDisabled(getCheckbox("cbDisableScrollbarFadeout"));
 
     auto scrollbarHideType =
@@ -674,6 +692,9 @@ void SettingsDialog::save() {
     int autosaveTimeout = gtk_spin_button_get_value(GTK_SPIN_BUTTON(spAutosaveTimeout));
     settings->setAutosaveTimeout(autosaveTimeout);
 
+    settings->setUndoMemoryBudget(gtk_spin_button_get_value(GTK_SPIN_BUTTON(get("spUndoMemoryBudget"))));
+    settings->setUndoMemoryLimit(gtk_spin_button_get_value(GTK_SPIN_BUTTON(get("spUndoMemoryLimit"))));
+
     if (getCheckbox("cbIgnoreFirstStylusEvents")) {
         GtkWidget* spNumIgnoredStylusEvents = get("spNumIgnoredStylusEvents");
         int numIgnoredStylusEvents = gtk_spin_button_get_value(GTK_SPIN_BUTTON(spNumIgnoredStylusEvents));
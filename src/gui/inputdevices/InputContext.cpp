@@ -4,6 +4,7 @@
 
 #include "InputContext.h"
 
+#include "gui/LatencyTrace.h"
 #include "util/DeviceListHelper.h"
 
 #include "InputEvents.h"
@@ -71,6 +72,7 @@ auto InputContext::handle(GdkEvent* sourceEvent) -> bool {
     printDebug(sourceEvent);
 
     InputEvent event = InputEvents::translateEvent(sourceEvent, this->getSettings());
+    LatencyTrace::getInstance().setCurrentEvent(event.receiveTime);
 
     // Add the device to the list of known devices if it is currently unknown
     GdkDevice* sourceDevice = gdk_event_get_source_device(sourceEvent);
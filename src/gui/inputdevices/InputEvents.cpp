@@ -4,6 +4,8 @@
 
 #include "InputEvents.h"
 
+#include "gui/LatencyTrace.h"
+
 auto InputEvents::translateEventType(GdkEventType type) -> InputEventType {
     switch (type) {
         case GDK_MOTION_NOTIFY:
@@ -111,6 +113,9 @@ auto InputEvents::translateEvent(GdkEvent* sourceEvent, Settings* settings) -> I
 
     // Copy the timestamp
     targetEvent.timestamp = gdk_event_get_time(sourceEvent);
+    if (LatencyTrace::isEnabled()) {
+        targetEvent.receiveTime = g_get_monotonic_time();
+    }
 
     // Copy the pressure data
     gdk_event_get_axis(sourceEvent, GDK_AXIS_PRESSURE, &targetEvent.pressure);
@@ -106,6 +106,11 @@ struct InputEvent final {
 
     GdkEventSequence* sequence{};
     guint32 timestamp{0};
+
+    /**
+     * Monotonic time in microseconds when the event was received, for LatencyTrace
+     */
+    gint64 receiveTime{0};
 };
 
 class InputEvents {
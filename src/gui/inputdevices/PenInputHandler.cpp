@@ -8,6 +8,7 @@
 
 #include "control/ToolHandler.h"
 #include "control/settings/ButtonConfig.h"
+#include "gui/LatencyTrace.h"
 #include "gui/XournalView.h"
 #include "gui/XournalppCursor.h"
 #include "gui/inputdevices/PositionInputData.h"
@@ -20,7 +21,79 @@
 
 PenInputHandler::PenInputHandler(InputContext* inputContext): AbstractInputHandler(inputContext) {}
 
-PenInputHandler::~PenInputHandler() = default;
+PenInputHandler::~PenInputHandler() {
+    if (this->tickCallbackId != 0) {
+        gtk_widget_remove_tick_callback(GTK_WIDGET(this->inputContext->getXournal()), this->tickCallbackId);
+        this->tickCallbackId = 0;
+    }
+}
+
+auto PenInputHandler::queueMotion(InputEvent const& event) -> bool {
+    if (!this->inputRunning || !this->deviceClassPressed ||
+        !this->inputContext->getSettings()->getInputSystemMotionCoalescingEnabled()) {
+        return false;
+    }
+
+    // Only strokes are drawn in batches, other tools keep their immediate feedback
+    ToolHandler* toolHandler = this->inputContext->getToolHandler();
+    ToolType toolType = toolHandler->getToolType();
+    if ((toolType != TOOL_PEN && toolType != TOOL_HIGHLIGHTER) || toolHandler->isSinglePageTool() ||
+        this->inputContext->getXournal()->selection) {
+        return false;
+    }
+
+    this->queuedMotion.push_back(event);
+
+    if (this->tickCallbackId == 0) {
+        this->tickCallbackId =
+                gtk_widget_add_tick_callback(GTK_WIDGET(this->inputContext->getXournal()), onFrameTick, this, nullptr);
+    }
+
+    return true;
+}
+
+auto PenInputHandler::onFrameTick(GtkWidget* widget, GdkFrameClock* frameClock, gpointer self) -> gboolean {
+    auto* handler = static_cast<PenInputHandler*>(self);
+    handler->tickCallbackId = 0;
+    handler->flushMotion();
+    return G_SOURCE_REMOVE;
+}
+
+void PenInputHandler::flushMotion() {
+    if (this->queuedMotion.empty()) {
+        return;
+    }
+
+    std::vector<InputEvent> events;
+    std::swap(events, this->queuedMotion);
+
+    LatencyTrace& trace = LatencyTrace::getInstance();
+    gint64 previousEvent = trace.getCurrentEvent();
+
+    // The stroke is drawn on the page it was started on, which repaints once for all events of the batch.
+    // Switching to another page ends the stroke and starts a new one there.
+    XojPageView* batchPage = nullptr;
+    for (InputEvent const& event: events) {
+        XojPageView* page = this->sequenceStartPage;
+        if (page != batchPage) {
+            if (batchPage) {
+                batchPage->endMotionBatch();
+            }
+            batchPage = page;
+            if (batchPage) {
+                batchPage->beginMotionBatch();
+            }
+        }
+
+        trace.setCurrentEvent(event.receiveTime);
+        this->actionMotion(event);
+    }
+
+    if (batchPage) {
+        batchPage->endMotionBatch();
+    }
+    trace.setCurrentEvent(previousEvent);
+}
 
 void PenInputHandler::updateLastEvent(InputEvent const& event) {
     if (!event) {
@@ -11,6 +11,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "AbstractInputHandler.h"
 
 class InputContext;
@@ -71,6 +73,17 @@ protected:
      */
     XojPageView* sequenceStartPage = nullptr;
 
+private:
+    /**
+     * Motion events waiting for the next frame
+     */
+    std::vector<InputEvent> queuedMotion;
+
+    /**
+     * Tick callback of the frame clock which processes queuedMotion
+     */
+    guint tickCallbackId = 0;
+
 public:
     explicit PenInputHandler(InputContext* inputContext);
     ~PenInputHandler() override;
@@ -111,6 +124,18 @@ protected:
      */
     virtual bool changeTool(InputEvent const& event) = 0;
 
+    /**
+     * Queues the motion event of a running stroke until the next frame of the widget.
+     * All events of a frame are then processed in one pass by flushMotion().
+     * @return true if the event was queued
+     */
+    bool queueMotion(InputEvent const& event);
+
+    /**
+     * Processes the queued motion events. Needs to be called before any other event is handled.
+     */
+    void flushMotion();
+
     /**
      * Do the scrolling with the hand tool
      */
@@ -130,4 +155,7 @@ protected:
      * @param page The page the event is relative to.
      */
     double inferPressureIfEnabled(PositionInputData const& pos, XojPageView* page);
+
+private:
+    static gboolean onFrameTick(GtkWidget* widget, GdkFrameClock* frameClock, gpointer self);
 };
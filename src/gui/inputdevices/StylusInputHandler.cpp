@@ -20,6 +20,11 @@ auto StylusInputHandler::handleImpl(InputEvent const& event) -> bool {
     // Only handle events when there is no active gesture
     GtkXournal* xournal = inputContext->getXournal();
 
+    // Keep the order of events, queued motion is processed first
+    if (event.type != MOTION_EVENT) {
+        flushMotion();
+    }
+
     // Determine the pressed states of devices and associate them to the current event
     setPressedState(event);
 
@@ -61,7 +66,8 @@ auto StylusInputHandler::handleImpl(InputEvent const& event) -> bool {
         } else if (this->eventsToIgnore == 0) {
             this->eventsToIgnore = -1;
             this->actionStart(event);
-        } else {
+        } else if (!this->queueMotion(event)) {
+            flushMotion();
             this->actionMotion(event);
         }
         XournalppCursor* cursor = xournal->view->getCursor();
@@ -9,6 +9,7 @@
 #include "control/Control.h"
 #include "control/settings/Settings.h"
 #include "control/tools/EditSelection.h"
+#include "gui/LatencyTrace.h"
 #include "gui/Layout.h"
 #include "gui/Shadow.h"
 #include "gui/XournalView.h"
@@ -291,16 +292,19 @@ static auto gtk_xournal_draw(GtkWidget* widget, cairo_t* cr) -> gboolean {
 
     Rectangle clippingRect(x1 - 10, y1 - 10, x2 - x1 + 20, y2 - y1 + 20);
 
-    for (auto&& pv: xournal->view->getViewPages()) {
-        int px = pv->getX();
-        int py = pv->getY();
-        int pw = pv->getDisplayWidth();
-        int ph = pv->getDisplayHeight();
+    auto const& pages = xournal->view->getViewPages();
+    for (size_t i = 0; i < pages.size(); i++) {
+        int px = pages[i].getX();
+        int py = pages[i].getY();
+        int pw = pages[i].getDisplayWidth();
+        int ph = pages[i].getDisplayHeight();
 
-        if (!clippingRect.intersects(pv->getRect())) {
+        if (!clippingRect.intersects(pages[i].getRect())) {
             continue;
         }
 
+        XojPageView* pv = xournal->view->getViewFor(i);
+
         gtk_xournal_draw_shadow(xournal, cr, px, py, pw, ph, pv->isSelected());
 
         cairo_save(cr);
@@ -319,6 +323,8 @@ static auto gtk_xournal_draw(GtkWidget* widget, cairo_t* cr) -> gboolean {
         xournal->selection->paint(cr, zoom);
     }
 
+    LatencyTrace::getInstance().drawn(gtk_widget_get_frame_clock(widget));
+
     return true;
 }
 
@@ -0,0 +1,118 @@
+#include "DecodedImageCache.h"
+
+#include "Image.h"
+
+/**
+ * Budget for decoded surfaces, about 30 full HD screenshots.
+ * The most recently used surface is always kept, even if it is larger.
+ */
+constexpr size_t BUDGET = 256 * 1024 * 1024;
+
+DecodedImageCache::DecodedImageCache() = default;
+
+DecodedImageCache::~DecodedImageCache() {
+    for (auto& e: this->entries) {
+        cairo_surface_destroy(e.second.surface);
+    }
+}
+
+auto DecodedImageCache::getInstance() -> DecodedImageCache& {
+    static DecodedImageCache instance;
+    return instance;
+}
+
+auto DecodedImageCache::getSurfaceSize(cairo_surface_t* surface) -> size_t {
+    size_t size = static_cast<size_t>(cairo_image_surface_get_stride(surface)) *
+                  static_cast<size_t>(cairo_image_surface_get_height(surface));
+
+    // The downsampled levels the renderer attaches to the surface add up to a third of its size
+    return size + size / 3;
+}
+
+auto DecodedImageCache::get(Image* image) -> cairo_surface_t* {
+    std::shared_ptr<const string> data;
+    uint64_t generation = 0;
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        auto it = this->entries.find(image);
+        if (it != this->entries.end()) {
+            this->lru.splice(this->lru.begin(), this->lru, it->second.lru);
+            return cairo_surface_reference(it->second.surface);
+        }
+
+        Decoding& d = this->decoding[image];
+        d.decoders++;
+        generation = d.generation;
+
+        // Keeps the data alive, also if the image is changed or deleted while decoding
+        data = image->getData();
+    }
+
+    // Decoded without the lock, so other images can be drawn meanwhile
+    cairo_surface_t* surface = data ? Image::decode(*data) : nullptr;
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    auto decodingIt = this->decoding.find(image);
+    bool removed = decodingIt->second.generation != generation;
+    if (--decodingIt->second.decoders == 0) {
+        this->decoding.erase(decodingIt);
+    }
+
+    if (surface == nullptr || removed) {
+        // The image was changed or deleted meanwhile, the pointer may already belong to another image
+        return surface;
+    }
+
+    auto it = this->entries.find(image);
+    if (it != this->entries.end()) {
+        // Another thread decoded the same image
+        cairo_surface_destroy(surface);
+        this->lru.splice(this->lru.begin(), this->lru, it->second.lru);
+        return cairo_surface_reference(it->second.surface);
+    }
+
+    this->lru.push_front(image);
+
+    Entry& e = this->entries[image];
+    e.surface = surface;
+    e.size = getSurfaceSize(surface);
+    e.lru = this->lru.begin();
+    this->usedBytes += e.size;
+
+    evict();
+
+    return cairo_surface_reference(surface);
+}
+
+void DecodedImageCache::remove(const Image* image) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    // A surface being decoded is of the old data
+    auto decodingIt = this->decoding.find(image);
+    if (decodingIt != this->decoding.end()) {
+        decodingIt->second.generation++;
+    }
+
+    auto it = this->entries.find(image);
+    if (it == this->entries.end()) {
+        return;
+    }
+
+    cairo_surface_destroy(it->second.surface);
+    this->usedBytes -= it->second.size;
+    this->lru.erase(it->second.lru);
+    this->entries.erase(it);
+}
+
+void DecodedImageCache::evict() {
+    while (this->usedBytes > BUDGET && this->lru.size() > 1) {
+        auto it = this->entries.find(this->lru.back());
+        this->lru.pop_back();
+
+        // Surfaces still drawn by another thread are kept alive by their reference
+        cairo_surface_destroy(it->second.surface);
+        this->usedBytes -= it->second.size;
+        this->entries.erase(it);
+    }
+}
@@ -0,0 +1,90 @@
+/*
+ * Xournal++
+ *
+ * Decoded surfaces of the images in all documents
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include <cairo.h>
+
+class Image;
+
+/**
+ * Images keep their encoded PNG data and are only decoded while they are drawn. The decoded
+ * surfaces are kept within a byte budget, the surfaces used least recently are released first.
+ * As visible images are requested on each redraw, these are images which are off screen.
+ *
+ * Callers get their own reference to the surface, so an image can be evicted while
+ * another thread still draws it.
+ */
+class DecodedImageCache final {
+    DecodedImageCache();
+
+public:
+    static DecodedImageCache& getInstance();
+
+    ~DecodedImageCache();
+    DecodedImageCache(DecodedImageCache const&) = delete;
+    DecodedImageCache(DecodedImageCache&&) = delete;
+    DecodedImageCache& operator=(DecodedImageCache const&) = delete;
+    DecodedImageCache& operator=(DecodedImageCache&&) = delete;
+
+public:
+    /**
+     * @return A new reference to the decoded surface of image, which is decoded if it is not cached.
+     *         nullptr if the data could not be decoded.
+     */
+    cairo_surface_t* get(Image* image);
+
+    /**
+     * Releases the surface of image, called if the image is deleted or its data changes
+     */
+    void remove(const Image* image);
+
+private:
+    /**
+     * Releases the least recently used surfaces until the budget is met, needs the mutex
+     */
+    void evict();
+
+    static size_t getSurfaceSize(cairo_surface_t* surface);
+
+private:
+    struct Entry {
+        cairo_surface_t* surface = nullptr;
+        size_t size = 0;
+        std::list<const Image*>::iterator lru;
+    };
+
+    std::mutex mutex;
+
+    std::unordered_map<const Image*, Entry> entries;
+
+    /**
+     * Images decoded without the mutex. remove() increments the generation, so the surface of
+     * data which was replaced or freed meanwhile is not cached.
+     */
+    struct Decoding {
+        int decoders = 0;
+        uint64_t generation = 0;
+    };
+    std::unordered_map<const Image*, Decoding> decoding;
+
+    /**
+     * Most recently used first
+     */
+    std::list<const Image*> lru;
+
+    size_t usedBytes = 0;
+};
@@ -89,6 +89,7 @@ void Document::clearDocument(bool destroy) {
 
     this->pages.clear();
     this->pageIndex.reset();
+    this->lastSnapshot.reset();
     freeTreeContentModel();
 
     this->filepath = fs::path{};
@@ -159,6 +160,11 @@ void Document::setPreview(cairo_surface_t* preview) {
     }
 }
 
+auto Document::createSnapshot() -> std::shared_ptr<DocumentSnapshot> {
+    this->lastSnapshot = std::make_shared<DocumentSnapshot>(this, this->lastSnapshot.get());
+    return this->lastSnapshot;
+}
+
 auto Document::getEvMetadataFilename() -> fs::path {
     if (!this->filepath.empty()) {
         return this->filepath;
@@ -23,6 +23,7 @@
 #include "pdf/base/XojPdfPage.h"
 
 #include "DocumentHandler.h"
+#include "DocumentSnapshot.h"
 #include "LinkDestination.h"
 #include "PageRef.h"
 #include "XournalType.h"
@@ -86,6 +87,14 @@ public:
     cairo_surface_t* getPreview();
     void setPreview(cairo_surface_t* preview);
 
+    /**
+     * Creates a read only snapshot of the document, which can be saved or exported
+     * without holding the document lock. The document needs to be locked while calling this.
+     *
+     * Pages which were not modified since the last snapshot are shared with it instead of copied.
+     */
+    std::shared_ptr<DocumentSnapshot> createSnapshot();
+
     void lock();
     void unlock();
     bool tryLock();
@@ -152,6 +161,11 @@ private:
      */
     cairo_surface_t* preview = nullptr;
 
+    /**
+     * The last snapshot, its unchanged pages are reused by the next one
+     */
+    std::shared_ptr<DocumentSnapshot> lastSnapshot;
+
     /**
      * The lock of the document
      */
@@ -0,0 +1,135 @@
+#include "DocumentSnapshot.h"
+
+#include <stack>
+#include <unordered_map>
+
+#include "Document.h"
+#include "Layer.h"
+#include "LinkDestination.h"
+#include "XojPage.h"
+
+DocumentSnapshot::DocumentSnapshot(Document* doc, const DocumentSnapshot* previous):
+        filepath(doc->getFilepath()),
+        pdfFilepath(doc->getPdfFilepath()),
+        attachPdf(doc->isAttachPdf()) {
+    // The copy constructor does not share the loaded PDF, the assignment does
+    this->pdfDocument = doc->getPdfDocument();
+    setPreview(doc->getPreview());
+    readOutline(doc);
+
+    std::unordered_map<XojPage*, const Entry*> previousEntries;
+    if (previous) {
+        previousEntries.reserve(previous->pages.size());
+        for (const Entry& e: previous->pages) {
+            if (PageRef source = e.source.lock()) {
+                previousEntries[source.get()] = &e;
+            }
+        }
+    }
+
+    size_t count = doc->getPageCount();
+    this->pages.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        PageRef page = doc->getPage(i);
+
+        Entry entry;
+        entry.source = page;
+        entry.revision = page->getRevision();
+        entry.layerSizes = getLayerSizes(page);
+
+        auto it = previousEntries.find(page.get());
+        if (it != previousEntries.end() && it->second->revision == entry.revision &&
+            it->second->layerSizes == entry.layerSizes) {
+            entry.copy = it->second->copy;
+        } else {
+            entry.copy = PageRef(page->clone());
+            this->copiedPageCount++;
+        }
+
+        this->pages.push_back(std::move(entry));
+    }
+}
+
+DocumentSnapshot::~DocumentSnapshot() { setPreview(nullptr); }
+
+auto DocumentSnapshot::getLayerSizes(const PageRef& page) -> std::vector<size_t> {
+    std::vector<size_t> sizes;
+    sizes.reserve(page->getLayerCount());
+    for (Layer* l: *page->getLayers()) {
+        sizes.push_back(l->getElements()->size());
+    }
+    return sizes;
+}
+
+void DocumentSnapshot::readOutline(Document* doc) {
+    GtkTreeModel* model = doc->getContentsModel();
+    GtkTreeIter first = {0};
+    if (model == nullptr || !gtk_tree_model_get_iter_first(model, &first)) {
+        return;
+    }
+
+    // Depth first, so parents are added before their children
+    std::stack<std::pair<GtkTreeIter, size_t>> nodes;
+    nodes.emplace(first, npos);
+    while (!nodes.empty()) {
+        auto [iter, parent] = nodes.top();
+        nodes.pop();
+
+        XojLinkDest* link = nullptr;
+        gtk_tree_model_get(model, &iter, DOCUMENT_LINKS_COLUMN_LINK, &link, -1);
+
+        OutlineEntry entry;
+        entry.parent = parent;
+        entry.name = link->dest->getName();
+        size_t pdfPage = link->dest->getPdfPage();
+        entry.page = pdfPage == npos ? npos : doc->findPdfPage(pdfPage);
+        entry.hasPosition = link->dest->shouldChangeLeft() && link->dest->shouldChangeTop();
+        entry.left = link->dest->getLeft();
+        entry.top = link->dest->getTop();
+        entry.expand = link->dest->getExpand();
+        g_object_unref(link);
+
+        size_t index = this->outline.size();
+        this->outline.push_back(std::move(entry));
+
+        GtkTreeIter next = iter;
+        if (gtk_tree_model_iter_next(model, &next)) {
+            nodes.emplace(next, parent);
+        }
+
+        GtkTreeIter child;
+        if (gtk_tree_model_iter_children(model, &child, &iter)) {
+            nodes.emplace(child, index);
+        }
+    }
+}
+
+auto DocumentSnapshot::getPageCount() const -> size_t { return this->pages.size(); }
+
+auto DocumentSnapshot::getPage(size_t page) const -> PageRef {
+    if (page >= this->pages.size()) {
+        return nullptr;
+    }
+    return this->pages[page].copy;
+}
+
+auto DocumentSnapshot::getFilepath() const -> fs::path { return this->filepath; }
+
+auto DocumentSnapshot::getPdfFilepath() const -> fs::path { return this->pdfFilepath; }
+
+auto DocumentSnapshot::isAttachPdf() const -> bool { return this->attachPdf; }
+
+auto DocumentSnapshot::getPdfDocument() -> XojPdfDocument& { return this->pdfDocument; }
+
+auto DocumentSnapshot::getPreview() const -> cairo_surface_t* { return this->preview; }
+
+void DocumentSnapshot::setPreview(cairo_surface_t* preview) {
+    if (this->preview) {
+        cairo_surface_destroy(this->preview);
+    }
+    this->preview = preview ? cairo_surface_reference(preview) : nullptr;
+}
+
+auto DocumentSnapshot::getCopiedPageCount() const -> size_t { return this->copiedPageCount; }
+
+auto DocumentSnapshot::getOutline() const -> const std::vector<OutlineEntry>& { return this->outline; }
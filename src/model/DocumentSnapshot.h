@@ -0,0 +1,131 @@
+/*
+ * Xournal++
+ *
+ * A read only copy of the document, used to save and export
+ * in the background while the user continues editing
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "pdf/base/XojPdfDocument.h"
+
+#include "PageRef.h"
+#include "Util.h"
+#include "XournalType.h"
+#include "filesystem.h"
+
+class Document;
+
+class DocumentSnapshot {
+public:
+    /**
+     * Creates a snapshot of the document. The document needs to be locked while this runs,
+     * afterwards the snapshot is independent of the document and may be used without the lock.
+     *
+     * Pages which were not modified since they were copied into previous are shared with it
+     * instead of being copied again (copy on write on page level).
+     */
+    explicit DocumentSnapshot(Document* doc, const DocumentSnapshot* previous = nullptr);
+    ~DocumentSnapshot();
+
+    DocumentSnapshot(const DocumentSnapshot&) = delete;
+    DocumentSnapshot& operator=(const DocumentSnapshot&) = delete;
+
+public:
+    size_t getPageCount() const;
+
+    /**
+     * The returned page is shared between snapshots and must not be modified
+     */
+    PageRef getPage(size_t page) const;
+
+    fs::path getFilepath() const;
+    fs::path getPdfFilepath() const;
+    bool isAttachPdf() const;
+    XojPdfDocument& getPdfDocument();
+
+    cairo_surface_t* getPreview() const;
+    void setPreview(cairo_surface_t* preview);
+
+    /**
+     * @return The number of pages which had to be copied, the others are shared with the previous snapshot
+     */
+    size_t getCopiedPageCount() const;
+
+    /**
+     * An entry of the outline of the background PDF
+     */
+    struct OutlineEntry {
+        /**
+         * The index of the parent entry, npos for top level entries
+         */
+        size_t parent = npos;
+
+        string name;
+
+        /**
+         * The page of the document the entry links to, npos if the PDF page is not in the document
+         */
+        size_t page = npos;
+
+        bool hasPosition = false;
+        double left = 0;
+        double top = 0;
+
+        bool expand = false;
+    };
+
+    /**
+     * The outline of the background PDF, parents are listed before their children
+     */
+    const std::vector<OutlineEntry>& getOutline() const;
+
+private:
+    struct Entry {
+        /**
+         * The page of the document this entry is a copy of
+         */
+        std::weak_ptr<XojPage> source;
+
+        /**
+         * The revision of the source page at the time the copy was taken
+         */
+        uint64_t revision = 0;
+
+        /**
+         * The element count of each layer, a cheap additional check
+         * in case a modification of the source page was not notified
+         */
+        std::vector<size_t> layerSizes;
+
+        PageRef copy;
+    };
+
+    static std::vector<size_t> getLayerSizes(const PageRef& page);
+
+    void readOutline(Document* doc);
+
+private:
+    std::vector<Entry> pages;
+
+    size_t copiedPageCount = 0;
+
+    fs::path filepath;
+    fs::path pdfFilepath;
+    bool attachPdf = false;
+
+    XojPdfDocument pdfDocument;
+
+    std::vector<OutlineEntry> outline;
+
+    cairo_surface_t* preview = nullptr;
+};
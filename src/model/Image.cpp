@@ -1,15 +1,20 @@
 #include "Image.h"
 
+#include <cstring>
+#include <memory>
 #include <utility>
 
 #include "serializing/ObjectInputStream.h"
 #include "serializing/ObjectOutputStream.h"
 
+#include "DecodedImageCache.h"
 #include "pixbuf-utils.h"
 
 Image::Image(): Element(ELEMENT_IMAGE) {}
 
 Image::~Image() {
+    DecodedImageCache::getInstance().remove(this);
+
     if (this->image) {
         cairo_surface_destroy(this->image);
         this->image = nullptr;
@@ -24,7 +29,7 @@ auto Image::clone() -> Element* {
     img->setColor(this->getColor());
     img->width = this->width;
     img->height = this->height;
-    img->data = this->data;
+    img->data = getData();
 
     img->image = cairo_surface_reference(this->image);
     img->calcSize();
@@ -42,45 +47,96 @@ void Image::setHeight(double height) {
     this->calcSize();
 }
 
-auto Image::cairoReadFunction(Image* image, unsigned char* data, unsigned int length) -> cairo_status_t {
-    for (unsigned int i = 0; i < length; i++, image->read++) {
-        if (image->read >= image->data.length()) {
-            return CAIRO_STATUS_READ_ERROR;
-        }
-
-        data[i] = image->data[image->read];
+auto Image::cairoReadFunction(PngReader* reader, unsigned char* data, unsigned int length) -> cairo_status_t {
+    if (reader->data.length() - reader->pos < length) {
+        return CAIRO_STATUS_READ_ERROR;
     }
 
+    std::memcpy(data, reader->data.data() + reader->pos, length);
+    reader->pos += length;
+
+    return CAIRO_STATUS_SUCCESS;
+}
+
+auto Image::cairoWriteFunction(string* data, const unsigned char* buffer, unsigned int length) -> cairo_status_t {
+    data->append(reinterpret_cast<const char*>(buffer), length);
     return CAIRO_STATUS_SUCCESS;
 }
 
 void Image::setImage(string data) {
+    DecodedImageCache::getInstance().remove(this);
+
     if (this->image) {
         cairo_surface_destroy(this->image);
         this->image = nullptr;
     }
-    this->data = std::move(data);
+    std::atomic_store(&this->data, std::make_shared<const string>(std::move(data)));
 }
 
 void Image::setImage(GdkPixbuf* img) { setImage(f_pixbuf_to_cairo_surface(img)); }
 
 void Image::setImage(cairo_surface_t* image) {
+    DecodedImageCache::getInstance().remove(this);
+
     if (this->image) {
         cairo_surface_destroy(this->image);
         this->image = nullptr;
     }
 
+    // The encoded data belongs to the previous image
+    std::atomic_store(&this->data, std::shared_ptr<const string>());
     this->image = image;
 }
 
 auto Image::getImage() -> cairo_surface_t* {
-    if (this->image == nullptr && this->data.length()) {
-        this->read = 0;
-        this->image = cairo_image_surface_create_from_png_stream(
-                reinterpret_cast<cairo_read_func_t>(&cairoReadFunction), this);
+    if (this->image) {
+        return cairo_surface_reference(this->image);
+    }
+    auto data = getData();
+    if (!data || data->empty()) {
+        return nullptr;
+    }
+
+    return DecodedImageCache::getInstance().get(this);
+}
+
+auto Image::getData() const -> std::shared_ptr<const string> { return std::atomic_load(&this->data); }
+
+auto Image::decode(const string& data) -> cairo_surface_t* {
+    PngReader reader{data, 0};
+    cairo_surface_t* surface = cairo_image_surface_create_from_png_stream(
+            reinterpret_cast<cairo_read_func_t>(&cairoReadFunction), &reader);
+
+    if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+        g_warning("Could not decode image: %s", cairo_status_to_string(cairo_surface_status(surface)));
+        cairo_surface_destroy(surface);
+        return nullptr;
     }
 
-    return this->image;
+    return surface;
+}
+
+auto Image::getDataSize() const -> size_t {
+    if (this->image) {
+        return static_cast<size_t>(cairo_image_surface_get_stride(this->image)) *
+               static_cast<size_t>(cairo_image_surface_get_height(this->image));
+    }
+    auto data = getData();
+    return data ? data->size() : 0;
+}
+
+auto Image::getPngData() -> string {
+    auto data = getData();
+    if (data && !data->empty()) {
+        return *data;
+    }
+
+    string png;
+    if (this->image) {
+        cairo_surface_write_to_png_stream(this->image, reinterpret_cast<cairo_write_func_t>(&cairoWriteFunction),
+                                          &png);
+    }
+    return png;
 }
 
 void Image::scale(double x0, double y0, double fx, double fy, double rotation,
@@ -107,7 +163,9 @@ void Image::serialize(ObjectOutputStream& out) {
     out.writeDouble(this->width);
     out.writeDouble(this->height);
 
-    out.writeImage(this->image);
+    cairo_surface_t* img = getImage();
+    out.writeImage(img);
+    cairo_surface_destroy(img);
 
     out.endObject();
 }
@@ -120,12 +178,7 @@ void Image::readSerialized(ObjectInputStream& in) {
     this->width = in.readDouble();
     this->height = in.readDouble();
 
-    if (this->image) {
-        cairo_surface_destroy(this->image);
-        this->image = nullptr;
-    }
-
-    this->image = in.readImage();
+    setImage(in.readImage());
 
     in.endObject();
     this->calcSize();
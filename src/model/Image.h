@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -29,8 +30,26 @@ public:
     void setImage(string data);
     void setImage(cairo_surface_t* image);
     void setImage(GdkPixbuf* img);
+
+    /**
+     * Images loaded from PNG data are decoded on demand, the decoded surface may be released
+     * by the DecodedImageCache while the image is not drawn.
+     *
+     * @return A new reference to the image, which has to be released with cairo_surface_destroy
+     */
     cairo_surface_t* getImage();
 
+    /**
+     * @return The image encoded as PNG. The data the image was loaded from is returned as is,
+     *         an image set as surface is encoded
+     */
+    string getPngData();
+
+    /**
+     * @return The size of the PNG data or of the image which was not loaded from data, in bytes
+     */
+    size_t getDataSize() const;
+
     virtual void scale(double x0, double y0, double fx, double fy, double rotation, bool restoreLineWidth);
     virtual void rotate(double x0, double y0, double th);
 
@@ -47,12 +66,37 @@ public:
 private:
     void calcSize() const override;
 
-    static cairo_status_t cairoReadFunction(Image* image, unsigned char* data, unsigned int length);
+    /**
+     * @return The encoded PNG, nullptr if the image was not loaded from data.
+     *         The reference keeps the data alive while it is decoded, also if the image is changed meanwhile.
+     */
+    std::shared_ptr<const string> getData() const;
+
+    /**
+     * Decodes PNG data, called by the DecodedImageCache
+     * @return A new surface, nullptr if the data is not a valid PNG
+     */
+    static cairo_surface_t* decode(const string& data);
+
+    struct PngReader {
+        const string& data;
+        string::size_type pos;
+    };
+
+    static cairo_status_t cairoReadFunction(PngReader* reader, unsigned char* data, unsigned int length);
+    static cairo_status_t cairoWriteFunction(string* data, const unsigned char* buffer, unsigned int length);
 
 private:
+    /**
+     * An image which was not loaded from data, it cannot be decoded again and is always kept
+     */
     cairo_surface_t* image = nullptr;
 
-    string data;
+    /**
+     * The encoded PNG, the decoded surface is owned by the DecodedImageCache.
+     * Only accessed atomically, render threads read it while decoding.
+     */
+    std::shared_ptr<const string> data;
 
-    string::size_type read = false;
+    friend class DecodedImageCache;
 };
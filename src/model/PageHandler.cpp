@@ -11,25 +11,33 @@ void PageHandler::addListener(PageListener* l) { this->listener.push_back(l); }
 void PageHandler::removeListener(PageListener* l) { this->listener.remove(l); }
 
 void PageHandler::fireRectChanged(Rectangle<double>& rect) {
+    markChanged();
     for (PageListener* pl: this->listener) {
         pl->rectChanged(rect);
     }
 }
 
 void PageHandler::fireRangeChanged(Range& range) {
+    markChanged();
     for (PageListener* pl: this->listener) {
         pl->rangeChanged(range);
     }
 }
 
 void PageHandler::fireElementChanged(Element* elem) {
+    markChanged();
     for (PageListener* pl: this->listener) {
         pl->elementChanged(elem);
     }
 }
 
 void PageHandler::firePageChanged() {
+    markChanged();
     for (PageListener* pl: this->listener) {
         pl->pageChanged();
     }
 }
+
+void PageHandler::markChanged() { this->revision++; }
+
+auto PageHandler::getRevision() const -> uint64_t { return this->revision; }
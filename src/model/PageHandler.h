@@ -11,6 +11,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <list>
 #include <string>
 #include <vector>
@@ -33,6 +35,17 @@ public:
     void fireElementChanged(Element* elem);
     void firePageChanged();
 
+    /**
+     * Marks the page as modified, without notifying the listeners
+     */
+    void markChanged();
+
+    /**
+     * @return A counter which is increased on every modification of the page,
+     *         used to detect if a copy of the page (e.g. in a DocumentSnapshot) is still up to date
+     */
+    uint64_t getRevision() const;
+
 private:
     void addListener(PageListener* l);
     void removeListener(PageListener* l);
@@ -40,5 +53,7 @@ private:
 private:
     std::list<PageListener*> listener;
 
+    std::atomic<uint64_t> revision{0};
+
     friend class PageListener;
 };
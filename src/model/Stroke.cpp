@@ -45,7 +45,7 @@ void Stroke::serialize(ObjectOutputStream& out) {
 
     out.writeInt(fill);
 
-    out.writeData(this->points.data(), this->points.size(), sizeof(Point));
+    out.writeArray(this->points);
 
     this->lineStyle.serialize(out);
 
@@ -63,11 +63,7 @@ void Stroke::readSerialized(ObjectInputStream& in) {
 
     this->fill = in.readInt();
 
-    Point* p{};
-    int count{};
-    in.readData(reinterpret_cast<void**>(&p), &count);
-    this->points = std::vector<Point>{p, p + count};
-    g_free(p);
+    this->points = in.readArray<Point>();
     this->lineStyle.readSerialized(in);
 
     in.endObject();
@@ -135,6 +131,23 @@ auto Stroke::getPointCount() const -> int { return this->points.size(); }
 
 auto Stroke::getPointVector() const -> std::vector<Point> const& { return points; }
 
+void Stroke::setPointVector(const std::vector<Point>& other) {
+    this->points = other;
+    this->sizeCalculated = false;
+}
+
+void Stroke::setPointVector(std::vector<Point>&& other) {
+    this->points = std::move(other);
+    this->sizeCalculated = false;
+}
+
+auto Stroke::releasePoints() -> std::vector<Point> {
+    std::vector<Point> released;
+    released.swap(this->points);
+    this->sizeCalculated = false;
+    return released;
+}
+
 void Stroke::deletePointsFrom(int index) { points.resize(std::min(size_t(index), points.size())); }
 
 void Stroke::deletePoint(int index) { this->points.erase(std::next(begin(this->points), index)); }
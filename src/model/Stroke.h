@@ -67,6 +67,14 @@ public:
     int getPointCount() const;
     void freeUnusedPointItems();
     std::vector<Point> const& getPointVector() const;
+    void setPointVector(const std::vector<Point>& other);
+    void setPointVector(std::vector<Point>&& other);
+
+    /**
+     * Moves the points out of the stroke and frees their memory, e.g. to store them
+     * somewhere else while the stroke is not part of the document
+     */
+    std::vector<Point> releasePoints();
     Point getPoint(int index) const;
     const Point* getPoints() const;
 
@@ -8,12 +8,29 @@
 
 #include "Stacktrace.h"
 
+/**
+ * The Text elements with a cached layout, the least recently used first, and the estimated memory of their layouts
+ */
+static std::mutex layoutCacheMutex;
+static std::list<const Text*> layoutCache;
+static size_t layoutCacheSize = 0;
+
+/**
+ * Memory of a layout without text: the layout, its context and the font description
+ */
+constexpr size_t LAYOUT_BASE_SIZE = 1024;
+
+constexpr size_t LAYOUT_CACHE_BUDGET = 32 * 1024 * 1024;
+
 Text::Text(): AudioElement(ELEMENT_TEXT) {
     this->font.setName("Sans");
     this->font.setSize(12);
 }
 
-Text::~Text() = default;
+Text::~Text() {
+    std::lock_guard<std::mutex> lock(this->layoutMutex);
+    releaseLayout();
+}
 
 auto Text::clone() -> Element* {
     Text* text = new Text();
@@ -39,11 +56,74 @@ auto Text::getFontName() const -> string { return font.getName(); }
 auto Text::getText() const -> string { return this->text; }
 
 void Text::setText(string text) {
-    this->text = std::move(text);
+    {
+        std::lock_guard<std::mutex> lock(this->layoutMutex);
+        releaseLayout();
+        this->text = std::move(text);
+    }
 
     calcSize();
 }
 
+auto Text::getLayout() const -> PangoLayout* {
+    int dpi = TextView::getDpi();
+    if (this->layout && (this->layoutFontName != this->font.getName() ||
+                         this->layoutFontSize != this->font.getSize() || this->layoutDpi != dpi)) {
+        releaseLayout();
+    }
+
+    if (this->layout == nullptr) {
+        this->layout = TextView::createLayout(this);
+        this->layoutFontName = this->font.getName();
+        this->layoutFontSize = this->font.getSize();
+        this->layoutDpi = dpi;
+
+        // Pango keeps glyphs, clusters and attributes for each character
+        this->layoutBytes =
+                LAYOUT_BASE_SIZE + this->text.length() * (sizeof(PangoGlyphInfo) + sizeof(gint) + sizeof(PangoLogAttr));
+
+        std::lock_guard<std::mutex> lock(layoutCacheMutex);
+        layoutCacheSize += this->layoutBytes;
+        this->layoutLru = layoutCache.insert(layoutCache.end(), this);
+        evictLayouts(this);
+    } else {
+        std::lock_guard<std::mutex> lock(layoutCacheMutex);
+        layoutCache.splice(layoutCache.end(), layoutCache, this->layoutLru);
+    }
+
+    return this->layout;
+}
+
+auto Text::getLayoutMutex() const -> std::mutex& { return this->layoutMutex; }
+
+void Text::releaseLayout() const {
+    if (this->layout) {
+        std::lock_guard<std::mutex> lock(layoutCacheMutex);
+        releaseLayoutUnlocked();
+    }
+}
+
+void Text::releaseLayoutUnlocked() const {
+    g_object_unref(this->layout);
+    this->layout = nullptr;
+    layoutCacheSize -= this->layoutBytes;
+    this->layoutBytes = 0;
+    layoutCache.erase(this->layoutLru);
+}
+
+void Text::evictLayouts(const Text* keep) {
+    for (auto it = layoutCache.begin(); it != layoutCache.end() && layoutCacheSize > LAYOUT_CACHE_BUDGET;) {
+        const Text* text = *it++;
+
+        // getLayout() takes the layout mutex first, so this order may only try. A layout in use is kept.
+        if (text == keep || !text->layoutMutex.try_lock()) {
+            continue;
+        }
+        text->releaseLayoutUnlocked();
+        text->layoutMutex.unlock();
+    }
+}
+
 void Text::calcSize() const {
     TextView::calcSize(this, this->width, this->height);
     this->updateSnapping();
@@ -118,7 +198,11 @@ void Text::readSerialized(ObjectInputStream& in) {
 
     readSerializedAudioElement(in);
 
-    this->text = in.readString();
+    {
+        std::lock_guard<std::mutex> lock(this->layoutMutex);
+        releaseLayout();
+        this->text = in.readString();
+    }
 
     font.readSerialized(in);
 
@@ -11,6 +11,9 @@
 
 #pragma once
 
+#include <list>
+#include <mutex>
+
 #include <gtk/gtk.h>
 
 #include "AudioElement.h"
@@ -37,6 +40,14 @@ public:
     void setInEditing(bool inEditing);
     bool isInEditing() const;
 
+    /**
+     * The shaped text, created on demand and kept until the text, the font or the DPI changes.
+     * The layouts of all Text elements are kept within a budget, the least recently used are released first.
+     * Texts are drawn by several threads, the layout must only be used while holding getLayoutMutex().
+     */
+    PangoLayout* getLayout() const;
+    std::mutex& getLayoutMutex() const;
+
     void scale(double x0, double y0, double fx, double fy, double rotation, bool restoreLineWidth) override;
     void rotate(double x0, double y0, double th) override;
 
@@ -59,10 +70,43 @@ protected:
     void calcSize() const override;
     void updateSnapping() const;
 
+private:
+    /**
+     * Releases the cached layout, needs the layout mutex
+     */
+    void releaseLayout() const;
+
+    /**
+     * Releases the cached layout, needs the layout mutex and the mutex of the layout cache
+     */
+    void releaseLayoutUnlocked() const;
+
+    /**
+     * Releases the least recently used layouts until the budget is met, needs the mutex of the layout cache.
+     * The layout of keep is in use by the caller.
+     */
+    static void evictLayouts(const Text* keep);
+
 private:
     XojFont font;
 
     string text;
 
     bool inEditing = false;
+
+    mutable std::mutex layoutMutex;
+    mutable PangoLayout* layout = nullptr;
+    mutable size_t layoutBytes = 0;
+
+    /**
+     * The font and DPI the layout was created with, the font is changed by reference with getFont()
+     */
+    mutable string layoutFontName;
+    mutable double layoutFontSize = 0;
+    mutable int layoutDpi = 0;
+
+    /**
+     * Position in the layout cache, only valid while there is a layout
+     */
+    mutable std::list<const Text*>::iterator layoutLru;
 };
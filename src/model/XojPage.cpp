@@ -32,11 +32,13 @@ XojPage::XojPage(XojPage const& page):
 auto XojPage::clone() -> XojPage* { return new XojPage(*this); }
 
 void XojPage::addLayer(Layer* layer) {
+    markChanged();
     this->layer.push_back(layer);
     this->currentLayer = npos;
 }
 
 void XojPage::insertLayer(Layer* layer, int index) {
+    markChanged();
     if (index >= static_cast<int>(this->layer.size())) {
         addLayer(layer);
         return;
@@ -47,6 +49,7 @@ void XojPage::insertLayer(Layer* layer, int index) {
 }
 
 void XojPage::removeLayer(Layer* layer) {
+    markChanged();
     for (unsigned int i = 0; i < this->layer.size(); i++) {
         if (layer == this->layer[i]) {
             this->layer.erase(this->layer.begin() + i);
@@ -111,16 +114,21 @@ auto XojPage::isLayerVisible(int layerId) -> bool {
 auto XojPage::isLayerVisible(Layer* layer) -> bool { return layer->isVisible(); }
 
 void XojPage::setBackgroundPdfPageNr(size_t page) {
+    markChanged();
     this->pdfBackgroundPage = page;
     this->bgType.format = PageTypeFormat::Pdf;
     this->bgType.config = "";
 }
 
-void XojPage::setBackgroundColor(Color color) { this->backgroundColor = color; }
+void XojPage::setBackgroundColor(Color color) {
+    markChanged();
+    this->backgroundColor = color;
+}
 
 auto XojPage::getBackgroundColor() const -> Color { return this->backgroundColor; }
 
 void XojPage::setSize(double width, double height) {
+    markChanged();
     this->width = width;
     this->height = height;
 }
@@ -141,6 +149,7 @@ auto XojPage::isAnnotated() -> bool {
 }
 
 void XojPage::setBackgroundType(const PageType& bgType) {
+    markChanged();
     this->bgType = bgType;
 
     if (!bgType.isPdfPage()) {
@@ -155,7 +164,10 @@ auto XojPage::getBackgroundType() -> PageType { return this->bgType; }
 
 auto XojPage::getBackgroundImage() -> BackgroundImage& { return this->backgroundImage; }
 
-void XojPage::setBackgroundImage(BackgroundImage img) { this->backgroundImage = std::move(img); }
+void XojPage::setBackgroundImage(BackgroundImage img) {
+    markChanged();
+    this->backgroundImage = std::move(img);
+}
 
 auto XojPage::getSelectedLayer() -> Layer* {
     if (this->layer.empty()) {
@@ -1,117 +1,169 @@
 #include "EraseableStroke.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include "model/Stroke.h"
 
-#include "EraseableStrokePart.h"
-#include "PartList.h"
 #include "Range.h"
 
-EraseableStroke::EraseableStroke(Stroke* stroke): stroke(stroke) {
-    this->parts = new PartList();
-    g_mutex_init(&this->partLock);
+/**
+ * The array of points is compacted if it has more unused points than this
+ */
+constexpr size_t MIN_UNUSED_POINTS = 1024;
 
-    for (int i = 1; i < stroke->getPointCount(); i++) {
-        this->parts->add(new EraseableStrokePart(stroke->getPoint(i - 1), stroke->getPoint(i)));
+EraseableStroke::EraseableStroke(Stroke* stroke): stroke(stroke) {
+    this->points = stroke->getPointVector();
+
+    // Neighbouring parts share their end point, the array is never modified in place
+    for (size_t i = 1; i < this->points.size(); i++) {
+        Part part;
+        part.begin = i - 1;
+        part.end = i + 1;
+        part.width = this->points[i - 1].z;
+        calcSize(part);
+        this->parts.push_back(part);
+        this->usedPoints += part.size();
     }
-}
 
-EraseableStroke::~EraseableStroke() {
-    delete this->parts;
-    this->parts = nullptr;
+    publish();
 }
 
+EraseableStroke::~EraseableStroke() = default;
+
 ////////////////////////////////////////////////////////////////////////////////
 // This is done in a Thread, every thing else in the main loop /////////////////
 ////////////////////////////////////////////////////////////////////////////////
 
 void EraseableStroke::draw(cairo_t* cr) {
-    g_mutex_lock(&this->partLock);
-    PartList* tmpCopy = this->parts->clone();
-    g_mutex_unlock(&this->partLock);
+    std::shared_ptr<DrawBuffer> buffer;
+    {
+        std::lock_guard<std::mutex> lock(this->drawBufferMutex);
+        buffer = this->drawBuffer;
+    }
 
     double w = this->stroke->getWidth();
 
-    for (GList* l = tmpCopy->data; l != nullptr; l = l->next) {
-        auto* part = static_cast<EraseableStrokePart*>(l->data);
-        if (part->getWidth() == Point::NO_PRESSURE) {
+    size_t begin = 0;
+    for (auto& [end, width]: buffer->parts) {
+        if (width == Point::NO_PRESSURE) {
             cairo_set_line_width(cr, w);
         } else {
-            cairo_set_line_width(cr, part->getWidth());
+            cairo_set_line_width(cr, width);
         }
 
-        GList* pl = part->getPoints();
-        auto* p = static_cast<Point*>(pl->data);
-        cairo_move_to(cr, p->x, p->y);
-
-        pl = pl->next;
-        for (; pl != nullptr; pl = pl->next) {
-            auto* p = static_cast<Point*>(pl->data);
-            cairo_line_to(cr, p->x, p->y);
+        cairo_move_to(cr, buffer->points[begin].x, buffer->points[begin].y);
+        for (size_t i = begin + 1; i < end; i++) {
+            cairo_line_to(cr, buffer->points[i].x, buffer->points[i].y);
         }
         cairo_stroke(cr);
-    }
 
-    delete tmpCopy;
+        begin = end;
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////
 
+/**
+ * Only points inside the eraser box are erased, and whole parts if both ends are close to it
+ */
+static inline auto isOutside(double x1, double y1, double x2, double y2, double x, double y, double halfEraserSize)
+        -> bool {
+    double margin = halfEraserSize * 1.2;
+    return x1 > x + margin || x2 < x - margin || y1 > y + margin || y2 < y - margin;
+}
+
 /**
  * The only public method
  */
 auto EraseableStroke::erase(double x, double y, double halfEraserSize, Range* range) -> Range* {
     this->repaintRect = range;
 
-    g_mutex_lock(&this->partLock);
-    PartList* tmpCopy = this->parts->clone();
-    g_mutex_unlock(&this->partLock);
+    // Most parts of a long stroke are not close to the eraser, only the range between the first
+    // and the last part which is close is replaced
+    size_t first = this->parts.size();
+    size_t last = 0;
+    for (size_t i = 0; i < this->parts.size(); i++) {
+        const Part& part = this->parts[i];
+        if (!isOutside(part.x1, part.y1, part.x2, part.y2, x, y, halfEraserSize)) {
+            first = std::min(first, i);
+            last = i;
+        }
+    }
+    if (first == this->parts.size()) {
+        return this->repaintRect;
+    }
 
-    for (GList* l = tmpCopy->data; l != nullptr;) {
-        auto* p = static_cast<EraseableStrokePart*>(l->data);
-        l = l->next;
-        erase(x, y, halfEraserSize, p, tmpCopy);
+    this->nextParts.clear();
+    bool changed = false;
+    for (size_t i = first; i <= last; i++) {
+        this->usedPoints -= this->parts[i].size();
+        changed |= erase(x, y, halfEraserSize, this->parts[i], this->nextParts);
+    }
+    for (const Part& part: this->nextParts) {
+        this->usedPoints += part.size();
     }
 
-    g_mutex_lock(&this->partLock);
-    PartList* old = this->parts;
-    this->parts = tmpCopy;
-    g_mutex_unlock(&this->partLock);
+    // Also if nothing was erased, the parts may have been subdivided
+    auto begin = this->parts.begin() + static_cast<ptrdiff_t>(first);
+    auto end = this->parts.begin() + static_cast<ptrdiff_t>(last + 1);
+    if (this->nextParts.size() == last + 1 - first) {
+        std::copy(this->nextParts.begin(), this->nextParts.end(), begin);
+    } else {
+        this->parts.insert(this->parts.erase(begin, end), this->nextParts.begin(), this->nextParts.end());
+    }
 
-    delete old;
+    if (this->points.size() > 2 * this->usedPoints + MIN_UNUSED_POINTS) {
+        compact();
+    }
+
+    if (changed) {
+        publish();
+    }
 
     return this->repaintRect;
 }
 
-void EraseableStroke::addRepaintRect(double x, double y, double width, double height) {
+void EraseableStroke::addRepaintRect(const Part& part) {
     if (this->repaintRect) {
-        this->repaintRect->addPoint(x, y);
+        this->repaintRect->addPoint(part.x1, part.y1);
     } else {
-        this->repaintRect = new Range(x, y);
+        this->repaintRect = new Range(part.x1, part.y1);
     }
 
-    this->repaintRect->addPoint(x + width, y + height);
+    this->repaintRect->addPoint(part.x2, part.y2);
 }
 
-void EraseableStroke::erase(double x, double y, double halfEraserSize, EraseableStrokePart* part, PartList* list) {
-    if (part->points->next == nullptr) {
-        return;
+void EraseableStroke::calcSize(Part& part) const {
+    const Point& first = this->points[part.begin];
+    part.x1 = part.x2 = first.x;
+    part.y1 = part.y2 = first.y;
+
+    for (size_t i = part.begin + 1; i < part.end; i++) {
+        const Point& p = this->points[i];
+        part.x1 = std::min(part.x1, p.x);
+        part.x2 = std::max(part.x2, p.x);
+        part.y1 = std::min(part.y1, p.y);
+        part.y2 = std::max(part.y2, p.y);
     }
+}
 
-    Point eraser(x, y);
+auto EraseableStroke::erase(double x, double y, double halfEraserSize, Part part, vector<Part>& result) -> bool {
+    if (isOutside(part.x1, part.y1, part.x2, part.y2, x, y, halfEraserSize)) {
+        result.push_back(part);
+        return false;
+    }
 
-    auto* a = static_cast<Point*>(g_list_first(part->points)->data);
-    auto* b = static_cast<Point*>(g_list_last(part->points)->data);
+    Point eraser(x, y);
 
-    if (eraser.lineLengthTo(*a) < halfEraserSize * 1.2 && eraser.lineLengthTo(*b) < halfEraserSize * 1.2) {
-        list->data = g_list_remove(list->data, part);
-        addRepaintRect(part->getX(), part->getY(), part->getElementWidth(), part->getElementHeight());
+    Point a = this->points[part.begin];
+    Point b = this->points[part.end - 1];
 
-        delete part;
-        return;
+    if (eraser.lineLengthTo(a) < halfEraserSize * 1.2 && eraser.lineLengthTo(b) < halfEraserSize * 1.2) {
+        addRepaintRect(part);
+        return true;
     }
 
     double x1 = x - halfEraserSize;
@@ -119,41 +171,19 @@ void EraseableStroke::erase(double x, double y, double halfEraserSize, Eraseable
     double y1 = y - halfEraserSize;
     double y2 = y + halfEraserSize;
 
-    double aX = a->x;
-    double aY = a->y;
-    double bX = b->x;
-    double bY = b->y;
+    double aX = a.x;
+    double aY = a.y;
+    double bX = b.x;
+    double bY = b.y;
 
     // check first point
     if (aX >= x1 && aY >= y1 && aX <= x2 && aY <= y2) {
-        bool deleteAfter = false;
-
-        if (erasePart(x, y, halfEraserSize, part, list, &deleteAfter)) {
-            addRepaintRect(part->getX(), part->getY(), part->getElementWidth(), part->getElementHeight());
-            part->calcSize();
-        }
-
-        if (deleteAfter) {
-            delete part;
-        }
-
-        return;
+        return erasePart(x, y, halfEraserSize, part, result);
     }
 
     // check last point
     if (bX >= x1 && bY >= y1 && bX <= x2 && bY <= y2) {
-        bool deleteAfter = false;
-
-        if (erasePart(x, y, halfEraserSize, part, list, &deleteAfter)) {
-            addRepaintRect(part->getX(), part->getY(), part->getElementWidth(), part->getElementHeight());
-            part->calcSize();
-        }
-
-        if (deleteAfter) {
-            delete part;
-        }
-
-        return;
+        return erasePart(x, y, halfEraserSize, part, result);
     }
 
     double len = hypot(bX - aX, bY - aY);
@@ -180,116 +210,129 @@ void EraseableStroke::erase(double x, double y, double halfEraserSize, Eraseable
         constexpr double PADDING = 0.1;
 
         if (distance <= len / 2 + PADDING) {
-            bool deleteAfter = false;
-
-            if (erasePart(x, y, halfEraserSize, part, list, &deleteAfter)) {
-                addRepaintRect(part->getX(), part->getY(), part->getElementWidth(), part->getElementHeight());
-                part->calcSize();
-            }
-
-            if (deleteAfter) {
-                delete part;
-            }
-
-            return;
+            return erasePart(x, y, halfEraserSize, part, result);
         }
     }
+
+    result.push_back(part);
+    return false;
 }
 
-auto EraseableStroke::erasePart(double x, double y, double halfEraserSize, EraseableStrokePart* part, PartList* list,
-                                bool* deleteStrokeAfter) -> bool {
-    bool changed = false;
+auto EraseableStroke::erasePart(double x, double y, double halfEraserSize, Part& part, vector<Part>& result)
+        -> bool {
+    // The bounds do not change by subdividing, they are repainted if something is erased
+    Part bounds = part;
 
-    part->splitFor(halfEraserSize);
+    splitFor(part, halfEraserSize);
 
     double x1 = x - halfEraserSize;
     double x2 = x + halfEraserSize;
     double y1 = y - halfEraserSize;
     double y2 = y + halfEraserSize;
 
+    bool changed = false;
+    size_t count = result.size();
+
     /**
-     * erase the beginning
+     * Split the range at the erased points, pieces with less than two points are not drawn and removed
      */
-    for (GList* l = part->getPoints(); l != nullptr;) {
-        auto* p = static_cast<Point*>(l->data);
-        l = l->next;
-        if (p->x >= x1 && p->y >= y1 && p->x <= x2 && p->y <= y2) {
-            part->points = g_list_remove(part->points, p);
-            delete p;
+    size_t runBegin = part.begin;
+    for (size_t i = part.begin; i < part.end; i++) {
+        const Point& p = this->points[i];
+        if (p.x >= x1 && p.y >= y1 && p.x <= x2 && p.y <= y2) {
+            if (i - runBegin >= 2) {
+                Part piece = part;
+                piece.begin = runBegin;
+                piece.end = i;
+                result.push_back(piece);
+            }
+            runBegin = i + 1;
             changed = true;
-        } else {
-            // only the beginning is handled here
-            break;
         }
     }
 
-    /**
-     * erase the end
-     */
-    for (GList* l = g_list_last(part->getPoints()); l != nullptr;) {
-        auto* p = static_cast<Point*>(l->data);
-        l = l->prev;
-        if (p->x >= x1 && p->y >= y1 && p->x <= x2 && p->y <= y2) {
-            part->points = g_list_remove(part->points, p);
-            delete p;
-            changed = true;
-        } else {
-            // only the end is handled here
-            break;
-        }
+    if (!changed) {
+        result.push_back(part);
+        return false;
     }
 
-    /**
-     * handle the rest
-     */
+    if (part.end - runBegin >= 2) {
+        Part piece = part;
+        piece.begin = runBegin;
+        result.push_back(piece);
+    }
 
-    GList* lists = nullptr;
-    GList* current = nullptr;
-
-    for (GList* l = part->points; l != nullptr;) {
-        auto* p = static_cast<Point*>(l->data);
-        l = l->next;
-        if (p->x >= x1 && p->y >= y1 && p->x <= x2 && p->y <= y2) {
-            part->points = g_list_remove(part->points, p);
-            delete p;
-            if (current) {
-                lists = g_list_append(lists, current);
-                current = nullptr;
-            }
-            changed = true;
-        } else {
-            current = g_list_append(current, p);
-        }
+    addRepaintRect(bounds);
+    for (size_t i = count; i < result.size(); i++) {
+        calcSize(result[i]);
     }
 
-    if (current) {
-        lists = g_list_append(lists, current);
-        current = nullptr;
+    return true;
+}
+
+void EraseableStroke::splitFor(Part& part, double halfEraserSize) {
+    if (halfEraserSize == part.splitSize) {
+        return;
     }
 
-    g_list_free(part->points);
-    part->points = nullptr;
-    if (lists) {
-        part->points = static_cast<GList*>(lists->data);
-        lists = g_list_delete_link(lists, lists);
+    part.splitSize = halfEraserSize;
 
-        int pos = g_list_index(list->data, part) + 1;
+    Point a = this->points[part.begin];
+    Point b = this->points[part.end - 1];
 
-        // create data structure for all new (splitted) parts
-        for (GList* l = lists; l != nullptr; l = l->next) {
-            auto* newPart = new EraseableStrokePart(part->width);
-            newPart->points = static_cast<GList*>(l->data);
-            list->data = g_list_insert(list->data, newPart, pos++);
-        }
+    double len = a.lineLengthTo(b);
 
-        g_list_free(lists);
-    } else {
-        // no parts, all deleted
-        list->data = g_list_remove(list->data, part);
-        *deleteStrokeAfter = true;
+    // nothing to do, the size is enough small
+    if (len <= halfEraserSize) {
+        return;
     }
 
-    return changed;
+    double step = halfEraserSize / 2;
+    auto count = static_cast<size_t>(std::ceil(len / step)) - 1;
+
+    // The subdivided segment is appended, the old range is left unused
+    size_t begin = this->points.size();
+    this->points.reserve(begin + count + 2);
+    this->points.push_back(a);
+    for (size_t i = count; i > 0; i--) {
+        this->points.push_back(a.lineTo(b, len - static_cast<double>(i - 1) * step));
+    }
+    this->points.push_back(b);
+
+    part.begin = begin;
+    part.end = this->points.size();
+}
+
+void EraseableStroke::compact() {
+    vector<Point> compacted;
+    compacted.reserve(this->usedPoints);
+    for (Part& part: this->parts) {
+        size_t begin = compacted.size();
+        compacted.insert(compacted.end(), this->points.begin() + static_cast<ptrdiff_t>(part.begin),
+                         this->points.begin() + static_cast<ptrdiff_t>(part.end));
+        part.begin = begin;
+        part.end = compacted.size();
+    }
+    this->points = std::move(compacted);
+}
+
+void EraseableStroke::publish() {
+    // The spare buffer may still be drawn by a render thread which took it before the last publish()
+    if (!this->spareBuffer || this->spareBuffer.use_count() > 1) {
+        this->spareBuffer = std::make_shared<DrawBuffer>();
+    }
+
+    DrawBuffer& buffer = *this->spareBuffer;
+    buffer.points.clear();
+    buffer.parts.clear();
+    for (const Part& part: this->parts) {
+        buffer.points.insert(buffer.points.end(), this->points.begin() + static_cast<ptrdiff_t>(part.begin),
+                             this->points.begin() + static_cast<ptrdiff_t>(part.end));
+        buffer.parts.emplace_back(buffer.points.size(), part.width);
+    }
+
+    std::lock_guard<std::mutex> lock(this->drawBufferMutex);
+    std::swap(this->drawBuffer, this->spareBuffer);
 }
 
 auto EraseableStroke::getStroke(Stroke* original) -> GList* {
@@ -297,16 +340,10 @@ auto EraseableStroke::getStroke(Stroke* original) -> GList* {
 
     Stroke* s = nullptr;
     Point lastPoint(NAN, NAN);
-    for (GList* l = this->parts->data; l != nullptr; l = l->next) {
-        auto* p = static_cast<EraseableStrokePart*>(l->data);
-        GList* points = p->getPoints();
-        if (g_list_length(points) < 2) {
-            continue;
-        }
-
-        Point a = *(static_cast<Point*>(g_list_first(points)->data));
-        Point b = *(static_cast<Point*>(g_list_last(points)->data));
-        a.z = p->width;
+    for (const Part& part: this->parts) {
+        Point a = this->points[part.begin];
+        Point b = this->points[part.end - 1];
+        a.z = part.width;
 
         if (!lastPoint.equalsPos(a) || s == nullptr) {
             if (s) {
@@ -11,7 +11,10 @@
 
 #pragma once
 
+#include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <gtk/gtk.h>
@@ -20,11 +23,20 @@
 
 #include "XournalType.h"
 
-class EraseableStrokePart;
-class PartList;
 class Range;
 class Stroke;
 
+/**
+ * Each segment of the stroke is a part, which is split into smaller parts while it is erased.
+ *
+ * The points of all parts are stored in one array, a part is a range of it. Erasing moves the
+ * bounds of a range or splits it into several ranges, without copying points. Only if a segment
+ * is subdivided for the eraser size the new points are appended, the array is compacted once
+ * most of it is unused.
+ *
+ * Erasing is done in the main loop, drawing in the render threads. After each erase a copy of the
+ * parts is published for drawing, two buffers are alternated so they can be reused.
+ */
 class EraseableStroke {
 public:
     EraseableStroke(Stroke* stroke);
@@ -41,15 +53,83 @@ public:
     void draw(cairo_t* cr);
 
 private:
-    void erase(double x, double y, double halfEraserSize, EraseableStrokePart* part, PartList* list);
-    static bool erasePart(double x, double y, double halfEraserSize, EraseableStrokePart* part, PartList* list,
-                          bool* deleteStrokeAfter);
+    struct Part {
+        /**
+         * The range of the part in points, [begin, end)
+         */
+        size_t begin = 0;
+        size_t end = 0;
+
+        double width = 0;
+
+        /**
+         * The eraser size the segment was subdivided for, 0 if it is not
+         */
+        double splitSize = 0;
+
+        double x1 = 0;
+        double y1 = 0;
+        double x2 = 0;
+        double y2 = 0;
+
+        size_t size() const { return end - begin; }
+    };
+
+    /**
+     * A copy of the parts for drawing
+     */
+    struct DrawBuffer {
+        vector<Point> points;
+
+        /**
+         * The end of the part in points and its width
+         */
+        vector<std::pair<size_t, double>> parts;
+    };
+
+    /**
+     * Erases from part and appends what is left of it to result
+     *
+     * @return True if the part was changed
+     */
+    bool erase(double x, double y, double halfEraserSize, Part part, vector<Part>& result);
+    bool erasePart(double x, double y, double halfEraserSize, Part& part, vector<Part>& result);
+
+    /**
+     * Subdivides the segment of a part, so single points of it can be erased
+     */
+    void splitFor(Part& part, double halfEraserSize);
+
+    void calcSize(Part& part) const;
+    void addRepaintRect(const Part& part);
+
+    /**
+     * Rewrites points with only the ranges of the parts
+     */
+    void compact();
 
-    void addRepaintRect(double x, double y, double width, double height);
+    /**
+     * Copies the parts into the unused draw buffer and makes it the one which is drawn
+     */
+    void publish();
 
 private:
-    GMutex partLock{};
-    PartList* parts = nullptr;
+    vector<Point> points;
+    vector<Part> parts;
+
+    /**
+     * The number of points in the ranges of the parts
+     */
+    size_t usedPoints = 0;
+
+    /**
+     * Reused to collect the parts while erasing
+     */
+    vector<Part> nextParts;
+
+    std::mutex drawBufferMutex;
+    std::shared_ptr<DrawBuffer> drawBuffer;
+    std::shared_ptr<DrawBuffer> spareBuffer;
 
     Range* repaintRect = nullptr;
 
@@ -1,19 +1,22 @@
 #include "XojCairoPdfExport.h"
 
-#include <map>
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
 #include <sstream>
-#include <stack>
+#include <utility>
 
 #include <cairo/cairo-pdf.h>
 
 #include "view/DocumentView.h"
 
+#include "ThreadPool.h"
 #include "Util.h"
 #include "filesystem.h"
 #include "i18n.h"
 
-XojCairoPdfExport::XojCairoPdfExport(Document* doc, ProgressListener* progressListener):
-        doc(doc), progressListener(progressListener) {}
+XojCairoPdfExport::XojCairoPdfExport(std::shared_ptr<DocumentSnapshot> snapshot, ProgressListener* progressListener):
+        snapshot(std::move(snapshot)), progressListener(progressListener) {}
 
 XojCairoPdfExport::~XojCairoPdfExport() {
     if (this->surface != nullptr) {
@@ -28,78 +31,69 @@ void XojCairoPdfExport::setNoBackgroundExport(bool noBackgroundExport) {
     this->noBackgroundExport = noBackgroundExport;
 }
 
+/**
+ * Render the pages on this count of threads
+ */
+void XojCairoPdfExport::setWorkerCount(unsigned int workerCount) { this->workerCount = std::max(workerCount, 1U); }
+
+auto XojCairoPdfExport::getRenderTime() const -> double { return this->renderTime / 1e6; }
+
+auto XojCairoPdfExport::getEncodeTime() const -> double { return this->encodeTime / 1e6; }
+
 auto XojCairoPdfExport::startPdf(const fs::path& file) -> bool {
     this->surface = cairo_pdf_surface_create(file.u8string().c_str(), 0, 0);
     this->cr = cairo_create(surface);
 
 #if CAIRO_VERSION >= CAIRO_VERSION_ENCODE(1, 16, 0)
-    cairo_pdf_surface_set_metadata(surface, CAIRO_PDF_METADATA_TITLE, doc->getFilepath().filename().u8string().c_str());
-    GtkTreeModel* tocModel = doc->getContentsModel();
-    this->populatePdfOutline(tocModel);
+    cairo_pdf_surface_set_metadata(surface, CAIRO_PDF_METADATA_TITLE,
+                                   snapshot->getFilepath().filename().u8string().c_str());
+    this->populatePdfOutline();
 #endif
 
     return true;
 }
 
 #if CAIRO_VERSION >= CAIRO_VERSION_ENCODE(1, 16, 0)
-void XojCairoPdfExport::populatePdfOutline(GtkTreeModel* tocModel) {
-    if (tocModel == nullptr)
-        return;
-
-    int idCounter = CAIRO_PDF_OUTLINE_ROOT;
-    std::stack<std::pair<GtkTreeIter, int>> nodeStack;
-
-    GtkTreeIter firstIter = {0};
-    if (!gtk_tree_model_get_iter_first(tocModel, &firstIter)) {
-        // Outline is empty, so do nothing.
-        return;
-    }
-
-    nodeStack.push(std::make_pair(firstIter, idCounter));
-    while (!nodeStack.empty()) {
-        auto [iter, parentId] = nodeStack.top();
-        nodeStack.pop();
-        const int currentId = ++idCounter;
-        XojLinkDest* link = nullptr;
-
-        gtk_tree_model_get(tocModel, &iter, DOCUMENT_LINKS_COLUMN_LINK, &link, -1);
-        auto dest = link->dest;
-        auto pdfBgPage = dest->getPdfPage();  // Link destination in original background PDF
-        auto pageDest = pdfBgPage == npos ? npos : doc->findPdfPage(pdfBgPage);  // Destination in document
-        if (pageDest != npos) {
-            std::ostringstream linkAttrBuf;
-            linkAttrBuf << "page=" << pageDest + 1;
-            if (dest->shouldChangeLeft() && dest->shouldChangeTop()) {
-                linkAttrBuf << " pos=[" << dest->getLeft() << " " << dest->getTop() << "]";
-            }
-            const auto linkAttr = linkAttrBuf.str();
-            auto outlineFlags = dest->getExpand() ? CAIRO_PDF_OUTLINE_FLAG_OPEN : 0;
-            cairo_pdf_surface_add_outline(this->surface, parentId, link->dest->getName().data(), linkAttr.data(),
-                                          static_cast<cairo_pdf_outline_flags_t>(outlineFlags));
+void XojCairoPdfExport::populatePdfOutline() {
+    const auto& outline = snapshot->getOutline();
+
+    // The id of each entry in the PDF, entries which are not added pass the id of their parent on
+    std::vector<int> ids(outline.size());
+    for (size_t i = 0; i < outline.size(); i++) {
+        const DocumentSnapshot::OutlineEntry& entry = outline[i];
+        int parentId = entry.parent == npos ? CAIRO_PDF_OUTLINE_ROOT : ids[entry.parent];
+
+        if (entry.page == npos) {
+            ids[i] = parentId;
+            continue;
         }
-        g_object_unref(link);
 
-        GtkTreeIter childIter;
-        if (gtk_tree_model_iter_children(tocModel, &childIter, &iter)) {
-            nodeStack.push(std::make_pair(childIter, currentId));
-        }
-
-        if (gtk_tree_model_iter_next(tocModel, &iter)) {
-            nodeStack.push(std::make_pair(iter, parentId));
+        std::ostringstream linkAttrBuf;
+        linkAttrBuf << "page=" << entry.page + 1;
+        if (entry.hasPosition) {
+            linkAttrBuf << " pos=[" << entry.left << " " << entry.top << "]";
         }
+        const auto linkAttr = linkAttrBuf.str();
+        auto outlineFlags = entry.expand ? CAIRO_PDF_OUTLINE_FLAG_OPEN : 0;
+        ids[i] = cairo_pdf_surface_add_outline(this->surface, parentId, entry.name.c_str(), linkAttr.c_str(),
+                                               static_cast<cairo_pdf_outline_flags_t>(outlineFlags));
     }
 }
 #endif
 
 void XojCairoPdfExport::endPdf() {
+    // The PDF surface writes the remaining objects when it is destroyed
+    gint64 start = g_get_monotonic_time();
     cairo_destroy(this->cr);
     this->cr = nullptr;
     cairo_surface_destroy(this->surface);
     this->surface = nullptr;
+    this->encodeTime += g_get_monotonic_time() - start;
 }
 
 void XojCairoPdfExport::exportPage(size_t page) {
-    PageRef p = doc->getPage(page);
+    gint64 renderStart = g_get_monotonic_time();
+    PageRef p = snapshot->getPage(page);
 
     cairo_pdf_surface_set_size(this->surface, p->getWidth(), p->getHeight());
 
@@ -108,7 +102,7 @@ void XojCairoPdfExport::exportPage(size_t page) {
     cairo_save(this->cr);
     if (p->getBackgroundType().isPdfPage() && !noBackgroundExport) {
         int pgNo = p->getPdfPageNr();
-        XojPdfPageSPtr popplerPage = doc->getPdfPage(pgNo);
+        XojPdfPageSPtr popplerPage = snapshot->getPdfDocument().getPage(pgNo);
 
         popplerPage->render(cr, true);
     }
@@ -116,30 +110,168 @@ void XojCairoPdfExport::exportPage(size_t page) {
     view.drawPage(p, this->cr, true /* dont render eraseable */, noBackgroundExport);
 
     // next page
+    gint64 encodeStart = g_get_monotonic_time();
+    this->renderTime += encodeStart - renderStart;
     cairo_show_page(this->cr);
     cairo_restore(this->cr);
+    this->encodeTime += g_get_monotonic_time() - encodeStart;
 }
 
-// export layers one by one to produce as many PDF pages as there are layers.
-void XojCairoPdfExport::exportPageLayers(size_t page) {
-    PageRef p = doc->getPage(page);
+auto XojCairoPdfExport::recordPage(size_t page, bool presentationMode) -> std::vector<cairo_surface_t*> {
+    gint64 start = g_get_monotonic_time();
+    PageRef p = snapshot->getPage(page);
+    std::vector<cairo_surface_t*> recordings;
+
+    // In presentation mode the first PDF page only contains Layer 1, the last all layers.
+    // The layer visibility of the page is not touched, the page is shared with other snapshots.
+    size_t steps = presentationMode ? p->getLayerCount() : 1;
+
+    cairo_rectangle_t extents = {0, 0, p->getWidth(), p->getHeight()};
+
+    for (size_t step = 1; step <= steps; step++) {
+        cairo_surface_t* recording = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, &extents);
+        cairo_t* recordingCr = cairo_create(recording);
+
+        DocumentView view;
+        view.setPopplerMutex(&this->popplerMutex);
+        if (presentationMode) {
+            view.initDrawing(p, recordingCr, true);
+
+            bool backgroundVisible = p->isLayerVisible(0);
+            if (!noBackgroundExport && backgroundVisible) {
+                view.drawBackground();
+            }
+            if (!backgroundVisible) {
+                view.drawTransparentBackgroundPattern();
+            }
+
+            for (size_t i = 0; i < step; i++) {
+                view.drawLayer(recordingCr, (*p->getLayers())[i]);
+            }
+
+            view.finializeDrawing();
+        } else {
+            view.drawPage(p, recordingCr, true /* dont render eraseable */, noBackgroundExport);
+        }
 
-    // We keep a copy of the layers initial Visible state
-    std::map<Layer*, bool> initialVisibility;
-    for (const auto& layer: *p->getLayers()) {
-        initialVisibility[layer] = layer->isVisible();
-        layer->setVisible(false);
+        cairo_destroy(recordingCr);
+        recordings.push_back(recording);
     }
 
-    // We draw as many pages as there are layers. The first page has
-    // only Layer 1 visible, the last has all layers visible.
-    for (const auto& layer: *p->getLayers()) {
-        layer->setVisible(true);
-        exportPage(page);
+    this->renderTime += g_get_monotonic_time() - start;
+    return recordings;
+}
+
+void XojCairoPdfExport::writeRecordedPage(size_t page, std::vector<cairo_surface_t*>& recordings) {
+    gint64 start = g_get_monotonic_time();
+    PageRef p = snapshot->getPage(page);
+
+    for (cairo_surface_t* recording: recordings) {
+        cairo_pdf_surface_set_size(this->surface, p->getWidth(), p->getHeight());
+
+        cairo_save(this->cr);
+
+        // The background is rendered here, while the workers may render TeX images
+        if (p->getBackgroundType().isPdfPage() && !noBackgroundExport) {
+            std::lock_guard<std::mutex> lock(this->popplerMutex);
+            int pgNo = p->getPdfPageNr();
+            XojPdfPageSPtr popplerPage = snapshot->getPdfDocument().getPage(pgNo);
+
+            popplerPage->render(cr, true);
+        }
+
+        cairo_set_source_surface(this->cr, recording, 0, 0);
+        cairo_paint(this->cr);
+
+        // next page
+        cairo_show_page(this->cr);
+        cairo_restore(this->cr);
+
+        cairo_surface_destroy(recording);
     }
+    recordings.clear();
 
-    // We restore the initial visibilities
-    for (const auto& layer: *p->getLayers()) layer->setVisible(initialVisibility[layer]);
+    // Includes the PDF background, which is drawn directly into the PDF
+    this->encodeTime += g_get_monotonic_time() - start;
+}
+
+void XojCairoPdfExport::exportPagesParallel(const std::vector<size_t>& pages, bool presentationMode) {
+    ThreadPool pool(this->workerCount);
+
+    std::mutex resultMutex;
+    std::condition_variable pageRecorded;
+    std::vector<std::vector<cairo_surface_t*>> results(pages.size());
+    std::vector<bool> recorded(pages.size(), false);
+    int finishedCount = 0;
+
+    auto addPage = [&](size_t n) {
+        pool.addTask([&, n]() {
+            auto recordings = recordPage(pages[n], presentationMode);
+
+            int state = 0;
+            {
+                std::lock_guard<std::mutex> lock(resultMutex);
+                results[n] = std::move(recordings);
+                recorded[n] = true;
+                state = finishedCount++;
+            }
+            pageRecorded.notify_all();
+
+            if (this->progressListener) {
+                this->progressListener->setCurrentState(state);
+            }
+        });
+    };
+
+    // Limit the count of recorded pages waiting to be written, to bound the memory usage
+    size_t window = 2 * static_cast<size_t>(pool.getThreadCount());
+    size_t added = 0;
+    for (; added < pages.size() && added < window; added++) {
+        addPage(added);
+    }
+
+    // The PDF is written in page order, while the next pages are recorded
+    for (size_t n = 0; n < pages.size(); n++) {
+        std::vector<cairo_surface_t*> recordings;
+        {
+            std::unique_lock<std::mutex> lock(resultMutex);
+            pageRecorded.wait(lock, [&]() { return static_cast<bool>(recorded[n]); });
+            recordings = std::move(results[n]);
+        }
+
+        if (added < pages.size()) {
+            addPage(added++);
+        }
+
+        writeRecordedPage(pages[n], recordings);
+    }
+
+    pool.waitAll();
+}
+
+void XojCairoPdfExport::exportPages(const std::vector<size_t>& pages, bool presentationMode) {
+    if (this->progressListener) {
+        this->progressListener->setMaximumState(pages.size());
+    }
+
+    if (this->workerCount > 1 && pages.size() > 1) {
+        exportPagesParallel(pages, presentationMode);
+        return;
+    }
+
+    int c = 0;
+    for (size_t i: pages) {
+        if (presentationMode) {
+            auto recordings = recordPage(i, true);
+            writeRecordedPage(i, recordings);
+        } else {
+            exportPage(i);
+        }
+
+        if (this->progressListener) {
+            this->progressListener->setCurrentState(c++);
+        }
+    }
 }
 
 auto XojCairoPdfExport::createPdf(fs::path const& file, PageRangeVector& range, bool presentationMode) -> bool {
@@ -152,40 +284,24 @@ auto XojCairoPdfExport::createPdf(fs::path const& file, PageRangeVector& range,
         return false;
     }
 
-    int count = 0;
-    for (PageRangeEntry* e: range) {
-        count += e->getLast() - e->getFirst() + 1;
-    }
-
-    if (this->progressListener) {
-        this->progressListener->setMaximumState(count);
-    }
-
-    int c = 0;
+    std::vector<size_t> pages;
     for (PageRangeEntry* e: range) {
         for (int i = e->getFirst(); i <= e->getLast(); i++) {
-            if (i < 0 || i >= static_cast<int>(doc->getPageCount())) {
+            if (i < 0 || i >= static_cast<int>(snapshot->getPageCount())) {
                 continue;
             }
-
-            if (presentationMode) {
-                exportPageLayers(i);
-            } else {
-                exportPage(i);
-            }
-
-            if (this->progressListener) {
-                this->progressListener->setCurrentState(c++);
-            }
+            pages.push_back(i);
         }
     }
 
+    exportPages(pages, presentationMode);
+
     endPdf();
     return true;
 }
 
 auto XojCairoPdfExport::createPdf(fs::path const& file, bool presentationMode) -> bool {
-    if (doc->getPageCount() < 1) {
+    if (snapshot->getPageCount() < 1) {
         lastError = _("No pages to export!");
         return false;
     }
@@ -194,23 +310,12 @@ auto XojCairoPdfExport::createPdf(fs::path const& file, bool presentationMode) -
         return false;
     }
 
-    int count = doc->getPageCount();
-    if (this->progressListener) {
-        this->progressListener->setMaximumState(count);
+    std::vector<size_t> pages(snapshot->getPageCount());
+    for (size_t i = 0; i < pages.size(); i++) {
+        pages[i] = i;
     }
 
-    for (int i = 0; i < count; i++) {
-
-        if (presentationMode) {
-            exportPageLayers(i);
-        } else {
-            exportPage(i);
-        }
-
-        if (this->progressListener) {
-            this->progressListener->setCurrentState(i);
-        }
-    }
+    exportPages(pages, presentationMode);
 
     endPdf();
     return true;
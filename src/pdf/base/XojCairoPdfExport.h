@@ -11,15 +11,20 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 #include "control/jobs/ProgressListener.h"
-#include "model/Document.h"
+#include "model/DocumentSnapshot.h"
 
 #include "XojPdfExport.h"
 #include "filesystem.h"
 
 class XojCairoPdfExport: public XojPdfExport {
 public:
-    XojCairoPdfExport(Document* doc, ProgressListener* progressListener);
+    XojCairoPdfExport(std::shared_ptr<DocumentSnapshot> snapshot, ProgressListener* progressListener);
     virtual ~XojCairoPdfExport();
 
 public:
@@ -32,6 +37,14 @@ public:
      */
     virtual void setNoBackgroundExport(bool noBackgroundExport);
 
+    /**
+     * Render the pages on this count of threads, 1 exports the pages one after another
+     */
+    virtual void setWorkerCount(unsigned int workerCount);
+
+    virtual double getRenderTime() const;
+    virtual double getEncodeTime() const;
+
 private:
     bool startPdf(const fs::path& file);
 #if CAIRO_VERSION >= CAIRO_VERSION_ENCODE(1, 16, 0)
@@ -40,20 +53,36 @@ private:
      * background PDF.
      *
      * This requires features available only in cairo 1.16 or newer.
-     *
-     * @param tocModel The Document's content model. Does nothing if set to null.
      */
-    void populatePdfOutline(GtkTreeModel* tocModel);
+    void populatePdfOutline();
 #endif
     void endPdf();
     void exportPage(size_t page);
+
     /**
-     * Export as a PDF document where each additional layer creates a
-     * new page */
-    void exportPageLayers(size_t page);
+     * Exports the pages in the given order, on several threads if workerCount > 1
+     */
+    void exportPages(const std::vector<size_t>& pages, bool presentationMode);
+
+    /**
+     * Renders the pages into recording surfaces on a thread pool and writes them in order to the PDF
+     */
+    void exportPagesParallel(const std::vector<size_t>& pages, bool presentationMode);
+
+    /**
+     * Records the annotations of a page, without the PDF background. This is called from the worker threads.
+     *
+     * @return One recording surface per PDF page to create (one per layer in presentation mode)
+     */
+    std::vector<cairo_surface_t*> recordPage(size_t page, bool presentationMode);
+
+    /**
+     * Writes the recorded PDF pages of a page and destroys the recordings
+     */
+    void writeRecordedPage(size_t page, std::vector<cairo_surface_t*>& recordings);
 
 private:
-    Document* doc = nullptr;
+    std::shared_ptr<DocumentSnapshot> snapshot;
     ProgressListener* progressListener = nullptr;
 
     cairo_surface_t* surface = nullptr;
@@ -61,5 +90,19 @@ private:
 
     bool noBackgroundExport = false;
 
+    unsigned int workerCount = 1;
+
+    /**
+     * Poppler is not thread safe, the PDF backgrounds and the TeX images recorded by the workers are rendered
+     * one after another
+     */
+    std::mutex popplerMutex;
+
+    /**
+     * Time spent drawing the pages and writing them to the PDF, in microseconds
+     */
+    std::atomic<gint64> renderTime{0};
+    std::atomic<gint64> encodeTime{0};
+
     string lastError;
 };
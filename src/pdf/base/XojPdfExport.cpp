@@ -10,3 +10,14 @@ XojPdfExport::~XojPdfExport() = default;
 void XojPdfExport::setNoBackgroundExport(bool noBackgroundExport) {
     // Does nothing in the base class
 }
+
+/**
+ * Render the pages on this count of threads
+ */
+void XojPdfExport::setWorkerCount(unsigned int workerCount) {
+    // Does nothing in the base class
+}
+
+auto XojPdfExport::getRenderTime() const -> double { return 0; }
+
+auto XojPdfExport::getEncodeTime() const -> double { return 0; }
@@ -33,5 +33,16 @@ public:
      */
     virtual void setNoBackgroundExport(bool noBackgroundExport);
 
+    /**
+     * Render the pages on this count of threads, 1 exports the pages one after another
+     */
+    virtual void setWorkerCount(unsigned int workerCount);
+
+    /**
+     * The time spent drawing the pages and writing the PDF, in seconds. Drawing is summed over all workers.
+     */
+    virtual double getRenderTime() const;
+    virtual double getEncodeTime() const;
+
 private:
 };
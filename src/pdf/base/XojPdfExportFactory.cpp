@@ -1,5 +1,7 @@
 #include "XojPdfExportFactory.h"
 
+#include <utility>
+
 #include <config-features.h>
 
 #include "XojCairoPdfExport.h"
@@ -8,6 +10,7 @@ XojPdfExportFactory::XojPdfExportFactory() = default;
 
 XojPdfExportFactory::~XojPdfExportFactory() = default;
 
-auto XojPdfExportFactory::createExport(Document* doc, ProgressListener* listener) -> XojPdfExport* {
-    return new XojCairoPdfExport(doc, listener);
+auto XojPdfExportFactory::createExport(std::shared_ptr<DocumentSnapshot> snapshot, ProgressListener* listener)
+        -> XojPdfExport* {
+    return new XojCairoPdfExport(std::move(snapshot), listener);
 }
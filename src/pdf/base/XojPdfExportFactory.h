@@ -11,13 +11,14 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "XojPdfExport.h"
 #include "XournalType.h"
 
-class Document;
+class DocumentSnapshot;
 class ProgressListener;
 
 class XojPdfExportFactory {
@@ -26,7 +27,10 @@ private:
     virtual ~XojPdfExportFactory();
 
 public:
-    static XojPdfExport* createExport(Document* doc, ProgressListener* listener);
+    /**
+     * The pages are rendered from the snapshot, the document does not need to be locked while exporting
+     */
+    static XojPdfExport* createExport(std::shared_ptr<DocumentSnapshot> snapshot, ProgressListener* listener);
 
 private:
 };
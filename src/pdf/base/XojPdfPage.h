@@ -45,6 +45,12 @@ public:
 
     virtual vector<XojPdfRectangle> findText(string& text) = 0;
 
+    /**
+     * Extracts the text of the page, with the bounding box of each character
+     * (same length as text, in page coordinates)
+     */
+    virtual void getTextLayout(std::u32string& text, vector<XojPdfRectangle>& glyphs) = 0;
+
     virtual int getPageId() = 0;
 
 private:
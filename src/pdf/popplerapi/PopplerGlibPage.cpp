@@ -1,5 +1,7 @@
 #include "PopplerGlibPage.h"
 
+#include <algorithm>
+
 
 PopplerGlibPage::PopplerGlibPage(PopplerPage* page): page(page) {
     if (page != nullptr) {
@@ -78,3 +80,31 @@ auto PopplerGlibPage::findText(string& text) -> vector<XojPdfRectangle> {
 
     return findings;
 }
+
+void PopplerGlibPage::getTextLayout(std::u32string& text, vector<XojPdfRectangle>& glyphs) {
+    text.clear();
+    glyphs.clear();
+
+    char* utf8 = poppler_page_get_text(page);
+    PopplerRectangle* rects = nullptr;
+    guint rectCount = 0;
+    if (utf8 == nullptr || !poppler_page_get_text_layout(page, &rects, &rectCount)) {
+        g_free(utf8);
+        return;
+    }
+
+    glong length = 0;
+    gunichar* chars = g_utf8_to_ucs4_fast(utf8, -1, &length);
+    g_free(utf8);
+
+    // There is one rectangle per character, the text layout uses the same orientation as the page
+    size_t count = std::min(static_cast<size_t>(length), static_cast<size_t>(rectCount));
+    text.assign(chars, chars + count);
+    glyphs.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        glyphs.emplace_back(rects[i].x1, rects[i].y1, rects[i].x2, rects[i].y2);
+    }
+
+    g_free(chars);
+    g_free(rects);
+}
@@ -31,6 +31,8 @@ public:
 
     virtual vector<XojPdfRectangle> findText(string& text);
 
+    virtual void getTextLayout(std::u32string& text, vector<XojPdfRectangle>& glyphs);
+
     virtual int getPageId();
 
 private:
@@ -0,0 +1,144 @@
+#include "LuaValue.h"
+
+#ifdef ENABLE_PLUGINS
+
+#include <new>
+#include <utility>
+
+extern "C" {
+#include <lauxlib.h>
+}
+
+/**
+ * Tables nested deeper are most likely cyclic
+ */
+constexpr int MAX_DEPTH = 64;
+
+auto LuaValue::fromLua(lua_State* L, int idx, std::string& error) -> LuaValue {
+    LuaValue value;
+    if (!value.read(L, lua_absindex(L, idx), 0, error)) {
+        return LuaValue();
+    }
+    return value;
+}
+
+auto LuaValue::table() -> LuaValue {
+    LuaValue value;
+    value.type = Type::Table;
+    return value;
+}
+
+auto LuaValue::fromString(std::string value) -> LuaValue {
+    LuaValue result;
+    result.type = Type::String;
+    result.str = std::move(value);
+    return result;
+}
+
+void LuaValue::append(LuaValue value) {
+    LuaValue key;
+    key.type = Type::Integer;
+    key.integer = static_cast<lua_Integer>(this->keys.size() + 1);
+
+    this->keys.push_back(std::move(key));
+    this->values.push_back(std::move(value));
+}
+
+auto LuaValue::read(lua_State* L, int idx, int depth, std::string& error) -> bool {
+    switch (lua_type(L, idx)) {
+        case LUA_TNIL:
+            this->type = Type::Nil;
+            return true;
+        case LUA_TBOOLEAN:
+            this->type = Type::Boolean;
+            this->boolean = lua_toboolean(L, idx);
+            return true;
+        case LUA_TNUMBER:
+            if (lua_isinteger(L, idx)) {
+                this->type = Type::Integer;
+                this->integer = lua_tointeger(L, idx);
+            } else {
+                this->type = Type::Number;
+                this->number = lua_tonumber(L, idx);
+            }
+            return true;
+        case LUA_TSTRING: {
+            size_t len = 0;
+            const char* s = lua_tolstring(L, idx, &len);
+            this->type = Type::String;
+            this->str.assign(s, len);
+            return true;
+        }
+        case LUA_TUSERDATA: {
+            auto* p = static_cast<std::vector<Point>*>(luaL_testudata(L, idx, LUA_POINTS_METATABLE));
+            if (p == nullptr) {
+                error = "userdata cannot be passed to another Lua state";
+                return false;
+            }
+            this->type = Type::Points;
+            this->points = *p;
+            return true;
+        }
+        case LUA_TTABLE:
+            if (depth >= MAX_DEPTH) {
+                error = "tables are nested too deeply, or contain a cycle";
+                return false;
+            }
+
+            this->type = Type::Table;
+            lua_pushnil(L);
+            while (lua_next(L, idx) != 0) {
+                LuaValue key;
+                LuaValue value;
+                if (!key.read(L, lua_absindex(L, -2), depth + 1, error) ||
+                    !value.read(L, lua_absindex(L, -1), depth + 1, error)) {
+                    lua_pop(L, 2);
+                    return false;
+                }
+                this->keys.push_back(std::move(key));
+                this->values.push_back(std::move(value));
+                lua_pop(L, 1);
+            }
+            return true;
+        default:
+            error = std::string(luaL_typename(L, idx)) + " values cannot be passed to another Lua state";
+            return false;
+    }
+}
+
+void LuaValue::push(lua_State* L) const {
+    switch (this->type) {
+        case Type::Nil:
+            lua_pushnil(L);
+            break;
+        case Type::Boolean:
+            lua_pushboolean(L, this->boolean);
+            break;
+        case Type::Integer:
+            lua_pushinteger(L, this->integer);
+            break;
+        case Type::Number:
+            lua_pushnumber(L, this->number);
+            break;
+        case Type::String:
+            lua_pushlstring(L, this->str.data(), this->str.size());
+            break;
+        case Type::Points:
+            new (lua_newuserdata(L, sizeof(std::vector<Point>))) std::vector<Point>(this->points);
+            luaL_setmetatable(L, LUA_POINTS_METATABLE);
+            break;
+        case Type::Table:
+            luaL_checkstack(L, 3, "LuaValue::push");
+            lua_createtable(L, 0, static_cast<int>(this->keys.size()));
+            for (size_t i = 0; i < this->keys.size(); i++) {
+                this->keys[i].push(L);
+                this->values[i].push(L);
+                lua_rawset(L, -3);
+            }
+            break;
+    }
+}
+
+auto LuaValue::getType() const -> Type { return this->type; }
+
+#endif
@@ -0,0 +1,86 @@
+/*
+ * Xournal++
+ *
+ * A Lua value which can be passed between Lua states
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include "config-features.h"
+
+#ifdef ENABLE_PLUGINS
+
+#include <string>
+#include <vector>
+
+#include "model/Point.h"
+
+extern "C" {
+#include <lua.h>
+}
+
+/**
+ * Name of the metatable of point buffers, see luapi_application.h
+ */
+constexpr const char* LUA_POINTS_METATABLE = "Xournalpp.Points";
+
+/**
+ * A deep copy of nil, booleans, numbers, strings, point buffers and tables of these. Lua states
+ * cannot share values, so data passed between the UI and a background Lua state is copied.
+ */
+class LuaValue final {
+public:
+    enum class Type { Nil, Boolean, Integer, Number, String, Table, Points };
+
+public:
+    LuaValue() = default;
+
+    /**
+     * Copies the value at index idx of the Lua stack
+     *
+     * @param error Set if the value contains a function, a thread, another userdata or a cycle
+     */
+    static auto fromLua(lua_State* L, int idx, std::string& error) -> LuaValue;
+
+    /**
+     * @return An empty table
+     */
+    static auto table() -> LuaValue;
+
+    static auto fromString(std::string value) -> LuaValue;
+
+    /**
+     * Appends a value to the sequence of a table
+     */
+    void append(LuaValue value);
+
+    /**
+     * Pushes a copy of the value to the Lua stack
+     */
+    void push(lua_State* L) const;
+
+    auto getType() const -> Type;
+
+private:
+    auto read(lua_State* L, int idx, int depth, std::string& error) -> bool;
+
+private:
+    Type type = Type::Nil;
+
+    bool boolean = false;
+    lua_Integer integer = 0;
+    lua_Number number = 0;
+    std::string str;
+
+    std::vector<LuaValue> keys;
+    std::vector<LuaValue> values;
+
+    std::vector<Point> points;
+};
+
+#endif
@@ -1,8 +1,12 @@
 #include "Plugin.h"
 #ifdef ENABLE_PLUGINS
 
+#include <algorithm>
 #include <utility>
 
+#include "control/Control.h"
+
+#include "PluginWorkerJob.h"
 #include "config.h"
 #include "i18n.h"
 
@@ -13,6 +17,7 @@ extern "C" {
 }
 
 #include "luapi_application.h"
+#include "luapi_worker.h"
 
 /*
  ** these libs are loaded by lua.c and are readily available to any Lua
@@ -25,6 +30,8 @@ Plugin::Plugin(Control* control, std::string name, fs::path path):
     loadIni();
 }
 
+Plugin::~Plugin() { cancelBackgroundJobs(); }
+
 auto Plugin::getPluginFromLua(lua_State* lua) -> Plugin* {
     lua_getfield(lua, LUA_REGISTRYINDEX, "Xournalpp_Plugin");
 
@@ -160,29 +167,38 @@ void Plugin::registerXournalppLibs(lua_State* luaPtr) {
     }
 }
 
-void Plugin::addPluginToLuaPath() {
-    lua_getglobal(lua.get(), "package");
+void Plugin::initWorkerLua(lua_State* luaPtr, fs::path const& pluginPath) {
+    luaL_openlibs(luaPtr);
+
+    luaL_requiref(luaPtr, "worker", luaopen_worker, 1);
+    lua_pop(luaPtr, 1);
+
+    addPluginToLuaPath(luaPtr, pluginPath);
+}
+
+void Plugin::addPluginToLuaPath(lua_State* luaPtr, fs::path const& pluginPath) {
+    lua_getglobal(luaPtr, "package");
 
     // get field "path" from table at top of stack (-1)
-    lua_getfield(lua.get(), -1, "path");
+    lua_getfield(luaPtr, -1, "path");
 
     // For now: limit the include path to the current plugin folder, for security and compatibility reasons
     // grab path string from top of stack
     // std::string curPath = lua_tostring(lua, -1);
     // curPath.append(";");
-    auto curPath = path / "?.lua";
+    auto curPath = pluginPath / "?.lua";
 
     // get rid of the std::string on the stack we just pushed on line 5
-    lua_pop(lua.get(), 1);
+    lua_pop(luaPtr, 1);
 
     // push the new one
-    lua_pushstring(lua.get(), curPath.string().c_str());
+    lua_pushstring(luaPtr, curPath.string().c_str());
 
     // set the field "path" in table at -2 with value at top of stack
-    lua_setfield(lua.get(), -2, "path");
+    lua_setfield(luaPtr, -2, "path");
 
     // get rid of package table from top of stack
-    lua_pop(lua.get(), 1);
+    lua_pop(luaPtr, 1);
 }
 
 void Plugin::loadScript() {
@@ -223,7 +239,7 @@ void Plugin::loadScript() {
 
     registerXournalppLibs(lua.get());
 
-    addPluginToLuaPath();
+    addPluginToLuaPath(lua.get(), path);
 
     // Run the loaded Lua script
     if (lua_pcall(lua.get(), 0, 0, 0) != LUA_OK) {
@@ -238,11 +254,14 @@ void Plugin::loadScript() {
     }
 }
 
-auto Plugin::callFunction(const std::string& fnc) -> bool {
+auto Plugin::callFunction(const std::string& fnc, const std::vector<const LuaValue*>& args) -> bool {
     lua_getglobal(lua.get(), fnc.c_str());
+    for (const LuaValue* arg: args) {
+        arg->push(lua.get());
+    }
 
     // Run the function
-    if (lua_pcall(lua.get(), 0, 0, 0)) {
+    if (lua_pcall(lua.get(), static_cast<int>(args.size()), 0, 0)) {
         const char* errMsg = lua_tostring(lua.get(), -1);
         std::map<int, std::string> button;
         button.insert(std::pair<int, std::string>(0, _("OK")));
@@ -257,4 +276,44 @@ auto Plugin::callFunction(const std::string& fnc) -> bool {
 
 auto Plugin::isValid() const -> bool { return valid; }
 
+void Plugin::runInBackground(std::string function, LuaValue data, std::string callback, std::string doneCallback) {
+    auto* job = new PluginWorkerJob(this, path / mainfile, std::move(function), std::move(data), std::move(callback),
+                                    std::move(doneCallback));
+    this->backgroundJobs.push_back(job);
+    control->getScheduler()->addJob(job, JOB_PRIORITY_NONE);
+}
+
+void Plugin::deliverMessages(const std::string& callback, const LuaValue& messages) {
+    callFunction(callback, {&messages});
+}
+
+void Plugin::backgroundJobFinished(PluginWorkerJob* job, const std::string& doneCallback, const LuaValue& result,
+                                   const std::string& error) {
+    auto it = std::find(this->backgroundJobs.begin(), this->backgroundJobs.end(), job);
+    if (it == this->backgroundJobs.end()) {
+        return;
+    }
+    this->backgroundJobs.erase(it);
+    job->unref();
+
+    if (!doneCallback.empty()) {
+        LuaValue errorValue = error.empty() ? LuaValue() : LuaValue::fromString(error);
+        callFunction(doneCallback, {&result, &errorValue});
+    } else if (!error.empty()) {
+        std::map<int, std::string> button;
+        button.insert(std::pair<int, std::string>(0, _("OK")));
+        XojMsgBox::showPluginMessage(name, error, button, true);
+
+        g_warning("Error in Plugin: «%s», error: «%s»", name.c_str(), error.c_str());
+    }
+}
+
+void Plugin::cancelBackgroundJobs() {
+    for (PluginWorkerJob* job: this->backgroundJobs) {
+        job->cancel();
+        job->unref();
+    }
+    this->backgroundJobs.clear();
+}
+
 #endif
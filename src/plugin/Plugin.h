@@ -21,6 +21,7 @@
 
 #include <gtk/gtk.h>
 
+#include "LuaValue.h"
 #include "filesystem.h"
 
 extern "C" {
@@ -28,6 +29,7 @@ extern "C" {
 }
 
 class Plugin;
+class PluginWorkerJob;
 class Control;
 
 struct MenuEntry final {
@@ -51,6 +53,7 @@ struct LuaDeleter {
 class Plugin final {
 public:
     Plugin(Control* control, std::string name, fs::path path);
+    ~Plugin();
 
 public:
     /// Load the plugin script
@@ -99,18 +102,34 @@ public:
     ///@return The main controller
     auto getControl() const -> Control*;
 
+    /// Run a function of the plugin script on a background Lua state, see app.runInBackground
+    void runInBackground(std::string function, LuaValue data, std::string callback, std::string doneCallback);
+
+    /// Call the callback with a batch of messages from a background function
+    void deliverMessages(const std::string& callback, const LuaValue& messages);
+
+    /// A background function returned or failed, error is empty on success
+    void backgroundJobFinished(PluginWorkerJob* job, const std::string& doneCallback, const LuaValue& result,
+                               const std::string& error);
+
+    /// Stop all background functions of this plugin, e.g. because the document was closed
+    void cancelBackgroundJobs();
+
+    /// Load the libraries available to background functions
+    static void initWorkerLua(lua_State* luaPtr, fs::path const& pluginPath);
+
 private:
     /// Load ini file
     void loadIni();
 
     /// Execute lua function
-    auto callFunction(const std::string& fnc) -> bool;
+    auto callFunction(const std::string& fnc, const std::vector<const LuaValue*>& args = {}) -> bool;
 
     /// Load custom Lua Libraries
     static void registerXournalppLibs(lua_State* luaPtr);
 
     /// Add the plugin folder to the lua path
-    void addPluginToLuaPath();
+    static void addPluginToLuaPath(lua_State* luaPtr, fs::path const& pluginPath);
 
 public:
     /// Get Plugin from lua engine
@@ -120,6 +139,7 @@ private:
     Control* control;                              ///< The main controller
     std::unique_ptr<lua_State, LuaDeleter> lua{};  ///< Lua engine
     std::vector<MenuEntry> menuEntries;            ///< All registered menu entries
+    std::vector<PluginWorkerJob*> backgroundJobs;  ///< Running background functions, referenced
 
     std::string name;             ///< Plugin name
     std::string description;      ///< Description of the plugin
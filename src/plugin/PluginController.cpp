@@ -16,6 +16,7 @@ PluginController::PluginController(Control* control): control(control) {
 #ifdef ENABLE_PLUGINS
     auto searchPath = control->getGladeSearchPath()->getFirstSearchPath();
     loadPluginsFrom((searchPath /= "../plugins").lexically_normal());
+    registerListener(control);
 #endif
 }
 
@@ -88,3 +89,13 @@ auto PluginController::getPlugins() const -> std::vector<Plugin*> {
     std::transform(begin(plugins), end(plugins), std::back_inserter(pl), [](auto&& plugin) { return plugin.get(); });
     return pl;
 }
+
+void PluginController::documentChanged(DocumentChangeType type) {
+#ifdef ENABLE_PLUGINS
+    if (type == DOCUMENT_CHANGE_CLEARED || type == DOCUMENT_CHANGE_COMPLETE) {
+        for (auto&& p: this->plugins) {
+            p->cancelBackgroundJobs();
+        }
+    }
+#endif
+}
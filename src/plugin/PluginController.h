@@ -15,12 +15,14 @@
 #include <string>
 #include <vector>
 
+#include "model/DocumentListener.h"
+
 #include "Plugin.h"
 #include "filesystem.h"
 
 class Control;
 
-class PluginController final {
+class PluginController final: public DocumentListener {
 public:
     explicit PluginController(Control* control);
 
@@ -52,6 +54,11 @@ public:
      */
     auto getPlugins() const -> std::vector<Plugin*>;
 
+    /**
+     * Cancels the background functions of all plugins if the document is closed
+     */
+    void documentChanged(DocumentChangeType type) override;
+
 private:
     /**
      * The main controller
@@ -0,0 +1,207 @@
+#include "PluginWorkerJob.h"
+
+#ifdef ENABLE_PLUGINS
+
+#include <utility>
+
+#include "control/Control.h"
+
+#include "Plugin.h"
+#include "Util.h"
+
+extern "C" {
+#include <lauxlib.h>
+}
+
+/**
+ * Time the function runs before other jobs get their turn, in microseconds
+ */
+constexpr gint64 SLICE_DURATION = 20 * 1000;
+
+/**
+ * Lua instructions between two checks for the end of the time slice
+ */
+constexpr int HOOK_INSTRUCTIONS = 1000;
+
+/**
+ * Messages are passed to the UI thread when this many are queued, or after FLUSH_INTERVAL
+ */
+constexpr size_t MAX_BATCH_SIZE = 500;
+constexpr gint64 FLUSH_INTERVAL = 100 * 1000;
+
+PluginWorkerJob::PluginWorkerJob(Plugin* plugin, fs::path script, std::string function, LuaValue data,
+                                 std::string callback, std::string doneCallback):
+        plugin(plugin),
+        control(plugin->getControl()),
+        script(std::move(script)),
+        function(std::move(function)),
+        data(std::move(data)),
+        callback(std::move(callback)),
+        doneCallback(std::move(doneCallback)) {}
+
+PluginWorkerJob::~PluginWorkerJob() { closeLua(); }
+
+void PluginWorkerJob::cancel() { this->cancelled = true; }
+
+auto PluginWorkerJob::isCancelled() const -> bool { return this->cancelled; }
+
+auto PluginWorkerJob::fromLua(lua_State* L) -> PluginWorkerJob* {
+    lua_getfield(L, LUA_REGISTRYINDEX, "Xournalpp_Worker");
+    auto* job = static_cast<PluginWorkerJob*>(lua_touserdata(L, -1));
+    lua_pop(L, 1);
+    return job;
+}
+
+auto PluginWorkerJob::start(std::string& error) -> bool {
+    this->lua = luaL_newstate();
+    Plugin::initWorkerLua(this->lua, this->script.parent_path());
+
+    lua_pushlightuserdata(this->lua, this);
+    lua_setfield(this->lua, LUA_REGISTRYINDEX, "Xournalpp_Worker");
+
+    // Define the functions of the plugin
+    if (luaL_loadfile(this->lua, this->script.string().c_str()) != LUA_OK ||
+        lua_pcall(this->lua, 0, 0, 0) != LUA_OK) {
+        const char* msg = lua_tostring(this->lua, -1);
+        error = msg ? msg : "Could not load " + this->script.string();
+        return false;
+    }
+
+    this->thread = lua_newthread(this->lua);
+    // Keep the thread referenced while it runs
+    lua_setfield(this->lua, LUA_REGISTRYINDEX, "Xournalpp_WorkerThread");
+
+    lua_getglobal(this->thread, this->function.c_str());
+    if (!lua_isfunction(this->thread, -1)) {
+        error = "The plugin has no function «" + this->function + "»";
+        return false;
+    }
+    this->data.push(this->thread);
+
+    lua_sethook(this->thread, hook, LUA_MASKCOUNT, HOOK_INSTRUCTIONS);
+    return true;
+}
+
+void PluginWorkerJob::closeLua() {
+    if (this->lua) {
+        lua_close(this->lua);
+        this->lua = nullptr;
+        this->thread = nullptr;
+    }
+}
+
+void PluginWorkerJob::hook(lua_State* L, lua_Debug* ar) {
+    PluginWorkerJob* job = fromLua(L);
+    if (job->isCancelled()) {
+        luaL_error(L, "Cancelled");
+    }
+
+    // Cannot yield e.g. inside of a table.sort() comparator, the next check will
+    if (g_get_monotonic_time() > job->sliceEnd && lua_isyieldable(L)) {
+        lua_yield(L, 0);
+    }
+}
+
+void PluginWorkerJob::run() {
+    if (isCancelled()) {
+        closeLua();
+        return;
+    }
+
+    int args = 0;
+    if (this->lua == nullptr) {
+        std::string error;
+        if (!start(error)) {
+            finish(LuaValue(), error);
+            return;
+        }
+        args = 1;
+        this->lastFlush = g_get_monotonic_time();
+    }
+
+    this->sliceEnd = g_get_monotonic_time() + SLICE_DURATION;
+
+#if LUA_VERSION_NUM >= 504
+    int results = 0;
+    int status = lua_resume(this->thread, nullptr, args, &results);
+#else
+    int status = lua_resume(this->thread, nullptr, args);
+#endif
+
+    if (isCancelled()) {
+        closeLua();
+        return;
+    }
+
+    if (status == LUA_YIELD) {
+        // Discard the values of an explicit coroutine.yield()
+        lua_settop(this->thread, 0);
+
+        if (g_get_monotonic_time() - this->lastFlush > FLUSH_INTERVAL) {
+            flushMessages();
+        }
+        control->getScheduler()->addJob(this, JOB_PRIORITY_NONE);
+        return;
+    }
+
+    if (status == LUA_OK) {
+        std::string error;
+        LuaValue result;
+        if (lua_gettop(this->thread) > 0) {
+            result = LuaValue::fromLua(this->thread, 1, error);
+        }
+        finish(std::move(result), error);
+    } else {
+        const char* error = lua_tostring(this->thread, -1);
+        finish(LuaValue(), error ? error : "Unknown error");
+    }
+}
+
+void PluginWorkerJob::post(LuaValue message) {
+    this->messages.push_back(std::move(message));
+
+    if (this->messages.size() >= MAX_BATCH_SIZE || g_get_monotonic_time() - this->lastFlush > FLUSH_INTERVAL) {
+        flushMessages();
+    }
+}
+
+void PluginWorkerJob::flushMessages() {
+    this->lastFlush = g_get_monotonic_time();
+    if (this->messages.empty() || this->callback.empty()) {
+        this->messages.clear();
+        return;
+    }
+
+    LuaValue batch = LuaValue::table();
+    for (LuaValue& m: this->messages) {
+        batch.append(std::move(m));
+    }
+    this->messages.clear();
+
+    // Released by the callback
+    this->ref();
+    Util::execInUiThread([this, batch = std::move(batch)]() {
+        if (!isCancelled()) {
+            this->plugin->deliverMessages(this->callback, batch);
+        }
+        this->unref();
+    });
+}
+
+void PluginWorkerJob::finish(LuaValue result, std::string error) {
+    flushMessages();
+    closeLua();
+
+    // Released by the callback
+    this->ref();
+    Util::execInUiThread([this, result = std::move(result), error = std::move(error)]() {
+        if (!isCancelled()) {
+            this->plugin->backgroundJobFinished(this, this->doneCallback, result, error);
+        }
+        this->unref();
+    });
+}
+
+auto PluginWorkerJob::getType() -> JobType { return JOB_TYPE_PLUGIN; }
+
+#endif
@@ -0,0 +1,124 @@
+/*
+ * Xournal++
+ *
+ * Runs a plugin function on a background Lua state
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include "config-features.h"
+
+#ifdef ENABLE_PLUGINS
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <glib.h>
+
+#include "control/jobs/Job.h"
+
+#include "LuaValue.h"
+#include "filesystem.h"
+
+extern "C" {
+#include <lua.h>
+}
+
+class Control;
+class Plugin;
+
+/**
+ * Started by app.runInBackground(). The job loads the plugin script into a new Lua state, which
+ * only has the standard libraries and the worker library, and calls a function of it with a copy
+ * of the data passed by the plugin.
+ *
+ * The function runs as a coroutine, which is suspended after a few milliseconds and resumed by the
+ * next run of the job, so rendering is not blocked. Messages sent with worker.post() are passed to
+ * the UI thread in batches, where the plugin can apply them to the document.
+ */
+class PluginWorkerJob: public Job {
+public:
+    PluginWorkerJob(Plugin* plugin, fs::path script, std::string function, LuaValue data, std::string callback,
+                    std::string doneCallback);
+
+protected:
+    ~PluginWorkerJob() override;
+
+public:
+    /**
+     * Stops the Lua function at the next opportunity, no further callbacks are called.
+     * Needs to be called from the UI thread.
+     */
+    void cancel();
+    bool isCancelled() const;
+
+    /**
+     * Queues a message for the UI thread, called by worker.post()
+     */
+    void post(LuaValue message);
+
+    /**
+     * @return The job running on the Lua state L
+     */
+    static auto fromLua(lua_State* L) -> PluginWorkerJob*;
+
+    void run() override;
+
+    JobType getType() override;
+
+private:
+    /**
+     * Creates the Lua state and prepares the call of the function
+     *
+     * @return False if the script could not be loaded
+     */
+    bool start(std::string& error);
+    void closeLua();
+
+    /**
+     * Passes the queued messages to the UI thread
+     */
+    void flushMessages();
+
+    void finish(LuaValue result, std::string error);
+
+    /**
+     * Called by Lua every few instructions, suspends the function at the end of the time slice
+     */
+    static void hook(lua_State* L, lua_Debug* ar);
+
+private:
+    Plugin* plugin = nullptr;
+    Control* control = nullptr;
+
+    fs::path script;
+    std::string function;
+    LuaValue data;
+    std::string callback;
+    std::string doneCallback;
+
+    lua_State* lua = nullptr;
+
+    /**
+     * The coroutine running the function
+     */
+    lua_State* thread = nullptr;
+
+    /**
+     * End of the current time slice, in microseconds
+     */
+    gint64 sliceEnd = 0;
+
+    std::vector<LuaValue> messages;
+    gint64 lastFlush = 0;
+
+    std::atomic<bool> cancelled{false};
+};
+
+#endif
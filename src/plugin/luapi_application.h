@@ -9,8 +9,11 @@
  * @license GNU GPLv2 or later
  */
 
+#include <algorithm>
 #include <cstring>
 #include <map>
+#include <new>
+#include <vector>
 
 #include "control/Control.h"
 #include "control/PageBackgroundChangeController.h"
@@ -18,7 +21,12 @@
 #include "control/layer/LayerController.h"
 #include "control/pagetype/PageTypeHandler.h"
 #include "gui/widgets/XournalWidget.h"
+#include "model/Stroke.h"
+#include "undo/InsertUndoAction.h"
+#include "undo/StrokePointsUndoAction.h"
 
+#include "LuaValue.h"
+#include "Range.h"
 #include "StringUtils.h"
 #include "XojMsgBox.h"
 using std::map;
@@ -739,6 +747,565 @@ static int applib_setLayerVisibility(lua_State* L) {
 }
 
 
+/*
+ * Point buffers
+ *
+ * A point buffer is a userdata holding the points of a stroke in one array, so plugins can process
+ * large strokes without creating a Lua table for every point. Point indices start at 1, a pressure
+ * of -1 means the point has no pressure.
+ *
+ * Example:
+ *   local points = app.newPoints({10, 10, -1, 20, 15, -1})
+ *   points:append(30, 10)
+ *   local x, y, pressure = points:get(2)
+ *   points:transform(1, 0, 0, 1, 5, 5)  -- moves all points by 5pt
+ *   local values, count = points:getRange(1, #points)
+ */
+using LuaPoints = std::vector<Point>;
+
+static auto points_check(lua_State* L, int arg) -> LuaPoints* {
+    return static_cast<LuaPoints*>(luaL_checkudata(L, arg, LUA_POINTS_METATABLE));
+}
+
+/**
+ * Pushes a new, empty point buffer
+ */
+static auto points_push(lua_State* L) -> LuaPoints* {
+    auto* points = new (lua_newuserdata(L, sizeof(LuaPoints))) LuaPoints();
+    luaL_setmetatable(L, LUA_POINTS_METATABLE);
+    return points;
+}
+
+/**
+ * @return The 0-based index of the 1-based point index at arg
+ */
+static auto points_checkIndex(lua_State* L, const LuaPoints& points, int arg) -> size_t {
+    lua_Integer index = luaL_checkinteger(L, arg);
+    luaL_argcheck(L, index >= 1 && static_cast<size_t>(index) <= points.size(), arg, "point index out of range");
+    return static_cast<size_t>(index - 1);
+}
+
+/**
+ * Copies the flat table {x1, y1, pressure1, x2, ...} at arg into the points, starting at the 0-based index first.
+ * The buffer grows if needed.
+ */
+static void points_readTable(lua_State* L, LuaPoints& points, size_t first, int arg) {
+    luaL_checktype(L, arg, LUA_TTABLE);
+    size_t count = lua_rawlen(L, arg) / 3;
+    if (first + count > points.size()) {
+        points.resize(first + count);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        Point& p = points[first + i];
+        lua_rawgeti(L, arg, static_cast<lua_Integer>(3 * i + 1));
+        lua_rawgeti(L, arg, static_cast<lua_Integer>(3 * i + 2));
+        lua_rawgeti(L, arg, static_cast<lua_Integer>(3 * i + 3));
+        p.x = lua_tonumber(L, -3);
+        p.y = lua_tonumber(L, -2);
+        p.z = lua_tonumber(L, -1);
+        lua_pop(L, 3);
+    }
+}
+
+static int points_gc(lua_State* L) {
+    points_check(L, 1)->~LuaPoints();
+    return 0;
+}
+
+static int points_len(lua_State* L) {
+    lua_pushinteger(L, static_cast<lua_Integer>(points_check(L, 1)->size()));
+    return 1;
+}
+
+/*
+ * Example: local x, y, pressure = points:get(1)
+ */
+static int points_get(lua_State* L) {
+    LuaPoints& points = *points_check(L, 1);
+    const Point& p = points[points_checkIndex(L, points, 2)];
+    lua_pushnumber(L, p.x);
+    lua_pushnumber(L, p.y);
+    lua_pushnumber(L, p.z);
+    return 3;
+}
+
+/*
+ * Example: points:set(1, 10.5, 20, 0.8)
+ * the pressure is optional
+ */
+static int points_set(lua_State* L) {
+    LuaPoints& points = *points_check(L, 1);
+    Point& p = points[points_checkIndex(L, points, 2)];
+    p.x = luaL_checknumber(L, 3);
+    p.y = luaL_checknumber(L, 4);
+    p.z = luaL_optnumber(L, 5, Point::NO_PRESSURE);
+    return 0;
+}
+
+/*
+ * Example: points:append(10.5, 20, 0.8)
+ * the pressure is optional
+ */
+static int points_append(lua_State* L) {
+    LuaPoints& points = *points_check(L, 1);
+    points.emplace_back(luaL_checknumber(L, 2), luaL_checknumber(L, 3), luaL_optnumber(L, 4, Point::NO_PRESSURE));
+    return 0;
+}
+
+/*
+ * Example: points:resize(100)
+ * New points are at (0, 0) without pressure
+ */
+static int points_resize(lua_State* L) {
+    LuaPoints& points = *points_check(L, 1);
+    lua_Integer count = luaL_checkinteger(L, 2);
+    luaL_argcheck(L, count >= 0, 2, "negative point count");
+    points.resize(static_cast<size_t>(count), Point(0, 0, Point::NO_PRESSURE));
+    return 0;
+}
+
+/*
+ * Returns count points starting at first as a flat table {x1, y1, pressure1, x2, ...} and the count of points
+ * copied, which is less than count at the end of the buffer. If a table is passed as third argument it is
+ * filled instead of creating a new one, entries after the copied points are left untouched.
+ *
+ * Example: local values, n = points:getRange(1, #points, values)
+ */
+static int points_getRange(lua_State* L) {
+    LuaPoints& points = *points_check(L, 1);
+    size_t first = points_checkIndex(L, points, 2);
+    lua_Integer requested = luaL_checkinteger(L, 3);
+    size_t count = std::min(static_cast<size_t>(std::max<lua_Integer>(requested, 0)), points.size() - first);
+
+    if (lua_istable(L, 4)) {
+        lua_pushvalue(L, 4);
+    } else {
+        lua_createtable(L, static_cast<int>(3 * count), 0);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        const Point& p = points[first + i];
+        lua_pushnumber(L, p.x);
+        lua_rawseti(L, -2, static_cast<lua_Integer>(3 * i + 1));
+        lua_pushnumber(L, p.y);
+        lua_rawseti(L, -2, static_cast<lua_Integer>(3 * i + 2));
+        lua_pushnumber(L, p.z);
+        lua_rawseti(L, -2, static_cast<lua_Integer>(3 * i + 3));
+    }
+
+    lua_pushinteger(L, static_cast<lua_Integer>(count));
+    return 2;
+}
+
+/*
+ * Overwrites the points starting at first with a flat table {x1, y1, pressure1, x2, ...}, first may be one
+ * after the last point to append
+ *
+ * Example: points:setRange(#points + 1, {30, 10, -1, 40, 20, -1})
+ */
+static int points_setRange(lua_State* L) {
+    LuaPoints& points = *points_check(L, 1);
+    lua_Integer first = luaL_checkinteger(L, 2);
+    luaL_argcheck(L, first >= 1 && static_cast<size_t>(first) <= points.size() + 1, 2, "point index out of range");
+    points_readTable(L, points, static_cast<size_t>(first - 1), 3);
+    return 0;
+}
+
+/*
+ * Applies the affine transformation x' = xx * x + xy * y + x0, y' = yx * x + yy * y + y0 to all points
+ *
+ * Example: points:transform(2, 0, 0, 2, 0, 0)
+ * scales the points by 2
+ */
+static int points_transform(lua_State* L) {
+    LuaPoints& points = *points_check(L, 1);
+    double xx = luaL_checknumber(L, 2);
+    double yx = luaL_checknumber(L, 3);
+    double xy = luaL_checknumber(L, 4);
+    double yy = luaL_checknumber(L, 5);
+    double x0 = luaL_checknumber(L, 6);
+    double y0 = luaL_checknumber(L, 7);
+
+    for (Point& p: points) {
+        double x = p.x;
+        p.x = xx * x + xy * p.y + x0;
+        p.y = yx * x + yy * p.y + y0;
+    }
+    return 0;
+}
+
+/*
+ * Example: local minX, minY, maxX, maxY = points:bounds()
+ * returns nothing if the buffer is empty
+ */
+static int points_bounds(lua_State* L) {
+    LuaPoints& points = *points_check(L, 1);
+    if (points.empty()) {
+        return 0;
+    }
+
+    auto [minX, maxX] = std::minmax_element(points.begin(), points.end(),
+                                            [](const Point& a, const Point& b) { return a.x < b.x; });
+    auto [minY, maxY] = std::minmax_element(points.begin(), points.end(),
+                                            [](const Point& a, const Point& b) { return a.y < b.y; });
+    lua_pushnumber(L, minX->x);
+    lua_pushnumber(L, minY->y);
+    lua_pushnumber(L, maxX->x);
+    lua_pushnumber(L, maxY->y);
+    return 4;
+}
+
+static const luaL_Reg pointsMethods[] = {{"get", points_get},
+                                         {"set", points_set},
+                                         {"append", points_append},
+                                         {"resize", points_resize},
+                                         {"getRange", points_getRange},
+                                         {"setRange", points_setRange},
+                                         {"transform", points_transform},
+                                         {"bounds", points_bounds},
+                                         {nullptr, nullptr}};
+
+/**
+ * Registers the metatable of point buffers
+ */
+static void points_register(lua_State* L) {
+    if (luaL_newmetatable(L, LUA_POINTS_METATABLE)) {
+        lua_pushvalue(L, -1);
+        lua_setfield(L, -2, "__index");
+        lua_pushcfunction(L, points_gc);
+        lua_setfield(L, -2, "__gc");
+        lua_pushcfunction(L, points_len);
+        lua_setfield(L, -2, "__len");
+        luaL_setfuncs(L, pointsMethods, 0);
+    }
+    lua_pop(L, 1);
+}
+
+/*
+ * Creates a point buffer, optionally filled from a flat table {x1, y1, pressure1, x2, ...}
+ *
+ * Example: local points = app.newPoints({10, 10, -1, 20, 15, -1})
+ */
+static int applib_newPoints(lua_State* L) {
+    LuaPoints* points = points_push(L);
+    if (!lua_isnoneornil(L, 1)) {
+        points_readTable(L, *points, 0, 1);
+    }
+    return 1;
+}
+
+static const char* STROKE_TOOL_NAMES[] = {"PEN", "ERASER", "HIGHLIGHTER", nullptr};
+
+/**
+ * Returns the layer given by the optional page and layer numbers at pageArg and layerArg, the current page and
+ * its selected layer by default. Layers are numbered from 1, as in app.getDocumentStructure().
+ */
+static auto applib_checkLayer(lua_State* L, int pageArg, int layerArg, PageRef& page) -> Layer* {
+    Control* control = Plugin::getPluginFromLua(L)->getControl();
+    Document* doc = control->getDocument();
+
+    bool currentPage = lua_isnoneornil(L, pageArg);
+    lua_Integer pageNo = currentPage ? 0 : luaL_checkinteger(L, pageArg);
+    bool selectedLayer = lua_isnoneornil(L, layerArg);
+    lua_Integer layerId = selectedLayer ? 0 : luaL_checkinteger(L, layerArg);
+
+    // Look up while locked, the errors are raised after unlocking, so they do not leave the document locked
+    Layer* layer = nullptr;
+    doc->lock();
+    if (currentPage) {
+        page = control->getCurrentPage();
+    } else if (pageNo >= 1 && static_cast<size_t>(pageNo) <= doc->getPageCount()) {
+        page = doc->getPage(static_cast<size_t>(pageNo - 1));
+    }
+    if (page && selectedLayer) {
+        layer = page->getSelectedLayer();
+    } else if (page && layerId >= 1 && static_cast<size_t>(layerId) <= page->getLayerCount()) {
+        layer = (*page->getLayers())[static_cast<size_t>(layerId - 1)];
+    }
+    doc->unlock();
+
+    luaL_argcheck(L, page || currentPage, pageArg, "page does not exist");
+    if (!page) {
+        luaL_error(L, "No page!");
+    }
+    luaL_argcheck(L, layer || selectedLayer, layerArg, "layer does not exist");
+    if (layer == nullptr) {
+        luaL_error(L, "No layer!");
+    }
+    return layer;
+}
+
+/**
+ * Pushes the field key of the table at index without invoking metamethods, which could raise errors
+ */
+static void applib_rawGetField(lua_State* L, int index, const char* key) {
+    index = lua_absindex(L, index);
+    lua_pushstring(L, key);
+    lua_rawget(L, index);
+}
+
+/*
+ * Returns the strokes of a layer, by default of the current layer of the current page, as a table of the shape
+ * {
+ *   {
+ *     "points" = point buffer, a copy of the points of the stroke,
+ *     "width" = number,
+ *     "color" = integer (0xRRGGBB),
+ *     "fill" = integer (-1 if the stroke is not filled),
+ *     "tool" = string ("PEN", "ERASER" or "HIGHLIGHTER")
+ *   },
+ *   ...
+ * }
+ *
+ * Example: local strokes = app.getStrokes(1, 1)
+ * returns the strokes on the first layer of the first page
+ */
+static int applib_getStrokes(lua_State* L) {
+    PageRef page;
+    Layer* layer = applib_checkLayer(L, 1, 2, page);
+    Document* doc = Plugin::getPluginFromLua(L)->getControl()->getDocument();
+
+    struct StrokeData {
+        LuaPoints points;
+        double width;
+        uint32_t color;
+        int fill;
+        StrokeTool tool;
+    };
+
+    // Only copy while locked: creating the Lua objects may raise an error, which would leave the document locked
+    vector<StrokeData> strokes;
+    doc->lock();
+    for (Element* e: *layer->getElements()) {
+        if (e->getType() != ELEMENT_STROKE) {
+            continue;
+        }
+        auto* stroke = static_cast<Stroke*>(e);
+        strokes.push_back({stroke->getPointVector(), stroke->getWidth(), uint32_t(stroke->getColor()),
+                           stroke->getFill(), stroke->getToolType()});
+    }
+    doc->unlock();
+
+    lua_createtable(L, static_cast<int>(strokes.size()), 0);
+
+    lua_Integer index = 0;
+    for (StrokeData& stroke: strokes) {
+        lua_createtable(L, 0, 5);
+
+        *points_push(L) = std::move(stroke.points);
+        lua_setfield(L, -2, "points");
+
+        lua_pushnumber(L, stroke.width);
+        lua_setfield(L, -2, "width");
+
+        lua_pushinteger(L, static_cast<lua_Integer>(stroke.color));
+        lua_setfield(L, -2, "color");
+
+        lua_pushinteger(L, stroke.fill);
+        lua_setfield(L, -2, "fill");
+
+        lua_pushstring(L, STROKE_TOOL_NAMES[stroke.tool]);
+        lua_setfield(L, -2, "tool");
+
+        lua_rawseti(L, -2, ++index);
+    }
+
+    return 1;
+}
+
+/*
+ * Adds strokes to a layer, by default to the current layer of the current page. All strokes are added as one
+ * undo action. Each stroke is a table like those returned by app.getStrokes(), only "points" is required.
+ * The other keys default to a width of 1.4, black, not filled and "PEN".
+ *
+ * Example: app.addStrokes({{["points"] = points, ["color"] = 0xff0000}}, 1, 1)
+ * adds a red stroke to the first layer of the first page
+ */
+static int applib_addStrokes(lua_State* L) {
+    luaL_checktype(L, 1, LUA_TTABLE);
+    PageRef page;
+    Layer* layer = applib_checkLayer(L, 2, 3, page);
+    Control* control = Plugin::getPluginFromLua(L)->getControl();
+
+    // Check all strokes first, so nothing is added on an error
+    lua_Integer count = static_cast<lua_Integer>(lua_rawlen(L, 1));
+    for (lua_Integer i = 1; i <= count; i++) {
+        lua_rawgeti(L, 1, i);
+        if (!lua_istable(L, -1)) {
+            luaL_error(L, "Stroke %d is not a table", static_cast<int>(i));
+        }
+
+        applib_rawGetField(L, -1, "points");
+        if (!luaL_testudata(L, -1, LUA_POINTS_METATABLE)) {
+            luaL_error(L, "Stroke %d has no point buffer", static_cast<int>(i));
+        }
+        if (static_cast<LuaPoints*>(lua_touserdata(L, -1))->size() < 2) {
+            luaL_error(L, "Stroke %d has less than 2 points", static_cast<int>(i));
+        }
+
+        applib_rawGetField(L, -2, "width");
+        luaL_optnumber(L, -1, 0);
+        applib_rawGetField(L, -3, "color");
+        luaL_optinteger(L, -1, 0);
+        applib_rawGetField(L, -4, "fill");
+        luaL_optinteger(L, -1, 0);
+        applib_rawGetField(L, -5, "tool");
+        luaL_checkoption(L, -1, "PEN", STROKE_TOOL_NAMES);
+        lua_pop(L, 6);
+    }
+
+    // The fields were checked and are read without metamethods, no error can be raised from here on, which would
+    // leak the strokes created so far
+    vector<Element*> strokes;
+    strokes.reserve(static_cast<size_t>(count));
+    for (lua_Integer i = 1; i <= count; i++) {
+        lua_rawgeti(L, 1, i);
+        applib_rawGetField(L, -1, "points");
+        applib_rawGetField(L, -2, "width");
+        applib_rawGetField(L, -3, "color");
+        applib_rawGetField(L, -4, "fill");
+        applib_rawGetField(L, -5, "tool");
+
+        const LuaPoints& points = *static_cast<LuaPoints*>(lua_touserdata(L, -5));
+        double width = luaL_optnumber(L, -4, 1.4);
+        auto color = static_cast<uint32_t>(luaL_optinteger(L, -3, 0x000000));
+        auto fill = static_cast<int>(luaL_optinteger(L, -2, -1));
+        auto tool = static_cast<StrokeTool>(luaL_checkoption(L, -1, "PEN", STROKE_TOOL_NAMES));
+
+        auto* stroke = new Stroke();
+        stroke->setPointVector(points);
+        stroke->setWidth(width);
+        stroke->setColor(Color(color));
+        stroke->setFill(fill);
+        stroke->setToolType(tool);
+        strokes.push_back(stroke);
+
+        lua_pop(L, 6);
+    }
+
+    if (strokes.empty()) {
+        return 0;
+    }
+
+    Document* doc = control->getDocument();
+    doc->lock();
+    for (Element* e: strokes) {
+        layer->addElement(e);
+    }
+    doc->unlock();
+
+    // One repaint instead of one for every stroke
+    page->firePageChanged();
+
+    control->getUndoRedoHandler()->addUndoAction(std::make_unique<InsertsUndoAction>(page, layer, std::move(strokes)));
+
+    return 0;
+}
+
+/*
+ * Replaces the points of a stroke, by default of a stroke on the current layer of the current page, as one undo
+ * action. Strokes are numbered from 1 in the order of app.getStrokes(), which only counts strokes.
+ *
+ * Example: local strokes = app.getStrokes(1, 1)
+ *          strokes[3].points:transform(1, 0, 0, 1, 10, 0)
+ *          app.setStrokePoints(3, strokes[3].points, 1, 1)
+ * moves the third stroke on the first layer of the first page by 10pt to the right
+ */
+static int applib_setStrokePoints(lua_State* L) {
+    lua_Integer index = luaL_checkinteger(L, 1);
+    const LuaPoints& points = *points_check(L, 2);
+    luaL_argcheck(L, points.size() >= 2, 2, "less than 2 points");
+    PageRef page;
+    Layer* layer = applib_checkLayer(L, 3, 4, page);
+    Control* control = Plugin::getPluginFromLua(L)->getControl();
+    Document* doc = control->getDocument();
+
+    Stroke* stroke = nullptr;
+    lua_Integer strokeNo = 0;
+    doc->lock();
+    for (Element* e: *layer->getElements()) {
+        if (e->getType() == ELEMENT_STROKE && ++strokeNo == index) {
+            stroke = static_cast<Stroke*>(e);
+            break;
+        }
+    }
+    if (stroke == nullptr) {
+        doc->unlock();
+        luaL_argerror(L, 1, "stroke does not exist");
+    }
+
+    Range range(stroke->getX(), stroke->getY());
+    range.addPoint(stroke->getX() + stroke->getElementWidth(), stroke->getY() + stroke->getElementHeight());
+
+    vector<Point> previous = stroke->releasePoints();
+    stroke->setPointVector(points);
+
+    range.addPoint(stroke->getX(), stroke->getY());
+    range.addPoint(stroke->getX() + stroke->getElementWidth(), stroke->getY() + stroke->getElementHeight());
+    doc->unlock();
+
+    page->fireRangeChanged(range);
+
+    control->getUndoRedoHandler()->addUndoAction(
+            std::make_unique<StrokePointsUndoAction>(page, stroke, std::move(previous)));
+
+    return 0;
+}
+
+/*
+ * Runs a function of the plugin script in the background, so the application does not freeze while it runs.
+ * The function is called on a separate Lua state with a copy of "data" as argument. This state has only the
+ * standard libraries and the worker library: worker.post(message) sends a message to the UI thread,
+ * worker.newPoints() creates a point buffer and worker.isCancelled() tells if the function was cancelled.
+ *
+ * The messages are passed in batches to "callback", which runs on the UI thread and can use the app library to
+ * change the document. "done" is called with the return value of the function, or with nil and an error message.
+ * Background functions are cancelled when the document is closed, or with app.cancelBackgroundJobs().
+ *
+ * Example: app.runInBackground({["function"] = "reflow", ["data"] = {["pages"] = 300},
+ *                               ["callback"] = "applyEdits", ["done"] = "reflowDone"})
+ */
+static int applib_runInBackground(lua_State* L) {
+    Plugin* plugin = Plugin::getPluginFromLua(L);
+    luaL_checktype(L, 1, LUA_TTABLE);
+
+    lua_getfield(L, 1, "function");
+    lua_getfield(L, 1, "callback");
+    lua_getfield(L, 1, "done");
+    lua_getfield(L, 1, "data");
+
+    if (!lua_isstring(L, -4)) {
+        luaL_error(L, "Missing \"function\" to run in the background");
+    }
+    const char* function = lua_tostring(L, -4);
+    const char* callback = luaL_optstring(L, -3, "");
+    const char* done = luaL_optstring(L, -2, "");
+
+    {
+        std::string error;
+        LuaValue data = LuaValue::fromLua(L, -1, error);
+        if (error.empty()) {
+            plugin->runInBackground(function, std::move(data), callback, done);
+            lua_pop(L, 4);
+            return 0;
+        }
+        lua_pushstring(L, error.c_str());
+    }
+    return lua_error(L);
+}
+
+/*
+ * Cancels all background functions of the plugin started with app.runInBackground(). No callbacks are called
+ * for them anymore.
+ *
+ * Example: app.cancelBackgroundJobs()
+ */
+static int applib_cancelBackgroundJobs(lua_State* L) {
+    Plugin::getPluginFromLua(L)->cancelBackgroundJobs();
+    return 0;
+}
+
 /*
  * The full Lua Plugin API.
  * See above for example usage of each function.
@@ -760,6 +1327,12 @@ static const luaL_Reg applib[] = {{"msgbox", applib_msgbox},
                                   {"setPageSize", applib_setPageSize},
                                   {"setCurrentLayer", applib_setCurrentLayer},
                                   {"setLayerVisibility", applib_setLayerVisibility},
+                                  {"newPoints", applib_newPoints},
+                                  {"getStrokes", applib_getStrokes},
+                                  {"addStrokes", applib_addStrokes},
+                                  {"setStrokePoints", applib_setStrokePoints},
+                                  {"runInBackground", applib_runInBackground},
+                                  {"cancelBackgroundJobs", applib_cancelBackgroundJobs},
 
                                   // Placeholder
                                   //	{"MSG_BT_OK", nullptr},
@@ -770,6 +1343,8 @@ static const luaL_Reg applib[] = {{"msgbox", applib_msgbox},
  * Open application Library
  */
 LUAMOD_API int luaopen_app(lua_State* L) {
+    points_register(L);
+
     luaL_newlib(L, applib);
     //	lua_pushnumber(L, MSG_BT_OK);
     //	lua_setfield(L, -2, "MSG_BT_OK");
@@ -0,0 +1,65 @@
+/*
+ * Xournal++
+ *
+ * Lua API, library of background functions started with app.runInBackground()
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <string>
+
+#include "LuaValue.h"
+#include "PluginWorkerJob.h"
+
+/*
+ * Sends a message to the UI thread. Messages are passed in batches to the callback given to app.runInBackground(),
+ * as a table in the order they were posted. A message may contain nil, booleans, numbers, strings, point buffers and
+ * tables of these.
+ *
+ * Example: worker.post({["page"] = 3, ["points"] = points})
+ */
+static int workerlib_post(lua_State* L) {
+    {
+        std::string error;
+        LuaValue message = LuaValue::fromLua(L, 1, error);
+        if (error.empty()) {
+            PluginWorkerJob::fromLua(L)->post(std::move(message));
+            return 0;
+        }
+        lua_pushstring(L, error.c_str());
+    }
+    return lua_error(L);
+}
+
+/*
+ * Returns true if the background function was cancelled, e.g. because the document was closed.
+ * A cancelled function is stopped automatically, checking this is only needed to clean up.
+ *
+ * Example: if worker.isCancelled() then return end
+ */
+static int workerlib_isCancelled(lua_State* L) {
+    lua_pushboolean(L, PluginWorkerJob::fromLua(L)->isCancelled());
+    return 1;
+}
+
+/*
+ * The API available to background functions.
+ * The app library is not available, since it accesses the UI and the document.
+ */
+static const luaL_Reg workerlib[] = {{"post", workerlib_post},
+                                     {"isCancelled", workerlib_isCancelled},
+                                     {"newPoints", applib_newPoints},
+                                     {nullptr, nullptr}};
+
+/**
+ * Open worker Library
+ */
+LUAMOD_API int luaopen_worker(lua_State* L) {
+    points_register(L);
+
+    luaL_newlib(L, workerlib);
+    return 1;
+}
@@ -66,6 +66,16 @@ auto DeleteUndoAction::redo(Control*) -> bool {
     return true;
 }
 
+auto DeleteUndoAction::getDetachedElements() -> vector<Element*> {
+    vector<Element*> detached;
+    if (!this->undone) {
+        for (GList* l = this->elements; l != nullptr; l = l->next) {
+            detached.push_back(static_cast<PageLayerPosEntry<Element>*>(l->data)->element);
+        }
+    }
+    return detached;
+}
+
 auto DeleteUndoAction::getText() -> string {
     if (eraser) {
         return _("Erase stroke");
@@ -34,6 +34,8 @@ public:
 
     string getText() override;
 
+    vector<Element*> getDetachedElements() override;
+
 private:
     GList* elements = nullptr;
     bool eraser = true;
@@ -89,6 +89,14 @@ void EraseUndoAction::finalize() {
 
 auto EraseUndoAction::getText() -> string { return _("Erase stroke"); }
 
+auto EraseUndoAction::getDetachedElements() -> vector<Element*> {
+    vector<Element*> detached;
+    for (GList* l = this->undone ? this->edited : this->original; l != nullptr; l = l->next) {
+        detached.push_back(static_cast<PageLayerPosEntry<Stroke>*>(l->data)->element);
+    }
+    return detached;
+}
+
 auto EraseUndoAction::undo(Control* control) -> bool {
     for (GList* l = this->edited; l != nullptr; l = l->next) {
         auto* e = static_cast<PageLayerPosEntry<Stroke>*>(l->data);
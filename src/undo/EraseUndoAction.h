@@ -38,6 +38,8 @@ public:
 
     virtual string getText();
 
+    virtual vector<Element*> getDetachedElements();
+
 private:
     GList* edited = nullptr;
     GList* original = nullptr;
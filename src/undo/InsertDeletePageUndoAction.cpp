@@ -3,6 +3,7 @@
 #include "control/Control.h"
 #include "gui/XournalppCursor.h"
 #include "model/Document.h"
+#include "model/Layer.h"
 #include "model/PageRef.h"
 
 #include "i18n.h"
@@ -17,6 +18,8 @@ InsertDeletePageUndoAction::InsertDeletePageUndoAction(const PageRef& page, int
 InsertDeletePageUndoAction::~InsertDeletePageUndoAction() { this->page = nullptr; }
 
 auto InsertDeletePageUndoAction::undo(Control* control) -> bool {
+    this->undone = true;
+
     if (this->inserted) {
         return deletePage(control);
     }
@@ -26,6 +29,8 @@ auto InsertDeletePageUndoAction::undo(Control* control) -> bool {
 }
 
 auto InsertDeletePageUndoAction::redo(Control* control) -> bool {
+    this->undone = false;
+
     if (this->inserted) {
         return insertPage(control);
     }
@@ -89,6 +94,18 @@ auto InsertDeletePageUndoAction::deletePage(Control* control) -> bool {
     return true;
 }
 
+auto InsertDeletePageUndoAction::getDetachedElements() -> vector<Element*> {
+    vector<Element*> detached;
+
+    // The page is not in the document if it was deleted, or if its insertion was undone
+    if (this->inserted == this->undone) {
+        for (Layer* l: *this->page->getLayers()) {
+            detached.insert(detached.end(), l->getElements()->begin(), l->getElements()->end());
+        }
+    }
+    return detached;
+}
+
 auto InsertDeletePageUndoAction::getText() -> string {
     if (this->inserted) {
         return _("Page inserted");
@@ -28,6 +28,8 @@ public:
 
     virtual string getText();
 
+    virtual vector<Element*> getDetachedElements();
+
 private:
     bool insertPage(Control* control);
     bool deletePage(Control* control);
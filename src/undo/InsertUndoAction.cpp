@@ -39,6 +39,13 @@ auto InsertUndoAction::getText() -> string {
     }
 }
 
+auto InsertUndoAction::getDetachedElements() -> vector<Element*> {
+    if (this->undone) {
+        return {this->element};
+    }
+    return {};
+}
+
 auto InsertUndoAction::undo(Control* control) -> bool {
     this->layer->removeElement(this->element, false);
 
@@ -78,6 +85,13 @@ InsertsUndoAction::~InsertsUndoAction() {
 
 auto InsertsUndoAction::getText() -> string { return _("Insert elements"); }
 
+auto InsertsUndoAction::getDetachedElements() -> vector<Element*> {
+    if (this->undone) {
+        return this->elements;
+    }
+    return {};
+}
+
 auto InsertsUndoAction::undo(Control* control) -> bool {
     for (Element* elem: this->elements) {
         this->layer->removeElement(elem, false);
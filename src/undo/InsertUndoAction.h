@@ -28,6 +28,8 @@ public:
 
     virtual string getText();
 
+    virtual vector<Element*> getDetachedElements();
+
 private:
     Layer* layer;
     Element* element;
@@ -44,6 +46,8 @@ public:
 
     virtual string getText();
 
+    virtual vector<Element*> getDetachedElements();
+
 private:
     Layer* layer;
     vector<Element*> elements;
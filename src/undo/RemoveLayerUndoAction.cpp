@@ -27,6 +27,13 @@ RemoveLayerUndoAction::~RemoveLayerUndoAction() {
 
 auto RemoveLayerUndoAction::getText() -> string { return _("Delete layer"); }
 
+auto RemoveLayerUndoAction::getDetachedElements() -> vector<Element*> {
+    if (this->undone) {
+        return {};
+    }
+    return *this->layer->getElements();
+}
+
 auto RemoveLayerUndoAction::undo(Control* control) -> bool {
     layerController->insertLayer(this->page, this->layer, this->layerPos);
     Document* doc = control->getDocument();
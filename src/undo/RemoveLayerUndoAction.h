@@ -27,6 +27,8 @@ public:
 
     virtual string getText();
 
+    virtual vector<Element*> getDetachedElements();
+
 private:
     LayerController* layerController;
     Layer* layer;
@@ -0,0 +1,44 @@
+#include "StrokePointsUndoAction.h"
+
+#include <utility>
+
+#include "model/Stroke.h"
+
+#include "Range.h"
+#include "i18n.h"
+
+StrokePointsUndoAction::StrokePointsUndoAction(const PageRef& page, Stroke* stroke, std::vector<Point> points):
+        UndoAction("StrokePointsUndoAction"), stroke(stroke), points(std::move(points)) {
+    this->page = page;
+}
+
+StrokePointsUndoAction::~StrokePointsUndoAction() = default;
+
+auto StrokePointsUndoAction::undo(Control* control) -> bool {
+    swapPoints();
+    this->undone = true;
+    return true;
+}
+
+auto StrokePointsUndoAction::redo(Control* control) -> bool {
+    swapPoints();
+    this->undone = false;
+    return true;
+}
+
+void StrokePointsUndoAction::swapPoints() {
+    Range range(this->stroke->getX(), this->stroke->getY());
+    range.addPoint(this->stroke->getX() + this->stroke->getElementWidth(),
+                   this->stroke->getY() + this->stroke->getElementHeight());
+
+    std::vector<Point> current = this->stroke->releasePoints();
+    this->stroke->setPointVector(std::move(this->points));
+    this->points = std::move(current);
+
+    range.addPoint(this->stroke->getX(), this->stroke->getY());
+    range.addPoint(this->stroke->getX() + this->stroke->getElementWidth(),
+                   this->stroke->getY() + this->stroke->getElementHeight());
+    this->page->fireRangeChanged(range);
+}
+
+auto StrokePointsUndoAction::getText() -> string { return _("Change stroke points"); }
@@ -0,0 +1,43 @@
+/*
+ * Xournal++
+ *
+ * Undo action for replacing the points of a stroke
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "model/Point.h"
+
+#include "UndoAction.h"
+
+class StrokePointsUndoAction: public UndoAction {
+public:
+    /**
+     * @param points The points of stroke before they were replaced
+     */
+    StrokePointsUndoAction(const PageRef& page, Stroke* stroke, std::vector<Point> points);
+    virtual ~StrokePointsUndoAction();
+
+public:
+    virtual bool undo(Control* control);
+    virtual bool redo(Control* control);
+
+    virtual string getText();
+
+private:
+    /**
+     * Exchanges the points of the stroke with the stored points, undo and redo are the same
+     */
+    void swapPoints();
+
+private:
+    Stroke* stroke;
+    std::vector<Point> points;
+};
@@ -1,9 +1,21 @@
 #include "UndoAction.h"
 
+#include "model/Image.h"
+#include "model/Stroke.h"
+#include "model/TexImage.h"
+#include "model/Text.h"
+
 #include "Rectangle.h"
 
 UndoAction::UndoAction(std::string className): className(std::move(className)) {}
 
+UndoAction::~UndoAction() {
+    // The strokes are deleted by the subclass, only the block needs to be released
+    if (this->spillFile) {
+        this->spillFile->free(this->spillBlock);
+    }
+}
+
 auto UndoAction::getPages() -> std::vector<PageRef> {
     std::vector<PageRef> pages;
     pages.push_back(this->page);
@@ -11,3 +23,91 @@ auto UndoAction::getPages() -> std::vector<PageRef> {
 }
 
 auto UndoAction::getClassName() const -> std::string const& { return this->className; }
+
+auto UndoAction::getDetachedElements() -> vector<Element*> { return {}; }
+
+/**
+ * Approximate memory of an element, in bytes
+ */
+static auto getElementMemoryUsage(Element* e) -> size_t {
+    switch (e->getType()) {
+        case ELEMENT_STROKE:
+            return sizeof(Stroke) + static_cast<size_t>(dynamic_cast<Stroke*>(e)->getPointCount()) * sizeof(Point);
+        case ELEMENT_IMAGE:
+            return sizeof(Image) + dynamic_cast<Image*>(e)->getDataSize();
+        case ELEMENT_TEXIMAGE:
+            return sizeof(TexImage) + dynamic_cast<TexImage*>(e)->getBinaryData().size();
+        case ELEMENT_TEXT:
+            return sizeof(Text) + dynamic_cast<Text*>(e)->getText().size();
+    }
+    return 0;
+}
+
+auto UndoAction::getMemoryUsage() -> size_t {
+    size_t usage = this->className.size() + 64;
+    for (Element* e: getDetachedElements()) {
+        usage += getElementMemoryUsage(e);
+    }
+    return usage;
+}
+
+void UndoAction::spill(UndoSpillFile& file) {
+    if (this->spillFile) {
+        return;
+    }
+
+    vector<Point> points;
+    vector<std::pair<Stroke*, size_t>> strokes;
+    for (Element* e: getDetachedElements()) {
+        if (e->getType() != ELEMENT_STROKE) {
+            continue;
+        }
+
+        auto* s = dynamic_cast<Stroke*>(e);
+        const vector<Point>& strokePoints = s->getPointVector();
+        if (strokePoints.empty()) {
+            continue;
+        }
+        points.insert(points.end(), strokePoints.begin(), strokePoints.end());
+        strokes.emplace_back(s, strokePoints.size());
+    }
+
+    if (points.empty() || !file.write(points.data(), points.size() * sizeof(Point), this->spillBlock)) {
+        return;
+    }
+
+    for (auto& [s, count]: strokes) {
+        s->releasePoints();
+    }
+
+    this->spillFile = &file;
+    this->spilledStrokes = std::move(strokes);
+}
+
+void UndoAction::restore() {
+    if (!this->spillFile) {
+        return;
+    }
+
+    size_t count = 0;
+    for (auto& entry: this->spilledStrokes) {
+        count += entry.second;
+    }
+
+    vector<Point> points(count);
+    if (!this->spillFile->read(this->spillBlock, points.data(), count * sizeof(Point))) {
+        g_warning("Could not restore the strokes of \"%s\" from the undo history file", this->className.c_str());
+    } else {
+        auto it = points.begin();
+        for (auto& [s, strokeCount]: this->spilledStrokes) {
+            s->setPointVector(vector<Point>(it, it + static_cast<ptrdiff_t>(strokeCount)));
+            it += static_cast<ptrdiff_t>(strokeCount);
+        }
+    }
+
+    this->spillFile->free(this->spillBlock);
+    this->spillFile = nullptr;
+    this->spilledStrokes.clear();
+}
+
+auto UndoAction::isSpilled() const -> bool { return this->spillFile != nullptr; }
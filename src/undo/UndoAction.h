@@ -11,17 +11,22 @@
 
 #pragma once
 
+#include <utility>
+
 #include "model/PageRef.h"
 
+#include "UndoSpillFile.h"
 #include "config.h"
 
 class Control;
+class Element;
+class Stroke;
 class XojPage;
 
 class UndoAction {
 public:
     UndoAction(std::string className);  // NOLINT
-    virtual ~UndoAction() = default;
+    virtual ~UndoAction();
 
 public:
     virtual bool undo(Control* control) = 0;
@@ -36,9 +41,43 @@ public:
 
     auto getClassName() const -> std::string const&;
 
+    /**
+     * The elements owned by the action which are not part of the document in its current state,
+     * e.g. deleted strokes. They are only kept for undo / redo.
+     */
+    virtual vector<Element*> getDetachedElements();
+
+    /**
+     * @return Approximate memory kept alive by the action, in bytes
+     */
+    size_t getMemoryUsage();
+
+    /**
+     * Moves the points of the detached strokes to the file, restore() needs to be called before undo / redo
+     */
+    void spill(UndoSpillFile& file);
+    void restore();
+    bool isSpilled() const;
+
 protected:
     // This is only for debugging / Testing purpose
     std::string className;
     PageRef page;
     bool undone = false;
+
+private:
+    UndoSpillFile* spillFile = nullptr;
+    UndoSpillFile::BlockId spillBlock = 0;
+
+    /**
+     * The spilled strokes and their point count, in the order their points are stored in the block
+     */
+    vector<std::pair<Stroke*, size_t>> spilledStrokes;
+
+    /**
+     * The memory usage counted by the UndoRedoHandler
+     */
+    size_t accountedMemory = 0;
+
+    friend class UndoRedoHandler;
 };
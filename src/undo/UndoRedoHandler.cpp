@@ -4,6 +4,7 @@
 #include <cinttypes>
 
 #include "control/Control.h"
+#include "control/settings/Settings.h"
 
 #include "XojMsgBox.h"
 #include "config.h"
@@ -74,6 +75,11 @@ void UndoRedoHandler::clearContents() {
 
     this->savedUndo = nullptr;
     this->autosavedUndo = nullptr;
+    this->savedUndoDropped = false;
+    this->autosavedUndoDropped = false;
+
+    this->memoryUsage = 0;
+    this->droppedCount = 0;
 
     printContents();
 }
@@ -84,10 +90,74 @@ void UndoRedoHandler::clearRedo() {
         g_message("clearRedo()::Delete UndoAction: %" PRIu64 " / %s", (size_t)&undoAction, undoAction.getClassName());
     }
 #endif
+    for (auto const& action: this->redoList) {
+        forget(*action);
+    }
     redoList.clear();
     printContents();
 }
 
+void UndoRedoHandler::account(UndoAction& action) {
+    this->memoryUsage -= action.accountedMemory;
+    action.accountedMemory = action.getMemoryUsage();
+    this->memoryUsage += action.accountedMemory;
+}
+
+void UndoRedoHandler::forget(UndoAction& action) {
+    this->memoryUsage -= action.accountedMemory;
+    action.accountedMemory = 0;
+}
+
+void UndoRedoHandler::enforceMemoryBudget() {
+    if (this->control == nullptr) {
+        return;
+    }
+
+    Settings* settings = this->control->getSettings();
+    size_t budget = static_cast<size_t>(std::max(settings->getUndoMemoryBudget(), 0)) * 1024 * 1024;
+    size_t limit = static_cast<size_t>(std::max(settings->getUndoMemoryLimit(), 0)) * 1024 * 1024;
+
+    // Only undo actions are spilled or dropped, the redo actions are not counted against the budget.
+    // They are removed with the next new action anyway.
+    size_t redoMemory = 0;
+    for (auto const& action: this->redoList) {
+        redoMemory += action->accountedMemory;
+    }
+    auto undoMemory = [&]() { return this->memoryUsage - redoMemory; };
+
+    // The newest action may still be modified, e.g. while erasing
+    for (size_t i = 0; i + 1 < this->undoList.size() && undoMemory() > budget; i++) {
+        UndoAction& action = *this->undoList[i];
+        if (!action.isSpilled()) {
+            action.spill(this->spillFile);
+            account(action);
+        }
+    }
+
+    while (this->undoList.size() > 1 && undoMemory() + this->spillFile.getSize() > limit) {
+        dropOldestUndoAction();
+    }
+}
+
+void UndoRedoHandler::dropOldestUndoAction() {
+    UndoAction* dropped = this->undoList.front().get();
+
+    // Undoing everything now leads to the state after the dropped action, the state before it is lost
+    auto updateMarker = [dropped](UndoAction*& marker, bool& markerDropped) {
+        if (marker == dropped) {
+            marker = nullptr;
+        } else if (marker == nullptr) {
+            markerDropped = true;
+        }
+    };
+    updateMarker(this->savedUndo, this->savedUndoDropped);
+    updateMarker(this->autosavedUndo, this->autosavedUndoDropped);
+
+    forget(*dropped);
+    this->undoList.pop_front();
+    this->droppedCount++;
+}
+
 void UndoRedoHandler::undo() {
     if (this->undoList.empty()) {
         return;
@@ -99,11 +169,15 @@ void UndoRedoHandler::undo() {
     this->redoList.emplace_back(std::move(this->undoList.back()));
     this->undoList.pop_back();
 
+    undoAction.restore();
+
     Document* doc = control->getDocument();
     doc->lock();
     bool undoResult = undoAction.undo(this->control);
     doc->unlock();
 
+    account(undoAction);
+
     if (!undoResult) {
         string msg = FS(_F("Could not undo \"{1}\"\n"
                            "Something went wrong… Please write a bug report…") %
@@ -128,11 +202,16 @@ void UndoRedoHandler::redo() {
     this->undoList.emplace_back(std::move(this->redoList.back()));
     this->redoList.pop_back();
 
+    redoAction.restore();
+
     Document* doc = control->getDocument();
     doc->lock();
     bool redoResult = redoAction.redo(this->control);
     doc->unlock();
 
+    account(redoAction);
+    enforceMemoryBudget();
+
     if (!redoResult) {
         string msg = FS(_F("Could not redo \"{1}\"\n"
                            "Something went wrong… Please write a bug report…") %
@@ -157,8 +236,15 @@ void UndoRedoHandler::addUndoAction(UndoActionPtr action) {
         return;
     }
 
+    // The previous action is complete now, e.g. the erasing has finished
+    if (!this->undoList.empty()) {
+        account(*this->undoList.back());
+    }
+
     this->undoList.emplace_back(std::move(action));
     clearRedo();
+    account(*this->undoList.back());
+    enforceMemoryBudget();
     fireUpdateUndoRedoButtons(this->undoList.back()->getPages());
 
     printContents();
@@ -172,6 +258,7 @@ void UndoRedoHandler::addUndoActionBefore(UndoActionPtr action, UndoAction* befo
         addUndoAction(std::move(action));
         return;
     }
+    account(*action);
     this->undoList.emplace(iter, std::move(action));
     clearRedo();
     fireUpdateUndoRedoButtons(this->undoList.back()->getPages());
@@ -185,6 +272,7 @@ auto UndoRedoHandler::removeUndoAction(UndoAction* action) -> bool {
     if (iter == end(this->undoList)) {
         return false;
     }
+    forget(*action);
     this->undoList.erase(iter);
     clearRedo();
     fireUpdateUndoRedoButtons(action->getPages());
@@ -225,6 +313,10 @@ void UndoRedoHandler::fireUpdateUndoRedoButtons(const vector<PageRef>& pages) {
             continue;
         }
 
+        // Every modification of the document goes through an undo action,
+        // so this keeps the revision used by DocumentSnapshot up to date
+        page->markChanged();
+
         for (auto&& undoRedoListener: this->listener) {
             undoRedoListener->undoRedoPageChanged(page);
         }
@@ -234,6 +326,10 @@ void UndoRedoHandler::fireUpdateUndoRedoButtons(const vector<PageRef>& pages) {
 void UndoRedoHandler::addUndoRedoListener(UndoRedoListener* listener) { this->listener.emplace_back(listener); }
 
 auto UndoRedoHandler::isChanged() -> bool {
+    if (this->savedUndoDropped) {
+        return true;
+    }
+
     if (this->undoList.empty()) {
         return this->savedUndo;
     }
@@ -242,6 +338,10 @@ auto UndoRedoHandler::isChanged() -> bool {
 }
 
 auto UndoRedoHandler::isChangedAutosave() -> bool {
+    if (this->autosavedUndoDropped) {
+        return true;
+    }
+
     if (this->undoList.empty()) {
         return this->autosavedUndo;
     }
@@ -250,8 +350,18 @@ auto UndoRedoHandler::isChangedAutosave() -> bool {
 
 void UndoRedoHandler::documentAutosaved() {
     this->autosavedUndo = this->undoList.empty() ? nullptr : this->undoList.back().get();
+    this->autosavedUndoDropped = false;
 }
 
 void UndoRedoHandler::documentSaved() {
     this->savedUndo = this->undoList.empty() ? nullptr : this->undoList.back().get();
+    this->savedUndoDropped = false;
 }
+
+auto UndoRedoHandler::getMemoryUsage() const -> size_t { return this->memoryUsage; }
+
+auto UndoRedoHandler::getSpilledSize() const -> size_t { return this->spillFile.getSize(); }
+
+auto UndoRedoHandler::getActionCount() const -> size_t { return this->undoList.size() + this->redoList.size(); }
+
+auto UndoRedoHandler::getDroppedCount() const -> size_t { return this->droppedCount; }
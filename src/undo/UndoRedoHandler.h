@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "UndoAction.h"
+#include "UndoSpillFile.h"
 #include "XournalType.h"
 
 class Control;
@@ -60,17 +61,61 @@ public:
     void documentAutosaved();
     void documentSaved();
 
+    /**
+     * @return The memory used by the undo and redo actions, without the data moved to the temporary file, in bytes
+     */
+    size_t getMemoryUsage() const;
+
+    /**
+     * @return The compressed size of the strokes moved to the temporary file, in bytes
+     */
+    size_t getSpilledSize() const;
+
+    size_t getActionCount() const;
+
+    /**
+     * @return The number of actions removed from the history because of the memory limit
+     */
+    size_t getDroppedCount() const;
+
 private:
     void clearRedo();
     void printContents();
 
+    /**
+     * Updates the memory usage of an action, e.g. after it was undone
+     */
+    void account(UndoAction& action);
+    void forget(UndoAction& action);
+
+    /**
+     * Moves the strokes of the oldest actions to the temporary file while the memory budget is exceeded,
+     * and drops the oldest actions while the limit is exceeded. Only the memory of the undo actions is counted.
+     */
+    void enforceMemoryBudget();
+    void dropOldestUndoAction();
+
 private:
+    /**
+     * Declared before the lists, the actions release their blocks when they are deleted
+     */
+    UndoSpillFile spillFile;
+
     std::deque<UndoActionPtr> undoList;
     std::deque<UndoActionPtr> redoList;
 
     UndoAction* savedUndo = nullptr;
     UndoAction* autosavedUndo = nullptr;
 
+    /**
+     * The saved state was before an action which was dropped, it cannot be reached by undo anymore
+     */
+    bool savedUndoDropped = false;
+    bool autosavedUndoDropped = false;
+
+    size_t memoryUsage = 0;
+    size_t droppedCount = 0;
+
     std::vector<UndoRedoListener*> listener;
 
     Control* control = nullptr;
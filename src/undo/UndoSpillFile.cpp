@@ -0,0 +1,182 @@
+#include "UndoSpillFile.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include <zlib.h>
+
+#include "PathUtil.h"
+
+/**
+ * The file is only compacted if this many bytes can be reclaimed
+ */
+constexpr uint64_t MIN_COMPACT_SIZE = 16 * 1024 * 1024;
+
+static auto nextFilePath() -> fs::path {
+    static std::atomic<int> counter{0};
+    return Util::getTmpDirSubfolder("undo") / ("history-" + std::to_string(counter++) + ".bin");
+}
+
+UndoSpillFile::UndoSpillFile() = default;
+
+UndoSpillFile::~UndoSpillFile() {
+    if (this->file.is_open()) {
+        this->file.close();
+    }
+    if (!this->path.empty()) {
+        std::error_code ec;
+        fs::remove(this->path, ec);
+    }
+}
+
+auto UndoSpillFile::open() -> bool {
+    if (this->file.is_open()) {
+        return true;
+    }
+
+    if (this->path.empty()) {
+        this->path = nextFilePath();
+    }
+
+    this->file.open(this->path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!this->file.is_open()) {
+        g_warning("Could not create the undo history file \"%s\"", this->path.u8string().c_str());
+        return false;
+    }
+    this->fileSize = 0;
+    return true;
+}
+
+auto UndoSpillFile::write(const void* data, size_t size, BlockId& id) -> bool {
+    if (!open()) {
+        return false;
+    }
+
+    uLongf compressedSize = compressBound(size);
+    vector<Bytef> compressed(compressedSize);
+    if (compress2(compressed.data(), &compressedSize, static_cast<const Bytef*>(data), size, Z_BEST_SPEED) != Z_OK) {
+        return false;
+    }
+
+    this->file.clear();
+    this->file.seekp(static_cast<std::streamoff>(this->fileSize));
+    this->file.write(reinterpret_cast<const char*>(compressed.data()), static_cast<std::streamsize>(compressedSize));
+    if (!this->file.good()) {
+        g_warning("Could not write the undo history file \"%s\"", this->path.u8string().c_str());
+        return false;
+    }
+
+    Block block;
+    block.offset = this->fileSize;
+    block.compressedSize = compressedSize;
+    block.size = size;
+    block.used = true;
+
+    if (this->freeIds.empty()) {
+        id = this->blocks.size();
+        this->blocks.push_back(block);
+    } else {
+        id = this->freeIds.back();
+        this->freeIds.pop_back();
+        this->blocks[id] = block;
+    }
+
+    this->fileSize += compressedSize;
+    this->usedSize += compressedSize;
+    this->usedDataSize += size;
+    return true;
+}
+
+auto UndoSpillFile::read(BlockId id, void* data, size_t size) -> bool {
+    if (id >= this->blocks.size() || !this->blocks[id].used || this->blocks[id].size != size) {
+        return false;
+    }
+
+    Block& block = this->blocks[id];
+    vector<Bytef> compressed(block.compressedSize);
+
+    this->file.clear();
+    this->file.seekg(static_cast<std::streamoff>(block.offset));
+    this->file.read(reinterpret_cast<char*>(compressed.data()), static_cast<std::streamsize>(block.compressedSize));
+    if (!this->file.good()) {
+        g_warning("Could not read the undo history file \"%s\"", this->path.u8string().c_str());
+        return false;
+    }
+
+    uLongf uncompressedSize = size;
+    return uncompress(static_cast<Bytef*>(data), &uncompressedSize, compressed.data(), block.compressedSize) ==
+                   Z_OK &&
+           uncompressedSize == size;
+}
+
+void UndoSpillFile::free(BlockId id) {
+    if (id >= this->blocks.size() || !this->blocks[id].used) {
+        return;
+    }
+
+    Block& block = this->blocks[id];
+    block.used = false;
+    this->usedSize -= block.compressedSize;
+    this->usedDataSize -= block.size;
+    this->freeIds.push_back(id);
+
+    if (this->usedSize == 0) {
+        // Nothing left, start over at the beginning of the file
+        this->blocks.clear();
+        this->freeIds.clear();
+        this->file.close();
+        open();
+    } else if (this->fileSize - this->usedSize > std::max<uint64_t>(this->usedSize, MIN_COMPACT_SIZE)) {
+        compact();
+    }
+}
+
+void UndoSpillFile::compact() {
+    fs::path newPath = nextFilePath();
+    std::fstream newFile(newPath, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!newFile.is_open()) {
+        return;
+    }
+
+    uint64_t offset = 0;
+    vector<uint64_t> offsets(this->blocks.size());
+    vector<char> buffer;
+    for (size_t i = 0; i < this->blocks.size(); i++) {
+        Block& block = this->blocks[i];
+        if (!block.used) {
+            continue;
+        }
+
+        buffer.resize(block.compressedSize);
+        this->file.clear();
+        this->file.seekg(static_cast<std::streamoff>(block.offset));
+        this->file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        newFile.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        if (!this->file.good() || !newFile.good()) {
+            g_warning("Could not compact the undo history file \"%s\"", this->path.u8string().c_str());
+            newFile.close();
+            std::error_code ec;
+            fs::remove(newPath, ec);
+            return;
+        }
+
+        offsets[i] = offset;
+        offset += block.compressedSize;
+    }
+
+    for (size_t i = 0; i < this->blocks.size(); i++) {
+        this->blocks[i].offset = offsets[i];
+    }
+
+    this->file.close();
+    std::error_code ec;
+    fs::remove(this->path, ec);
+
+    this->file = std::move(newFile);
+    this->path = newPath;
+    this->fileSize = offset;
+}
+
+auto UndoSpillFile::getSize() const -> size_t { return this->usedSize; }
+
+auto UndoSpillFile::getDataSize() const -> size_t { return this->usedDataSize; }
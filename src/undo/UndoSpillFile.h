@@ -0,0 +1,91 @@
+/*
+ * Xournal++
+ *
+ * Temporary file for the data of old undo actions
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+#include "XournalType.h"
+#include "filesystem.h"
+
+/**
+ * Stores compressed blocks of data in a temporary file, which is created on the first write and
+ * removed when this object is destroyed. The space of freed blocks is reclaimed by rewriting the
+ * file once more than half of it is unused.
+ */
+class UndoSpillFile {
+public:
+    using BlockId = size_t;
+
+    UndoSpillFile();
+    ~UndoSpillFile();
+
+    UndoSpillFile(const UndoSpillFile&) = delete;
+    UndoSpillFile& operator=(const UndoSpillFile&) = delete;
+
+public:
+    /**
+     * Compresses the data and appends it to the file
+     *
+     * @return False if the file could not be written
+     */
+    bool write(const void* data, size_t size, BlockId& id);
+
+    /**
+     * Reads a block back into data, which needs to have the size the block was written with
+     *
+     * @return False if the block could not be read
+     */
+    bool read(BlockId id, void* data, size_t size);
+
+    /**
+     * The block is not needed anymore
+     */
+    void free(BlockId id);
+
+    /**
+     * @return The size of the blocks in the file, in bytes
+     */
+    size_t getSize() const;
+
+    /**
+     * @return The uncompressed size of the blocks in the file, in bytes
+     */
+    size_t getDataSize() const;
+
+private:
+    bool open();
+
+    /**
+     * Rewrites the file without the freed blocks
+     */
+    void compact();
+
+private:
+    struct Block {
+        uint64_t offset = 0;
+        uint64_t compressedSize = 0;
+        uint64_t size = 0;
+        bool used = false;
+    };
+
+    fs::path path;
+    std::fstream file;
+    uint64_t fileSize = 0;
+
+    vector<Block> blocks;
+    vector<BlockId> freeIds;
+
+    size_t usedSize = 0;
+    size_t usedDataSize = 0;
+};
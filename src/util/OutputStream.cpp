@@ -41,3 +41,17 @@ void GzOutputStream::close() {
         this->fp = nullptr;
     }
 }
+
+////////////////////////////////////////////////////////
+/// StringOutputStream /////////////////////////////////
+////////////////////////////////////////////////////////
+
+StringOutputStream::StringOutputStream() = default;
+
+StringOutputStream::~StringOutputStream() = default;
+
+void StringOutputStream::write(const char* data, int len) { this->contents.append(data, len); }
+
+void StringOutputStream::close() {}
+
+auto StringOutputStream::getContents() -> string& { return this->contents; }
@@ -52,3 +52,22 @@ private:
     string target;
     fs::path file;
 };
+
+class StringOutputStream: public OutputStream {
+public:
+    StringOutputStream();
+    virtual ~StringOutputStream();
+
+public:
+    virtual void write(const char* data, int len);
+
+    virtual void close();
+
+    /**
+     * @return The written data
+     */
+    string& getContents();
+
+private:
+    string contents;
+};
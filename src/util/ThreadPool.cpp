@@ -0,0 +1,76 @@
+#include "ThreadPool.h"
+
+#include <utility>
+
+ThreadPool::ThreadPool(unsigned int threadCount) {
+    if (threadCount == 0) {
+        threadCount = getDefaultThreadCount();
+    }
+
+    this->workers.reserve(threadCount);
+    for (unsigned int i = 0; i < threadCount; i++) {
+        this->workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(this->queueMutex);
+        this->stopping = true;
+    }
+    this->taskAvailable.notify_all();
+
+    for (std::thread& t: this->workers) {
+        t.join();
+    }
+}
+
+auto ThreadPool::getDefaultThreadCount() -> unsigned int {
+    unsigned int count = std::thread::hardware_concurrency();
+    return count > 0 ? count : 1;
+}
+
+auto ThreadPool::getThreadCount() const -> unsigned int { return static_cast<unsigned int>(this->workers.size()); }
+
+void ThreadPool::addTask(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(this->queueMutex);
+        this->tasks.push_back(std::move(task));
+        this->pendingTasks++;
+    }
+    this->taskAvailable.notify_one();
+}
+
+void ThreadPool::waitAll() {
+    std::unique_lock<std::mutex> lock(this->queueMutex);
+    this->allTasksDone.wait(lock, [this]() { return this->pendingTasks == 0; });
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(this->queueMutex);
+            this->taskAvailable.wait(lock, [this]() { return this->stopping || !this->tasks.empty(); });
+
+            // Finish the queued tasks before stopping
+            if (this->tasks.empty()) {
+                return;
+            }
+
+            task = std::move(this->tasks.front());
+            this->tasks.pop_front();
+        }
+
+        task();
+
+        bool done = false;
+        {
+            std::lock_guard<std::mutex> lock(this->queueMutex);
+            done = --this->pendingTasks == 0;
+        }
+        if (done) {
+            this->allTasksDone.notify_all();
+        }
+    }
+}
@@ -0,0 +1,72 @@
+/*
+ * Xournal++
+ *
+ * A fixed count of worker threads processing a queue of tasks
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+    /**
+     * @param threadCount The count of worker threads, 0 to use one thread per CPU core
+     */
+    explicit ThreadPool(unsigned int threadCount = 0);
+
+    /**
+     * Finishes all queued tasks, then stops the worker threads
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+public:
+    /**
+     * Queues a task, which is executed by the next idle worker thread
+     */
+    void addTask(std::function<void()> task);
+
+    /**
+     * Blocks until all queued tasks are finished
+     */
+    void waitAll();
+
+    unsigned int getThreadCount() const;
+
+    /**
+     * @return The count of CPU cores, at least 1
+     */
+    static unsigned int getDefaultThreadCount();
+
+private:
+    void workerLoop();
+
+private:
+    std::vector<std::thread> workers;
+
+    std::deque<std::function<void()>> tasks;
+
+    /**
+     * Count of tasks which are queued or currently executed
+     */
+    size_t pendingTasks = 0;
+
+    bool stopping = false;
+
+    std::mutex queueMutex;
+    std::condition_variable taskAvailable;
+    std::condition_variable allTasksDone;
+};
@@ -2,6 +2,8 @@
 
 BinObjectEncoding::BinObjectEncoding() = default;
 
+BinObjectEncoding::BinObjectEncoding(gsize reserve): ObjectEncoding(reserve) {}
+
 BinObjectEncoding::~BinObjectEncoding() = default;
 
 void BinObjectEncoding::addData(const void* data, int len) {
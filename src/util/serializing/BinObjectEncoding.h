@@ -16,6 +16,7 @@
 class BinObjectEncoding: public ObjectEncoding {
 public:
     BinObjectEncoding();
+    explicit BinObjectEncoding(gsize reserve);
     virtual ~BinObjectEncoding();
 
 public:
@@ -1,6 +1,7 @@
 #include "InputStreamException.h"
 
 const char* XML_VERSION_STR = "XojStrm1:";
+const char* XML_VERSION_STR_COMPACT = "XojStrm2:";
 
 InputStreamException::InputStreamException(const string& message, const string& filename, int line) {
     this->message = message + ", " + filename + ": " + std::to_string(line);
@@ -1,6 +1,6 @@
 #include "ObjectEncoding.h"
 
-ObjectEncoding::ObjectEncoding() { this->data = g_string_new(""); }
+ObjectEncoding::ObjectEncoding(gsize reserve) { this->data = g_string_sized_new(reserve); }
 
 ObjectEncoding::~ObjectEncoding() = default;
 
@@ -18,7 +18,10 @@
 
 class ObjectEncoding {
 public:
-    ObjectEncoding();
+    /**
+     * @param reserve Initial size of the buffer, it grows exponentially if more data is added
+     */
+    explicit ObjectEncoding(gsize reserve = 4096);
     virtual ~ObjectEncoding();
 
 public:
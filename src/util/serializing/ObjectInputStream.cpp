@@ -16,9 +16,10 @@ auto ObjectInputStream::read(const char* data, int len) -> bool {
     if (this->str) {
         g_string_free(this->str, true);
     }
+
     this->str = g_string_new_len(data, len);
     this->pos = 0;
-
+    this->compact = false;
 
     //	//clipboad debug
     //	FILE * fp = fopen("/home/andreas/tmp/xoj/clipboard.bin", "w");
@@ -26,16 +27,20 @@ auto ObjectInputStream::read(const char* data, int len) -> bool {
     //	fclose(fp);
 
     try {
+        // The header has the old string encoding in both formats
         string version = readString();
-        if (version != XML_VERSION_STR) {
+        if (version == XML_VERSION_STR_COMPACT) {
+            this->compact = true;
+        } else if (version != XML_VERSION_STR) {
             g_warning("ObjectInputStream version mismatch... two different Xournal versions running? (%s / %s)",
-                      version.c_str(), XML_VERSION_STR);
+                      version.c_str(), XML_VERSION_STR_COMPACT);
             return false;
         }
     } catch (InputStreamException& e) {
         g_warning("InputStreamException: %s", e.what());
         return false;
     }
+
     return true;
 }
 
@@ -53,10 +58,9 @@ auto ObjectInputStream::readObject() -> string {
 }
 
 auto ObjectInputStream::getNextObjectName() -> string {
-    int pos = this->pos;
+    gsize pos = this->pos;
     checkType('{');
     string name = readString();
-
     this->pos = pos;
 
     return name;
@@ -64,9 +68,41 @@ auto ObjectInputStream::getNextObjectName() -> string {
 
 void ObjectInputStream::endObject() { checkType('}'); }
 
+auto ObjectInputStream::readVarint() -> guint64 {
+    guint64 value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (this->pos >= this->str->len) {
+            throw InputStreamException("End reached, but try to read a number", __FILE__, __LINE__);
+        }
+
+        auto byte = static_cast<unsigned char>(this->str->str[this->pos++]);
+        value |= static_cast<guint64>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+
+    throw InputStreamException("Invalid number", __FILE__, __LINE__);
+}
+
+auto ObjectInputStream::readBytes(size_t len, const char* type) -> const char* {
+    if (len > this->str->len - this->pos) {
+        throw InputStreamException(FS(FORMAT_STR("End reached, but try to read {1}") % type), __FILE__, __LINE__);
+    }
+
+    const char* data = this->str->str + this->pos;
+    this->pos += len;
+    return data;
+}
+
 auto ObjectInputStream::readInt() -> int {
     checkType('i');
 
+    if (this->compact) {
+        guint64 value = readVarint();
+        return static_cast<int>(static_cast<gint64>(value >> 1) ^ -static_cast<gint64>(value & 1));
+    }
+
     if (this->pos + sizeof(int) >= this->str->len) {
         throw InputStreamException("End reached, but try to read an integer", __FILE__, __LINE__);
     }
@@ -79,18 +115,18 @@ auto ObjectInputStream::readInt() -> int {
 auto ObjectInputStream::readDouble() -> double {
     checkType('d');
 
-    if (this->pos + sizeof(double) >= this->str->len) {
-        throw InputStreamException("End reached, but try to read an double", __FILE__, __LINE__);
-    }
-
-    double d = *(reinterpret_cast<double*>(this->str->str + this->pos));
-    this->pos += sizeof(double);
+    double d = 0;
+    memcpy(&d, readBytes(sizeof(double), "a double"), sizeof(double));
     return d;
 }
 
 auto ObjectInputStream::readSizeT() -> size_t {
     checkType('l');
 
+    if (this->compact) {
+        return readVarint();
+    }
+
     if (this->pos + sizeof(size_t) >= this->str->len) {
         throw InputStreamException("End reached, but try to read an integer", __FILE__, __LINE__);
     }
@@ -103,6 +139,11 @@ auto ObjectInputStream::readSizeT() -> size_t {
 auto ObjectInputStream::readString() -> string {
     checkType('s');
 
+    if (this->compact) {
+        size_t len = readVarint();
+        return string(readBytes(len, "a string"), len);
+    }
+
     if (this->pos + sizeof(int) >= this->str->len) {
         throw InputStreamException("End reached, but try to read an string", __FILE__, __LINE__);
     }
@@ -119,33 +160,42 @@ auto ObjectInputStream::readString() -> string {
     return s;
 }
 
-void ObjectInputStream::readData(void** data, int* length) {
+auto ObjectInputStream::readDataBlock(int& width, size_t& count) -> const char* {
     checkType('b');
 
-    if (this->pos + 2 * sizeof(int) >= this->str->len) {
-        throw InputStreamException("End reached, but try to read data", __FILE__, __LINE__);
+    if (this->compact) {
+        count = readVarint();
+        width = static_cast<int>(readVarint());
+    } else {
+        const char* header = readBytes(2 * sizeof(int), "data");
+        int len = 0;
+        memcpy(&len, header, sizeof(int));
+        memcpy(&width, header + sizeof(int), sizeof(int));
+        count = len > 0 ? len : 0;
     }
 
-    int len = *(reinterpret_cast<int*>(this->str->str + this->pos));
-    this->pos += sizeof(int);
-
-    int width = *(reinterpret_cast<int*>(this->str->str + this->pos));
-    this->pos += sizeof(int);
-
-    if (this->pos + (len * width) >= this->str->len) {
+    if (width <= 0 || count > (this->str->len - this->pos) / width) {
+        if (count == 0) {
+            return nullptr;
+        }
         throw InputStreamException("End reached, but try to read data", __FILE__, __LINE__);
     }
 
-    if (len == 0) {
+    return readBytes(count * width, "data");
+}
+
+void ObjectInputStream::readData(void** data, int* length) {
+    int width = 0;
+    size_t count = 0;
+    const char* block = readDataBlock(width, count);
+
+    if (count == 0) {
         *length = 0;
         *data = nullptr;
     } else {
-        *data = g_malloc(len * width);
-        *length = len;
-
-        memcpy(*data, this->str->str + this->pos, len * width);
-
-        this->pos += len * width;
+        *data = g_malloc(count * width);
+        *length = static_cast<int>(count);
+        memcpy(*data, block, count * width);
     }
 }
 
@@ -163,55 +213,58 @@ public:
 };
 
 auto cairoReadFunction(PngDatasource* obj, unsigned char* data, unsigned int length) -> cairo_status_t {
-    for (unsigned int i = 0; i < length; i++, obj->pos++) {
-        if (obj->pos >= obj->len) {
-            return CAIRO_STATUS_READ_ERROR;
-        }
-        data[i] = obj->data[obj->pos];
+    if (static_cast<unsigned int>(obj->len - obj->pos) < length) {
+        return CAIRO_STATUS_READ_ERROR;
     }
 
+    memcpy(data, obj->data + obj->pos, length);
+    obj->pos += length;
+
     return CAIRO_STATUS_SUCCESS;
 }
 
 auto ObjectInputStream::readImage() -> cairo_surface_t* {
     checkType('m');
 
-    if (this->pos + sizeof(int) >= this->str->len) {
-        throw InputStreamException("End reached, but try to read an image", __FILE__, __LINE__);
+    size_t len = 0;
+    if (this->compact) {
+        len = readVarint();
+    } else {
+        // The length was written as gsize, of which only an int is used
+        const char* header = readBytes(sizeof(gsize), "an image");
+        int l = 0;
+        memcpy(&l, header, sizeof(int));
+        len = l > 0 ? l : 0;
     }
 
-    int len = *(reinterpret_cast<int*>(this->str->str + this->pos));
-    // this->pos += sizeof(int);
-    // totally not equivalent!
-    this->pos += sizeof(gsize);
-
-    if (this->pos + len >= this->str->len) {
-        throw InputStreamException("End reached, but try to read an image", __FILE__, __LINE__);
+    const char* data = readBytes(len, "an image");
+    if (len == 0) {
+        return nullptr;
     }
 
-    PngDatasource source(this->str->str + this->pos, len);
-    // cairo_surface_t * img = cairo_image_surface_create_from_png_stream((cairo_read_func_t) cairoReadFunction,
-    // &source);
-    cairo_surface_t* img = cairo_image_surface_create_from_png_stream(
-            reinterpret_cast<cairo_read_func_t>(&cairoReadFunction), &source);
-
-    this->pos += len;
-
-    return img;
+    PngDatasource source(const_cast<char*>(data), len);
+    return cairo_image_surface_create_from_png_stream(reinterpret_cast<cairo_read_func_t>(&cairoReadFunction),
+                                                      &source);
 }
 
 void ObjectInputStream::checkType(char type) {
-    if (this->pos + 2 > this->str->len) {
+    // The compact format only has the type character, without '_'
+    gsize tagLen = this->compact ? 1 : 2;
+    if (this->pos + tagLen > this->str->len) {
         throw InputStreamException(FS(FORMAT_STR("End reached, but try to read {1}, index {2} of {3}") % getType(type) %
                                       this->pos % this->str->len),
                                    __FILE__, __LINE__);
     }
-    if (this->str->str[this->pos] != '_') {
-        throw InputStreamException(FS(FORMAT_STR("Expected type signature of {1}, index {2} of {3}, but read '{4}'") %
-                                      getType(type) % this->pos % this->str->len % this->str->str[this->pos]),
-                                   __FILE__, __LINE__);
+
+    if (!this->compact) {
+        if (this->str->str[this->pos] != '_') {
+            throw InputStreamException(
+                    FS(FORMAT_STR("Expected type signature of {1}, index {2} of {3}, but read '{4}'") % getType(type) %
+                       this->pos % this->str->len % this->str->str[this->pos]),
+                    __FILE__, __LINE__);
+        }
+        this->pos++;
     }
-    this->pos++;
 
     if (this->str->str[this->pos] != type) {
         throw InputStreamException(
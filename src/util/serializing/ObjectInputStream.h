@@ -11,12 +11,21 @@
 
 #pragma once
 
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
 #include <gtk/gtk.h>
 
 #include "InputStreamException.h"
+#include "i18n.h"
 
 class Serializeable;
 
+/**
+ * Reads the compact format written by ObjectOutputStream, and the older format
+ * with two byte type tags and fixed size numbers
+ */
 class ObjectInputStream {
 public:
     ObjectInputStream();
@@ -38,12 +47,57 @@ public:
     void readData(void** data, int* len);
     cairo_surface_t* readImage();
 
+    /**
+     * Reads values written by ObjectOutputStream::writeArray, with a single copy
+     */
+    template <typename T>
+    std::vector<T> readArray() {
+        static_assert(std::is_trivially_copyable<T>::value, "The values are copied as bytes");
+
+        int width = 0;
+        size_t count = 0;
+        const char* data = readDataBlock(width, count);
+        if (count > 0 && width != static_cast<int>(sizeof(T))) {
+            throw InputStreamException(FS(FORMAT_STR("Expected elements of {1} bytes, but read {2}") %
+                                          static_cast<int>(sizeof(T)) % width),
+                                       __FILE__, __LINE__);
+        }
+
+        std::vector<T> values(count);
+        if (count > 0) {
+            memcpy(values.data(), data, count * sizeof(T));
+        }
+        return values;
+    }
+
 private:
     void checkType(char type);
 
+    /**
+     * Reads the header of binary data
+     * @return The elements, valid while the stream exists
+     */
+    const char* readDataBlock(int& width, size_t& count);
+
+    /**
+     * Reads a variable length number of the compact format
+     */
+    guint64 readVarint();
+
+    /**
+     * Skips len bytes
+     * @return The skipped bytes
+     */
+    const char* readBytes(size_t len, const char* type);
+
     static string getType(char type);
 
 private:
     GString* str = nullptr;
     gsize pos = 0;
+
+    /**
+     * The stream has the compact format, with one byte type tags and variable length numbers
+     */
+    bool compact = false;
 };
@@ -1,13 +1,43 @@
 #include "ObjectOutputStream.h"
 
+#include <cstring>
+
 #include "ObjectEncoding.h"
 #include "Serializeable.h"
 
+namespace {
+/**
+ * Maximum size of a variable length 64 bit number
+ */
+constexpr size_t MAX_VARINT_SIZE = 10;
+
+auto encodeVarint(guint64 value, unsigned char* buffer) -> size_t {
+    size_t len = 0;
+    while (value >= 0x80) {
+        buffer[len++] = static_cast<unsigned char>(value | 0x80);
+        value >>= 7;
+    }
+    buffer[len++] = static_cast<unsigned char>(value);
+    return len;
+}
+
+/**
+ * Small negative numbers are mapped to small positive numbers, so they stay short
+ */
+auto zigzag(gint64 value) -> guint64 {
+    return (static_cast<guint64>(value) << 1) ^ static_cast<guint64>(value >> 63);
+}
+}  // namespace
+
 ObjectOutputStream::ObjectOutputStream(ObjectEncoding* encoder) {
     g_assert(encoder != nullptr);
     this->encoder = encoder;
 
-    writeString(XML_VERSION_STR);
+    // The header uses the old string encoding, so older versions can read and reject it
+    int len = strlen(XML_VERSION_STR_COMPACT);
+    this->encoder->addStr("_s");
+    this->encoder->addData(&len, sizeof(int));
+    this->encoder->addData(XML_VERSION_STR_COMPACT, len);
 }
 
 ObjectOutputStream::~ObjectOutputStream() {
@@ -15,45 +45,51 @@ ObjectOutputStream::~ObjectOutputStream() {
     this->encoder = nullptr;
 }
 
-void ObjectOutputStream::writeObject(const char* name) {
-    this->encoder->addStr("_{");
+void ObjectOutputStream::writeTag(char type, guint64 value) {
+    unsigned char buffer[1 + MAX_VARINT_SIZE];
+    buffer[0] = static_cast<unsigned char>(type);
+    size_t len = 1 + encodeVarint(value, buffer + 1);
+    this->encoder->addData(buffer, len);
+}
 
+void ObjectOutputStream::writeObject(const char* name) {
+    this->encoder->addData("{", 1);
     writeString(name);
 }
 
-void ObjectOutputStream::endObject() { this->encoder->addStr("_}"); }
+void ObjectOutputStream::endObject() { this->encoder->addData("}", 1); }
 
-void ObjectOutputStream::writeInt(int i) {
-    this->encoder->addStr("_i");
-    this->encoder->addData(&i, sizeof(int));
-}
+void ObjectOutputStream::writeInt(int i) { writeTag('i', zigzag(i)); }
 
 void ObjectOutputStream::writeDouble(double d) {
-    this->encoder->addStr("_d");
-    this->encoder->addData(&d, sizeof(double));
+    char buffer[1 + sizeof(double)];
+    buffer[0] = 'd';
+    memcpy(buffer + 1, &d, sizeof(double));
+    this->encoder->addData(buffer, sizeof(buffer));
 }
 
-void ObjectOutputStream::writeSizeT(size_t st) {
-    this->encoder->addStr("_l");
-    this->encoder->addData(&st, sizeof(size_t));
-}
+void ObjectOutputStream::writeSizeT(size_t st) { writeTag('l', st); }
 
 void ObjectOutputStream::writeString(const char* str) { writeString(string(str)); }
 
 void ObjectOutputStream::writeString(const string& s) {
-    this->encoder->addStr("_s");
-    int len = s.length();
-    this->encoder->addData(&len, sizeof(int));
-    this->encoder->addData(s.c_str(), len);
+    writeTag('s', s.length());
+    this->encoder->addData(s.c_str(), s.length());
 }
 
 void ObjectOutputStream::writeData(const void* data, int len, int width) {
-    this->encoder->addStr("_b");
-    this->encoder->addData(&len, sizeof(int));
+    if (data == nullptr) {
+        len = 0;
+    }
 
-    // size of one element
-    this->encoder->addData(&width, sizeof(int));
-    if (data != nullptr) {
+    // Count and size of one element, followed by all elements as one block
+    unsigned char buffer[1 + 2 * MAX_VARINT_SIZE];
+    buffer[0] = 'b';
+    size_t headerLen = 1 + encodeVarint(len, buffer + 1);
+    headerLen += encodeVarint(width, buffer + headerLen);
+    this->encoder->addData(buffer, headerLen);
+
+    if (len > 0) {
         this->encoder->addData(data, len * width);
     }
 }
@@ -66,10 +102,11 @@ static auto cairoWriteFunction(GString* string, const unsigned char* data, unsig
 void ObjectOutputStream::writeImage(cairo_surface_t* img) {
     GString* imgStr = g_string_sized_new(102400);
 
-    cairo_surface_write_to_png_stream(img, reinterpret_cast<cairo_write_func_t>(&cairoWriteFunction), imgStr);
+    if (img) {
+        cairo_surface_write_to_png_stream(img, reinterpret_cast<cairo_write_func_t>(&cairoWriteFunction), imgStr);
+    }
 
-    this->encoder->addStr("_m");
-    this->encoder->addData(&imgStr->len, sizeof(gsize));
+    writeTag('m', imgStr->len);
 
     this->encoder->addData(imgStr->str, imgStr->len);
 
@@ -12,6 +12,7 @@
 #pragma once
 
 #include <string>
+#include <type_traits>
 #include <vector>
 
 #include <gtk/gtk.h>
@@ -21,6 +22,10 @@
 class ObjectEncoding;
 class Serializeable;
 
+/**
+ * Writes the compact format: one byte type tags, integers as variable length
+ * (zigzag) numbers and binary arrays as a single block.
+ */
 class ObjectOutputStream {
 public:
     ObjectOutputStream(ObjectEncoding* encoder);
@@ -37,10 +42,26 @@ public:
     void writeString(const string& s);
 
     void writeData(const void* data, int len, int width);
+
+    /**
+     * Writes all values with a single copy, read with ObjectInputStream::readArray
+     */
+    template <typename T>
+    void writeArray(const std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable<T>::value, "The values are copied as bytes");
+        writeData(values.data(), static_cast<int>(values.size()), sizeof(T));
+    }
+
     void writeImage(cairo_surface_t* img);
 
     GString* getStr();
 
+private:
+    /**
+     * Writes a type tag followed by value as variable length number
+     */
+    void writeTag(char type, guint64 value);
+
 private:
     ObjectEncoding* encoder = nullptr;
 };
@@ -16,8 +16,16 @@
 class ObjectInputStream;
 class ObjectOutputStream;
 
+/**
+ * Header of streams with two byte type tags and fixed size numbers, only read
+ */
 extern const char* XML_VERSION_STR;
 
+/**
+ * Header of the compact streams, with one byte type tags and variable length integers
+ */
+extern const char* XML_VERSION_STR_COMPACT;
+
 class Serializeable {
 public:
     virtual void serialize(ObjectOutputStream& out) = 0;
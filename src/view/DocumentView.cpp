@@ -6,6 +6,7 @@
 #include "model/Layer.h"
 #include "model/eraser/EraseableStroke.h"
 
+#include "ImageMipmap.h"
 #include "StrokeView.h"
 #include "TextView.h"
 
@@ -22,6 +23,8 @@ DocumentView::~DocumentView() {
  */
 void DocumentView::setMarkAudioStroke(bool markAudioStroke) { this->markAudioStroke = markAudioStroke; }
 
+void DocumentView::setPopplerMutex(std::mutex* popplerMutex) { this->popplerMutex = popplerMutex; }
+
 void DocumentView::applyColor(cairo_t* cr, Stroke* s) {
     if (s->getToolType() == STROKE_TOOL_HIGHLIGHTER) {
         if (s->getFill() != -1) {
@@ -69,27 +72,19 @@ void DocumentView::drawText(cairo_t* cr, Text* t) {
 }
 
 void DocumentView::drawImage(cairo_t* cr, Image* i) {
-    cairo_matrix_t defaultMatrix = {0};
-    cairo_get_matrix(cr, &defaultMatrix);
-
+    // The own reference keeps the surface alive, even if it is evicted from the cache meanwhile
     cairo_surface_t* img = i->getImage();
-    int width = cairo_image_surface_get_width(img);
-    int height = cairo_image_surface_get_height(img);
+    if (img == nullptr) {
+        return;
+    }
 
     cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+    ImageMipmap::paint(cr, img, i->getX(), i->getY(), i->getElementWidth(), i->getElementHeight());
 
-    double xFactor = i->getElementWidth() / width;
-    double yFactor = i->getElementHeight() / height;
-
-    cairo_scale(cr, xFactor, yFactor);
-
-    cairo_set_source_surface(cr, img, i->getX() / xFactor, i->getY() / yFactor);
-    cairo_paint(cr);
-
-    cairo_set_matrix(cr, &defaultMatrix);
+    cairo_surface_destroy(img);
 }
 
-void DocumentView::drawTexImage(cairo_t* cr, TexImage* texImage) {
+void DocumentView::drawTexImage(cairo_t* cr, TexImage* texImage) const {
     cairo_matrix_t defaultMatrix = {0};
     cairo_get_matrix(cr, &defaultMatrix);
 
@@ -97,6 +92,11 @@ void DocumentView::drawTexImage(cairo_t* cr, TexImage* texImage) {
     cairo_surface_t* img = texImage->getImage();
 
     if (pdf != nullptr) {
+        std::unique_lock<std::mutex> lock;
+        if (this->popplerMutex) {
+            lock = std::unique_lock<std::mutex>(*this->popplerMutex);
+        }
+
         if (poppler_document_get_n_pages(pdf) < 1) {
             g_warning("Got latex PDf without pages!: %s", texImage->getText().c_str());
             return;
@@ -114,19 +114,11 @@ void DocumentView::drawTexImage(cairo_t* cr, TexImage* texImage) {
         cairo_translate(cr, texImage->getX(), texImage->getY());
         cairo_scale(cr, xFactor, yFactor);
         poppler_page_render(page, cr);
+        g_object_unref(page);
     } else if (img != nullptr) {
-        int width = cairo_image_surface_get_width(img);
-        int height = cairo_image_surface_get_height(img);
-
         cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
-
-        double xFactor = texImage->getElementWidth() / width;
-        double yFactor = texImage->getElementHeight() / height;
-
-        cairo_scale(cr, xFactor, yFactor);
-
-        cairo_set_source_surface(cr, img, texImage->getX() / xFactor, texImage->getY() / yFactor);
-        cairo_paint(cr);
+        ImageMipmap::paint(cr, img, texImage->getX(), texImage->getY(), texImage->getElementWidth(),
+                           texImage->getElementHeight());
     }
 
     cairo_set_matrix(cr, &defaultMatrix);
@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -61,6 +62,12 @@ public:
      */
     void setMarkAudioStroke(bool markAudioStroke);
 
+    /**
+     * Poppler is not thread safe. If pages are drawn on several threads, TeX images are only rendered while
+     * holding this mutex, which also needs to be held while rendering PDF backgrounds.
+     */
+    void setPopplerMutex(std::mutex* popplerMutex);
+
     // API for special drawing, usually you won't call this methods
 public:
     /**
@@ -96,7 +103,7 @@ public:
 private:
     static void drawText(cairo_t* cr, Text* t);
     static void drawImage(cairo_t* cr, Image* i);
-    static void drawTexImage(cairo_t* cr, TexImage* texImage);
+    void drawTexImage(cairo_t* cr, TexImage* texImage) const;
 
     void drawElement(cairo_t* cr, Element* e) const;
 
@@ -110,6 +117,8 @@ private:
     bool dontRenderEditingStroke = false;
     bool markAudioStroke = false;
 
+    std::mutex* popplerMutex = nullptr;
+
     double lX = -1;
     double lY = -1;
     double lWidth = -1;
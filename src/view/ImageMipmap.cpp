@@ -0,0 +1,133 @@
+#include "ImageMipmap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <vector>
+
+namespace {
+/**
+ * Levels below the full resolution, levels[0] has half of its size
+ */
+struct Pyramid {
+    ~Pyramid() {
+        for (cairo_surface_t* level: levels) {
+            cairo_surface_destroy(level);
+        }
+    }
+
+    std::mutex mutex;
+    std::vector<cairo_surface_t*> levels;
+};
+
+const cairo_user_data_key_t pyramidKey = {0};
+
+/**
+ * Protects attaching the pyramid to a surface, the levels are protected by the mutex of the pyramid
+ */
+std::mutex attachMutex;
+
+void destroyPyramid(void* data) { delete static_cast<Pyramid*>(data); }
+
+auto getPyramid(cairo_surface_t* surface) -> Pyramid* {
+    std::lock_guard<std::mutex> lock(attachMutex);
+
+    auto* pyramid = static_cast<Pyramid*>(cairo_surface_get_user_data(surface, &pyramidKey));
+    if (pyramid == nullptr) {
+        pyramid = new Pyramid();
+        if (cairo_surface_set_user_data(surface, &pyramidKey, pyramid, destroyPyramid) != CAIRO_STATUS_SUCCESS) {
+            delete pyramid;
+            return nullptr;
+        }
+    }
+    return pyramid;
+}
+
+auto downsample(cairo_surface_t* src) -> cairo_surface_t* {
+    int srcWidth = cairo_image_surface_get_width(src);
+    int srcHeight = cairo_image_surface_get_height(src);
+    int width = std::max(1, srcWidth / 2);
+    int height = std::max(1, srcHeight / 2);
+
+    cairo_format_t format = cairo_image_surface_get_format(src);
+    if (format != CAIRO_FORMAT_RGB24) {
+        format = CAIRO_FORMAT_ARGB32;
+    }
+
+    cairo_surface_t* level = cairo_image_surface_create(format, width, height);
+    cairo_t* cr = cairo_create(level);
+    cairo_scale(cr, static_cast<double>(width) / srcWidth, static_cast<double>(height) / srcHeight);
+    cairo_set_source_surface(cr, src, 0, 0);
+    cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_GOOD);
+    cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+    cairo_paint(cr);
+    cairo_destroy(cr);
+
+    return level;
+}
+}  // namespace
+
+ImageMipmap::ImageMipmap() = default;
+
+ImageMipmap::~ImageMipmap() = default;
+
+auto ImageMipmap::getLevel(cairo_surface_t* surface, double scale) -> cairo_surface_t* {
+    if (scale >= 0.5 || scale <= 0 || cairo_surface_get_type(surface) != CAIRO_SURFACE_TYPE_IMAGE) {
+        return cairo_surface_reference(surface);
+    }
+
+    // The smallest level which is still at least as large as the target
+    auto level = static_cast<size_t>(std::floor(-std::log2(scale)));
+
+    Pyramid* pyramid = getPyramid(surface);
+    if (pyramid == nullptr) {
+        return cairo_surface_reference(surface);
+    }
+
+    std::lock_guard<std::mutex> lock(pyramid->mutex);
+    while (pyramid->levels.size() < level) {
+        cairo_surface_t* src = pyramid->levels.empty() ? surface : pyramid->levels.back();
+        if (cairo_image_surface_get_width(src) <= 1 && cairo_image_surface_get_height(src) <= 1) {
+            break;
+        }
+        pyramid->levels.push_back(downsample(src));
+    }
+
+    if (pyramid->levels.empty()) {
+        return cairo_surface_reference(surface);
+    }
+    return cairo_surface_reference(pyramid->levels[std::min(level, pyramid->levels.size()) - 1]);
+}
+
+void ImageMipmap::paint(cairo_t* cr, cairo_surface_t* surface, double x, double y, double width, double height) {
+    int surfaceWidth = cairo_image_surface_get_width(surface);
+    int surfaceHeight = cairo_image_surface_get_height(surface);
+    if (surfaceWidth <= 0 || surfaceHeight <= 0) {
+        return;
+    }
+
+    cairo_surface_t* level = nullptr;
+    if (cairo_surface_get_type(cairo_get_target(cr)) == CAIRO_SURFACE_TYPE_IMAGE) {
+        // Size of one pixel of the surface on the target, in both directions
+        double xx = width / surfaceWidth;
+        double xy = 0;
+        cairo_user_to_device_distance(cr, &xx, &xy);
+        double yx = 0;
+        double yy = height / surfaceHeight;
+        cairo_user_to_device_distance(cr, &yx, &yy);
+
+        level = getLevel(surface, std::max(std::hypot(xx, xy), std::hypot(yx, yy)));
+    } else {
+        // PDF and SVG output keep the full resolution, they may be zoomed in later
+        level = cairo_surface_reference(surface);
+    }
+
+    cairo_save(cr);
+    cairo_translate(cr, x, y);
+    cairo_scale(cr, width / cairo_image_surface_get_width(level), height / cairo_image_surface_get_height(level));
+    cairo_set_source_surface(cr, level, 0, 0);
+    cairo_paint(cr);
+    cairo_restore(cr);
+
+    cairo_surface_destroy(level);
+}
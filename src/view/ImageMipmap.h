@@ -0,0 +1,39 @@
+/*
+ * Xournal++
+ *
+ * Downsampled levels of image surfaces
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cairo.h>
+
+/**
+ * Each level has half the width and height of the previous one. The levels are created on demand
+ * and attached to the surface, they are released together with it.
+ */
+class ImageMipmap {
+private:
+    ImageMipmap();
+    virtual ~ImageMipmap();
+
+public:
+    /**
+     * Paints surface into the rectangle x, y, width, height of cr.
+     *
+     * If the surface is scaled down on a raster target, the smallest level which still has at least
+     * the resolution of the target is painted. Vector targets always get the full resolution.
+     */
+    static void paint(cairo_t* cr, cairo_surface_t* surface, double x, double y, double width, double height);
+
+    /**
+     * @param scale Target pixels per pixel of surface
+     * @return A new reference to the level for scale, surface itself if it is not scaled down
+     */
+    static cairo_surface_t* getLevel(cairo_surface_t* surface, double scale);
+};
@@ -1,5 +1,7 @@
 #include "TextView.h"
 
+#include <mutex>
+
 #include "control/settings/Settings.h"
 #include "model/Text.h"
 #include "pdf/base/XojPdfPage.h"
@@ -15,6 +17,8 @@ static int textDpi = 72;
 
 void TextView::setDpi(int dpi) { textDpi = dpi; }
 
+auto TextView::getDpi() -> int { return textDpi; }
+
 auto TextView::initPango(cairo_t* cr, const Text* t) -> PangoLayout* {
     PangoLayout* layout = pango_cairo_create_layout(cr);
 
@@ -39,30 +43,87 @@ void TextView::updatePangoFont(PangoLayout* layout, const Text* t) {
     pango_font_description_free(desc);
 }
 
-void TextView::drawText(cairo_t* cr, const Text* t) {
-    cairo_save(cr);
-
-    cairo_translate(cr, t->getX(), t->getY());
+auto TextView::createLayout(const Text* t) -> PangoLayout* {
+    // The layout keeps the font options of this surface, the text is measured as on screen
+    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 1, 1);
+    cairo_t* cr = cairo_create(surface);
 
     PangoLayout* layout = initPango(cr, t);
     string str = t->getText();
     pango_layout_set_text(layout, str.c_str(), str.length());
 
-    pango_cairo_show_layout(cr, layout);
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
 
-    g_object_unref(layout);
+    return layout;
+}
 
-    cairo_restore(cr);
+/**
+ * The font options of the surface createLayout() shapes the text for. Sizes are always measured with these,
+ * the size of a Text must not depend on the target it was drawn to last.
+ */
+static auto getMeasureFontOptions() -> const cairo_font_options_t* {
+    static const cairo_font_options_t* options = [] {
+        cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 1, 1);
+        cairo_font_options_t* surfaceOptions = cairo_font_options_create();
+        cairo_surface_get_font_options(surface, surfaceOptions);
+        cairo_surface_destroy(surface);
+        return surfaceOptions;
+    }();
+    return options;
 }
 
-auto TextView::findText(const Text* t, string& search) -> vector<XojPdfRectangle> {
-    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 1, 1);
-    cairo_t* cr = cairo_create(surface);
+void TextView::bindLayout(PangoLayout* layout, cairo_t* cr) {
+    PangoContext* context = pango_layout_get_context(layout);
+
+    // Font maps are per thread and not thread safe, the cached layout may have been shaped on another thread
+    PangoFontMap* fontMap = pango_cairo_font_map_get_default();
+    if (pango_context_get_font_map(context) != fontMap) {
+        pango_context_set_font_map(context, fontMap);
+        pango_layout_context_changed(layout);
+    }
+
+    cairo_font_options_t* options = nullptr;
+    if (cr == nullptr) {
+        options = cairo_font_options_copy(getMeasureFontOptions());
+    } else {
+        // Take the hinting and antialiasing of the target, e.g. PDF and screen differ. The matrix is kept, so the
+        // layout is only shaped again if the target options change, not on every zoom level.
+        options = cairo_font_options_create();
+        cairo_surface_get_font_options(cairo_get_target(cr), options);
+        cairo_font_options_t* crOptions = cairo_font_options_create();
+        cairo_get_font_options(cr, crOptions);
+        cairo_font_options_merge(options, crOptions);
+        cairo_font_options_destroy(crOptions);
+    }
+
+    const cairo_font_options_t* current = pango_cairo_context_get_font_options(context);
+    if (current == nullptr || !cairo_font_options_equal(current, options)) {
+        pango_cairo_context_set_font_options(context, options);
+        pango_layout_context_changed(layout);
+    }
+    cairo_font_options_destroy(options);
+}
 
-    PangoLayout* layout = initPango(cr, t);
-    string str = t->getText();
-    pango_layout_set_text(layout, str.c_str(), str.length());
+void TextView::drawText(cairo_t* cr, const Text* t) {
+    cairo_save(cr);
+
+    cairo_translate(cr, t->getX(), t->getY());
+
+    {
+        std::lock_guard<std::mutex> lock(t->getLayoutMutex());
+        PangoLayout* layout = t->getLayout();
+        bindLayout(layout, cr);
+        pango_cairo_show_layout(cr, layout);
+    }
 
+    cairo_restore(cr);
+}
+
+auto TextView::findText(const Text* t, string& search) -> vector<XojPdfRectangle> {
+    std::lock_guard<std::mutex> lock(t->getLayoutMutex());
+    PangoLayout* layout = t->getLayout();
+    bindLayout(layout, nullptr);
 
     string text = t->getText();
 
@@ -88,27 +149,17 @@ auto TextView::findText(const Text* t, string& search) -> vector<XojPdfRectangle
         }
     } while (pos != -1);
 
-    g_object_unref(layout);
-    cairo_surface_destroy(surface);
-    cairo_destroy(cr);
-
     return list;
 }
 
 void TextView::calcSize(const Text* t, double& width, double& height) {
-    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 1, 1);
-    cairo_t* cr = cairo_create(surface);
+    std::lock_guard<std::mutex> lock(t->getLayoutMutex());
+    PangoLayout* layout = t->getLayout();
+    bindLayout(layout, nullptr);
 
-    PangoLayout* layout = initPango(cr, t);
-    string str = t->getText();
-    pango_layout_set_text(layout, str.c_str(), str.length());
     int w = 0;
     int h = 0;
     pango_layout_get_size(layout, &w, &h);
     width = (static_cast<double>(w)) / PANGO_SCALE;
     height = (static_cast<double>(h)) / PANGO_SCALE;
-    g_object_unref(layout);
-
-    cairo_surface_destroy(surface);
-    cairo_destroy(cr);
 }
@@ -24,6 +24,7 @@ private:
 
 public:
     static void setDpi(int dpi);
+    static int getDpi();
 
     /**
      * Calculates the size of a Text model
@@ -45,8 +46,22 @@ public:
      */
     static PangoLayout* initPango(cairo_t* cr, const Text* t);
 
+    /**
+     * Creates a layout with the text and font of t, which does not depend on a cairo context.
+     * Used for the layout cached by Text and by the TextEditor, so both measure the text the same way.
+     */
+    static PangoLayout* createLayout(const Text* t);
+
     /**
      * Sets the font name from Text model
      */
     static void updatePangoFont(PangoLayout* layout, const Text* t);
+
+private:
+    /**
+     * Prepares a cached layout for the current thread and for the font options of the target of cr.
+     * With cr nullptr the layout is prepared for measuring, with the same font options on every call.
+     * Needs the layout mutex of the Text.
+     */
+    static void bindLayout(PangoLayout* layout, cairo_t* cr);
 };
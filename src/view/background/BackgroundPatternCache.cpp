@@ -0,0 +1,131 @@
+#include "BackgroundPatternCache.h"
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * Count of cached images, e.g. for the zoom of the main view and the zoom of the previews
+ */
+constexpr size_t MAX_ENTRIES = 4;
+
+/**
+ * Larger backgrounds are drawn directly, to limit the memory used by the cache
+ */
+constexpr double MAX_PIXELS = 8 * 1024 * 1024;
+
+/**
+ * Tolerance for a device offset to be considered on the pixel grid
+ */
+constexpr double PIXEL_EPSILON = 1e-6;
+
+static auto isOnPixelGrid(double value) -> bool { return std::abs(value - std::round(value)) < PIXEL_EPSILON; }
+
+auto BackgroundPatternCache::Key::operator==(const Key& other) const -> bool {
+    return type == other.type && width == other.width && height == other.height &&
+           backgroundColor == other.backgroundColor && lineWidthFactor == other.lineWidthFactor &&
+           scale == other.scale;
+}
+
+BackgroundPatternCache::BackgroundPatternCache() = default;
+
+BackgroundPatternCache::~BackgroundPatternCache() { clear(); }
+
+auto BackgroundPatternCache::getInstance() -> BackgroundPatternCache& {
+    static BackgroundPatternCache instance;
+    return instance;
+}
+
+auto BackgroundPatternCache::paint(cairo_t* cr, Key key, const std::function<void(cairo_t*)>& render) -> bool {
+    cairo_surface_t* target = cairo_get_target(cr);
+    if (cairo_surface_get_type(target) != CAIRO_SURFACE_TYPE_IMAGE) {
+        return false;
+    }
+
+    double deviceScaleX = 1;
+    double deviceScaleY = 1;
+    cairo_surface_get_device_scale(target, &deviceScaleX, &deviceScaleY);
+    double deviceOffsetX = 0;
+    double deviceOffsetY = 0;
+    cairo_surface_get_device_offset(target, &deviceOffsetX, &deviceOffsetY);
+    if (deviceScaleX != 1 || deviceScaleY != 1 || !isOnPixelGrid(deviceOffsetX) || !isOnPixelGrid(deviceOffsetY)) {
+        return false;
+    }
+
+    // The image can only be copied 1:1, without resampling
+    cairo_matrix_t matrix;
+    cairo_get_matrix(cr, &matrix);
+    if (matrix.xy != 0 || matrix.yx != 0 || matrix.xx <= 0 || matrix.xx != matrix.yy || !isOnPixelGrid(matrix.x0) ||
+        !isOnPixelGrid(matrix.y0)) {
+        return false;
+    }
+
+    key.scale = matrix.xx;
+    int width = static_cast<int>(std::ceil(key.width * key.scale));
+    int height = static_cast<int>(std::ceil(key.height * key.scale));
+    if (width <= 0 || height <= 0 || static_cast<double>(width) * height > MAX_PIXELS) {
+        return false;
+    }
+
+    cairo_surface_t* surface = find(key);
+    if (surface == nullptr) {
+        surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+        cairo_t* crSurface = cairo_create(surface);
+        cairo_scale(crSurface, key.scale, key.scale);
+        render(crSurface);
+        cairo_destroy(crSurface);
+        cairo_surface_flush(surface);
+
+        add(key, surface);
+    }
+
+    cairo_save(cr);
+    cairo_identity_matrix(cr);
+    cairo_set_source_surface(cr, surface, std::round(matrix.x0), std::round(matrix.y0));
+    cairo_paint(cr);
+    cairo_restore(cr);
+
+    cairo_surface_destroy(surface);
+    return true;
+}
+
+auto BackgroundPatternCache::find(const Key& key) -> cairo_surface_t* {
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    for (Entry& e: this->entries) {
+        if (e.key == key) {
+            e.lastUse = ++this->useCounter;
+            return cairo_surface_reference(e.surface);
+        }
+    }
+
+    return nullptr;
+}
+
+void BackgroundPatternCache::add(const Key& key, cairo_surface_t* surface) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    // Another thread may have rendered the same background in the meantime
+    for (Entry& e: this->entries) {
+        if (e.key == key) {
+            return;
+        }
+    }
+
+    if (this->entries.size() >= MAX_ENTRIES) {
+        auto oldest = std::min_element(this->entries.begin(), this->entries.end(),
+                                       [](const Entry& a, const Entry& b) { return a.lastUse < b.lastUse; });
+        cairo_surface_destroy(oldest->surface);
+        this->entries.erase(oldest);
+    }
+
+    this->entries.push_back({key, cairo_surface_reference(surface), ++this->useCounter});
+}
+
+void BackgroundPatternCache::clear() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+
+    for (Entry& e: this->entries) {
+        cairo_surface_destroy(e.surface);
+    }
+    this->entries.clear();
+}
@@ -0,0 +1,93 @@
+/*
+ * Xournal++
+ *
+ * Shares rendered background patterns between pages
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <gtk/gtk.h>
+
+#include "model/PageType.h"
+#include "util/Color.h"
+
+#include "XournalType.h"
+
+/**
+ * The ruled, graph, dotted, isometric and staves backgrounds consist of thousands of lines and
+ * dots. They only depend on the page type, the page size, the background color and the zoom, so
+ * all pages with the same background share one image, which is rendered once and then painted
+ * with a single operation.
+ *
+ * Only image surfaces are painted from the cache, the background is still drawn as vector
+ * graphics for PDF, SVG and print output.
+ */
+class BackgroundPatternCache final {
+public:
+    struct Key {
+        PageType type;
+        double width;
+        double height;
+        Color backgroundColor;
+        double lineWidthFactor;
+        double scale;
+
+        bool operator==(const Key& other) const;
+    };
+
+private:
+    BackgroundPatternCache();
+
+public:
+    static BackgroundPatternCache& getInstance();
+
+    ~BackgroundPatternCache();
+    BackgroundPatternCache(BackgroundPatternCache const&) = delete;
+    BackgroundPatternCache(BackgroundPatternCache&&) = delete;
+    BackgroundPatternCache& operator=(BackgroundPatternCache const&) = delete;
+    BackgroundPatternCache& operator=(BackgroundPatternCache&&) = delete;
+
+public:
+    /**
+     * Paints the background from the cache, render draws it in page coordinates if it is not cached yet.
+     *
+     * @param key Describes the background, the scale is taken from cr
+     * @return False if the target of cr cannot be painted from the cache, e.g. because it is a
+     * vector surface or rotated. The caller needs to draw the background itself then.
+     */
+    bool paint(cairo_t* cr, Key key, const std::function<void(cairo_t*)>& render);
+
+    /**
+     * Removes all images
+     */
+    void clear();
+
+private:
+    /**
+     * @return A new reference to the cached image, nullptr if there is none
+     */
+    cairo_surface_t* find(const Key& key);
+    void add(const Key& key, cairo_surface_t* surface);
+
+private:
+    struct Entry {
+        Key key;
+        cairo_surface_t* surface;
+        uint64_t lastUse;
+    };
+
+    std::mutex mutex;
+    vector<Entry> entries;
+    uint64_t useCounter = 0;
+};
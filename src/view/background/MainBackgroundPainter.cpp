@@ -1,6 +1,7 @@
 #include "MainBackgroundPainter.h"
 
 #include "BackgroundConfig.h"
+#include "BackgroundPatternCache.h"
 #include "BaseBackgroundPainter.h"
 #include "DottedBackgroundPainter.h"
 #include "GraphBackgroundPainter.h"
@@ -34,6 +35,7 @@ MainBackgroundPainter::~MainBackgroundPainter() {
  * Set a factor to draw the lines bolder, for previews
  */
 void MainBackgroundPainter::setLineWidthFactor(double factor) {
+    this->lineWidthFactor = factor;
     for (auto& e: painter) {
         e.second->setLineWidthFactor(factor);
     }
@@ -47,8 +49,21 @@ void MainBackgroundPainter::paint(PageType pt, cairo_t* cr, PageRef page) {
         painter = it->second;
     }
 
-    BackgroundConfig config(pt.config);
+    auto render = [&](cairo_t* target) {
+        BackgroundConfig config(pt.config);
 
-    painter->resetConfig();
-    painter->paint(cr, page, &config);
+        painter->resetConfig();
+        painter->paint(target, page, &config);
+    };
+
+    // A plain background is a single rectangle, nothing to gain from the cache
+    if (painter != defaultPainter) {
+        BackgroundPatternCache::Key key{pt, page->getWidth(), page->getHeight(), page->getBackgroundColor(),
+                                        this->lineWidthFactor, 1};
+        if (BackgroundPatternCache::getInstance().paint(cr, key, render)) {
+            return;
+        }
+    }
+
+    render(cr);
 }
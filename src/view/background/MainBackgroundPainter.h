@@ -40,4 +40,6 @@ public:
 private:
     map<PageTypeFormat, BaseBackgroundPainter*> painter;
     BaseBackgroundPainter* defaultPainter;
+
+    double lineWidthFactor = 1;
 };
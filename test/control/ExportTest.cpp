@@ -0,0 +1,114 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <fstream>
+#include <iterator>
+#include <memory>
+
+#include <config-test.h>
+#include <poppler.h>
+
+#include "control/jobs/ImageExport.h"
+#include "control/jobs/ProgressListener.h"
+#include "control/xojfile/LoadHandler.h"
+#include "pdf/base/XojPdfExportFactory.h"
+
+#include "PageRange.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+/**
+ * Exports a document with TeX images and Text elements on every page, which are rendered by several threads
+ */
+class ExportTest: public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(ExportTest);
+
+    CPPUNIT_TEST(testParallelPng);
+    CPPUNIT_TEST(testParallelPdf);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    fs::path folder;
+    LoadHandler handler;
+    Document* doc = nullptr;
+    PageRangeVector range;
+
+    void setUp() {
+        // A folder of its own, tests may run in parallel
+        gchar* tmp = g_dir_make_tmp("xournalpp-export-test-XXXXXX", nullptr);
+        CPPUNIT_ASSERT(tmp != nullptr);
+        folder = fs::u8path(tmp);
+        g_free(tmp);
+
+        doc = handler.loadDocument(GET_TESTFILE("export-tex-text.unzipped.xoj"));
+        CPPUNIT_ASSERT(doc != nullptr);
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(4), doc->getPageCount());
+
+        range.push_back(new PageRangeEntry(0, int(doc->getPageCount() - 1)));
+    }
+
+    void tearDown() {
+        for (PageRangeEntry* e: range) {
+            delete e;
+        }
+        range.clear();
+
+        fs::remove_all(folder);
+    }
+
+    static auto readFile(fs::path const& file) -> string {
+        std::ifstream in(file, std::ios::binary);
+        return string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    void exportPng(fs::path const& file, unsigned int workerCount) {
+        DummyProgressListener progress;
+        ImageExport imgExport(doc->createSnapshot(), file, EXPORT_GRAPHICS_PNG, false, range);
+        imgExport.setQualityParameter(EXPORT_QUALITY_DPI, 72);
+        imgExport.setWorkerCount(workerCount);
+        imgExport.exportGraphics(&progress);
+        CPPUNIT_ASSERT_EQUAL(string(), imgExport.getLastErrorMsg());
+    }
+
+    void testParallelPng() {
+        exportPng(folder / "serial.png", 1);
+        exportPng(folder / "parallel.png", 4);
+
+        // Rendering on several threads gives the same pages as rendering one after another
+        for (int page = 1; page <= 4; page++) {
+            string serial = readFile(folder / ("serial-" + std::to_string(page) + ".png"));
+            string parallel = readFile(folder / ("parallel-" + std::to_string(page) + ".png"));
+            CPPUNIT_ASSERT(!serial.empty());
+            CPPUNIT_ASSERT(serial == parallel);
+        }
+    }
+
+    void testParallelPdf() {
+        fs::path file = folder / "parallel.pdf";
+
+        DummyProgressListener progress;
+        std::unique_ptr<XojPdfExport> pdfe(XojPdfExportFactory::createExport(doc->createSnapshot(), &progress));
+        pdfe->setWorkerCount(4);
+        CPPUNIT_ASSERT(pdfe->createPdf(file, range, false));
+        CPPUNIT_ASSERT_EQUAL(string(), pdfe->getLastError());
+
+        gchar* uri = g_filename_to_uri(file.u8string().c_str(), nullptr, nullptr);
+        PopplerDocument* pdf = poppler_document_new_from_file(uri, nullptr, nullptr);
+        g_free(uri);
+        CPPUNIT_ASSERT(pdf != nullptr);
+        CPPUNIT_ASSERT_EQUAL(4, poppler_document_get_n_pages(pdf));
+        g_object_unref(pdf);
+    }
+};
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION(ExportTest);
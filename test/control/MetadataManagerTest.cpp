@@ -0,0 +1,171 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <fstream>
+
+#include <config-test.h>
+
+#include "control/settings/MetadataManager.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class MetadataManagerTest: public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(MetadataManagerTest);
+
+    CPPUNIT_TEST(testStoreAndGet);
+    CPPUNIT_TEST(testPersistence);
+    CPPUNIT_TEST(testBoundedSize);
+    CPPUNIT_TEST(testInvalidIndex);
+    CPPUNIT_TEST(testTwoInstances);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    fs::path folder;
+    fs::path indexFile;
+
+    void setUp() {
+        // A folder of its own, tests may run in parallel
+        gchar* tmp = g_dir_make_tmp("xournalpp-metadata-test-XXXXXX", nullptr);
+        CPPUNIT_ASSERT(tmp != nullptr);
+        folder = fs::u8path(tmp);
+        g_free(tmp);
+
+        indexFile = folder / "metadata.index";
+    }
+
+    void tearDown() { fs::remove_all(folder); }
+
+    static auto countLines(fs::path const& file) -> size_t {
+        std::ifstream in(file);
+        size_t lines = 0;
+        for (string line; getline(in, line);) {
+            lines++;
+        }
+        return lines;
+    }
+
+    void testStoreAndGet() {
+        MetadataManager manager(indexFile);
+        CPPUNIT_ASSERT(!manager.getForFile("/tmp/a.xopp").valid);
+
+        manager.storeMetadata("/tmp/a.xopp", 3, 1.5);
+        manager.documentChanged();
+        manager.storeMetadata("/tmp/my file.xopp", 7, 2);
+        manager.documentChanged();
+
+        MetadataEntry a = manager.getForFile("/tmp/a.xopp");
+        CPPUNIT_ASSERT(a.valid);
+        CPPUNIT_ASSERT_EQUAL(3, a.page);
+        CPPUNIT_ASSERT_EQUAL(1.5, a.zoom);
+
+        MetadataEntry b = manager.getForFile("/tmp/my file.xopp");
+        CPPUNIT_ASSERT(b.valid);
+        CPPUNIT_ASSERT_EQUAL(7, b.page);
+
+        CPPUNIT_ASSERT(!manager.getForFile("/tmp/c.xopp").valid);
+    }
+
+    void testPersistence() {
+        {
+            MetadataManager manager(indexFile);
+            for (int i = 0; i < 200; i++) {
+                manager.storeMetadata("/tmp/a.xopp", i, 1);
+                manager.documentChanged();
+            }
+            manager.storeMetadata("/tmp/b.xopp", 5, 0.5);
+        }
+
+        MetadataManager manager(indexFile);
+        CPPUNIT_ASSERT_EQUAL(199, manager.getForFile("/tmp/a.xopp").page);
+        CPPUNIT_ASSERT_EQUAL(5, manager.getForFile("/tmp/b.xopp").page);
+        CPPUNIT_ASSERT_EQUAL(0.5, manager.getForFile("/tmp/b.xopp").zoom);
+
+        // Outdated records are dropped from time to time
+        CPPUNIT_ASSERT(countLines(indexFile) < 100);
+    }
+
+    void testBoundedSize() {
+        {
+            // The times are not in the order of the records, the oldest files are dropped
+            std::ofstream out(indexFile);
+            out << "XOJ-METADATA-INDEX/1.0\n";
+            for (int n = 0; n < 600; n++) {
+                int i = n * 7 % 600;
+                out << 1000 + i << " " << i << " 1 \"/tmp/file" << i << ".xopp\"\n";
+            }
+        }
+
+        {
+            MetadataManager manager(indexFile);
+            CPPUNIT_ASSERT(!manager.getForFile("/tmp/file99.xopp").valid);
+            CPPUNIT_ASSERT_EQUAL(100, manager.getForFile("/tmp/file100.xopp").page);
+            CPPUNIT_ASSERT_EQUAL(599, manager.getForFile("/tmp/file599.xopp").page);
+            CPPUNIT_ASSERT_EQUAL(size_t{501}, countLines(indexFile));
+
+            // A new file replaces the oldest one
+            manager.storeMetadata("/tmp/new.xopp", 1, 1);
+            manager.documentChanged();
+        }
+
+        CPPUNIT_ASSERT(countLines(indexFile) <= 501);
+
+        MetadataManager manager(indexFile);
+        CPPUNIT_ASSERT(!manager.getForFile("/tmp/file100.xopp").valid);
+        CPPUNIT_ASSERT_EQUAL(101, manager.getForFile("/tmp/file101.xopp").page);
+        CPPUNIT_ASSERT_EQUAL(1, manager.getForFile("/tmp/new.xopp").page);
+    }
+
+    void testInvalidIndex() {
+        {
+            std::ofstream out(indexFile);
+            out << "XOJ-METADATA-INDEX/1.0\n";
+            out << "100 4 1.25 \"/tmp/a.xopp\"\n";
+            out << "200 x";
+        }
+
+        MetadataManager manager(indexFile);
+        CPPUNIT_ASSERT_EQUAL(4, manager.getForFile("/tmp/a.xopp").page);
+        CPPUNIT_ASSERT_EQUAL(size_t{2}, countLines(indexFile));
+
+        {
+            std::ofstream out(indexFile);
+            out << "something else\n";
+        }
+        MetadataManager other(indexFile);
+        CPPUNIT_ASSERT(!other.getForFile("/tmp/a.xopp").valid);
+    }
+
+    void testTwoInstances() {
+        MetadataManager first(indexFile);
+        CPPUNIT_ASSERT(!first.getForFile("/tmp/a.xopp").valid);
+
+        {
+            MetadataManager second(indexFile);
+            second.storeMetadata("/tmp/b.xopp", 2, 1);
+            second.documentChanged();
+        }
+
+        // The first instance rewrites the index, without the record appended by the second one
+        for (int i = 0; i < 200; i++) {
+            first.storeMetadata("/tmp/a.xopp", i, 1);
+            first.documentChanged();
+        }
+        CPPUNIT_ASSERT(countLines(indexFile) < 100);
+
+        MetadataManager manager(indexFile);
+        CPPUNIT_ASSERT_EQUAL(199, manager.getForFile("/tmp/a.xopp").page);
+        CPPUNIT_ASSERT_EQUAL(2, manager.getForFile("/tmp/b.xopp").page);
+    }
+};
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION(MetadataManagerTest);
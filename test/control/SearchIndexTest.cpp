@@ -0,0 +1,186 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <config-test.h>
+
+#include "control/search/SearchIndex.h"
+#include "control/xojfile/LoadHandler.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class SearchIndexTest: public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(SearchIndexTest);
+
+    CPPUNIT_TEST(testFindOnPdfPage);
+    CPPUNIT_TEST(testLineBreak);
+    CPPUNIT_TEST(testNotIndexed);
+    CPPUNIT_TEST(testSaveLoad);
+    CPPUNIT_TEST(testTextElements);
+    CPPUNIT_TEST(testSearchPage);
+    CPPUNIT_TEST(testPdfCandidates);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() {}
+
+    void tearDown() {}
+
+    /**
+     * Lays out the characters with a width of 6 and a line height of 20
+     */
+    static void addPage(SearchIndex& index, size_t pdfPage, const std::u32string& text) {
+        vector<XojPdfRectangle> glyphs;
+        double x = 10;
+        double y = 100;
+        for (char32_t c: text) {
+            glyphs.emplace_back(x, y, x + 6, y + 12);
+            if (c == U'\n') {
+                x = 10;
+                y += 20;
+            } else {
+                x += 6;
+            }
+        }
+        index.addPdfPage(pdfPage, text, glyphs);
+    }
+
+    void testFindOnPdfPage() {
+        SearchIndex index("", 2);
+        addPage(index, 0, U"Hello World, hello again");
+        addPage(index, 1, U"Nothing here");
+        CPPUNIT_ASSERT(index.isComplete());
+
+        vector<XojPdfRectangle> rects;
+        CPPUNIT_ASSERT(index.findOnPdfPage(0, "HELLO", rects));
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), rects.size());
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(10.0, rects[0].x1, 1e-9);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(40.0, rects[0].x2, 1e-9);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(100.0, rects[0].y1, 1e-9);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(112.0, rects[0].y2, 1e-9);
+
+        rects.clear();
+        CPPUNIT_ASSERT(index.findOnPdfPage(1, "hello", rects));
+        CPPUNIT_ASSERT(rects.empty());
+
+        // Shorter than a trigram
+        rects.clear();
+        CPPUNIT_ASSERT(index.findOnPdfPage(0, "o", rects));
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3), rects.size());
+    }
+
+    void testLineBreak() {
+        SearchIndex index("", 1);
+        addPage(index, 0, U"first line\nsecond line");
+
+        // A line break matches a space, the result has one rectangle per line
+        vector<XojPdfRectangle> rects;
+        CPPUNIT_ASSERT(index.findOnPdfPage(0, "line second", rects));
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), rects.size());
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(100.0, rects[0].y1, 1e-9);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(120.0, rects[1].y1, 1e-9);
+    }
+
+    void testNotIndexed() {
+        SearchIndex index("", 3);
+        addPage(index, 1, U"abc");
+
+        CPPUNIT_ASSERT(!index.isComplete());
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), index.getNextPdfPage());
+
+        vector<XojPdfRectangle> rects;
+        CPPUNIT_ASSERT(!index.findOnPdfPage(0, "abc", rects));
+        CPPUNIT_ASSERT(index.findOnPdfPage(1, "abc", rects));
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), rects.size());
+    }
+
+    void testSaveLoad() {
+        SearchIndex index("", 2);
+        addPage(index, 0, U"Grüße aus Zürich");
+        addPage(index, 1, U"second page");
+
+        fs::path file = fs::temp_directory_path() / "xournalpp-search-index-test.index";
+        CPPUNIT_ASSERT(index.save(file));
+
+        SearchIndex loaded("", 2);
+        CPPUNIT_ASSERT(loaded.load(file));
+        CPPUNIT_ASSERT(loaded.isComplete());
+
+        vector<XojPdfRectangle> rects;
+        CPPUNIT_ASSERT(loaded.findOnPdfPage(0, "ZÜRICH", rects));
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), rects.size());
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(70.0, rects[0].x1, 1e-9);
+
+        // Created for another PDF
+        SearchIndex other("", 3);
+        CPPUNIT_ASSERT(!other.load(file));
+
+        fs::remove(file);
+    }
+
+    void testTextElements() {
+        LoadHandler handler;
+        Document* doc = handler.loadDocument(GET_TESTFILE("test1.xoj"));
+
+        SearchIndex index("", 0);
+        vector<SearchResult> results = index.search(doc, "234", 10);
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), results.size());
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), results[0].page);
+        CPPUNIT_ASSERT(results[0].inTextElement);
+        CPPUNIT_ASSERT_EQUAL(string("12345"), results[0].context);
+
+        CPPUNIT_ASSERT(index.search(doc, "54", 10).empty());
+    }
+
+    void testSearchPage() {
+        LoadHandler handler;
+        Document* doc = handler.loadDocument(GET_TESTFILE("test1.xoj"));
+
+        SearchIndex index("", 0);
+        vector<SearchResult> results;
+        index.searchPage(doc, 0, "1234", {}, results);
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), results.size());
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), results[0].page);
+
+        // Appends to the results, pages which do not exist are ignored
+        index.searchPage(doc, 0, "2345", {}, results);
+        index.searchPage(doc, doc->getPageCount(), "2345", {}, results);
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), results.size());
+    }
+
+    void testPdfCandidates() {
+        SearchIndex index("", 4);
+        addPage(index, 0, U"the quick brown fox");
+        addPage(index, 1, U"jumps over the lazy dog");
+        addPage(index, 3, U"brown bread");
+
+        // Page 2 is not indexed yet, so it may contain anything
+        vector<bool> candidates = index.findPdfCandidates("BROWN");
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(4), candidates.size());
+        CPPUNIT_ASSERT(candidates[0]);
+        CPPUNIT_ASSERT(!candidates[1]);
+        CPPUNIT_ASSERT(candidates[2]);
+        CPPUNIT_ASSERT(candidates[3]);
+
+        // All trigrams must be on the page, not only some of them
+        candidates = index.findPdfCandidates("brown dog");
+        CPPUNIT_ASSERT(!candidates[0]);
+        CPPUNIT_ASSERT(!candidates[1]);
+        CPPUNIT_ASSERT(!candidates[3]);
+
+        // Shorter than a trigram, every page can contain it
+        candidates = index.findPdfCandidates("z");
+        CPPUNIT_ASSERT(candidates[0] && candidates[1] && candidates[2] && candidates[3]);
+    }
+};
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION(SearchIndexTest);
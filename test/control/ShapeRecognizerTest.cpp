@@ -0,0 +1,208 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <config-test.h>
+
+#include "control/shaperecognizer/Inertia.h"
+#include "control/shaperecognizer/InertiaPrefix.h"
+#include "control/shaperecognizer/ShapeRecognizer.h"
+#include "control/shaperecognizer/ShapeRecognizerResult.h"
+#include "model/Stroke.h"
+
+#ifdef TEST_CHECK_SPEED
+#include "SpeedTest.cpp"
+#endif
+
+#include <cmath>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class ShapeRecognizerTest: public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(ShapeRecognizerTest);
+
+#ifdef TEST_CHECK_SPEED
+    CPPUNIT_TEST(testSpeed);
+#endif
+
+    CPPUNIT_TEST(testInertiaPrefix);
+    CPPUNIT_TEST(testLine);
+    CPPUNIT_TEST(testRectangle);
+    CPPUNIT_TEST(testCircle);
+    CPPUNIT_TEST(testScribble);
+    CPPUNIT_TEST(testIncremental);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() {}
+
+    void tearDown() {}
+
+    /**
+     * Slight deterministic jitter, like a hand drawn stroke
+     */
+    static double jitter(int i) { return 0.3 * sin(i * 1.7) + 0.2 * cos(i * 0.9); }
+
+    static void addLine(Stroke* s, double x1, double y1, double x2, double y2, int count) {
+        for (int i = 0; i < count; i++) {
+            double t = static_cast<double>(i) / count;
+            int n = s->getPointCount();
+            s->addPoint(Point(x1 + t * (x2 - x1) + jitter(n), y1 + t * (y2 - y1) + jitter(n + 7)));
+        }
+    }
+
+    static void addCircle(Stroke* s, double x, double y, double r, int count) {
+        for (int i = 0; i <= count; i++) {
+            double a = 2 * M_PI * i / count;
+            s->addPoint(Point(x + (r + jitter(i)) * cos(a), y + (r + jitter(i + 3)) * sin(a)));
+        }
+    }
+
+    static void addScribble(Stroke* s, int count) {
+        for (int i = 0; i < count; i++) {
+            double t = i * 0.05;
+            s->addPoint(Point(300 + 100 * sin(t) + 40 * sin(7.3 * t), 300 + 80 * cos(1.3 * t) + 30 * sin(5.1 * t)));
+        }
+    }
+
+    static int recognize(Stroke* s) {
+        ShapeRecognizer reco;
+        ShapeRecognizerResult* result = reco.recognizePatterns(s);
+        if (result == nullptr) {
+            return 0;
+        }
+
+        Stroke* recognized = result->getRecognized();
+        int count = recognized->getPointCount();
+        delete recognized;
+        delete result;
+        return count;
+    }
+
+    void testInertiaPrefix() {
+        Stroke s;
+        addCircle(&s, 5000, 7000, 30, 500);
+
+        InertiaPrefix prefix;
+        prefix.update(&s);
+        CPPUNIT_ASSERT_EQUAL(s.getPointCount(), prefix.getPointCount());
+
+        int ranges[][2] = {{0, 500}, {0, 1}, {10, 20}, {250, 499}};
+        for (auto& r: ranges) {
+            Inertia direct;
+            for (int i = r[0]; i < r[1]; i++) {
+                direct.increase(s.getPoint(i), s.getPoint(i + 1), 1);
+            }
+
+            Inertia fromPrefix = prefix.get(r[0], r[1]);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(direct.getMass(), fromPrefix.getMass(), 1e-6);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(direct.centerX(), fromPrefix.centerX(), 1e-6);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(direct.centerY(), fromPrefix.centerY(), 1e-6);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(direct.det(), fromPrefix.det(), 1e-4);
+        }
+
+        CPPUNIT_ASSERT_EQUAL(0.0, prefix.get(3, 3).getMass());
+    }
+
+    void testLine() {
+        Stroke s;
+        addLine(&s, 100, 100, 400, 250, 200);
+        CPPUNIT_ASSERT_EQUAL(2, recognize(&s));
+    }
+
+    void testRectangle() {
+        Stroke s;
+        addLine(&s, 100, 100, 400, 100, 80);
+        addLine(&s, 400, 100, 400, 300, 60);
+        addLine(&s, 400, 300, 100, 300, 80);
+        addLine(&s, 100, 300, 100, 100, 60);
+        s.addPoint(Point(100, 100));
+        CPPUNIT_ASSERT_EQUAL(5, recognize(&s));
+    }
+
+    void testCircle() {
+        Stroke s;
+        addCircle(&s, 300, 300, 100, 300);
+        CPPUNIT_ASSERT(recognize(&s) >= 24);
+    }
+
+    void testScribble() {
+        Stroke s;
+        addScribble(&s, 2000);
+        CPPUNIT_ASSERT_EQUAL(0, recognize(&s));
+    }
+
+    /**
+     * Points which were added before the stroke ended give the same result
+     */
+    void testIncremental() {
+        Stroke s;
+        InertiaPrefix prefix;
+        for (int i = 0; i <= 300; i++) {
+            double a = 2 * M_PI * i / 300;
+            s.addPoint(Point(300 + 100 * cos(a), 300 + 100 * sin(a)));
+            if (i < 250) {
+                prefix.addPoint(s.getPoint(i));
+            }
+        }
+
+        ShapeRecognizer reco;
+        ShapeRecognizerResult* result = reco.recognizePatterns(&s, prefix);
+        CPPUNIT_ASSERT(result != nullptr);
+        CPPUNIT_ASSERT_EQUAL(s.getPointCount(), prefix.getPointCount());
+        delete result->getRecognized();
+        delete result;
+
+        // Points of another stroke are discarded
+        Stroke line;
+        addLine(&line, 0, 0, 500, 0, 100);
+        CPPUNIT_ASSERT_EQUAL(2, recognize(&line));
+
+        ShapeRecognizer reco2;
+        result = reco2.recognizePatterns(&line, prefix);
+        CPPUNIT_ASSERT(result != nullptr);
+        CPPUNIT_ASSERT_EQUAL(2, result->getRecognized()->getPointCount());
+        delete result->getRecognized();
+        delete result;
+    }
+
+#ifdef TEST_CHECK_SPEED
+    void testSpeed() {
+        Stroke circle;
+        addCircle(&circle, 300, 300, 100, 200000);
+        Stroke scribble;
+        addScribble(&scribble, 200000);
+        Stroke line;
+        addLine(&line, 100, 100, 400, 250, 200000);
+
+        for (Stroke* s: {&circle, &scribble, &line}) {
+            SpeedTest speed;
+
+            // Accumulated while drawing, not part of the pen up time
+            InertiaPrefix prefix;
+            prefix.update(s);
+
+            speed.startTest("recognize 200000 points on pen up");
+            ShapeRecognizer reco;
+            ShapeRecognizerResult* result = reco.recognizePatterns(s, prefix);
+            speed.endTest();
+
+            if (result) {
+                delete result->getRecognized();
+                delete result;
+            }
+        }
+    }
+#endif
+};
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION(ShapeRecognizerTest);
@@ -0,0 +1,79 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <config-test.h>
+
+#include "control/xojfile/LoadHandler.h"
+#include "model/Document.h"
+#include "model/DocumentSnapshot.h"
+#include "model/Layer.h"
+#include "model/Stroke.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class DocumentSnapshotTest: public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(DocumentSnapshotTest);
+
+    CPPUNIT_TEST(testCopyOnWrite);
+    CPPUNIT_TEST(testUnnotifiedChange);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() {}
+
+    void tearDown() {}
+
+    void testCopyOnWrite() {
+        LoadHandler handler;
+        Document* doc = handler.loadDocument(GET_TESTFILE("load/pages.xoj"));
+        CPPUNIT_ASSERT(doc != nullptr);
+        size_t pageCount = doc->getPageCount();
+        CPPUNIT_ASSERT(pageCount > 1);
+
+        // The first snapshot copies every page, the next one none of the unchanged pages
+        auto first = doc->createSnapshot();
+        CPPUNIT_ASSERT_EQUAL(pageCount, first->getCopiedPageCount());
+
+        auto unchanged = doc->createSnapshot();
+        CPPUNIT_ASSERT_EQUAL(size_t{0}, unchanged->getCopiedPageCount());
+        CPPUNIT_ASSERT(unchanged->getPage(1) == first->getPage(1));
+
+        // Only the touched page is copied again
+        doc->getPage(1)->markChanged();
+        auto changed = doc->createSnapshot();
+        CPPUNIT_ASSERT_EQUAL(size_t{1}, changed->getCopiedPageCount());
+        CPPUNIT_ASSERT(changed->getPage(0) == first->getPage(0));
+        CPPUNIT_ASSERT(changed->getPage(1) != first->getPage(1));
+        CPPUNIT_ASSERT_EQUAL(pageCount, changed->getPageCount());
+    }
+
+    void testUnnotifiedChange() {
+        LoadHandler handler;
+        Document* doc = handler.loadDocument(GET_TESTFILE("load/pages.xoj"));
+        CPPUNIT_ASSERT(doc != nullptr);
+
+        auto first = doc->createSnapshot();
+
+        // A stroke added without a page notification is detected by the element count of the layer
+        auto* stroke = new Stroke();
+        stroke->addPoint(Point(10, 10));
+        stroke->addPoint(Point(20, 20));
+        (*doc->getPage(0)->getLayers())[0]->addElement(stroke);
+
+        auto changed = doc->createSnapshot();
+        CPPUNIT_ASSERT_EQUAL(size_t{1}, changed->getCopiedPageCount());
+        CPPUNIT_ASSERT(changed->getPage(0) != first->getPage(0));
+    }
+};
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION(DocumentSnapshotTest);
@@ -0,0 +1,176 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <config-test.h>
+
+#include "model/Stroke.h"
+#include "model/eraser/EraseableStroke.h"
+
+#include "Range.h"
+
+#ifdef TEST_CHECK_SPEED
+#include "SpeedTest.cpp"
+#endif
+
+#include <cmath>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class EraseableStrokeTest: public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(EraseableStrokeTest);
+
+#ifdef TEST_CHECK_SPEED
+    CPPUNIT_TEST(testSpeed);
+#endif
+
+    CPPUNIT_TEST(testEraseMiddle);
+    CPPUNIT_TEST(testEraseNothing);
+    CPPUNIT_TEST(testEraseAll);
+    CPPUNIT_TEST(testPressure);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() {}
+
+    void tearDown() {}
+
+    /**
+     * A horizontal stroke from (0, 0) to (length, 0) with a point at every unit
+     */
+    static Stroke* createStroke(int length, double pressure = Point::NO_PRESSURE) {
+        auto* s = new Stroke();
+        s->setWidth(1);
+        for (int i = 0; i <= length; i++) {
+            s->addPoint(Point(i, 0, pressure));
+        }
+        return s;
+    }
+
+    static vector<Stroke*> getStrokes(EraseableStroke& e, Stroke* original) {
+        vector<Stroke*> strokes;
+        GList* list = e.getStroke(original);
+        for (GList* l = list; l != nullptr; l = l->next) {
+            strokes.push_back(static_cast<Stroke*>(l->data));
+        }
+        g_list_free(list);
+        return strokes;
+    }
+
+    void testEraseMiddle() {
+        Stroke* s = createStroke(100);
+        EraseableStroke e(s);
+
+        Range* range = e.erase(50, 0, 3);
+        CPPUNIT_ASSERT(range != nullptr);
+        CPPUNIT_ASSERT(range->getX() <= 47);
+        CPPUNIT_ASSERT(range->getX2() >= 53);
+        delete range;
+
+        vector<Stroke*> strokes = getStrokes(e, s);
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), strokes.size());
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, strokes[0]->getPoint(0).x, 1e-9);
+        CPPUNIT_ASSERT(strokes[0]->getPoint(strokes[0]->getPointCount() - 1).x < 47);
+        CPPUNIT_ASSERT(strokes[1]->getPoint(0).x > 53);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(100.0, strokes[1]->getPoint(strokes[1]->getPointCount() - 1).x, 1e-9);
+
+        for (Stroke* part: strokes) {
+            delete part;
+        }
+        delete s;
+    }
+
+    void testEraseNothing() {
+        Stroke* s = createStroke(100);
+        EraseableStroke e(s);
+
+        CPPUNIT_ASSERT(e.erase(50, 20, 3) == nullptr);
+
+        vector<Stroke*> strokes = getStrokes(e, s);
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), strokes.size());
+        CPPUNIT_ASSERT_EQUAL(101, strokes[0]->getPointCount());
+
+        delete strokes[0];
+        delete s;
+    }
+
+    void testEraseAll() {
+        Stroke* s = createStroke(10);
+        EraseableStroke e(s);
+
+        for (int x = 0; x <= 10; x += 2) {
+            delete e.erase(x, 0, 3);
+        }
+
+        CPPUNIT_ASSERT(getStrokes(e, s).empty());
+        delete s;
+    }
+
+    void testPressure() {
+        Stroke* s = createStroke(100, 2.5);
+        EraseableStroke e(s);
+
+        // The small eraser subdivides the segments next to it
+        delete e.erase(30, 0, 0.2);
+
+        vector<Stroke*> strokes = getStrokes(e, s);
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), strokes.size());
+        CPPUNIT_ASSERT(strokes[0]->getPoint(strokes[0]->getPointCount() - 1).x > 29.5);
+        for (Stroke* part: strokes) {
+            delete part;
+        }
+
+        // Erasing at the same place with another size subdivides these segments again
+        delete e.erase(30, 0, 0.5);
+
+        strokes = getStrokes(e, s);
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), strokes.size());
+        CPPUNIT_ASSERT(strokes[0]->getPoint(strokes[0]->getPointCount() - 1).x < 29.5);
+        CPPUNIT_ASSERT(strokes[1]->getPoint(0).x > 30.5);
+        for (Stroke* part: strokes) {
+            // The width of a segment is kept
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(2.5, part->getPoint(0).z, 1e-9);
+            delete part;
+        }
+        delete s;
+    }
+
+#ifdef TEST_CHECK_SPEED
+    void testSpeed() {
+        const int pointCount = 100000;
+
+        auto* s = new Stroke();
+        s->setWidth(1);
+        for (int i = 0; i < pointCount; i++) {
+            s->addPoint(Point(i * 0.5, 100 * std::sin(i * 0.01), 1 + 0.5 * std::sin(i * 0.1)));
+        }
+
+        SpeedTest speed;
+        speed.startTest("erase 2000 times across a stroke with 100000 points");
+
+        EraseableStroke e(s);
+        for (int i = 0; i < 2000; i++) {
+            double x = i * 25.0;
+            delete e.erase(x, 100 * std::sin(x / 50), 5);
+        }
+
+        speed.endTest();
+
+        for (Stroke* part: getStrokes(e, s)) {
+            delete part;
+        }
+        delete s;
+    }
+#endif
+};
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION(EraseableStrokeTest);
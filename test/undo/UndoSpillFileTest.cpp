@@ -0,0 +1,135 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <config-test.h>
+
+#include "model/Layer.h"
+#include "model/Stroke.h"
+#include "model/XojPage.h"
+#include "undo/DeleteUndoAction.h"
+#include "undo/UndoSpillFile.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class UndoSpillFileTest: public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(UndoSpillFileTest);
+
+    CPPUNIT_TEST(testWriteRead);
+    CPPUNIT_TEST(testFreeReusesBlocks);
+    CPPUNIT_TEST(testSpillRestore);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() {}
+
+    void tearDown() {}
+
+    void testWriteRead() {
+        UndoSpillFile file;
+
+        vector<int> a(10000);
+        for (size_t i = 0; i < a.size(); i++) {
+            a[i] = static_cast<int>(i % 100);
+        }
+        string b = "second block";
+
+        UndoSpillFile::BlockId idA = 0;
+        UndoSpillFile::BlockId idB = 0;
+        CPPUNIT_ASSERT(file.write(a.data(), a.size() * sizeof(int), idA));
+        CPPUNIT_ASSERT(file.write(b.data(), b.size(), idB));
+        CPPUNIT_ASSERT(idA != idB);
+        CPPUNIT_ASSERT_EQUAL(a.size() * sizeof(int) + b.size(), file.getDataSize());
+
+        // Compressed
+        CPPUNIT_ASSERT(file.getSize() < file.getDataSize());
+
+        string readB(b.size(), ' ');
+        CPPUNIT_ASSERT(file.read(idB, &readB[0], readB.size()));
+        CPPUNIT_ASSERT_EQUAL(b, readB);
+
+        vector<int> readA(a.size());
+        CPPUNIT_ASSERT(file.read(idA, readA.data(), readA.size() * sizeof(int)));
+        CPPUNIT_ASSERT(a == readA);
+
+        // The size needs to match
+        CPPUNIT_ASSERT(!file.read(idA, readA.data(), sizeof(int)));
+    }
+
+    void testFreeReusesBlocks() {
+        UndoSpillFile file;
+
+        string data = "data";
+        UndoSpillFile::BlockId first = 0;
+        UndoSpillFile::BlockId second = 0;
+        CPPUNIT_ASSERT(file.write(data.data(), data.size(), first));
+        CPPUNIT_ASSERT(file.write(data.data(), data.size(), second));
+
+        file.free(first);
+        CPPUNIT_ASSERT_EQUAL(data.size(), file.getDataSize());
+        CPPUNIT_ASSERT(!file.read(first, &data[0], data.size()));
+
+        UndoSpillFile::BlockId third = 0;
+        CPPUNIT_ASSERT(file.write(data.data(), data.size(), third));
+        CPPUNIT_ASSERT_EQUAL(first, third);
+
+        file.free(second);
+        file.free(third);
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), file.getSize());
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), file.getDataSize());
+    }
+
+    void testSpillRestore() {
+        UndoSpillFile file;
+        auto page = std::make_shared<XojPage>(100, 100);
+        Layer layer;
+
+        auto* s1 = new Stroke();
+        auto* s2 = new Stroke();
+        for (int i = 0; i < 100; i++) {
+            s1->addPoint(Point(i, i, 1));
+            s2->addPoint(Point(i, 2 * i));
+        }
+        vector<Point> points1 = s1->getPointVector();
+        vector<Point> points2 = s2->getPointVector();
+
+        // The strokes were deleted, so the action owns them
+        DeleteUndoAction action(page, false);
+        action.addElement(&layer, s1, 0);
+        action.addElement(&layer, s2, 1);
+
+        size_t usage = action.getMemoryUsage();
+        CPPUNIT_ASSERT(usage > 200 * sizeof(Point));
+
+        action.spill(file);
+        CPPUNIT_ASSERT(action.isSpilled());
+        CPPUNIT_ASSERT_EQUAL(0, s1->getPointCount());
+        CPPUNIT_ASSERT_EQUAL(0, s2->getPointCount());
+        CPPUNIT_ASSERT_EQUAL(usage - 200 * sizeof(Point), action.getMemoryUsage());
+        CPPUNIT_ASSERT(file.getSize() > 0);
+
+        action.restore();
+        CPPUNIT_ASSERT(!action.isSpilled());
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), file.getSize());
+        CPPUNIT_ASSERT_EQUAL(usage, action.getMemoryUsage());
+
+        CPPUNIT_ASSERT_EQUAL(points1.size(), s1->getPointVector().size());
+        CPPUNIT_ASSERT_EQUAL(points2.size(), s2->getPointVector().size());
+        for (size_t i = 0; i < points1.size(); i++) {
+            CPPUNIT_ASSERT(points1[i].equalsPos(s1->getPointVector()[i]));
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(points1[i].z, s1->getPointVector()[i].z, 1e-9);
+            CPPUNIT_ASSERT(points2[i].equalsPos(s2->getPointVector()[i]));
+        }
+    }
+};
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION(UndoSpillFileTest);
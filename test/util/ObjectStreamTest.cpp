@@ -0,0 +1,246 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <climits>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <config-test.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "serializing/BinObjectEncoding.h"
+#include "serializing/ObjectInputStream.h"
+#include "serializing/ObjectOutputStream.h"
+#include "serializing/Serializeable.h"
+
+#ifdef TEST_CHECK_SPEED
+#include "SpeedTest.cpp"
+#endif
+
+using std::string;
+using std::vector;
+
+struct TestPoint {
+    double x;
+    double y;
+    double z;
+};
+
+class ObjectStreamTest: public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(ObjectStreamTest);
+
+    CPPUNIT_TEST(testRoundTrip);
+    CPPUNIT_TEST(testArray);
+    CPPUNIT_TEST(testCompactIntegers);
+    CPPUNIT_TEST(testLegacyFormat);
+    CPPUNIT_TEST(testTruncated);
+
+#ifdef TEST_CHECK_SPEED
+    CPPUNIT_TEST(testThroughput);
+#endif
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() {}
+
+    void tearDown() {}
+
+    static bool readStream(ObjectInputStream& in, GString* data) {
+        bool result = in.read(data->str, data->len);
+        g_string_free(data, true);
+        return result;
+    }
+
+    void testRoundTrip() {
+        ObjectOutputStream out(new BinObjectEncoding());
+        out.writeObject("Test");
+        out.writeInt(0);
+        out.writeInt(-1);
+        out.writeInt(300);
+        out.writeInt(INT_MIN);
+        out.writeInt(INT_MAX);
+        out.writeDouble(-12.5);
+        out.writeSizeT(0);
+        out.writeSizeT(SIZE_MAX);
+        out.writeString("");
+        out.writeString("Text \xc3\xa4\xc3\xb6\xc3\xbc");
+        out.writeData(nullptr, 5, 8);
+        out.endObject();
+
+        ObjectInputStream in;
+        CPPUNIT_ASSERT(readStream(in, out.getStr()));
+
+        CPPUNIT_ASSERT_EQUAL(string("Test"), in.getNextObjectName());
+        in.readObject("Test");
+        CPPUNIT_ASSERT_EQUAL(0, in.readInt());
+        CPPUNIT_ASSERT_EQUAL(-1, in.readInt());
+        CPPUNIT_ASSERT_EQUAL(300, in.readInt());
+        CPPUNIT_ASSERT_EQUAL(INT_MIN, in.readInt());
+        CPPUNIT_ASSERT_EQUAL(INT_MAX, in.readInt());
+        CPPUNIT_ASSERT_EQUAL(-12.5, in.readDouble());
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), in.readSizeT());
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(SIZE_MAX), in.readSizeT());
+        CPPUNIT_ASSERT_EQUAL(string(""), in.readString());
+        CPPUNIT_ASSERT_EQUAL(string("Text \xc3\xa4\xc3\xb6\xc3\xbc"), in.readString());
+
+        void* data = nullptr;
+        int len = -1;
+        in.readData(&data, &len);
+        CPPUNIT_ASSERT_EQUAL(0, len);
+        CPPUNIT_ASSERT(data == nullptr);
+
+        in.endObject();
+    }
+
+    void testArray() {
+        vector<TestPoint> points;
+        for (int i = 0; i < 1000; i++) {
+            points.push_back({i * 0.5, -i * 0.25, i / 1000.0});
+        }
+
+        ObjectOutputStream out(new BinObjectEncoding());
+        out.writeArray(points);
+        out.writeArray(vector<TestPoint>());
+        out.writeData(points.data(), points.size(), sizeof(TestPoint));
+
+        ObjectInputStream in;
+        CPPUNIT_ASSERT(readStream(in, out.getStr()));
+
+        vector<TestPoint> read = in.readArray<TestPoint>();
+        CPPUNIT_ASSERT_EQUAL(points.size(), read.size());
+        CPPUNIT_ASSERT_EQUAL(0, memcmp(points.data(), read.data(), points.size() * sizeof(TestPoint)));
+
+        CPPUNIT_ASSERT(in.readArray<TestPoint>().empty());
+
+        // Arrays can also be read as raw data
+        void* data = nullptr;
+        int len = 0;
+        in.readData(&data, &len);
+        CPPUNIT_ASSERT_EQUAL(static_cast<int>(points.size()), len);
+        CPPUNIT_ASSERT_EQUAL(0, memcmp(points.data(), data, points.size() * sizeof(TestPoint)));
+        g_free(data);
+    }
+
+    void testCompactIntegers() {
+        ObjectOutputStream out(new BinObjectEncoding());
+        GString* header = out.getStr();
+        gsize headerLen = header->len;
+        g_string_free(header, true);
+
+        ObjectOutputStream out2(new BinObjectEncoding());
+        for (int i = -60; i < 60; i++) {
+            out2.writeInt(i);
+        }
+
+        // One byte type tag and one byte value for small numbers, the old format used 6 bytes
+        GString* data = out2.getStr();
+        CPPUNIT_ASSERT_EQUAL(headerLen + 120 * 2, static_cast<gsize>(data->len));
+        g_string_free(data, true);
+    }
+
+    static void appendLegacy(string& s, char type, const void* data, size_t len) {
+        s += '_';
+        s += type;
+        s.append(static_cast<const char*>(data), len);
+    }
+
+    static void appendLegacyString(string& s, const string& str) {
+        int len = str.length();
+        appendLegacy(s, 's', &len, sizeof(int));
+        s += str;
+    }
+
+    void testLegacyFormat() {
+        string s;
+        appendLegacyString(s, XML_VERSION_STR);
+        s += "_{";
+        appendLegacyString(s, "Test");
+        int i = -42;
+        appendLegacy(s, 'i', &i, sizeof(int));
+        double d = 3.25;
+        appendLegacy(s, 'd', &d, sizeof(double));
+        size_t st = 123456789;
+        appendLegacy(s, 'l', &st, sizeof(size_t));
+        appendLegacyString(s, "legacy");
+        int header[2] = {2, sizeof(TestPoint)};
+        TestPoint points[2] = {{1, 2, 3}, {4, 5, 6}};
+        appendLegacy(s, 'b', header, sizeof(header));
+        s.append(reinterpret_cast<const char*>(points), sizeof(points));
+        s += "_}";
+
+        ObjectInputStream in;
+        CPPUNIT_ASSERT(in.read(s.c_str(), s.length()));
+        in.readObject("Test");
+        CPPUNIT_ASSERT_EQUAL(-42, in.readInt());
+        CPPUNIT_ASSERT_EQUAL(3.25, in.readDouble());
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(123456789), in.readSizeT());
+        CPPUNIT_ASSERT_EQUAL(string("legacy"), in.readString());
+
+        vector<TestPoint> read = in.readArray<TestPoint>();
+        CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), read.size());
+        CPPUNIT_ASSERT_EQUAL(6.0, read[1].z);
+
+        in.endObject();
+    }
+
+    void testTruncated() {
+        ObjectOutputStream out(new BinObjectEncoding());
+        out.writeString("A string which is cut off");
+        GString* data = out.getStr();
+
+        ObjectInputStream in;
+        CPPUNIT_ASSERT(in.read(data->str, data->len - 5));
+        g_string_free(data, true);
+
+        CPPUNIT_ASSERT_THROW(in.readString(), InputStreamException);
+    }
+
+#ifdef TEST_CHECK_SPEED
+    void testThroughput() {
+        const int strokeCount = 20000;
+        vector<TestPoint> points(200, TestPoint{1.5, 2.5, 0.5});
+
+        SpeedTest speed;
+        speed.startTest("serialize 20000 strokes");
+
+        ObjectOutputStream out(new BinObjectEncoding());
+        for (int i = 0; i < strokeCount; i++) {
+            out.writeObject("Stroke");
+            out.writeDouble(1.41);
+            out.writeInt(i);
+            out.writeInt(-1);
+            out.writeArray(points);
+            out.endObject();
+        }
+        GString* data = out.getStr();
+
+        speed.endTest();
+        speed.startTest("deserialize 20000 strokes");
+
+        ObjectInputStream in;
+        CPPUNIT_ASSERT(readStream(in, data));
+        for (int i = 0; i < strokeCount; i++) {
+            in.readObject("Stroke");
+            in.readDouble();
+            CPPUNIT_ASSERT_EQUAL(i, in.readInt());
+            in.readInt();
+            CPPUNIT_ASSERT_EQUAL(points.size(), in.readArray<TestPoint>().size());
+            in.endObject();
+        }
+
+        speed.endTest();
+    }
+#endif
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ObjectStreamTest);
@@ -0,0 +1,119 @@
+/*
+ * Xournal++
+ *
+ * This file is part of the Xournal UnitTests
+ *
+ * @author Xournal++ Team
+ * https://github.com/xournalpp/xournalpp
+ *
+ * @license GNU GPLv2 or later
+ */
+
+#include <cstring>
+
+#include "model/XojPage.h"
+#include "view/background/BackgroundPatternCache.h"
+#include "view/background/MainBackgroundPainter.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+class BackgroundPatternCacheTest: public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(BackgroundPatternCacheTest);
+
+    CPPUNIT_TEST(testSameAsVector);
+    CPPUNIT_TEST(testVectorTarget);
+
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp() { BackgroundPatternCache::getInstance().clear(); }
+
+    void tearDown() { BackgroundPatternCache::getInstance().clear(); }
+
+    static PageRef createPage(PageTypeFormat format) {
+        auto page = std::make_shared<XojPage>(595.0, 842.0);
+        page->setBackgroundType(PageType(format));
+        return page;
+    }
+
+    /**
+     * Renders the background into an image, via the cache unless vector is set
+     */
+    static cairo_surface_t* render(const PageRef& page, double zoom, int x, int y, bool vector) {
+        cairo_surface_t* image = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 400, 300);
+
+        cairo_surface_t* target = image;
+        if (vector) {
+            target = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, nullptr);
+        }
+
+        cairo_t* cr = cairo_create(target);
+        cairo_translate(cr, -x, -y);
+        cairo_scale(cr, zoom, zoom);
+        MainBackgroundPainter painter;
+        painter.paint(page->getBackgroundType(), cr, page);
+        cairo_destroy(cr);
+
+        if (vector) {
+            cr = cairo_create(image);
+            cairo_set_source_surface(cr, target, 0, 0);
+            cairo_paint(cr);
+            cairo_destroy(cr);
+            cairo_surface_destroy(target);
+        }
+
+        cairo_surface_flush(image);
+        return image;
+    }
+
+    static bool equals(cairo_surface_t* a, cairo_surface_t* b) {
+        int size = cairo_image_surface_get_stride(a) * cairo_image_surface_get_height(a);
+        return std::memcmp(cairo_image_surface_get_data(a), cairo_image_surface_get_data(b), size) == 0;
+    }
+
+    void testSameAsVector() {
+        for (PageTypeFormat format: {PageTypeFormat::Ruled, PageTypeFormat::Lined, PageTypeFormat::Staves,
+                                     PageTypeFormat::Graph, PageTypeFormat::Dotted, PageTypeFormat::IsoDotted,
+                                     PageTypeFormat::IsoGraph}) {
+            PageRef page = createPage(format);
+
+            // The first call renders the cache, the second one paints from it
+            for (int i = 0; i < 2; i++) {
+                cairo_surface_t* cached = render(page, 1.37, 120, 250, false);
+                cairo_surface_t* vector = render(page, 1.37, 120, 250, true);
+                CPPUNIT_ASSERT(equals(cached, vector));
+                cairo_surface_destroy(cached);
+                cairo_surface_destroy(vector);
+            }
+        }
+    }
+
+    void testVectorTarget() {
+        PageRef page = createPage(PageTypeFormat::Graph);
+
+        cairo_surface_t* recording = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, nullptr);
+        cairo_t* cr = cairo_create(recording);
+        bool painted = BackgroundPatternCache::getInstance().paint(
+                cr, {page->getBackgroundType(), page->getWidth(), page->getHeight(), page->getBackgroundColor(), 1, 1},
+                [](cairo_t*) {});
+        CPPUNIT_ASSERT(!painted);
+
+        // Not on the pixel grid
+        cairo_surface_t* image = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 10, 10);
+        cairo_t* crImage = cairo_create(image);
+        cairo_translate(crImage, 0.5, 0);
+        painted = BackgroundPatternCache::getInstance().paint(
+                crImage,
+                {page->getBackgroundType(), page->getWidth(), page->getHeight(), page->getBackgroundColor(), 1, 1},
+                [](cairo_t*) {});
+        CPPUNIT_ASSERT(!painted);
+
+        cairo_destroy(crImage);
+        cairo_surface_destroy(image);
+        cairo_destroy(cr);
+        cairo_surface_destroy(recording);
+    }
+};
+
+// Registers the fixture into the 'registry'
+CPPUNIT_TEST_SUITE_REGISTRATION(BackgroundPatternCacheTest);